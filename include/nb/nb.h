@@ -51,6 +51,8 @@
 * 2011-11-05 eat 0.8.6  Included nbmail.h
 * 2014-02-16 eat 0.9.01 Conditional OpenSSL headers (also in 0.8.16)
 * 2014-12-05 eat 0.9.03 Include safe option for demo site - may change this
+* 2026-10-18 eat 0.9.04 Included nbcheckpoint.h
+* 2026-10-18 eat 0.9.04 Included nbmetric.h
 *============================================================================
 */
 #ifndef _NB_H_
@@ -101,6 +103,8 @@ extern int nb_opt_safe;       // prevent access to host environment
 #include <nb/nbverb.h>        /* verb structure */
 #include <nb/nbmath.h>        /* math functions */
 #include <nb/nbcall.h>        // cell function calls
+#include <nb/nbcheckpoint.h>  // checkpoint routines
+#include <nb/nbmetric.h>      // metric registry
 
 #ifdef HAVE_OPENSSL
 #include <nb/nbtls.h>         // TLS routines
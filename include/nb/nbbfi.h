@@ -36,6 +36,7 @@
 * 2003/03/15 eat 0.5.1  Created to conform to new make file
 * 2010-02-28 eat 0.7.9  Cleaned up -Wall warning messages (gcc 4.5.0)
 * 2012-12-31 eat 0.8.13 Checker updates
+* 2026-10-18 eat 0.9.04 Added array form (bfiv)
 *=============================================================================
 */
 /**************************************************************************
@@ -71,6 +72,7 @@ struct bfiseg {            /* bfi segment, where f(i) is truth */
 
 typedef struct bfiseg *bfi;
 extern bfi bfifree;
+extern int bfiListForm;  // use list form operations - for comparing with array form
 
 bfi bfiAlloc(void);
 bfi bfiNew(long start,long end);
@@ -108,3 +110,35 @@ bfi bfiOr(bfi g,bfi h);
 bfi bfiXor(bfi g,bfi h);
 bfi bfiXore(bfi g,bfi h);
 
+/*************************************************************************
+* Array Form
+*
+*   Segment start and end points are held in separate arrays ordered
+*   like a bfi list, for operations that benefit from random access.
+*************************************************************************/
+
+struct bfivec{
+  long start;              /* upper bound of domain - as in a bfi list head */
+  long end;                /* lower bound of domain */
+  size_t count;            /* number of segments */
+  size_t size;             /* number of segments allocated */
+  int  sorted;             /* segments are in bfi list order */
+  long *segStart;          /* segment start points - inclusive */
+  long *segEnd;            /* segment end points - exclusive */
+  };
+
+typedef struct bfivec *bfiv;
+
+bfiv bfivNew(long start,long end,size_t size);
+void bfivFree(bfiv v);
+void bfivInsert(bfiv v,long start,long end);
+void bfivSort(bfiv v,int unique);
+bfiv bfivFrom(bfi g);
+bfi  bfivList(bfiv v);
+bfiv bfivOr_(bfiv v);
+bfiv bfivOre_(bfiv v);
+bfiv bfivAnd(bfiv g,bfiv h);
+bfiv bfivOr(bfiv g,bfiv h);
+bfiv bfivOre(bfiv g,bfiv h);
+int  bfivEval(bfiv v,long i);
+
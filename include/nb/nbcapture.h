@@ -0,0 +1,64 @@
+/*
+* Copyright (C) 2014 Ed Trettevik <eat@nodebrain.org>
+*
+* NodeBrain is free software; you can modify and/or redistribute it under the
+* terms of either the MIT License (Expat) or the following NodeBrain License.
+*
+* Permission to use and redistribute with or without fee, in source and binary
+* forms, with or without modification, is granted free of charge to any person
+* obtaining a copy of this software and included documentation, provided that
+* the above copyright notice, this permission notice, and the following
+* disclaimer are retained with source files and reproduced in documention
+* included with source and binary distributions.
+*
+* Unless required by applicable law or agreed to in writing, this software is
+* distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+* KIND, either express or implied.
+*
+*=============================================================================
+* Program:  NodeBrain
+*
+* File:     nbcapture.h
+*
+* Title:    Event Capture and Replay Header
+*
+* Function:
+*
+*   This header defines routines that capture inbound commands and timer
+*   alarms to a file and replay them for load testing.
+*
+* See nbcapture.c for more information.
+*=============================================================================
+* Change History:
+*
+*    Date    Name/Change
+* ---------- -----------------------------------------------------------------
+* 2026-10-18 eat 0.9.04 (original prototype)
+*=============================================================================
+*/
+#ifndef _NB_CAPTURE_H_
+#define _NB_CAPTURE_H_
+
+#define NB_CAPTURE_MAGIC     "NBCAP01\n"  // file identifier and format version
+#define NB_CAPTURE_COMMAND   'C'          // command record
+#define NB_CAPTURE_ALARM     'A'          // timer alarm record
+
+typedef struct NB_CAPTURE{
+  FILE          *file;        // capture file
+  char          *buffer;      // output buffer
+  char          *name;        // capture file name
+  unsigned long long start;   // monotonic time of first record (ns)
+  unsigned long long last;    // monotonic time of last record (ns)
+  unsigned long commands;     // commands recorded
+  unsigned long alarms;       // alarms recorded
+  } NB_Capture;
+
+extern NB_Capture *nb_capture;    // active capture - NULL when not capturing
+extern int nb_captureHold;        // nested command depth - only depth 0 is recorded
+
+void nbCaptureInit(NB_Stem *stem);
+void nbCaptureCommand(nbCELL context,char *cursor,unsigned char cmdopt);
+void nbCaptureAlarm(time_t time);
+void nbCaptureClose(void);
+
+#endif
@@ -0,0 +1,113 @@
+/*
+* Copyright (C) 2014 Ed Trettevik <eat@nodebrain.org>
+*
+* NodeBrain is free software; you can modify and/or redistribute it under the
+* terms of either the MIT License (Expat) or the following NodeBrain License.
+*
+* Permission to use and redistribute with or without fee, in source and binary
+* forms, with or without modification, is granted free of charge to any person
+* obtaining a copy of this software and included documentation, provided that
+* the above copyright notice, this permission notice, and the following
+* disclaimer are retained with source files and reproduced in documention
+* included with source and binary distributions.
+*
+* Unless required by applicable law or agreed to in writing, this software is
+* distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+* KIND, either express or implied.
+*
+*=============================================================================
+* Program:  NodeBrain
+*
+* File:     nbcheckpoint.h
+*
+* Title:    Runtime State Checkpoint Header
+*
+* Function:
+*
+*   This header defines routines that save the runtime state of an agent to
+*   a checkpoint file and restore it.  The external API is used by node
+*   modules that implement the NB_NODE_SAVE and NB_NODE_RESTORE methods.
+*
+* See nbcheckpoint.c for more information.
+*=============================================================================
+* Change History:
+*
+*    Date    Name/Change
+* ---------- -----------------------------------------------------------------
+* 2026-10-18 eat 0.9.04 (original prototype)
+*=============================================================================
+*/
+#ifndef _NB_CHECKPOINT_H_
+#define _NB_CHECKPOINT_H_
+
+#if defined(NB_INTERNAL)
+
+#define NB_CHECKPOINT_MAGIC   "NBCKP01\n"  // file identifier and format version
+
+#define NB_CHECKPOINT_TERM    'T'          // asserted term value
+#define NB_CHECKPOINT_NODE    'N'          // node skill state
+#define NB_CHECKPOINT_TIMER   'A'          // pending node timer
+
+#define NB_CHECKPOINT_UNKNOWN 'U'          // cell value codes
+#define NB_CHECKPOINT_TRUE    '1'
+#define NB_CHECKPOINT_FALSE   '0'
+#define NB_CHECKPOINT_REAL    'R'
+#define NB_CHECKPOINT_STRING  'S'
+
+typedef struct NB_CHECKPOINT{
+  char          *data;        // buffer
+  size_t         size;        // allocated size
+  size_t         used;        // bytes used while saving
+  char          *cursor;      // read position while restoring
+  char          *end;         // end of current record while restoring
+  unsigned long  terms;       // term values saved or restored
+  unsigned long  nodes;       // nodes saved or restored
+  unsigned long  timers;      // timers saved or restored
+  } NB_Checkpoint;
+
+typedef NB_Checkpoint *nbCHECKPOINT;
+
+extern char nb_checkpointName[256];  // checkpoint file name - see "checkpoint" setting
+
+void nbCheckpointInit(NB_Stem *stem);
+void nbCheckpointStart(nbCELL context);
+void nbCheckpointStop(void);
+
+#else  // !NB_INTERNAL
+typedef void *nbCHECKPOINT;  // checkpoint stream handle passed to save and restore methods
+#endif // NB_INTERNAL
+
+//**********************************************
+// External API
+
+#if defined(WIN32)
+_declspec (dllexport)
+#endif
+extern int nbCheckpointPut(nbCELL context,nbCHECKPOINT checkpoint,void *data,size_t len);
+
+#if defined(WIN32)
+_declspec (dllexport)
+#endif
+extern int nbCheckpointGet(nbCELL context,nbCHECKPOINT checkpoint,void *data,size_t len);
+
+#if defined(WIN32)
+_declspec (dllexport)
+#endif
+extern int nbCheckpointPutInt(nbCELL context,nbCHECKPOINT checkpoint,unsigned long long value);
+
+#if defined(WIN32)
+_declspec (dllexport)
+#endif
+extern int nbCheckpointGetInt(nbCELL context,nbCHECKPOINT checkpoint,unsigned long long *value);
+
+#if defined(WIN32)
+_declspec (dllexport)
+#endif
+extern int nbCheckpointPutCell(nbCELL context,nbCHECKPOINT checkpoint,nbCELL cell);
+
+#if defined(WIN32)
+_declspec (dllexport)
+#endif
+extern nbCELL nbCheckpointGetCell(nbCELL context,nbCHECKPOINT checkpoint);
+
+#endif
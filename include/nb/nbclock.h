@@ -42,6 +42,8 @@
 *            using a shorter MAXNAP we are able to shorten the time a child is
 *            a zombie.  See nbmedulla.c for process handling.
 * 2010-02-28 eat 0.7.9  Cleaned up -Wall warning messages (gcc 4.5.0)
+* 2026-10-18 eat 0.9.04 Included simulated clock for event replay
+* 2026-10-18 eat 0.9.04 Exposed timer queue for checkpoints
 *=============================================================================
 */
 #ifndef _NB_CLOCK_H_
@@ -67,6 +69,7 @@ extern int        nb_clockClock;  /* time breakdown function: see NB_CLOCK_GMT a
 extern int        nb_clockFormat; /* time display format */
                                   /* 0 "ssssssssss ", 1 "yyyy/mm/dd hh:mm:ss " */
 extern int        nb_ClockAlerting;
+extern time_t     nb_clockSimTime; /* simulated clock time - 0 when using system clock */
 
 struct NB_TIMER{
   struct NB_TIMER *next;    /* next timer */
@@ -76,12 +79,15 @@ struct NB_TIMER{
 
 typedef struct NB_TIMER NB_Timer;
 
+extern NB_Timer  *nb_timerQueue;  // timer queue - see nbcheckpoint.c for external use
+
 void       nbClockInit(NB_Stem *stem);
 
 struct tm *nbClockGetTm(int clock,time_t utc);
 char      *nbClockToString(time_t utc,char *buffer);
 void       nbClockShowTimers(char *cursor);
 void       nbClockShowProcess(char *cursor);
+void       nbClockSimulate(time_t simTime);
 
 #endif // NB_INTERNAL
 
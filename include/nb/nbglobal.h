@@ -41,6 +41,7 @@
 * 2010-10-16 eat 0.8.4  Included servegroup.
 * 2012-12-25 eat 0.8.13 Included nb_charset.
 * 2014-01-06 eat 0.9.00 Included performance testing options
+* 2026-10-18 eat 0.9.04 Included nb_opt_latency
 *============================================================================
 */
 #ifndef _NB_GLOBAL_H_
@@ -76,6 +77,7 @@ extern int  nb_opt_hush;      // suppress calls to log routines
 extern int  nb_opt_stats;     // display statistics
 extern int  nb_opt_boolnotrel;// boolean not relational (move not out of relational expressions)
 extern int  nb_opt_test;      // display pretend time to simplify output diff
+extern int  nb_opt_latency;   // time event pipeline stages
 
 extern int sourceTrace;       /* debugging trace flag for source input */
 extern int symbolicTrace;     /* debugging trace flag for symbolic sub */
@@ -44,6 +44,8 @@
 * 2008-10-23 Ed Trettevik (version 0.7.3 - extracted from old nb.h)
 *            nbi.h replaces old nb.h and new nb.h replaces old nbapi.h
 * 2014-01-12 eat 0.9.00 Included nbsentence and nbaxon headers
+* 2026-10-18 eat 0.9.04 Included nbcapture and nbimage headers
+* 2026-10-18 eat 0.9.04 Included nbreload and nbshard headers
 *============================================================================
 */
 #ifndef _NB_I_H_
@@ -92,4 +94,9 @@
 
 #include <nb/nb.h>
 
+#include <nb/nbcapture.h>     /* event capture and replay */
+#include <nb/nbimage.h>       /* rule image */
+#include <nb/nbreload.h>      /* incremental rule reload */
+#include <nb/nbshard.h>       /* shards */
+
 #endif
@@ -0,0 +1,79 @@
+/*
+* Copyright (C) 2014 Ed Trettevik <eat@nodebrain.org>
+*
+* NodeBrain is free software; you can modify and/or redistribute it under the
+* terms of either the MIT License (Expat) or the following NodeBrain License.
+*
+* Permission to use and redistribute with or without fee, in source and binary
+* forms, with or without modification, is granted free of charge to any person
+* obtaining a copy of this software and included documentation, provided that
+* the above copyright notice, this permission notice, and the following
+* disclaimer are retained with source files and reproduced in documention
+* included with source and binary distributions.
+*
+* Unless required by applicable law or agreed to in writing, this software is
+* distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+* KIND, either express or implied.
+*
+*=============================================================================
+* Program:  NodeBrain
+*
+* File:     nbimage.h
+*
+* Title:    Rule Image Header
+*
+* Function:
+*
+*   This header defines routines that save and load a compiled image of the
+*   rules loaded at startup.
+*
+* See nbimage.c for more information.
+*=============================================================================
+* Change History:
+*
+*    Date    Name/Change
+* ---------- -----------------------------------------------------------------
+* 2026-10-18 eat 0.9.04 (original prototype)
+*=============================================================================
+*/
+#ifndef _NB_IMAGE_H_
+#define _NB_IMAGE_H_
+
+#define NB_IMAGE_MAGIC     "NBIMG01\n"  // file identifier and format version
+
+#define NB_IMAGE_COMMAND   'C'          // resolved command
+#define NB_IMAGE_PUSH      'S'          // enter source file symbolic context
+#define NB_IMAGE_POP       'E'          // exit source file symbolic context
+#define NB_IMAGE_LET       '%'          // %assert or %default directive
+#define NB_IMAGE_ARG       'G'          // command line argument assertion
+
+typedef struct NB_IMAGE_BUFFER{
+  char          *data;        // buffer
+  size_t         size;        // allocated size
+  size_t         used;        // bytes used
+  } NB_ImageBuffer;
+
+typedef struct NB_IMAGE{
+  NB_ImageBuffer files;       // source file manifest
+  NB_ImageBuffer records;     // startup records
+  int            fileCount;   // number of files in manifest
+  char          *args;        // argument signature
+  int            recording;   // 1 while recording startup commands
+  int            loaded;      // 1 if startup came from the image
+  unsigned long  commands;    // number of commands
+  } NB_Image;
+
+extern char      nb_imageName[256];  // image file name - see "image" setting
+extern NB_Image *nb_image;           // startup image - NULL until arguments are processed
+extern int       nb_imageLine;       // next nbCmd() call is a source line to record
+
+int  nbImageStart(nbCELL context,int argc,char *argv[],int arg);
+void nbImageStop(void);
+void nbImageSource(char *filename,char *args);
+void nbImageSourceEnd(void);
+void nbImageCommand(nbCELL context,char symid,char *verb,char *cursor);
+void nbImageLet(char *cursor,int mode);
+void nbImageArg(char *cursor);
+int  nbImageArchive(char *cursor);
+
+#endif
@@ -42,6 +42,7 @@
 * 2008-03-24 eat 0.7.0  Started IP_CHANNEL structure as alternative to NBP CHANNEL
 * 2010-02-28 eat 0.7.9  Cleaned up -Wall warning messages. (gcc 4.5.0)
 * 2012-12-25 eat 0.8.13 Corrected buffer data type
+* 2026-10-18 eat 0.9.04 Included datagram record and replay functions
 *=============================================================================
 */
 #ifndef _NB_IP_H_
@@ -165,4 +166,24 @@ _declspec (dllexport)
 #endif
 extern int nbIpTcpConnect(char *addr,unsigned short port);
 
+#if defined(WIN32)
+_declspec (dllexport)
+#endif
+extern int nbIpRecordParse(nbCELL context,char *text,char *verb,size_t verbSize,char *filename,size_t fileSize,int *repeat);
+
+#if defined(WIN32)
+_declspec (dllexport)
+#endif
+extern FILE *nbIpRecord(nbCELL context,FILE *record,char *filename,char *magic);
+
+#if defined(WIN32)
+_declspec (dllexport)
+#endif
+extern FILE *nbIpRecordPut(nbCELL context,FILE *record,unsigned int addr,unsigned char *buffer,int len);
+
+#if defined(WIN32)
+_declspec (dllexport)
+#endif
+extern int nbIpReplay(nbCELL context,char *filename,char *magic,size_t maxlen,int repeat,void *handle,void (*handler)(nbCELL context,void *handle,unsigned int addr,unsigned char *buffer,int len),double *elapsed);
+
 #endif
@@ -44,6 +44,8 @@
 * 2008/03/08 eat 0.7.0  Removed file, pos, pipe from listener
 * 2008/03/09 eat 0.7.0  Moved old listener structure to nbprotocol.h
 * 2010/01/02 eat 0.7.7  Included type to enable separate read and write listeners
+* 2026-10-18 eat 0.9.04 Included event count for metrics
+* 2026-10-18 eat 0.9.04 Included latency set for event pipeline histograms
 *=============================================================================
 */
 #ifndef _NB_LISTENER_H_
@@ -63,8 +65,12 @@ typedef struct NB_LISTENER{
 #endif
   void             *session; /* session handle */
   void             (*handler)(struct NB_CELL *context,int fildes,void *session);
+  unsigned long long events; // handler calls
+  struct NB_LATENCY_SET *latency; // latency histograms for the node
   } NB_Listener;
 
+extern NB_Listener *selectUsed;  // active listeners
+
 #endif // NB_INTERNAL
 
 #if defined(WIN32)
@@ -36,6 +36,10 @@
 * 2007-05-04 eat 0.6.7  Increased command buffer size
 * 2008-09-30 eat 0.7.1  Included thread pointer in medulla structure
 * 2010-02-28 eat 0.7.9  Cleaned up -Wall warning messages. (gcc 4.5.0)
+* 2026-10-18 eat 0.9.04 Included pid hash chain in process structure
+* 2026-10-18 eat 0.9.04 Included post queue and worker threads
+* 2026-10-18 eat 0.9.04 Replaced stdout and stderr queues with line buffers
+* 2026-10-18 eat 0.9.04 Included nbMedullaSigChildUnblock and nbMedullaSigChildBlock
 *=============================================================================
 */
 #ifndef _NB_MEDULLA_H_
@@ -81,11 +85,14 @@ typedef struct NB_MEDULLA_PROCESS{
 // structure.  We can then redefine nbFILE to be a pointer to NB_MEDULLA_FILE
 #if !defined(WIN32)
   struct NB_MEDULLA_QUEUE *putQueue;
-  struct NB_MEDULLA_QUEUE *getQueue;
-  struct NB_MEDULLA_QUEUE *logQueue;
+  struct NB_MEDULLA_LINES *getLines;  // 2026-10-18 eat 0.9.04 - replaced getQueue
+  struct NB_MEDULLA_LINES *logLines;  // 2026-10-18 eat 0.9.04 - replaced logQueue
 #endif
+  struct NB_MEDULLA_PROCESS *pidNext;  // next entry in pid hash bucket
   } NB_Process,*nbPROCESS;
 
+#define NB_MEDULLA_PID_HASH_SIZE 1024  // processes by pid - power of 2
+
 extern nbPROCESS nb_process;
 
 #define NB_MEDULLA_PROCESS_TERM   1  // terminate on exit
@@ -190,6 +197,22 @@ struct NB_MEDULLA_BUFFER{
 typedef struct NB_MEDULLA_BUFFER NB_Buffer;
 typedef NB_Buffer *nbBUFFER;
 
+// Line buffer
+//
+//   Lines read from a child are framed in place and passed to the consumer
+//   without copying.  Only a partial line at the end is moved, and only when
+//   the space after it runs low.
+
+#define NB_MEDULLA_LINES_SIZE 64*1024
+
+typedef struct NB_MEDULLA_LINES{
+  char *data;     // first line not yet passed to the consumer
+  char *scan;     // where the search for the next newline resumes
+  char *free;     // end of data read
+  char *end;      // end of space for data - one byte is kept for a null
+  char buffer[NB_MEDULLA_LINES_SIZE];
+  } NB_Lines,*nbLINES;
+
 // General functions
 
 int nbMedullaOpen(void *session,int (*scheduler)(void *session),int (*processHandler)(nbPROCESS process,int pid,char *exittype,int exitcode));
@@ -251,6 +274,12 @@ int nbMedullaQueuePut(nbQUEUE queue,char *msg,size_t size);
 int nbMedullaQueueGet(nbQUEUE queue,char *msg,size_t size);
 nbQUEUE nbMedullaQueueClose(nbQUEUE queue);
 
+#if !defined(WIN32)
+nbLINES nbMedullaLinesOpen(void);
+int nbMedullaLinesRead(nbLINES lines,nbFILE fildes,nbPROCESS process,int (*consumer)(nbPROCESS process,int pid,void *session,char *msg));
+nbLINES nbMedullaLinesClose(nbLINES lines);
+#endif
+
 NB_MedullaFile *nbMedullaFileOpen(int option,nbFILE file,void *session,int (*handler)(void *medFile));
 int nbMedullaFileReader(NB_MedullaFile *medfile,void *session,int (*consumer)(void *session,char *msg));
 int nbMedullaFileClose(NB_MedullaFile *medfile);
@@ -260,6 +289,10 @@ int nbMedullaFileDisable(NB_MedullaFile *medfile);
 
 #endif
 extern void nbMedullaThreadCreate(NB_MEDULLA_WAIT_HANDLER handler,void *session);
+#if !defined(WIN32)
+void nbMedullaPostFork(void);
+void nbMedullaSigChildBlock(void);
+#endif
 
 #else  // !NB_INTERNAL (external interface only)
 
@@ -323,4 +356,20 @@ _declspec (dllexport)
 #endif
 extern nbPROCESS nbMedullaProcessClose(nbPROCESS process);
 
+// Post queue
+//
+//   Worker threads hand results to the main thread by posting a handler call.
+//   The handler is called by nbMedullaPulse() on the main thread, where it may
+//   use the interpreter.  A worker must not.
+
+#define NB_MEDULLA_POST_SIZE 4096  // post queue slots - power of 2
+
+typedef void (*NB_MEDULLA_POST_HANDLER)(void *session,void *data);
+
+#if !defined(WIN32)
+extern int nbMedullaPost(NB_MEDULLA_POST_HANDLER handler,void *session,void *data);
+extern int nbMedullaWorkerCreate(void *(*worker)(void *arg),void *arg);
+extern void nbMedullaSigChildUnblock(void);
+#endif
+
 #endif
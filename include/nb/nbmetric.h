@@ -0,0 +1,159 @@
+/*
+* Copyright (C) 2014 Ed Trettevik <eat@nodebrain.org>
+*
+* NodeBrain is free software; you can modify and/or redistribute it under the
+* terms of either the MIT License (Expat) or the following NodeBrain License.
+*
+* Permission to use and redistribute with or without fee, in source and binary
+* forms, with or without modification, is granted free of charge to any person
+* obtaining a copy of this software and included documentation, provided that
+* the above copyright notice, this permission notice, and the following
+* disclaimer are retained with source files and reproduced in documention
+* included with source and binary distributions.
+*
+* Unless required by applicable law or agreed to in writing, this software is
+* distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+* KIND, either express or implied.
+*
+*=============================================================================
+* Program:  NodeBrain
+*
+* File:     nbmetric.h
+*
+* Title:    Metric Header
+*
+* Function:
+*
+*   This header defines a registry of counters, gauges, and histograms that
+*   describe the engine and the modules it runs, and routines to expose them
+*   in the Prometheus text format.
+*
+* See nbmetric.c for more information.
+*=============================================================================
+* Change History:
+*
+*    Date    Name/Change
+* ---------- -----------------------------------------------------------------
+* 2026-10-18 eat 0.9.04 (original prototype)
+* 2026-10-18 eat 0.9.04 Included latency histograms for event pipeline stages
+*=============================================================================
+*/
+#ifndef _NB_METRIC_H_
+#define _NB_METRIC_H_
+
+#define NB_METRIC_COUNTER   1             // metric types
+#define NB_METRIC_GAUGE     2
+#define NB_METRIC_HISTOGRAM 3
+
+#define NB_METRIC_BUCKETS   16            // maximum histogram bucket bounds
+
+typedef struct NB_METRIC{
+  struct NB_METRIC *next;                 // next metric in registry
+  char    *name;                          // metric name
+  char    *labels;                        // label pairs without braces - NULL if none
+  char    *help;                          // help text
+  int     type;                           // see NB_METRIC_*
+  int     buckets;                        // number of histogram bucket bounds
+  double  value;                          // counter or gauge value - sum for histogram
+  double  count;                          // histogram observations
+  double  (*sample)(void *handle);        // gauge sample function - NULL to use value
+  void    *handle;                        // sample function handle
+  double  bound[NB_METRIC_BUCKETS];       // histogram bucket upper bounds - ascending
+  double  bucket[NB_METRIC_BUCKETS];      // histogram observations by bucket - not cumulative
+  } NB_Metric,*nbMETRIC;
+
+#if defined(NB_INTERNAL)
+
+// Latency histograms are log-linear: each power of 2 nanoseconds is split
+// into NB_LATENCY_SUB buckets, so a value is recorded within 12.5 percent.
+
+#define NB_LATENCY_SUBBITS 3                                // sub-bucket bits
+#define NB_LATENCY_SUB     (1<<NB_LATENCY_SUBBITS)          // sub-buckets per power of 2
+#define NB_LATENCY_BITS    40                               // values up to 2^40 ns (about 18 minutes)
+#define NB_LATENCY_SIZE    ((NB_LATENCY_BITS-NB_LATENCY_SUBBITS+1)*NB_LATENCY_SUB)
+
+#define NB_LATENCY_WAIT    0              // medulla readiness to listener handler
+#define NB_LATENCY_HANDLER 1              // listener handler
+#define NB_LATENCY_COMMAND 2              // command including reactions
+#define NB_LATENCY_REACT   3              // cell reaction
+#define NB_LATENCY_RULE    4              // rule action
+#define NB_LATENCY_FIRE    5              // event start to rule action
+#define NB_LATENCY_STAGES  6
+
+typedef struct NB_LATENCY{
+  double  count;                          // observations
+  double  sum;                            // nanoseconds
+  unsigned long long max;                 // largest observation
+  unsigned long long bucket[NB_LATENCY_SIZE];
+  } NB_Latency;
+
+typedef struct NB_LATENCY_SET{
+  struct NB_LATENCY_SET *next;            // next set
+  struct NB_CELL *context;                // node term - NULL for the agent
+  char    *name;                          // node name
+  NB_Latency stage[NB_LATENCY_STAGES];
+  } NB_LatencySet;
+
+extern NB_LatencySet *nb_latency;         // set for the event being processed - NULL for agent
+extern unsigned long long nb_latencyReady;  // time the medulla found files ready
+extern unsigned long long nb_latencyEvent;  // time the current event started - 0 when none
+
+unsigned long long nbLatencyNow(void);
+int nbLatencyIndex(unsigned long long value);
+unsigned long long nbLatencyLow(int index);
+unsigned long long nbLatencyObserve(int stage,unsigned long long start);
+NB_LatencySet *nbLatencySet(nbCELL context);
+void nbLatencyShow(void);
+
+extern NB_Metric nb_metricCommands;       // commands interpreted
+extern NB_Metric nb_metricFirings;        // rule firings
+extern NB_Metric nb_metricReacts;         // react cycles
+extern NB_Metric nb_metricPages;          // object pages allocated
+extern NB_Metric nb_metricEvalDepth;      // eval vector levels per cell reaction
+
+void nbMetricInit(NB_Stem *stem);
+void nbMetricStop(void);
+
+#endif // NB_INTERNAL
+
+#if defined(WIN32)
+_declspec (dllexport)
+#endif
+extern nbMETRIC nbMetricCounter(nbCELL context,char *name,char *labels,char *help);
+
+#if defined(WIN32)
+_declspec (dllexport)
+#endif
+extern nbMETRIC nbMetricGauge(nbCELL context,char *name,char *labels,char *help,double (*sample)(void *handle),void *handle);
+
+#if defined(WIN32)
+_declspec (dllexport)
+#endif
+extern nbMETRIC nbMetricHistogram(nbCELL context,char *name,char *labels,char *help,int buckets,double *bound);
+
+#if defined(WIN32)
+_declspec (dllexport)
+#endif
+extern void nbMetricAdd(nbMETRIC metric,double value);
+
+#if defined(WIN32)
+_declspec (dllexport)
+#endif
+extern void nbMetricSet(nbMETRIC metric,double value);
+
+#if defined(WIN32)
+_declspec (dllexport)
+#endif
+extern void nbMetricObserve(nbMETRIC metric,double value);
+
+#if defined(WIN32)
+_declspec (dllexport)
+#endif
+extern void nbMetricDrop(nbCELL context,nbMETRIC metric);
+
+#if defined(WIN32)
+_declspec (dllexport)
+#endif
+extern void nbMetricExpose(nbCELL context,void *handle,void (*put)(nbCELL context,void *handle,char *text));
+
+#endif
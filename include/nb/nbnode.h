@@ -37,6 +37,7 @@
 * 2013-01-11 eat 0.8.13 Checker updates
 * 2014-01-27 eat 0.9.00 Switch ifrule list to double linked and double root
 * 2014-06-14 eat 0.9.02 Include event transient terms
+* 2026-10-18 eat 0.9.04 Added save and restore methods for checkpoints
 *=============================================================================
 */
 #ifndef _NB_NODE_H_
@@ -111,6 +112,8 @@ typedef struct NB_FACET{
   void              (*solve)(struct NB_TERM *context,void *skillHandle,void *objectHandle,struct NB_LIST *args);
   int               (*command)(struct NB_TERM *context,void *skillHandle,void *objectHandle,struct NB_LIST *args,char *text);
   int               (*alert)(struct NB_TERM *context,void *skillHandle,void *objectHandle,NB_Cell *arglist,NB_Cell *value);
+  int               (*save)(struct NB_TERM *context,void *skillHandle,void *objectHandle,void *checkpoint);    // optional - NULL if not supported
+  int               (*restore)(struct NB_TERM *context,void *skillHandle,void *objectHandle,void *checkpoint); // optional - NULL if not supported
   struct NB_FACET_SHIM *shim;  // shim for facet methods
   } NB_Facet;
 
@@ -184,6 +187,8 @@ struct NB_FACET *nbFacetNew(NB_Skill *skill,const char *ident);
 #define NB_NODE_COMMAND  10  /* Interpret a node command */
 #define NB_NODE_ALARM    11  /* Alarm a node */
 #define NB_NODE_ALERT    12  /* Alert a node */
+#define NB_NODE_SAVE     13  /* Save node state to a checkpoint */
+#define NB_NODE_RESTORE  14  /* Restore node state from a checkpoint */
 
 
 #define NB_SHOW_ITEM   0 /* show node as single line item */
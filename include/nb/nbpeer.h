@@ -33,22 +33,38 @@
 *    Date    Name/Change
 * ---------- -----------------------------------------------------------------
 * 2010/01/07 eat 0.7.7  (original prototype) 
+* 2026-10-18 eat 0.9.04 Replaced fixed write buffer with a chain of buffers
 *=============================================================================
 */
 #ifndef _NBPEER_H_
 #define _NBPEER_H_       /* never again */
 
 #define NB_PEER_BUFLEN 64*1024  // buffer length
+#define NB_PEER_WRITE_MAX 4*NB_PEER_BUFLEN  // data queued before nbPeerSend reports full
+#define NB_PEER_FRAME_MAX 64*1024*1024  // largest record we send or accept
+#define NB_PEER_IOV 16          // buffers per write
+
+// 2026-10-18 eat 0.9.04 - write buffers are chained so records are never moved
+typedef struct NB_PEER_BUF{
+  struct NB_PEER_BUF *next;
+  int           size;    // bytes allocated for data
+  unsigned char *start;  // first byte not yet written
+  unsigned char *end;    // end of data
+  unsigned char data[1];
+  } nbPeerBuf;
 
 typedef struct NB_PEER{
   int           flags;   // see NB_PEER_FLAG_* 
 //  int           sd;      // socket we listen on - may preceed tls for now
 //  nbTLSX        *tlsx;
   nbTLS         *tls;
-  unsigned char *wbuf;
-  unsigned char *wloc;
+  nbPeerBuf     *wbuf;   // first buffer to write
+  nbPeerBuf     *wend;   // last buffer - new records are appended here
+  size_t        wsize;   // bytes queued for writing
+  size_t        wretry;  // size of TLS write to retry with the same buffer
   unsigned char *rbuf;
   unsigned char *rloc;
+  int           rsize;   // size of rbuf - grows for large records
   void          *handle;
   int  (*producer)(nbCELL context,struct NB_PEER *peer,void *handle);
   int  (*consumer)(nbCELL context,struct NB_PEER *peer,void *handle,void *data,int len);
@@ -80,7 +96,7 @@ extern int nbPeerConnect(nbCELL context,nbPeer *peer,void *handle,
   int (*consumer)(nbCELL context,nbPeer *peer,void *handle,void *data,int len),
   void (*shutdown)(nbCELL context,nbPeer *peer,void *handle,int code));
 
-extern int nbPeerSend(nbCELL context,nbPeer *peer,void *data,uint16_t len);
+extern int nbPeerSend(nbCELL context,nbPeer *peer,void *data,size_t len);
 
 extern int nbPeerShutdown(nbCELL context,nbPeer *peer,int code);
 
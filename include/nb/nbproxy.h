@@ -36,6 +36,8 @@
 * 2012-05-11 eat 0.8.9  Included NB_PROXY_FLAG_PRODUCER_SHUTDOWN flag
 * 2012-05-16 eat 0.8.9  Changed nbProxyConnect parameters - TLSX and URI replace tlsContext
 * 2012-05-19 eat 0.8.9  Included NB_PROXY_FLAG_CLIENT to support failover
+* 2026-10-18 eat 0.9.04 Included cached pages and nbProxyPutFile
+* 2026-10-18 eat 0.9.04 Included nbProxyBookJoin
 *=============================================================================
 */
 #ifndef _NBPROXY_H_
@@ -51,6 +53,8 @@ typedef struct NB_PROXY_PAGE{
   uint32_t      size;            // page size
   uint32_t      dataLen;         // data length
   unsigned char flags;           // see NB_PROXY_PAGE_FLAG_*
+  void         *handle;          // owner of cached data
+  void (*release)(void *handle); // called when a cached page is closed
   } nbProxyPage;
 
 #define NB_PROXY_PAGE_FLAG_CACHED 1  // static page - do not return to free pages
@@ -67,6 +71,9 @@ typedef struct NB_PROXY{
   nbTLS           *tls;     // TLS connection to client or server
   nbProxyBook      ibook;   // input book
   nbProxyBook      obook;   // output book
+  int              sendFile;   // file to send after the output book or -1 - see nbProxyPutFile
+  off_t            sendOffset; // offset of next byte to send
+  size_t           sendSize;   // bytes remaining to send
   void            *handle;
   int  (*producer)(nbCELL context,struct NB_PROXY *proxy,void *handle);
   int  (*consumer)(nbCELL context,struct NB_PROXY *proxy,void *handle);
@@ -99,12 +106,14 @@ extern int nbProxyBookWriteWhere(nbCELL context,nbProxyBook *book,void **data);
 extern int nbProxyBookProduced(nbCELL context,nbProxyBook *book,int len);
 extern int nbProxyBookReadWhere(nbCELL context,nbProxyBook *book,void **data);
 extern int nbProxyBookConsumed(nbCELL context,nbProxyBook *book,int len);
+extern int nbProxyBookJoin(nbCELL context,nbProxyBook *book);
 extern void *nbProxyBookClose(nbCELL context,nbProxyBook *book);
 //extern int nbProxySendBook(nbCELL context,nbProxy *proxy,nbProxyBook *book);
 
 extern nbProxyPage *nbProxyPageOpen(nbCELL context,void **data,size_t *size);
 extern int nbProxyPageProduced(nbCELL context,nbProxyPage *page,int len);
 extern void *nbProxyPageClose(nbCELL context,nbProxyPage *page);
+extern nbProxyPage *nbProxyPageOpenCached(nbCELL context,void *data,int len,void *handle,void (*release)(void *handle));
 
 extern nbProxy *nbProxyConstruct(nbCELL context,int client,nbCELL tlsContext,void *handle,
   int (*producer)(nbCELL context,nbProxy *proxy,void *handle),
@@ -132,6 +141,7 @@ extern nbProxy *nbProxyConnect(nbCELL context,nbTLSX *tlsx,char *uri,void *handl
 
 extern nbProxyPage *nbProxyGetPage(nbCELL context,nbProxy *proxy);
 extern int nbProxyPutPage(nbCELL context,nbProxy *proxy,nbProxyPage *page);
+extern int nbProxyPutFile(nbCELL context,nbProxy *proxy,int fd,off_t offset,size_t size);
 extern int nbProxyProduced(nbCELL context,nbProxy *proxy,int len);
 
 extern void nbProxyForward(nbCELL context,nbProxy *client,nbProxy *server,int option);
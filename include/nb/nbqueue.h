@@ -41,6 +41,7 @@
 *            1) cleaned up a bit to reduce compiler warning messages
 * 2009/02/14 eat 0.7.5 exported functions and made part of the nb library
 * 2010-02-28 eat 0.7.9  Cleaned up -Wall warning messages (gcc 4.5.0)
+* 2026-10-18 eat 0.9.04 Included segmented queue log (NBQ_LOG) functions
 *=============================================================================
 */
 #ifndef _NB_QUEUE_H_
@@ -117,6 +118,43 @@ struct NBQ_ENTRY{
   char   filename[255];       /* file name */
   };
 
+/*
+*  Segmented queue log
+*
+*    An identity directory may hold an append-only log instead of a file
+*    per transmission.  The log is a sequence of segment files and an offset
+*    file identifying the next record for consumers.
+*
+*      <queue>/<identity>/L.offset         sssssssssss ppppppppppppppppppp
+*      <queue>/<identity>/Lsssssssssss.log  one record per line
+*/
+#define NBQ_LOG_OFFSET      "L.offset"    // offset file name - presence selects the log format
+#define NBQ_LOG_OFFSET_SIZE 32            // offset file record size
+#define NBQ_LOG_SEGMENT     16*1024*1024  // segment size limit
+#define NBQ_LOG_SYNC        64            // records per sync
+
+struct NBQ_LOG{
+  struct NBQ_LOG *next;       // next cached producer
+  char   dirname[512];        // <queue>/<identity>
+  int    type;                // NBQ_PRODUCER or NBQ_CONSUMER
+  int    file;                // current segment - -1 when not open
+  int    offsetFile;          // consumer offset file - -1 for producers
+  unsigned int segment;       // current segment number
+  unsigned int firstSegment;  // consumer: first segment not yet removed
+  long   pos;                 // consumer: position of next record in segment
+  long   segmentSize;         // producer: segment size limit
+  unsigned int syncRecords;   // producer: records between syncs
+  unsigned int unsynced;      // producer: records written since last sync
+  time_t syncTime;            // producer: time of last sync
+  unsigned int records;       // consumer: records read since last commit
+  int    skip;                // consumer: skipping the rest of a long record
+  long   skipPos;             // consumer: position of the long record
+  long   recordPos;           // consumer: position of the last record read
+  char   *cursor;             // consumer: next record in buffer
+  char   *bufend;             // consumer: end of data in buffer
+  char   buffer[NB_BUFSIZE];
+  };
+
 #if defined(WIN32)
 _declspec (dllexport)
 #endif
@@ -191,5 +229,23 @@ _declspec (dllexport)
 #endif
 extern void nbQueueProcess(nbCELL context,char *dirname,nbCELL synapse);
 
+#if !defined(WIN32)
+extern int nbQueueLogExists(char *dirname,char *identityName);
+extern int nbQueueLogCreate(char *dirname,char *identityName);
+extern struct NBQ_LOG *nbQueueLogOpen(char *dirname,char *identityName,int type);
+extern struct NBQ_LOG *nbQueueLogGet(char *dirname,char *identityName);
+extern int nbQueueLogWrite(struct NBQ_LOG *log,char *record,size_t len);
+extern int nbQueueLogSync(struct NBQ_LOG *log);
+extern char *nbQueueLogRead(struct NBQ_LOG *log);
+extern void nbQueueLogRewind(struct NBQ_LOG *log);
+extern int nbQueueLogCommit(struct NBQ_LOG *log);
+extern void nbQueueLogClose(struct NBQ_LOG *log);
+extern void nbQueueLogStop(void);
+extern int nbQueueLogConvert(char *dirname,char *identityName);
+extern int nbQueueLogUnload(char *dirname,char *identityName,int drop);
+extern int nbQueueLogProcess(nbCELL context,char *dirname);
+extern int nbQueueBench(char *dirname,char *identityName,int records,double *seconds);
+#endif
+
 #endif
 
@@ -0,0 +1,61 @@
+/*
+* Copyright (C) 2014 Ed Trettevik <eat@nodebrain.org>
+*
+* NodeBrain is free software; you can modify and/or redistribute it under the
+* terms of either the MIT License (Expat) or the following NodeBrain License.
+*
+* Permission to use and redistribute with or without fee, in source and binary
+* forms, with or without modification, is granted free of charge to any person
+* obtaining a copy of this software and included documentation, provided that
+* the above copyright notice, this permission notice, and the following
+* disclaimer are retained with source files and reproduced in documention
+* included with source and binary distributions.
+*
+* Unless required by applicable law or agreed to in writing, this software is
+* distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+* KIND, either express or implied.
+*
+*=============================================================================
+* Program:  NodeBrain
+*
+* File:     nbreload.h
+*
+* Title:    Incremental Rule Reload Header
+*
+* Function:
+*
+*   This header defines routines that reload a rule file, redefining only
+*   the terms whose definitions have changed.
+*
+* See nbreload.c for more information.
+*=============================================================================
+* Change History:
+*
+*    Date    Name/Change
+* ---------- -----------------------------------------------------------------
+* 2026-10-18 eat 0.9.04 (original prototype)
+* 2026-10-18 eat 0.9.04 Included first reload flag
+*=============================================================================
+*/
+#ifndef _NB_RELOAD_H_
+#define _NB_RELOAD_H_
+
+typedef struct NB_RELOAD{
+  unsigned long  unchanged;   // definitions with the same text
+  unsigned long  changed;     // definitions redefined
+  unsigned long  added;       // new definitions
+  unsigned long  skipped;     // commands that are not definitions
+  int            first;       // first reload of the file - nothing is skipped
+  } NB_Reload;
+
+extern NB_Reload *nb_reload;       // active reload - NULL when not reloading
+extern int        nb_reloadLine;   // next nbCmd() call is a line of a reloaded file
+extern int        nb_reloadDefine; // next nbCmdDefine() call is a reloaded definition
+
+void       nbReloadInit(NB_Stem *stem);
+int        nbReloadCommand(char symid,char *verb);
+NB_String *nbReloadText(char *cursor);
+int        nbReloadSame(NB_Term *term,NB_String *text);
+void       nbReloadRecord(NB_Term *term,NB_String *text);
+
+#endif
@@ -38,6 +38,7 @@
 * 2005-05-15 eat 0.6.3  changed priority to signed char - not default on some platforms
 * 2010-02-28 eat 0.7.9  Cleaned up -Wall warning messages. (gcc 4.5.0)
 * 2014-01-27 eat 0.9.00 Include action.priorIf
+* 2026-10-18 eat 0.9.04 Included nbRuleReactQuietly for checkpoint restore
 *=============================================================================
 */
 #ifndef _NB_RULE_H_
@@ -269,6 +270,7 @@ NB_Object *nbRuleStep(NB_Rule *thread);
 NB_Rule   *nbRuleExec(NB_Cell *context,char *source);
 
 void       nbRuleDouse(void);
+void       nbRuleReactQuietly(void);
 
 void       nbRuleSolve(NB_Term *term);
 
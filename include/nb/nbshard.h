@@ -0,0 +1,83 @@
+/*
+* Copyright (C) 2014 Ed Trettevik <eat@nodebrain.org>
+*
+* NodeBrain is free software; you can modify and/or redistribute it under the
+* terms of either the MIT License (Expat) or the following NodeBrain License.
+*
+* Permission to use and redistribute with or without fee, in source and binary
+* forms, with or without modification, is granted free of charge to any person
+* obtaining a copy of this software and included documentation, provided that
+* the above copyright notice, this permission notice, and the following
+* disclaimer are retained with source files and reproduced in documention
+* included with source and binary distributions.
+*
+* Unless required by applicable law or agreed to in writing, this software is
+* distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+* KIND, either express or implied.
+*
+*=============================================================================
+* Program:  NodeBrain
+*
+* File:     nbshard.h
+*
+* Title:    Shard Header
+*
+* Function:
+*
+*   This header defines routines that partition independent rule sets into
+*   shards served by separate processes of a single agent, with a lock-free
+*   shared memory channel for commands between shards.
+*
+* See nbshard.c for more information.
+*=============================================================================
+* Change History:
+*
+*    Date    Name/Change
+* ---------- -----------------------------------------------------------------
+* 2026-10-18 eat 0.9.04 (original prototype)
+*=============================================================================
+*/
+#ifndef _NB_SHARD_H_
+#define _NB_SHARD_H_
+
+#define NB_SHARD_MAX        16            // maximum shards including main
+#define NB_SHARD_NAME_SIZE  64            // maximum shard name length plus one
+#define NB_SHARD_RING_SIZE  (256*1024)    // inbox size - must be a power of 2
+
+#define NB_SHARD_RECORD_FREE  0           // record states
+#define NB_SHARD_RECORD_READY 1
+#define NB_SHARD_RECORD_PAD   2
+
+typedef struct NB_SHARD_RECORD{
+  unsigned int          len;              // record length including header - multiple of 8
+  volatile unsigned int state;            // see NB_SHARD_RECORD_*
+  } NB_ShardRecord;
+
+typedef struct NB_SHARD{
+  char          name[NB_SHARD_NAME_SIZE]; // shard name
+  int           pid;                      // process id - 0 if not started
+  int           wakeRead;                 // wake pipe - read end
+  int           wakeWrite;                // wake pipe - write end
+  volatile int  wake;                     // 1 when a wake byte is pending
+  volatile unsigned long long reserve;    // next inbox position reserved by a sender
+  char          pad1[56];                 // keep senders and receiver on separate cache lines
+  volatile unsigned long long tail;       // next inbox position to receive
+  volatile unsigned long long received;   // commands received
+  volatile unsigned long long dropped;    // commands dropped because the inbox was full
+  char          pad2[40];
+  char          data[NB_SHARD_RING_SIZE]; // inbox
+  } NB_Shard;
+
+typedef struct NB_SHARD_TABLE{
+  volatile int  count;                    // shards defined including main
+  int           reserved;
+  NB_Shard      shard[NB_SHARD_MAX];      // shard[0] is main
+  } NB_ShardTable;
+
+extern NB_ShardTable *nb_shardTable;     // shared shard table - NULL until first shard is started
+extern int            nb_shardSelf;      // index of this process in the shard table
+
+void nbShardInit(NB_Stem *stem);
+void nbShardStop(void);
+
+#endif
@@ -36,6 +36,7 @@
 * 2002/10/08 Ed Trettevik (introduced in 0.4.1 A6)
 * 2006/03/26 eat 0.6.4  spawnExec and spawnSystem merged into nbSpawnChild
 * 2006/03/26 eat 0.6.4  spawnSkull replaced by nbSpawnSkull
+* 2026-10-18 eat 0.9.04 Included nbSpawnPool
 *=============================================================================
 */
 
@@ -45,6 +46,7 @@
 //#endif
 
 int nbSpawnChild(NB_Cell *context,int options,char *command);
+void nbSpawnPool(int max);
 
 #if defined(WIN32)
 _declspec (dllexport)
@@ -104,6 +104,7 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <sys/socket.h>
+#include <sys/uio.h>      // 2026-10-18 eat 0.9.04 - writev
 #include <netdb.h>
 #if defined(HAVE_SYS_TIME_H)
 #include <sys/time.h>
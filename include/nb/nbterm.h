@@ -37,6 +37,7 @@
 * 2008/02/08 eat 0.6.9  Glossary of terms changed to a binary tree
 * 2010/02/28 eat 0.7.9  Cleaned up -Wall warning messages (gcc 4.5.0)
 * 2014-01-26 eat 0.9.00 Switched glossary from tree to hash
+* 2026-10-18 eat 0.9.04 Included definition text recorded by the reload command
 *=============================================================================
 */
 #ifndef _NB_TERM_H_
@@ -67,6 +68,7 @@ typedef struct NB_TERM{
   //struct NB_TREE_NODE *terms;  /* subordinate glossary */
   NB_Hash *gloss;                // subordinate glossary of terms
   NB_Object *def;                // term definition
+  NB_String *reload;             // definition text recorded by reload command - see nbreload.c
   } NB_Term;
 
 extern NB_Term *termFree;
@@ -34,6 +34,7 @@
 * ---------- -----------------------------------------------------------------
 * 2003-03-15 eat 0.5.1  Created to conform to new make file
 * 2010-02-28 eat 0.7.9  Cleaned up -Wall warning messages. (gcc 4.5.0)
+* 2026-10-18 eat 0.9.04 Added shared time condition queues
 *=============================================================================
 */
 #ifndef _NBTIME_H_
@@ -78,8 +79,11 @@ struct tcDef{             /* time condition definition */
 typedef struct tcDef *tc;  /* time condition pointer */
 
 struct tcQueue{
+  struct tcQueue *next;  /* next queue in shared queue hash list */
+  char *key;        /* normalized expression for shared queues - or NULL */
   tc   tcdef;       /* Time Condition Definition */
   bfi  set;         /* Time Interval Set */
+  long end;         /* end of interval found by tcQueueTrue */
   };
 
 typedef struct tcQueue *tcq;
@@ -127,6 +131,7 @@ struct tcParm{
 
 tc tcParse(NB_Cell *context,char **source,char *msg,size_t msglen);
 tcq tcQueueNew(tc tcdef,long begin,long end);
+tcq tcQueueShare(tc tcdef,char *source,size_t len,long begin,long end);
 long tcQueueTrue(tcq queue,long begin,long end);
 long tcQueueFalse(tcq queue);
 
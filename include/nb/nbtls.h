@@ -35,6 +35,7 @@
 * ---------- -----------------------------------------------------------------
 * 2009-12-12 eat 0.7.7  (original prototype)
 * 2011-02-08 eat 0.8.5  Included nbTlsGetUri
+* 2026-10-18 eat 0.9.04 Included nbTlsWritev
 *=============================================================================
 */
 
@@ -146,6 +147,8 @@ extern int nbTlsRead(nbTLS *tls,char *buffer,size_t size);
 
 extern int nbTlsWrite(nbTLS *tls,char *buffer,size_t size);
 
+extern int nbTlsWritev(nbTLS *tls,struct iovec *iov,int iovcnt);
+
 extern int nbTlsClose(nbTLS *tls);
 
 extern int nbTlsFree(nbTLS *tls);
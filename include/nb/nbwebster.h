@@ -40,6 +40,8 @@
 * 2012-05-11 eat 0.8.9 - replace keepAlive flag with close flag
 * 2012-05-16 eat 0.8.9 - include forwardTlsx and forwardUri for reuse
 * 2012-12-30 eat 0.8.13 Included nbWebsterGetRootDir function
+* 2026-10-18 eat 0.9.04 Included static content cache
+* 2026-10-18 eat 0.9.04 Included session list and keep-alive timeout
 *==============================================================================
 */
 
@@ -72,6 +74,20 @@ typedef struct NB_WEB_USER{   // Webster User Structure
 //=============================================================================
 // New Structures
 //=============================================================================
+typedef struct NB_WEB_CACHE{       // Cached static file
+  struct NB_WEB_CACHE *next;       // next entry in hash chain
+  struct NB_WEB_CACHE *prior;      // more recently used entry
+  struct NB_WEB_CACHE *after;      // less recently used entry
+  char            *path;           // file path relative to document root
+  time_t           mtime;          // file modification time
+  off_t            fileSize;       // file size
+  int              refcnt;         // one for the cache plus one per page being sent
+  int              len;            // length of header fields and content
+  unsigned char   *data;           // header fields followed by content
+  } nbWebCache;
+
+#define NB_WEB_CACHE_HASH 509      // hash table size
+
 typedef struct NB_WEB_SERVER{      // Web Server
   nbCELL           context;        // node context
   nbCELL           siteContext;    // site context within node context
@@ -92,6 +108,19 @@ typedef struct NB_WEB_SERVER{      // Web Server
   nbWebUser       *userTree;       // List of authorized users
   nbCELL           filter;         // nodebrain translator (request filter)
   char            *config;         // configuration file name
+  nbWebCache     **cacheHash;      // static content cache hash table
+  nbWebCache      *cacheFirst;     // most recently used entry
+  nbWebCache      *cacheLast;      // least recently used entry
+  size_t           cacheSize;      // bytes of header fields and content cached
+  size_t           cacheMax;       // cache limit - "CacheSize" option in KB
+  size_t           cacheFileMax;   // largest file cached - "CacheFileSize" option in KB
+  unsigned long    cacheHits;      // requests served from the cache
+  unsigned long    cacheMisses;    // cacheable requests loaded from disk
+  struct NB_WEB_SESSION *sessions; // list of client sessions
+  nbCELL           synapse;        // keep-alive timer
+  time_t           timerTime;      // time keep-alive timer is set to expire - zero when not set
+  int              keepAliveTimeout; // seconds an idle connection is kept - "KeepAliveTimeout" option
+  int              keepAliveMax;   // requests served on a connection - "KeepAliveMax" option
   } nbWebServer;
 
 typedef struct NB_WEB_RESOURCE{   // Tree of cached resources
@@ -103,6 +132,8 @@ typedef struct NB_WEB_RESOURCE{   // Tree of cached resources
   
 typedef struct NB_WEB_SESSION{    // Web Session
   struct NB_TREE_NODE node;       // Binary tree node
+  struct NB_WEB_SESSION *next;    // next session in server list
+  struct NB_WEB_SESSION *prior;   // prior session in server list
   void            *handle;        // session handle
   char            *cookiesIn;     // cookies from client
   char            *cookiesOut;    // cookies to include in header fields
@@ -111,7 +142,7 @@ typedef struct NB_WEB_SESSION{    // Web Session
   struct NB_PROXY *client;        // connection to client
   struct NB_PROXY *server;        // connection to server (when acting as a proxy server)
   nbProxyBook      book;          // temporary book
-  int              fd;            // file descriptor (reading content files)
+  int              fd;            // file descriptor (reading content files) or -1
   //int              cgiClosed;     // flag indicated withn CGI program ended
   //nbCELL           userIdCell;    // Cell containing user
   //char            *userId;        // User ID
@@ -126,6 +157,11 @@ typedef struct NB_WEB_SESSION{    // Web Session
   char             method;        // request method - see NB_WEBSTER_METHOD_* below
   //char             keepAlive;     // keep connection for future request
   char             close;         // close connection after responding to request
+  char             gzip;          // client accepts gzip content encoding
+  char             busy;          // reply is in progress - hold pipelined requests
+  int              requests;      // requests received on this connection
+  time_t           idleTime;      // medulla clock time the connection became idle
+  int              reqlen;        // length of request including content
   char             reqcn[128];    // X509 certificate common name for valid certificate
   char             reqhost[512];  // request host
   char             reqauth[512];  // request authentication (basic - base64 encoded "user:password"
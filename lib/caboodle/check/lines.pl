@@ -0,0 +1,13 @@
+#!/usr/bin/perl
+# Write commands to check/lines.nb- so nb reads several lines at once,
+# a line split across reads, a partial line it must move to the front of
+# its line buffer, and a line longer than the buffer.
+sub put{syswrite(STDOUT,$_[0]);sleep 1;}
+put("assert a=1;\nassert b=2;\nassert c=3;\n");
+put("assert sp");
+put("lit=1;\n");
+put("#".("x" x 59998)."\nassert mo");
+put("ved=1;\n");
+$piece="assert piece1=1; #";
+$piece.="x" x (65535-length($piece));
+put($piece."assert piece2=1; #".("x" x 100)."\n");
@@ -0,0 +1,14 @@
+#!/usr/bin/perl
+# Scrape the metric socket for check/metric.nb-, then close the socket and
+# see that the close removes it.
+use IO::Socket::UNIX;
+$|=1;
+$path=shift;
+$sock=IO::Socket::UNIX->new(Type=>SOCK_STREAM,Peer=>$path) or exit 1;
+$text=join('',<$sock>);
+close($sock);
+print("assert commands=1;\n") if($text=~/^nb_commands_total \d+$/m);
+print("assert listener=1;\n") if($text=~/^nb_listener_events_total\{node="_",fd="\d+"\} \d+$/m);
+print("metric close\n");
+for($i=0;$i<10 && -S $path;$i++){sleep 1;}
+print("assert removed=1;\n") if(!-e $path);
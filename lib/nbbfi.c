@@ -80,6 +80,21 @@
 *   bfi bfiUntil(bfi g, bfi h);  Until
 *   bfi bfiYield(bfi g, bfi h);
 *
+*       Array Form
+*
+*   bfiv bfivNew(long start, long end, size_t size);
+*   void bfivFree(bfiv v);
+*   void bfivInsert(bfiv v, long start, long end);
+*   void bfivSort(bfiv v, int unique);
+*   bfiv bfivFrom(bfi g);
+*   bfi  bfivList(bfiv v);
+*   bfiv bfivOr_(bfiv v);         Connect (in place)
+*   bfiv bfivOre_(bfiv v);        Normalize (in place)
+*   bfiv bfivAnd(bfiv g, bfiv h);
+*   bfiv bfivOr(bfiv g, bfiv h);
+*   bfiv bfivOre(bfiv g, bfiv h);
+*   int  bfivEval(bfiv v, long i);
+*
 *
 * Description:
 *
@@ -172,6 +187,13 @@
 *   Our algorithms assure (and assume) that bfi list structures are properly
 *   ordered.   
 *
+*   A bfi may also be held in array form (bfiv), with segment start and end
+*   points in separate arrays in the same order as the list.  Segments can
+*   be added to an array in any order and sorted once, which is much cheaper
+*   than inserting out of order into a list.  The two set Boolean operations
+*   are implemented on arrays by merging, and a normalized array can be
+*   evaluated with a binary search.
+*
 *   Naming conventions used in this code are:
 *
 *     Functions/sets :   f,g,h   
@@ -194,6 +216,8 @@
 * 2013-01-23 eat 0.8.13 Checker updates
 * 2013-02-03 eat 0.8.13 Checker updates - CID 971426
 * 2014-01-25 eat 0.9.00 Checker updates
+* 2026-10-18 eat 0.9.04 Added array form with merge based operations
+* 2026-10-18 eat 0.9.04 Kept list form operations for comparison - see bfiListForm
 *=============================================================================
 */
 #include <nb/nbi.h>
@@ -339,6 +363,12 @@ void bfiIndexPrint(struct bfiindex *index){
 *************************************************************************/       
 bfi bfifree=NULL;
 
+/*
+*  When set, bfiAnd, bfiOr, bfiOre and tcComplex use the original list form
+*  operations so casts can be compared with the array form.
+*/
+int bfiListForm=0;
+
 /*************************************************************************
 *  Administrative Functions
 *************************************************************************/
@@ -1173,7 +1203,12 @@ bfi bfiYield(bfi g,bfi h){
 
 /*************************************************************************
 * Two Set Boolean Operations
+*
+*   These are merges of connected segments in array form.  The original
+*   list form operations are kept for comparison.
 *************************************************************************/ 
+static bfiv bfivConnectFrom(bfi g,int edge);
+
 /*
 *  And: (logical "and")
 *
@@ -1185,7 +1220,7 @@ bfi bfiYield(bfi g,bfi h){
 *    Result     ================================= 
 *                        |-----       |      |----   |-   |- 
 */
-bfi bfiAnd(bfi g,bfi h){
+static bfi bfiAndList(bfi g,bfi h){
   bfi f,F,G,H;
 
   G=bfiOr_(g);
@@ -1196,6 +1231,21 @@ bfi bfiAnd(bfi g,bfi h){
   f=bfiAnd_(F);
   bfiDispose(F);
   return(f);
+  }
+
+bfi bfiAnd(bfi g,bfi h){
+  bfi f;
+  bfiv G,H,F;
+
+  if(bfiListForm) return(bfiAndList(g,h));
+  G=bfivConnectFrom(g,0);
+  H=bfivConnectFrom(h,0);
+  F=bfivAnd(G,H);
+  bfivFree(G);
+  bfivFree(H);
+  f=bfivList(F);
+  bfivFree(F);
+  return(f);
   }  
 
 /*
@@ -1210,13 +1260,28 @@ bfi bfiAnd(bfi g,bfi h){
 *             |------    |-------- |------  |-------------------- 
 *                    |- 
 */
-bfi bfiOre(bfi g,bfi h){
+static bfi bfiOreList(bfi g,bfi h){
   bfi f,F;
 
   F=bfiUnion(g,h);  
   f=bfiOre_(F);
   bfiDispose(F);
   return(f);
+  }
+
+bfi bfiOre(bfi g,bfi h){
+  bfi f;
+  bfiv G,H,F;
+
+  if(bfiListForm) return(bfiOreList(g,h));
+  G=bfivConnectFrom(g,1);
+  H=bfivConnectFrom(h,1);
+  F=bfivOre(G,H);
+  bfivFree(G);
+  bfivFree(H);
+  f=bfivList(F);
+  bfivFree(F);
+  return(f);
   }  
 
 /*
@@ -1230,13 +1295,28 @@ bfi bfiOre(bfi g,bfi h){
 *    Result     ================================= 
 *             |--------  |-------- |------  |-------------------- 
 */
-bfi bfiOr(bfi g,bfi h){
+static bfi bfiOrList(bfi g,bfi h){
   bfi f,F;
 
   F=bfiUnion(g,h);  
   f=bfiOr_(F);
   bfiDispose(F);
   return(f);
+  }
+
+bfi bfiOr(bfi g,bfi h){
+  bfi f;
+  bfiv G,H,F;
+
+  if(bfiListForm) return(bfiOrList(g,h));
+  G=bfivConnectFrom(g,0);
+  H=bfivConnectFrom(h,0);
+  F=bfivOr(G,H);
+  bfivFree(G);
+  bfivFree(H);
+  f=bfivList(F);
+  bfivFree(F);
+  return(f);
   }  
 
 /*
@@ -1286,3 +1366,307 @@ bfi bfiXore(bfi g,bfi h){
   bfiDispose(F);
   return(f);
   }
+
+/*************************************************************************
+* Array Form
+*************************************************************************/
+/*
+*  Allocate a new array form function/set with room for size segments
+*/
+bfiv bfivNew(long start,long end,size_t size){
+  bfiv v;
+
+  v=(bfiv)nbAlloc(sizeof(struct bfivec));
+  if(end>start){
+    v->start=end;
+    v->end=start;
+    }
+  else{
+    v->start=start;
+    v->end=end;
+    }
+  if(size<16) size=16;
+  v->count=0;
+  v->size=size;
+  v->sorted=1;
+  v->segStart=(long *)malloc(size*sizeof(long));
+  v->segEnd=(long *)malloc(size*sizeof(long));
+  if(!v->segStart || !v->segEnd) nbExit("bfivNew: out of memory - terminating");
+  return(v);
+  }
+
+void bfivFree(bfiv v){
+  free(v->segStart);
+  free(v->segEnd);
+  nbFree(v,sizeof(struct bfivec));
+  }
+
+/*
+*  Add a segment to an array
+*
+*    Segments may be added in any order.  Call bfivSort before using the
+*    array if they were not added in order.
+*/
+void bfivInsert(bfiv v,long start,long end){
+  if(v->count>=v->size){
+    v->size*=2;
+    v->segStart=(long *)realloc(v->segStart,v->size*sizeof(long));
+    v->segEnd=(long *)realloc(v->segEnd,v->size*sizeof(long));
+    if(!v->segStart || !v->segEnd) nbExit("bfivInsert: out of memory - terminating");
+    }
+  if(v->count>0 && (start<v->segStart[v->count-1] || (start==v->segStart[v->count-1] && end<v->segEnd[v->count-1]))) v->sorted=0;
+  v->segStart[v->count]=start;
+  v->segEnd[v->count]=end;
+  v->count++;
+  }
+
+/*
+*  Sort segments into bfi list order
+*
+*    This is a stable merge sort by start and then end, so the result is
+*    the same as inserting the segments into a list with bfiInsert.  When
+*    unique is true, duplicate segments are dropped as by bfiInsertUnique.
+*/
+void bfivSort(bfiv v,int unique){
+  long *s=v->segStart,*e=v->segEnd,*ts,*te,*x;
+  size_t n=v->count,width,lo,mid,hi,i,j,k;
+
+  if(!v->sorted && n>1){
+    ts=(long *)malloc(n*sizeof(long));
+    te=(long *)malloc(n*sizeof(long));
+    if(!ts || !te) nbExit("bfivSort: out of memory - terminating");
+    for(width=1;width<n;width*=2){  /* merge runs of width from s,e into ts,te */
+      for(lo=0;lo<n;lo=hi){
+        mid=lo+width<n ? lo+width : n;
+        hi=mid+width<n ? mid+width : n;
+        for(i=lo,j=mid,k=lo;k<hi;k++){
+          if(j>=hi || (i<mid && (s[i]<s[j] || (s[i]==s[j] && e[i]<=e[j])))){
+            ts[k]=s[i];
+            te[k]=e[i++];
+            }
+          else{
+            ts[k]=s[j];
+            te[k]=e[j++];
+            }
+          }
+        }
+      x=s;s=ts;ts=x;
+      x=e;e=te;te=x;
+      }
+    free(ts);
+    free(te);
+    v->segStart=s;
+    v->segEnd=e;
+    }
+  v->sorted=1;
+  if(unique && n>1){
+    for(i=0,j=1;j<n;j++){
+      if(s[j]!=s[i] || e[j]!=e[i]){
+        i++;
+        s[i]=s[j];
+        e[i]=e[j];
+        }
+      }
+    v->count=i+1;
+    }
+  }
+
+/*
+*  Convert a list to array form
+*/
+bfiv bfivFrom(bfi g){
+  bfiv v;
+  bfi s;
+  size_t n=0;
+
+  for(s=g->next;s!=g;s=s->next) n++;
+  v=bfivNew(g->start,g->end,n);
+  for(s=g->next;s!=g;s=s->next){
+    v->segStart[v->count]=s->start;
+    v->segEnd[v->count]=s->end;
+    v->count++;
+    }
+  return(v);
+  }
+
+/*
+*  Convert a list to array form connecting overlapping segments
+*
+*    This is bfivFrom followed by bfivOr_ (edge=0) or bfivOre_ (edge=1)
+*    without copying segments that are connected.
+*/
+static bfiv bfivConnectFrom(bfi g,int edge){
+  bfiv v;
+  bfi s;
+
+  v=bfivNew(g->start,g->end,0);
+  for(s=g->next;s!=g;s=s->next){
+    if(v->count==0 || v->segEnd[v->count-1]<s->start || (edge && v->segEnd[v->count-1]==s->start))
+      bfivInsert(v,s->start,s->end);
+    else if(v->segEnd[v->count-1]<s->end) v->segEnd[v->count-1]=s->end;
+    }
+  return(v);
+  }
+
+/*
+*  Convert an array to list form
+*
+*    Segments are appended without searching for the insertion point, so
+*    the array must be sorted.
+*/
+bfi bfivList(bfiv v){
+  bfi f,t;
+  size_t i;
+
+  if(!v->sorted) bfivSort(v,0);
+  f=bfiNew(v->start,v->end);
+  for(i=0;i<v->count;i++){
+    if((t=bfifree)==NULL) t=bfiAlloc();
+    else bfifree=bfifree->next;
+    t->prior=f->prior;
+    t->next=f;
+    t->start=v->segStart[i];
+    t->end=v->segEnd[i];
+    f->prior->next=t;
+    f->prior=t;
+    }
+  return(f);
+  }
+
+/*
+*  Connect overlapping segments in place - see bfiOr_ and bfiOre_
+*
+*    When edge is true, adjoining segments are not connected.
+*/
+static bfiv bfivConnect(bfiv v,int edge){
+  long *s=v->segStart,*e=v->segEnd;
+  size_t i,j=0;
+
+  if(!v->sorted) bfivSort(v,0);
+  if(v->count==0) return(v);
+  for(i=1;i<v->count;i++){
+    if(e[j]<s[i] || (edge && e[j]==s[i])){
+      j++;
+      s[j]=s[i];
+      e[j]=e[i];
+      }
+    else if(e[j]<e[i]) e[j]=e[i];
+    }
+  v->count=j+1;
+  return(v);
+  }
+
+bfiv bfivOr_(bfiv v){
+  return(bfivConnect(v,0));
+  }
+
+bfiv bfivOre_(bfiv v){
+  return(bfivConnect(v,1));
+  }
+
+/*
+*  Allocate an array with the intersection of the domains of g and h
+*/
+static bfiv bfivDomain(bfiv g,bfiv h,size_t size){
+  long start,end;
+
+  if(g->end>=h->end) start=g->end;     /* maximum start */
+  else start=h->end;
+  if(g->start<=h->start) end=g->start; /* minimum end */
+  else end=h->start;
+  if(end<start) end=start;             /* f(i) is unknown for all i */
+  return(bfivNew(start,end,size));
+  }
+
+/*
+*  And: (logical "and") - see bfiAnd
+*
+*    g and h are connected in place (bfivOr_) and then merged.
+*/
+bfiv bfivAnd(bfiv g,bfiv h){
+  bfiv f;
+  long *gs,*ge,*hs,*he,start,end;
+  size_t i=0,j=0;
+
+  bfivOr_(g);
+  bfivOr_(h);
+  f=bfivDomain(g,h,g->count<h->count ? g->count : h->count);
+  gs=g->segStart;ge=g->segEnd;
+  hs=h->segStart;he=h->segEnd;
+  while(i<g->count && j<h->count){
+    start=gs[i]>hs[j] ? gs[i] : hs[j];
+    end=ge[i]<he[j] ? ge[i] : he[j];
+    if(start<end) bfivInsert(f,start,end);
+    if(ge[i]<he[j]) i++;
+    else j++;
+    }
+  return(f);
+  }
+
+/*
+*  Merge two sorted arrays and connect overlapping segments
+*/
+static bfiv bfivMerge(bfiv g,bfiv h,int edge){
+  bfiv f;
+  long *gs,*ge,*hs,*he;
+  size_t i=0,j=0;
+
+  if(!g->sorted) bfivSort(g,0);
+  if(!h->sorted) bfivSort(h,0);
+  f=bfivDomain(g,h,g->count+h->count);
+  gs=g->segStart;ge=g->segEnd;
+  hs=h->segStart;he=h->segEnd;
+  while(i<g->count && j<h->count){
+    if(gs[i]<hs[j] || (gs[i]==hs[j] && ge[i]<=he[j])){
+      f->segStart[f->count]=gs[i];
+      f->segEnd[f->count++]=ge[i++];
+      }
+    else{
+      f->segStart[f->count]=hs[j];
+      f->segEnd[f->count++]=he[j++];
+      }
+    }
+  for(;i<g->count;i++){
+    f->segStart[f->count]=gs[i];
+    f->segEnd[f->count++]=ge[i];
+    }
+  for(;j<h->count;j++){
+    f->segStart[f->count]=hs[j];
+    f->segEnd[f->count++]=he[j];
+    }
+  return(bfivConnect(f,edge));
+  }
+
+/*
+*  Or: (logical "or") - see bfiOr
+*/
+bfiv bfivOr(bfiv g,bfiv h){
+  return(bfivMerge(g,h,0));
+  }
+
+/*
+*  Ore: (logical "or" preserving edges) - see bfiOre
+*/
+bfiv bfivOre(bfiv g,bfiv h){
+  return(bfivMerge(g,h,1));
+  }
+
+/*
+*  Evaluate a normalized array for a given integer - see bfiEval
+*
+*    The array must be connected (bfivOr_ or bfivOre_) so that at most one
+*    segment can include i.  We find the last segment starting at or
+*    before i with a binary search.
+*/
+int bfivEval(bfiv v,long i){
+  size_t lo=0,hi=v->count,mid;
+
+  if(i<=v->end || i>v->start) return(0);
+  while(lo<hi){
+    mid=lo+(hi-lo)/2;
+    if(v->segStart[mid]<=i) lo=mid+1;
+    else hi=mid;
+    }
+  if(lo==0) return(0);
+  return(i<v->segEnd[lo-1]);
+  }
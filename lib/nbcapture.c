@@ -0,0 +1,443 @@
+/*
+* Copyright (C) 2014 Ed Trettevik <eat@nodebrain.org>
+*
+* NodeBrain is free software; you can modify and/or redistribute it under the
+* terms of either the MIT License (Expat) or the following NodeBrain License.
+*
+* Permission to use and redistribute with or without fee, in source and binary
+* forms, with or without modification, is granted free of charge to any person
+* obtaining a copy of this software and included documentation, provided that
+* the above copyright notice, this permission notice, and the following
+* disclaimer are retained with source files and reproduced in documention
+* included with source and binary distributions.
+*
+* Unless required by applicable law or agreed to in writing, this software is
+* distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+* KIND, either express or implied.
+*
+*=============================================================================
+* Program:  NodeBrain
+*
+* File:     nbcapture.c
+*
+* Title:    Event Capture and Replay Routines
+*
+* Function:
+*
+*   This file provides routines that record the inbound event stream of an
+*   agent to a compact binary file and replay it later.  This gives us a
+*   repeatable load test for the rule engine that does not depend on the
+*   listeners, peers, or servants that produced the original events.
+*
+* Synopsis:
+*
+*   #include "nbi.h"
+*
+*   void nbCaptureInit(NB_Stem *stem);
+*   void nbCaptureCommand(nbCELL context,char *cursor,unsigned char cmdopt);
+*   void nbCaptureAlarm(time_t time);
+*   void nbCaptureClose(void);
+*
+* Description
+*
+*   Commands:
+*
+*     capture "<file>"              Start recording to <file>
+*     capture stop                  Stop recording
+*     capture                       Display capture status
+*     replay "<file>" [<speed>]     Replay a capture file
+*
+*   While a capture is active, nbCmd() calls nbCaptureCommand() for every
+*   command that enters the interpreter from outside.  Commands issued by
+*   rule actions, or by a sourced file, are not recorded because they are
+*   reproduced by replaying the command that caused them.  The clock calls
+*   nbCaptureAlarm() for every timer that fires so a replay can reproduce
+*   the interleaving of commands and scheduled activity.
+*
+*   Each record is stamped with a monotonic clock offset in nanoseconds
+*   from the previous record.
+*
+*   File format (integers marked v are unsigned LEB128 varints):
+*
+*     header:   "NBCAP01\n" v<start seconds> v<start nanoseconds>
+*     command:  'C' v<delta> <cmdopt byte> v<len> <context> v<len> <command>
+*     alarm:    'A' v<delta> v<timer time>
+*
+*   The context is the full name of the command context relative to the
+*   root context, or an empty string for the root context.
+*
+*   A replay runs the clock in simulated mode (see nbClockSimulate) so timer
+*   conditions fire at the recorded times relative to the commands,
+*   regardless of the replay speed.  The speed argument is a multiplier.
+*
+*     1     Original speed (default)
+*     N     N times the original speed
+*     0     As fast as possible
+*
+*   When a replay completes we report the number of commands and alarms,
+*   the elapsed time, the command rate, and a distribution of command
+*   latency---the time nbCmd() takes to process a command including the
+*   resulting rule reactions.
+*
+*=============================================================================
+* Change History:
+*
+*    Date    Name/Change
+* ---------- -----------------------------------------------------------------
+* 2026-10-18 eat 0.9.04 (original prototype)
+* 2026-10-18 eat 0.9.04 Replaced replay histogram with the shared latency buckets
+*=============================================================================
+*/
+#include <nb/nbi.h>
+
+NB_Capture *nb_capture=NULL;    // active capture
+int nb_captureHold=0;           // nested command depth
+
+#define NB_CAPTURE_BUFSIZE 65536     // capture file buffer size
+
+/*
+*  Get a monotonic clock time in nanoseconds
+*/
+static unsigned long long nbCaptureClock(void){
+#if defined(WIN32)
+  return((unsigned long long)GetTickCount64()*1000000);
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+  return((unsigned long long)ts.tv_sec*1000000000+ts.tv_nsec);
+#endif
+  }
+
+/*
+*  Sleep for a number of nanoseconds
+*/
+static void nbCaptureNap(unsigned long long ns){
+#if defined(WIN32)
+  Sleep((DWORD)(ns/1000000));
+#else
+  struct timespec ts;
+  ts.tv_sec=ns/1000000000;
+  ts.tv_nsec=ns%1000000000;
+  while(nanosleep(&ts,&ts)<0 && errno==EINTR);
+#endif
+  }
+
+/*
+*  Write and read unsigned LEB128 varints
+*/
+static void nbCapturePutVarint(FILE *file,unsigned long long value){
+  while(value>=0x80){
+    putc((int)(value&0x7f)|0x80,file);
+    value>>=7;
+    }
+  putc((int)value,file);
+  }
+
+static int nbCaptureGetVarint(FILE *file,unsigned long long *value){
+  int c,shift=0;
+  *value=0;
+  while((c=getc(file))!=EOF){
+    *value|=(unsigned long long)(c&0x7f)<<shift;
+    if(!(c&0x80)) return(0);
+    shift+=7;
+    if(shift>63) return(-1);
+    }
+  return(-1);
+  }
+
+static int nbCaptureGetString(FILE *file,char *buffer,size_t size){
+  unsigned long long len;
+  if(nbCaptureGetVarint(file,&len) || len>=size) return(-1);
+  if(len>0 && fread(buffer,1,len,file)!=len) return(-1);
+  *(buffer+len)=0;
+  return(0);
+  }
+
+/*
+*  Write a record header with the delta since the last record
+*/
+static void nbCaptureRecord(int type){
+  unsigned long long now=nbCaptureClock();
+  putc(type,nb_capture->file);
+  nbCapturePutVarint(nb_capture->file,now-nb_capture->last);
+  nb_capture->last=now;
+  }
+
+/*
+*  Record a command
+*
+*    Commands that control capture and replay are not recorded.
+*/
+void nbCaptureCommand(nbCELL context,char *cursor,unsigned char cmdopt){
+  char name[1024];
+  size_t len;
+
+  if(strncmp(cursor,"capture",7)==0 && (*(cursor+7)==0 || *(cursor+7)==' ')) return;
+  if(strncmp(cursor,"replay",6)==0 && (*(cursor+6)==0 || *(cursor+6)==' ')) return;
+  if(context==NULL || context==(nbCELL)rootGloss || context->object.type!=termType) *name=0;
+  else nbTermName(rootGloss,(NB_Term *)context,name,sizeof(name));
+  nbCaptureRecord(NB_CAPTURE_COMMAND);
+  putc(cmdopt,nb_capture->file);
+  len=strlen(name);
+  nbCapturePutVarint(nb_capture->file,len);
+  fwrite(name,1,len,nb_capture->file);
+  len=strlen(cursor);
+  nbCapturePutVarint(nb_capture->file,len);
+  fwrite(cursor,1,len,nb_capture->file);
+  nb_capture->commands++;
+  }
+
+/*
+*  Record a timer alarm
+*/
+void nbCaptureAlarm(time_t time){
+  nbCaptureRecord(NB_CAPTURE_ALARM);
+  nbCapturePutVarint(nb_capture->file,(unsigned long long)time);
+  nb_capture->alarms++;
+  }
+
+/*
+*  Start a capture
+*/
+static int nbCaptureOpen(char *filename){
+  FILE *file;
+  unsigned long long sec,nsec;
+#if defined(WIN32)
+  time_t now;
+#else
+  struct timeval tv;
+#endif
+
+  if(nb_capture){
+    outMsg(0,'E',"Capture to \"%s\" already active.",nb_capture->name);
+    return(1);
+    }
+  if((file=fopen(filename,"wb"))==NULL){
+    outMsg(0,'E',"Unable to open capture file \"%s\" - %s",filename,strerror(errno));
+    return(1);
+    }
+  nb_capture=(NB_Capture *)nbAlloc(sizeof(NB_Capture));
+  memset(nb_capture,0,sizeof(NB_Capture));
+  nb_capture->file=file;
+  nb_capture->buffer=(char *)nbAlloc(NB_CAPTURE_BUFSIZE);
+  setvbuf(file,nb_capture->buffer,_IOFBF,NB_CAPTURE_BUFSIZE);
+  nb_capture->name=(char *)nbAlloc(strlen(filename)+1);
+  strcpy(nb_capture->name,filename);
+  nb_capture->start=nbCaptureClock();
+  nb_capture->last=nb_capture->start;
+#if defined(WIN32)
+  time(&now);
+  sec=(unsigned long long)now;
+  nsec=0;
+#else
+  gettimeofday(&tv,NULL);
+  sec=(unsigned long long)tv.tv_sec;
+  nsec=(unsigned long long)tv.tv_usec*1000;
+#endif
+  fwrite(NB_CAPTURE_MAGIC,1,8,file);
+  nbCapturePutVarint(file,sec);
+  nbCapturePutVarint(file,nsec);
+  outMsg(0,'I',"Capturing events to \"%s\"",filename);
+  return(0);
+  }
+
+/*
+*  Stop a capture
+*/
+void nbCaptureClose(void){
+  if(!nb_capture) return;
+  fclose(nb_capture->file);
+  outMsg(0,'I',"Captured %lu commands and %lu alarms to \"%s\"",nb_capture->commands,nb_capture->alarms,nb_capture->name);
+  nbFree(nb_capture->buffer,NB_CAPTURE_BUFSIZE);
+  nbFree(nb_capture->name,strlen(nb_capture->name)+1);
+  nbFree(nb_capture,sizeof(NB_Capture));
+  nb_capture=NULL;
+  }
+
+/*
+*  Latency percentile from a histogram bucketed by nbLatencyIndex
+*/
+static double nbCapturePercentile(unsigned long *histogram,unsigned long count,int percent,unsigned long long min,unsigned long long max){
+  unsigned long target=(count*percent+99)/100,sum=0;
+  unsigned long long value=max;
+  int bucket;
+  if(target==0) target=1;
+  for(bucket=0;bucket<NB_LATENCY_SIZE;bucket++){
+    sum+=histogram[bucket];
+    if(sum>=target){
+      value=nbLatencyLow(bucket);
+      break;
+      }
+    }
+  if(value<min) value=min;   // bucket floor may be below the observed range
+  if(value>max) value=max;
+  return((double)value);
+  }
+
+/*
+*  Replay a capture file
+*/
+static int nbCaptureReplay(char *filename,double speed){
+  FILE *file;
+  char magic[8],contextName[1024],*command;
+  size_t commandSize=NB_BUFSIZE;
+  unsigned long long startSec,startNsec,delta,offset=0,timerTime;
+  unsigned long long replayStart,now,due,began,latency;
+  unsigned long long latencyMin=0,latencyMax=0,latencySum=0;
+  unsigned long histogram[NB_LATENCY_SIZE];
+  unsigned long commands=0,alarms=0;
+  double elapsed;
+  time_t simTime;
+  nbCELL context;
+  int type,cmdopt,rc=0;
+
+  if(nb_ClockAlerting){
+    outMsg(0,'E',"Replay not supported from a timer alarm.");
+    return(1);
+    }
+  if((file=fopen(filename,"rb"))==NULL){
+    outMsg(0,'E',"Unable to open capture file \"%s\" - %s",filename,strerror(errno));
+    return(1);
+    }
+  setvbuf(file,NULL,_IOFBF,NB_CAPTURE_BUFSIZE);
+  if(fread(magic,1,8,file)!=8 || memcmp(magic,NB_CAPTURE_MAGIC,8)!=0
+    || nbCaptureGetVarint(file,&startSec) || nbCaptureGetVarint(file,&startNsec)){
+    outMsg(0,'E',"File \"%s\" is not a capture file.",filename);
+    fclose(file);
+    return(1);
+    }
+  memset(histogram,0,sizeof(histogram));
+  command=(char *)nbAlloc(commandSize);
+  outMsg(0,'I',"Replaying \"%s\" at speed %g",filename,speed);
+  replayStart=nbCaptureClock();
+  while((type=getc(file))!=EOF){
+    if(nbCaptureGetVarint(file,&delta)){
+      rc=1;
+      break;
+      }
+    offset+=delta;
+    if(speed>0){
+      due=replayStart+(unsigned long long)(offset/speed);
+      now=nbCaptureClock();
+      if(due>now) nbCaptureNap(due-now);
+      }
+    simTime=(time_t)(startSec+(startNsec+offset)/1000000000);
+    if(type==NB_CAPTURE_ALARM){
+      if(nbCaptureGetVarint(file,&timerTime)){
+        rc=1;
+        break;
+        }
+      if((time_t)timerTime>simTime) simTime=(time_t)timerTime;
+      nbClockSimulate(simTime);
+      nbClockAlert();
+      alarms++;
+      }
+    else if(type==NB_CAPTURE_COMMAND){
+      if((cmdopt=getc(file))==EOF || nbCaptureGetString(file,contextName,sizeof(contextName))
+        || nbCaptureGetString(file,command,commandSize)){
+        rc=1;
+        break;
+        }
+      nbClockSimulate(simTime);
+      nbClockAlert();
+      if(*contextName==0) context=(nbCELL)rootGloss;
+      else if((context=(nbCELL)nbTermFind(rootGloss,contextName))==NULL){
+        outMsg(0,'W',"Context \"%s\" not defined - command ignored: %s",contextName,command);
+        continue;
+        }
+      began=nbCaptureClock();
+      nbCmd(context,command,(unsigned char)cmdopt);
+      latency=nbCaptureClock()-began;
+      if(commands==0 || latency<latencyMin) latencyMin=latency;
+      if(latency>latencyMax) latencyMax=latency;
+      latencySum+=latency;
+      histogram[nbLatencyIndex(latency)]++;
+      commands++;
+      }
+    else{
+      rc=1;
+      break;
+      }
+    }
+  elapsed=(double)(nbCaptureClock()-replayStart)/1e9;
+  nbClockSimulate(0);
+  nbFree(command,commandSize);
+  fclose(file);
+  if(rc) outMsg(0,'E',"Capture file \"%s\" is corrupt or truncated - replay stopped.",filename);
+  outMsg(0,'I',"Replayed %lu commands and %lu alarms in %.6f seconds (%.0f commands/second)",
+    commands,alarms,elapsed,elapsed>0 ? commands/elapsed : 0.0);
+  if(commands) outMsg(0,'I',"Command latency (us): min=%.3f avg=%.3f p50=%.3f p90=%.3f p99=%.3f max=%.3f",
+    latencyMin/1e3,latencySum/1e3/commands,
+    nbCapturePercentile(histogram,commands,50,latencyMin,latencyMax)/1e3,
+    nbCapturePercentile(histogram,commands,90,latencyMin,latencyMax)/1e3,
+    nbCapturePercentile(histogram,commands,99,latencyMin,latencyMax)/1e3,
+    latencyMax/1e3);
+  return(rc);
+  }
+
+/*
+*  Command handlers
+*
+*    capture "<file>" | stop
+*    replay "<file>" [<speed>]
+*/
+static int nbCaptureCmd(nbCELL context,void *handle,char *verb,char *cursor){
+  char symid,ident[1024],*cursave=cursor;
+
+  if(!(clientIdentity->authority&AUTH_CONTROL)){
+    outMsg(0,'E',"Identity \"%s\" not authorized to capture events.",clientIdentity->name->value);
+    return(1);
+    }
+  symid=nbParseSymbol(ident,sizeof(ident),&cursor);
+  if(symid==';'){
+    if(nb_capture) outMsg(0,'I',"Capturing to \"%s\" - %lu commands and %lu alarms",nb_capture->name,nb_capture->commands,nb_capture->alarms);
+    else outMsg(0,'I',"Capture is not active.");
+    return(0);
+    }
+  if(symid=='t' && strcmp(ident,"stop")==0){
+    if(!nb_capture){
+      outMsg(0,'E',"Capture is not active.");
+      return(1);
+      }
+    nbCaptureClose();
+    return(0);
+    }
+  if(symid!='s'){
+    outMsg(0,'E',"Expecting quoted file name or \"stop\" at \"%s\"",cursave);
+    return(1);
+    }
+  return(nbCaptureOpen(ident));
+  }
+
+static int nbCaptureReplayCmd(nbCELL context,void *handle,char *verb,char *cursor){
+  char symid,filename[1024],ident[256],*cursave=cursor;
+  double speed=1;
+
+  if(!(clientIdentity->authority&AUTH_CONTROL)){
+    outMsg(0,'E',"Identity \"%s\" not authorized to replay events.",clientIdentity->name->value);
+    return(1);
+    }
+  symid=nbParseSymbol(filename,sizeof(filename),&cursor);
+  if(symid!='s'){
+    outMsg(0,'E',"Expecting quoted file name at \"%s\"",cursave);
+    return(1);
+    }
+  cursave=cursor;
+  symid=nbParseSymbol(ident,sizeof(ident),&cursor);
+  if(symid=='i' || symid=='r') speed=atof(ident);
+  else if(symid!=';'){
+    outMsg(0,'E',"Expecting numeric speed at \"%s\"",cursave);
+    return(1);
+    }
+  if(speed<0){
+    outMsg(0,'E',"Replay speed may not be negative.");
+    return(1);
+    }
+  return(nbCaptureReplay(filename,speed));
+  }
+
+void nbCaptureInit(NB_Stem *stem){
+  nbCELL context=(nbCELL)stem->verbs;
+  nbVerbDeclare(context,"capture",AUTH_CONTROL,0,stem,&nbCaptureCmd,"[\"<file>\"|stop]");
+  nbVerbDeclare(context,"replay",AUTH_CONTROL,0,stem,&nbCaptureReplayCmd,"\"<file>\" [<speed>]");
+  }
@@ -328,6 +328,8 @@
 * 2014-01-25 eat 0.9.00 Switched evaluation schedule back to array of lists
 *            The cell->mode NB_CELL_MODE_SCHEDULED flag was added to enable
 *            inserting cells once only without having to look them up first.
+* 2026-10-18 eat 0.9.04 Observe eval vector levels per reaction for metrics
+* 2026-10-18 eat 0.9.04 Return early when nothing is scheduled and time reactions
 *=============================================================================
 */
 #include <nb/nbi.h>
@@ -802,6 +804,11 @@ void nbCellReact(void){
   NB_Link *link,**linkP;
   NB_Cell *cell;
   NB_Object *value;
+  unsigned long long start;
+
+  if(evalVectorTop==evalVector && *evalVector==NULL) return;
+  nbMetricObserve(&nb_metricEvalDepth,evalVectorTop-evalVector+1);
+  start=nbLatencyNow();
   for(linkP=evalVector;linkP<=evalVectorTop;linkP++){
     for(link=*linkP;link!=NULL;link=*linkP){
       cell=(NB_Cell *)link->object;
@@ -830,6 +837,7 @@ void nbCellReact(void){
       }
     }
   evalVectorTop=evalVector;  /* set top level */
+  nbLatencyObserve(NB_LATENCY_REACT,start);
   }
 
 
@@ -0,0 +1,631 @@
+/*
+* Copyright (C) 2014 Ed Trettevik <eat@nodebrain.org>
+*
+* NodeBrain is free software; you can modify and/or redistribute it under the
+* terms of either the MIT License (Expat) or the following NodeBrain License.
+*
+* Permission to use and redistribute with or without fee, in source and binary
+* forms, with or without modification, is granted free of charge to any person
+* obtaining a copy of this software and included documentation, provided that
+* the above copyright notice, this permission notice, and the following
+* disclaimer are retained with source files and reproduced in documention
+* included with source and binary distributions.
+*
+* Unless required by applicable law or agreed to in writing, this software is
+* distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+* KIND, either express or implied.
+*
+*=============================================================================
+* Program:  NodeBrain
+*
+* File:     nbcheckpoint.c
+*
+* Title:    Runtime State Checkpoint Routines
+*
+* Function:
+*
+*   This file provides routines that save the runtime state of an agent to
+*   a compact binary checkpoint file, and restore it at startup, so an agent
+*   can be restarted without losing what it has learned from events.
+*
+* Synopsis:
+*
+*   #include "nbi.h"
+*
+*   void nbCheckpointInit(NB_Stem *stem);
+*   void nbCheckpointStart(nbCELL context);
+*   void nbCheckpointStop(void);
+*
+*   int    nbCheckpointPut(nbCELL context,nbCHECKPOINT checkpoint,void *data,size_t len);
+*   int    nbCheckpointGet(nbCELL context,nbCHECKPOINT checkpoint,void *data,size_t len);
+*   int    nbCheckpointPutInt(nbCELL context,nbCHECKPOINT checkpoint,unsigned long long value);
+*   int    nbCheckpointGetInt(nbCELL context,nbCHECKPOINT checkpoint,unsigned long long *value);
+*   int    nbCheckpointPutCell(nbCELL context,nbCHECKPOINT checkpoint,nbCELL cell);
+*   nbCELL nbCheckpointGetCell(nbCELL context,nbCHECKPOINT checkpoint);
+*
+* Description
+*
+*   Commands:
+*
+*     checkpoint [-f] ["<file>"]    Write a checkpoint
+*     restore ["<file>"]            Restore a checkpoint
+*
+*   The file name defaults to the "checkpoint" setting.  When the setting is
+*   specified, nbServeParseArgs() calls nbCheckpointStart() to restore the
+*   checkpoint, if one exists, after the startup arguments have loaded the
+*   rules, and nbStop() calls nbCheckpointStop() to write a final checkpoint.
+*
+*     nb --checkpoint=/var/nb/goofy.nbc goofy.nb
+*
+*   A checkpoint contains three kinds of state.
+*
+*     1) Values of terms defined as constants---the values established by
+*        assertions.  Terms defined by cell expressions are rebuilt by the
+*        rules and are not saved.
+*
+*     2) Node knowledge, for nodes whose skill provides the optional
+*        NB_NODE_SAVE and NB_NODE_RESTORE methods.  A module writes its
+*        state with the nbCheckpointPut* functions and reads it back with
+*        the nbCheckpointGet* functions.  Each node record carries the skill
+*        identifier and a length, so a node is skipped on restore if its
+*        skill has changed or its module does not support a restore.
+*
+*     3) Pending node timers (see nbClockSetTimer) for nodes in (2).  A
+*        timer that expired while the agent was down is set to fire on the
+*        next clock cycle.  Timers for time conditions are not saved because
+*        rules schedule them again when they are enabled.  Timers of nodes
+*        whose knowledge is not saved, like cache nodes, are not saved
+*        either, because they would fire against the empty state the node
+*        starts with.  A cache is empty after a restore.
+*
+*   Writing a checkpoint on a Unix-like system forks a child process that
+*   serializes a copy-on-write image of the state while the parent continues
+*   to process events.  Use the -f option to write in the foreground.  Files
+*   are written to a temporary file and renamed, so a reader never sees a
+*   partial checkpoint.
+*
+*   When a checkpoint is restored, rules are not fired.  Cells are brought up
+*   to date with the restored values, but any rule that reacted to those
+*   values did so before the checkpoint was written.
+*
+*   File format (integers marked v are unsigned LEB128 varints, s is a v
+*   length followed by that many bytes, c is a cell value):
+*
+*     header:     "NBCKP01\n" v<time written>
+*     term:       'T' s<term> c<value>
+*     node:       'N' s<term> s<skill> s<skill state>
+*     timer:      'A' s<term> v<time>
+*
+*     cell:       'U' | '1' | '0' | 'R' <8 byte double> | 'S' s<string>
+*
+*   Reals are stored in host byte order, so a checkpoint is not portable
+*   between platforms with a different byte order.
+*
+*=============================================================================
+* Change History:
+*
+*    Date    Name/Change
+* ---------- -----------------------------------------------------------------
+* 2026-10-18 eat 0.9.04 (original prototype)
+* 2026-10-18 eat 0.9.04 Only save timers of nodes that save their knowledge
+*=============================================================================
+*/
+#include <nb/nbi.h>
+
+char nb_checkpointName[256];  // checkpoint file name
+
+/*
+*  Buffer management
+*/
+static void nbCheckpointReserve(NB_Checkpoint *checkpoint,size_t len){
+  size_t size;
+  char *data;
+
+  if(checkpoint->used+len<=checkpoint->size) return;
+  size=checkpoint->size ? checkpoint->size : 65536;
+  while(size<checkpoint->used+len) size*=2;
+  data=(char *)nbAlloc(size);
+  if(checkpoint->data){
+    memcpy(data,checkpoint->data,checkpoint->used);
+    nbFree(checkpoint->data,checkpoint->size);
+    }
+  checkpoint->data=data;
+  checkpoint->size=size;
+  }
+
+static void nbCheckpointFree(NB_Checkpoint *checkpoint){
+  if(checkpoint->data) nbFree(checkpoint->data,checkpoint->size);
+  memset(checkpoint,0,sizeof(NB_Checkpoint));
+  }
+
+static int nbCheckpointVarint(char *buffer,unsigned long long value){
+  int len=0;
+  while(value>=0x80){
+    *(buffer+len)=(char)((value&0x7f)|0x80);
+    len++;
+    value>>=7;
+    }
+  *(buffer+len)=(char)value;
+  return(len+1);
+  }
+
+/*
+*  External API - used by module save and restore methods
+*
+*    The put functions return 0.  The get functions return 0 on success and
+*    -1 when the data is truncated or corrupt.
+*/
+int nbCheckpointPut(nbCELL context,nbCHECKPOINT checkpoint,void *data,size_t len){
+  nbCheckpointReserve(checkpoint,len);
+  memcpy(checkpoint->data+checkpoint->used,data,len);
+  checkpoint->used+=len;
+  return(0);
+  }
+
+int nbCheckpointGet(nbCELL context,nbCHECKPOINT checkpoint,void *data,size_t len){
+  if(checkpoint->cursor+len>checkpoint->end) return(-1);
+  memcpy(data,checkpoint->cursor,len);
+  checkpoint->cursor+=len;
+  return(0);
+  }
+
+int nbCheckpointPutInt(nbCELL context,nbCHECKPOINT checkpoint,unsigned long long value){
+  nbCheckpointReserve(checkpoint,10);
+  checkpoint->used+=nbCheckpointVarint(checkpoint->data+checkpoint->used,value);
+  return(0);
+  }
+
+int nbCheckpointGetInt(nbCELL context,nbCHECKPOINT checkpoint,unsigned long long *value){
+  char *cursor=checkpoint->cursor;
+  int shift=0;
+
+  *value=0;
+  while(cursor<checkpoint->end && shift<64){
+    *value|=(unsigned long long)(*cursor&0x7f)<<shift;
+    if(!(*cursor&0x80)){
+      checkpoint->cursor=cursor+1;
+      return(0);
+      }
+    cursor++;
+    shift+=7;
+    }
+  return(-1);
+  }
+
+static void nbCheckpointPutByte(nbCHECKPOINT checkpoint,int byte){
+  nbCheckpointReserve(checkpoint,1);
+  *(checkpoint->data+checkpoint->used)=(char)byte;
+  checkpoint->used++;
+  }
+
+static void nbCheckpointPutString(nbCHECKPOINT checkpoint,char *string){
+  size_t len=strlen(string);
+  nbCheckpointPutInt(NULL,checkpoint,len);
+  nbCheckpointPut(NULL,checkpoint,string,len);
+  }
+
+static int nbCheckpointGetString(nbCHECKPOINT checkpoint,char *buffer,size_t size){
+  unsigned long long len;
+
+  if(nbCheckpointGetInt(NULL,checkpoint,&len) || len>=size) return(-1);
+  if(nbCheckpointGet(NULL,checkpoint,buffer,len)) return(-1);
+  *(buffer+len)=0;
+  return(0);
+  }
+
+/*
+*  Put a cell value
+*
+*  Returns: 0 - saved, 1 - value type not supported and saved as Unknown
+*/
+int nbCheckpointPutCell(nbCELL context,nbCHECKPOINT checkpoint,nbCELL cell){
+  NB_Object *object=(NB_Object *)cell;
+  double real;
+  char code;
+
+  if(object==NULL || object==nb_Unknown) code=NB_CHECKPOINT_UNKNOWN;
+  else if(object==NB_OBJECT_TRUE) code=NB_CHECKPOINT_TRUE;
+  else if(object==NB_OBJECT_FALSE) code=NB_CHECKPOINT_FALSE;
+  else if(object->type==realType) code=NB_CHECKPOINT_REAL;
+  else if(object->type==strType) code=NB_CHECKPOINT_STRING;
+  else{
+    nbCheckpointPutByte(checkpoint,NB_CHECKPOINT_UNKNOWN);
+    return(1);
+    }
+  nbCheckpointPutByte(checkpoint,code);
+  if(code==NB_CHECKPOINT_REAL){
+    real=((NB_Real *)object)->value;
+    nbCheckpointPut(context,checkpoint,&real,sizeof(real));
+    }
+  else if(code==NB_CHECKPOINT_STRING) nbCheckpointPutString(checkpoint,((NB_String *)object)->value);
+  return(0);
+  }
+
+/*
+*  Get a cell value
+*
+*  Returns: Grabbed cell, which the caller must drop, or NULL if the data is corrupt
+*/
+nbCELL nbCheckpointGetCell(nbCELL context,nbCHECKPOINT checkpoint){
+  unsigned long long len;
+  double real;
+  char code,*string;
+  nbCELL cell;
+
+  if(nbCheckpointGet(context,checkpoint,&code,1)) return(NULL);
+  switch(code){
+    case NB_CHECKPOINT_UNKNOWN: return(nbCellGrab(context,NB_CELL_UNKNOWN));
+    case NB_CHECKPOINT_TRUE:    return(nbCellGrab(context,NB_CELL_TRUE));
+    case NB_CHECKPOINT_FALSE:   return(nbCellGrab(context,NB_CELL_FALSE));
+    case NB_CHECKPOINT_REAL:
+      if(nbCheckpointGet(context,checkpoint,&real,sizeof(real))) return(NULL);
+      return(nbCellCreateReal(context,real));
+    case NB_CHECKPOINT_STRING:
+      if(nbCheckpointGetInt(context,checkpoint,&len) || checkpoint->cursor+len>checkpoint->end) return(NULL);
+      string=(char *)nbAlloc(len+1);
+      memcpy(string,checkpoint->cursor,len);
+      *(string+len)=0;
+      checkpoint->cursor+=len;
+      cell=nbCellCreateString(context,string);
+      nbFree(string,len+1);
+      return(cell);
+    }
+  return(NULL);
+  }
+
+/*
+*  Save routines
+*/
+static int nbCheckpointIsConstant(NB_Object *object){
+  return(object==nb_Unknown || object==NB_OBJECT_TRUE || object==NB_OBJECT_FALSE
+    || object->type==realType || object->type==strType);
+  }
+
+/*
+*  Save node knowledge
+*
+*    The skill state is length prefixed.  We don't know the length until the
+*    save method returns, so the state is shifted to make room for it.
+*/
+static void nbCheckpointSaveNode(NB_Checkpoint *checkpoint,NB_Term *term,char *name){
+  NB_Node *node=(NB_Node *)term->def;
+  size_t record,start,len;
+  char prefix[10];
+  int n;
+
+  if(!node->facet || !node->facet->save || !node->knowledge) return;
+  record=checkpoint->used;
+  nbCheckpointPutByte(checkpoint,NB_CHECKPOINT_NODE);
+  nbCheckpointPutString(checkpoint,name);
+  nbCheckpointPutString(checkpoint,node->skill->ident->value);
+  start=checkpoint->used;
+  if((*node->facet->save)(term,node->skill->handle,node->knowledge,checkpoint)){
+    outMsg(0,'W',"Node %s state not saved - save method failed.",name);
+    checkpoint->used=record;
+    return;
+    }
+  len=checkpoint->used-start;
+  n=nbCheckpointVarint(prefix,len);
+  nbCheckpointReserve(checkpoint,n);
+  memmove(checkpoint->data+start+n,checkpoint->data+start,len);
+  memcpy(checkpoint->data+start,prefix,n);
+  checkpoint->used+=n;
+  checkpoint->nodes++;
+  }
+
+/*
+*  Save term values and node knowledge for a glossary
+*/
+static void nbCheckpointSaveGloss(NB_Checkpoint *checkpoint,NB_Term *context){
+  NB_Hash *hash=context->gloss;
+  NB_Term *term,**termP;
+  char name[1024];
+  int v;
+
+  if(!hash) return;
+  termP=(NB_Term **)&hash->vect;
+  for(v=0;v<=hash->mask;v++){
+    for(term=*termP;term!=NULL;term=(NB_Term *)term->cell.object.next){
+      if(term->def!=nb_Undefined){
+        nbTermName(rootGloss,term,name,sizeof(name));
+        if(nbCheckpointIsConstant(term->def)){
+          nbCheckpointPutByte(checkpoint,NB_CHECKPOINT_TERM);
+          nbCheckpointPutString(checkpoint,name);
+          nbCheckpointPutCell(NULL,checkpoint,(nbCELL)term->def);
+          checkpoint->terms++;
+          }
+        else if(term->def->type==nb_NodeType) nbCheckpointSaveNode(checkpoint,term,name);
+        }
+      nbCheckpointSaveGloss(checkpoint,term);
+      }
+    termP++;
+    }
+  }
+
+/*
+*  Save pending node timers
+*/
+static void nbCheckpointSaveTimers(NB_Checkpoint *checkpoint){
+  NB_Timer *timer;
+  NB_Node *node;
+  char name[1024];
+
+  for(timer=nb_timerQueue;timer!=NULL;timer=timer->next){
+    if(timer->object->type!=nb_NodeType) continue;
+    node=(NB_Node *)timer->object;
+    if(!node->context || !node->facet || !node->facet->save || !node->knowledge) continue;
+    nbTermName(rootGloss,node->context,name,sizeof(name));
+    nbCheckpointPutByte(checkpoint,NB_CHECKPOINT_TIMER);
+    nbCheckpointPutString(checkpoint,name);
+    nbCheckpointPutInt(NULL,checkpoint,(unsigned long long)timer->time);
+    checkpoint->timers++;
+    }
+  }
+
+/*
+*  Write a checkpoint file
+*/
+static int nbCheckpointWrite(char *filename){
+  NB_Checkpoint checkpoint;
+  char tmpname[512];
+  FILE *file;
+  time_t now;
+  int rc=0;
+
+  if(snprintf(tmpname,sizeof(tmpname),"%s.tmp",filename)>=sizeof(tmpname)){
+    outMsg(0,'E',"Checkpoint file name \"%s\" too long.",filename);
+    return(1);
+    }
+  memset(&checkpoint,0,sizeof(checkpoint));
+  nbCheckpointPut(NULL,&checkpoint,NB_CHECKPOINT_MAGIC,8);
+  time(&now);
+  nbCheckpointPutInt(NULL,&checkpoint,(unsigned long long)now);
+  nbCheckpointSaveGloss(&checkpoint,rootGloss);
+  nbCheckpointSaveTimers(&checkpoint);
+  if((file=fopen(tmpname,"wb"))==NULL){
+    outMsg(0,'E',"Unable to open checkpoint file \"%s\" - %s",tmpname,strerror(errno));
+    nbCheckpointFree(&checkpoint);
+    return(1);
+    }
+  if(fwrite(checkpoint.data,1,checkpoint.used,file)!=checkpoint.used) rc=1;
+  if(fclose(file)) rc=1;
+  if(rc){
+    outMsg(0,'E',"Unable to write checkpoint file \"%s\" - %s",tmpname,strerror(errno));
+    remove(tmpname);
+    }
+  else if(rename(tmpname,filename)){
+    outMsg(0,'E',"Unable to rename \"%s\" to \"%s\" - %s",tmpname,filename,strerror(errno));
+    remove(tmpname);
+    rc=1;
+    }
+  else outMsg(0,'I',"Checkpoint \"%s\" written - %lu terms, %lu nodes, %lu timers, %lu bytes",
+    filename,checkpoint.terms,checkpoint.nodes,checkpoint.timers,(unsigned long)checkpoint.used);
+  nbCheckpointFree(&checkpoint);
+  return(rc);
+  }
+
+/*
+*  Write a checkpoint in the background
+*
+*    The child process writes a copy-on-write image of our state, so the
+*    checkpoint is consistent without holding up the parent.
+*/
+static int nbCheckpointSave(char *filename,int foreground){
+#if !defined(WIN32)
+  pid_t pid;
+
+  if(!foreground){
+    outFlush();
+    fflush(stderr);
+    pid=fork();
+    if(pid==0) _exit(nbCheckpointWrite(filename));  // child writes the file
+    if(pid>0){
+      outMsg(0,'I',"Checkpoint \"%s\" started - pid %d",filename,pid);
+      return(0);
+      }
+    outMsg(0,'W',"Unable to fork checkpoint process - %s - writing in foreground",strerror(errno));
+    }
+#endif
+  return(nbCheckpointWrite(filename));
+  }
+
+/*
+*  Restore routines
+*/
+static void nbCheckpointRestoreTerm(NB_Checkpoint *checkpoint,char *name,nbCELL value){
+  NB_Term *term;
+
+  if((term=nbTermFind(rootGloss,name))==NULL){
+    if(nbTermNew(rootGloss,name,value,0)) checkpoint->terms++;
+    }
+  else if(term->def==nb_Undefined || nbCheckpointIsConstant(term->def)){
+    nbTermAssign(term,(NB_Object *)value);
+    checkpoint->terms++;
+    }
+  }
+
+static void nbCheckpointRestoreNode(NB_Checkpoint *checkpoint,char *name,char *skill,char *end){
+  NB_Term *term;
+  NB_Node *node;
+  char *fileEnd=checkpoint->end;
+
+  if((term=nbTermFind(rootGloss,name))==NULL || term->def->type!=nb_NodeType){
+    outMsg(0,'W',"Node %s not defined - state not restored.",name);
+    return;
+    }
+  node=(NB_Node *)term->def;
+  if(!node->skill || strcmp(node->skill->ident->value,skill)!=0){
+    outMsg(0,'W',"Node %s skill is no longer \"%s\" - state not restored.",name,skill);
+    return;
+    }
+  if(!node->facet || !node->facet->restore || !node->knowledge){
+    outMsg(0,'W',"Node %s skill \"%s\" does not support restore - state not restored.",name,skill);
+    return;
+    }
+  checkpoint->end=end;
+  if((*node->facet->restore)(term,node->skill->handle,node->knowledge,checkpoint))
+    outMsg(0,'W',"Node %s state not restored - restore method failed.",name);
+  else checkpoint->nodes++;
+  checkpoint->end=fileEnd;
+  nbCellPublish((NB_Cell *)node);
+  nbCellPublish((NB_Cell *)term);
+  }
+
+static void nbCheckpointRestoreTimer(NB_Checkpoint *checkpoint,char *name,time_t timerTime){
+  NB_Term *term;
+  NB_Node *node;
+  time_t now;
+
+  if((term=nbTermFind(rootGloss,name))==NULL || term->def->type!=nb_NodeType) return;
+  node=(NB_Node *)term->def;
+  if(!node->facet || !node->facet->restore || !node->knowledge) return;
+  time(&now);
+  if(timerTime<now) timerTime=now;
+  nbClockSetTimer(timerTime,(NB_Cell *)term->def);
+  checkpoint->timers++;
+  }
+
+/*
+*  Restore a checkpoint file
+*/
+static int nbCheckpointRestore(char *filename){
+  NB_Checkpoint checkpoint;
+  struct stat filestat;
+  FILE *file;
+  char name[1024],skill[256],type,*end;
+  unsigned long long written,len,timerTime;
+  nbCELL value;
+  int rc=0;
+
+  if(stat(filename,&filestat)!=0 || (file=fopen(filename,"rb"))==NULL){
+    outMsg(0,'E',"Unable to open checkpoint file \"%s\" - %s",filename,strerror(errno));
+    return(1);
+    }
+  memset(&checkpoint,0,sizeof(checkpoint));
+  nbCheckpointReserve(&checkpoint,filestat.st_size+1);
+  if(fread(checkpoint.data,1,filestat.st_size,file)!=filestat.st_size){
+    outMsg(0,'E',"Unable to read checkpoint file \"%s\" - %s",filename,strerror(errno));
+    fclose(file);
+    nbCheckpointFree(&checkpoint);
+    return(1);
+    }
+  fclose(file);
+  checkpoint.cursor=checkpoint.data+8;
+  checkpoint.end=checkpoint.data+filestat.st_size;
+  if(filestat.st_size<8 || memcmp(checkpoint.data,NB_CHECKPOINT_MAGIC,8)!=0 || nbCheckpointGetInt(NULL,&checkpoint,&written)){
+    outMsg(0,'E',"File \"%s\" is not a checkpoint file.",filename);
+    nbCheckpointFree(&checkpoint);
+    return(1);
+    }
+  while(checkpoint.cursor<checkpoint.end && rc==0){
+    type=*checkpoint.cursor++;
+    if(nbCheckpointGetString(&checkpoint,name,sizeof(name))) rc=1;
+    else if(type==NB_CHECKPOINT_TERM){
+      if((value=nbCheckpointGetCell(NULL,&checkpoint))==NULL) rc=1;
+      else{
+        nbCheckpointRestoreTerm(&checkpoint,name,value);
+        nbCellDrop(NULL,value);
+        }
+      }
+    else if(type==NB_CHECKPOINT_NODE){
+      if(nbCheckpointGetString(&checkpoint,skill,sizeof(skill)) || nbCheckpointGetInt(NULL,&checkpoint,&len)
+        || checkpoint.cursor+len>checkpoint.end) rc=1;
+      else{
+        end=checkpoint.cursor+len;
+        nbCheckpointRestoreNode(&checkpoint,name,skill,end);
+        checkpoint.cursor=end;
+        }
+      }
+    else if(type==NB_CHECKPOINT_TIMER){
+      if(nbCheckpointGetInt(NULL,&checkpoint,&timerTime)) rc=1;
+      else nbCheckpointRestoreTimer(&checkpoint,name,(time_t)timerTime);
+      }
+    else rc=1;
+    }
+  nbRuleReactQuietly();  // bring cells up to date without firing rules
+  if(rc) outMsg(0,'E',"Checkpoint file \"%s\" is corrupt or truncated - restore stopped.",filename);
+  outMsg(0,'I',"Checkpoint \"%s\" restored - %lu terms, %lu nodes, %lu timers",
+    filename,checkpoint.terms,checkpoint.nodes,checkpoint.timers);
+  nbCheckpointFree(&checkpoint);
+  return(rc);
+  }
+
+/*
+*  Restore checkpoint at startup after rules are loaded
+*/
+void nbCheckpointStart(nbCELL context){
+  struct stat filestat;
+
+  if(!*nb_checkpointName || nb_mode_check) return;
+  if(stat(nb_checkpointName,&filestat)!=0){
+    outMsg(0,'I',"Checkpoint \"%s\" not found - starting without saved state",nb_checkpointName);
+    return;
+    }
+  nbCheckpointRestore(nb_checkpointName);
+  }
+
+/*
+*  Write final checkpoint when stopping
+*/
+void nbCheckpointStop(void){
+  if(!*nb_checkpointName || nb_mode_check) return;
+  nbCheckpointWrite(nb_checkpointName);
+  }
+
+/*
+*  Command handlers
+*
+*    checkpoint [-f] ["<file>"]
+*    restore ["<file>"]
+*/
+static int nbCheckpointGetFile(char *cursor,char *filename,size_t size){
+  char symid,*cursave=cursor;
+
+  symid=nbParseSymbol(filename,size,&cursor);
+  if(symid==';'){
+    if(!*nb_checkpointName){
+      outMsg(0,'E',"Checkpoint file not specified - use a quoted file name or the checkpoint setting.");
+      return(1);
+      }
+    strcpy(filename,nb_checkpointName);
+    }
+  else if(symid!='s'){
+    outMsg(0,'E',"Expecting quoted file name at \"%s\"",cursave);
+    return(1);
+    }
+  return(0);
+  }
+
+static int nbCheckpointCmd(nbCELL context,void *handle,char *verb,char *cursor){
+  char filename[1024];
+  int foreground=0;
+
+  if(!(clientIdentity->authority&AUTH_CONTROL)){
+    outMsg(0,'E',"Identity \"%s\" not authorized to write a checkpoint.",clientIdentity->name->value);
+    return(1);
+    }
+  while(*cursor==' ') cursor++;
+  if(strncmp(cursor,"-f",2)==0 && (*(cursor+2)==0 || *(cursor+2)==' ' || *(cursor+2)==';')){
+    foreground=1;
+    cursor+=2;
+    }
+  if(nbCheckpointGetFile(cursor,filename,sizeof(filename))) return(1);
+  return(nbCheckpointSave(filename,foreground));
+  }
+
+static int nbCheckpointRestoreCmd(nbCELL context,void *handle,char *verb,char *cursor){
+  char filename[1024];
+
+  if(!(clientIdentity->authority&AUTH_CONTROL)){
+    outMsg(0,'E',"Identity \"%s\" not authorized to restore a checkpoint.",clientIdentity->name->value);
+    return(1);
+    }
+  if(nbCheckpointGetFile(cursor,filename,sizeof(filename))) return(1);
+  return(nbCheckpointRestore(filename));
+  }
+
+void nbCheckpointInit(NB_Stem *stem){
+  nbCELL context=(nbCELL)stem->verbs;
+  nbVerbDeclare(context,"checkpoint",AUTH_CONTROL,0,stem,&nbCheckpointCmd,"[-f] [\"<file>\"]");
+  nbVerbDeclare(context,"restore",AUTH_CONTROL,0,stem,&nbCheckpointRestoreCmd,"[\"<file>\"]");
+  }
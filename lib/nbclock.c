@@ -40,6 +40,7 @@
 *   char *nbClockToBuffer(char *buffer);
 *   char *nbClockToString(time_t utc,char *string);
 *   void  nbClockShowTimers();
+*   void  nbClockSimulate(time_t time);
 *
 * Description
 *
@@ -93,6 +94,13 @@
 *
 *            Prints a list of active timers.  Used by the SHOW command.
 *
+*   nbClockSimulate(time_t time)
+*
+*            Sets a simulated clock time.  While a simulated clock is set,
+*            nbClockAlert() and nbClockToBuffer() use the simulated time
+*            instead of the system clock.  A time of zero returns to the
+*            system clock.  The simulated clock never moves backward.
+*
 *=============================================================================
 * Change History:
 *
@@ -127,6 +135,9 @@
 * 2012-01-09 dtl 0.8.6  Checker updates
 * 2012-10-13 eat 0.8.12 Replaced malloc with nbAlloc
 * 2013-01-13 eat 0.8.13 Checker updates
+* 2026-10-18 eat 0.9.04 Included nbClockSimulate() for event replay
+*            Timers fired by nbClockAlert() are also recorded when capture
+*            is active.  See nbcapture.c.
 *=============================================================================
 */
 #include <nb/nbi.h> 
@@ -137,6 +148,7 @@ time_t nb_clockOffset=0; /* offset applied before breakdown to tm structure */
 int    nb_clockClock=NB_CLOCK_LOCAL;  /* break down function: 0 - gmtime(), 1 - localtime() */
 int    nb_clockFormat=1; /* format for displaying times */ 
                            /* 0 - UTC "ssssssssss ", 1 - "yyyy/mm/dd hh:mm:ss " */
+time_t nb_clockSimTime=0;  /* simulated clock time - 0 when using system clock */
 
 NB_Timer *nb_timerQueue; /* timer queue */
 NB_Timer *nb_timerFree;  /* free timers */
@@ -150,6 +162,22 @@ void nbClockInit(NB_Stem *stem){
   nb_timerQueue=NULL;
   nb_timerFree=NULL;
   }
+
+/*
+*  Get the clock time - simulated or system
+*/
+static time_t nbClockNow(time_t *clockTime){
+  if(nb_clockSimTime) *clockTime=nb_clockSimTime;
+  else time(clockTime);
+  return(*clockTime);
+  }
+
+/*
+*  Set a simulated clock time - 0 to return to system clock
+*/
+void nbClockSimulate(time_t simTime){
+  if(simTime==0 || simTime>nb_clockSimTime) nb_clockSimTime=simTime;
+  }
  
 /*
 *  Set a timer to alert an object.
@@ -180,7 +208,7 @@ void nbClockSetTimer(time_t etime,NB_Cell *object){
 
 void nbClockSetTimerInterval(int seconds,NB_Cell *object){
   time_t at;
-  time(&at);
+  nbClockNow(&at);
   at+=seconds;
   nbClockSetTimer(at,object); 
   }
@@ -212,7 +240,7 @@ int nbClockAlert(void){
   nb_ClockAlerting=1;
   //outMsg(0,'T',"nbClockAlert() called ...");
   
-  time(&nb_ClockTime);
+  nbClockNow(&nb_ClockTime);
   while(nb_timerQueue!=NULL && nb_timerQueue->time<=nb_ClockTime){
     react=0;
     cycleTime=nb_timerQueue->time;  /* Process 1 second cycle */
@@ -223,11 +251,12 @@ int nbClockAlert(void){
       nb_timerFree=timer;
       if(timer->time!=0){           /* if timer not cancelled, alert the object */
         object=timer->object;
+        if(nb_capture) nbCaptureAlarm(timer->time);
         (object->type->alarm)(object);
         react=1;
         }
       }
-    time(&nb_ClockTime);
+    nbClockNow(&nb_ClockTime);
     if(react) nbRuleReact();
     }
   outFlush();
@@ -274,7 +303,7 @@ time_t nbClockTimeGm(struct tm *tm){
 char *nbClockToBuffer(char *buffer){
   struct tm *printTm;     /* time in structured form */
 
-  time(&nb_ClockTime);
+  nbClockNow(&nb_ClockTime);
   if(nb_clockFormat==0){
     sprintf(buffer,"%.10d ",(int)nb_ClockTime);
     return(buffer+11);
@@ -262,6 +262,18 @@
 * 2014-03-15 eat 0.9.01 Fixed bug in rule parsing - was looking for newline in call to strtok
 * 2014-03-20 eat 0.9.01 Restored capability to define a node for a term that is current defined as undefined
 * 2014-06-14 eat 0.9.02 Replaced libreadline with libedit for licensing reasons
+* 2026-10-18 eat 0.9.04 Included capture and replay commands - see nbcapture.c
+* 2026-10-18 eat 0.9.04 Included image setting and "archive -image" - see nbimage.c
+* 2026-10-18 eat 0.9.04 Included checkpoint setting and commands - see nbcheckpoint.c
+* 2026-10-18 eat 0.9.04 Included reload command - see nbreload.c
+* 2026-10-18 eat 0.9.04 Included shard command - see nbshard.c
+* 2026-10-18 eat 0.9.04 Included servantPool setting - see nbspawn.c
+* 2026-10-18 eat 0.9.04 Included "forecast ... cast" option to time interval casting
+* 2026-10-18 eat 0.9.04 Count commands for metrics and included metric command
+* 2026-10-18 eat 0.9.04 Time commands for latency histograms and included "show %latency"
+* 2026-10-18 eat 0.9.04 Only normalize definition text for definitions being reloaded
+* 2026-10-18 eat 0.9.04 Included "forecast ... compare" to check array form casts against list form
+* 2026-10-18 eat 0.9.04 Included latency option to time event pipeline stages
 *==============================================================================
 */
 #include "../config.h"
@@ -470,6 +482,8 @@ void showSet(){
   outPut("logfile:\t%s\n",outLogName(NULL));
   outPut("outdir: \t%s\n",outDirName(NULL));
   outPut("pidfile:\t%s\n",servepid);
+  outPut("image:  \t%s\n",nb_imageName);
+  outPut("checkpoint:\t%s\n",nb_checkpointName);
   outPut("jaildir:\t%s\n",servejail);
   outPut("chdir:  \t%s\n",servedir);
   outPut("user:   \t%s\n",serveuser);
@@ -716,12 +730,14 @@ int nbCmdShow(nbCELL context,void *handle,char *verb,char *cursor){
 #if !defined(WIN32)
       else if(symid=='%'){  // experimental measures
         if(strncmp(ident,"type",len)==0) nbObjectShowTypes();
+        else if(strncmp(ident,"latency",len)==0) nbLatencyShow();
         //else if(strncmp(ident,"facet",len==0 nbSkillShowTypes();
         else{
           if(strcmp(ident,"?")!=0) outMsg(0,'E',"Expecting performance type option at \"%s\".",cursave);
           outPut("\nTo show all time measurements of a specified type:\n\n");
           outPut("  show ~<time_measure_type>\n\n");
           outPut("You may specify the <time_measure_type> with a single character.\n\n");
+          outPut("  (l)atency   - event pipeline stages by node\n");
           outPut("  (t)ype      - cell types\n");
           outPut("  (s)kill     - skills\n");
           outPut("\n");
@@ -1032,6 +1048,8 @@ int nbCmdSet(nbCELL context,void *handle,char *verb,char *cursor){
         else if(strcmp(ident,"jaildir")==0 || strcmp(ident,"jail")==0) nbSetOptStr(ident,servejail,token,sizeof(servejail)); // 2006-05-12 eat 0.6.6
         else if(strcmp(ident,"chdir")==0 || strcmp(ident,"dir")==0)  nbSetOptStr(ident,servedir,token,sizeof(servedir));   // 2006-05-12 eat 0.6.6
         else if(strcmp(ident,"pidfile")==0)  nbSetOptStr(ident,servepid,token,sizeof(servedir));   // 2010-10-14 eat 0.8.4
+        else if(strcmp(ident,"image")==0) nbSetOptStr(ident,nb_imageName,token,sizeof(nb_imageName)); // 2026-10-18 eat 0.9.04
+        else if(strcmp(ident,"checkpoint")==0) nbSetOptStr(ident,nb_checkpointName,token,sizeof(nb_checkpointName)); // 2026-10-18 eat 0.9.04
         else if(strcmp(ident,"user")==0) nbSetOptStr(ident,serveuser,token,sizeof(serveuser)); // 2006-05-12 eat 0.6.6
         else if(strcmp(ident,"group")==0) nbSetOptStr(ident,servegroup,token,sizeof(servegroup)); // 2010-10-16 eat 0.8.4
         else{
@@ -1062,6 +1080,7 @@ int nbCmdSet(nbCELL context,void *handle,char *verb,char *cursor){
           }
         */
         else if(strcmp(ident,"processLimit")==0) nbMedullaProcessLimit(i);
+        else if(strcmp(ident,"servantPool")==0) nbSpawnPool(i);  // 2026-10-18 eat 0.9.04
         else{
           outMsg(0,'E',"Unrecognized integer option \"%s\".",ident);
           return(1);
@@ -1097,6 +1116,8 @@ int nbCmdSet(nbCELL context,void *handle,char *verb,char *cursor){
       // was previously associated with the --solve option
       else if(strcmp(ident,"s")==0 || strcmp(ident,"servant")==0)   nb_opt_servant=1;
       else if(strcmp(ident,"S")==0 || strcmp(ident,"noServant")==0) nb_opt_servant=0;
+      else if(strcmp(ident,"latency")==0)   nb_opt_latency=1;  // 2026-10-18 eat 0.9.04
+      else if(strcmp(ident,"noLatency")==0) nb_opt_latency=0;
       else if(strcmp(ident,"showterms")==0) termPrintGloss((NB_Term *)context,NULL,0);
 
       /*
@@ -1339,6 +1360,9 @@ int nbCmdArchive(nbCELL context,void *handle,char *verb,char *cursor){
     outMsg(0,'E',"Identity \"%s\" not authorized to archive the log file.",clientIdentity->name->value);
     return(1);
     }
+  while(*cursor==' ') cursor++;
+  if(strncmp(cursor,"-image",6)==0 && (*(cursor+6)==0 || *(cursor+6)==' ' || *(cursor+6)==';'))
+    return(nbImageArchive(cursor+6));  // 2026-10-18 eat 0.9.04
   if(!agent){
     outMsg(0,'E',"archive command only supported in daemon mode"); 
     return(1);
@@ -1527,7 +1551,7 @@ int nbCmdDeclare(nbCELL context,void *handle,char *verb,char *cursor){
   return(0);
   }
          
-int nbCmdDefine(nbCELL context,void *handle,char *verb,char *cursor){
+static int nbCmdDefineTerm(nbCELL context,void *handle,char *verb,char *cursor){
   char ident[256],type[256];
   NB_Term *term,*typeTerm;  // goof with context type
   struct COND *ruleCond;
@@ -1761,6 +1785,7 @@ int nbCmdDefine(nbCELL context,void *handle,char *verb,char *cursor){
   else if(strcmp(type,"node")==0){
     if(term){ // 2014-11-21 eat - if redefining a term as a node, make sure it is already a node
       if(term->def->type==nb_NodeType){  // redefining a node to a node is ok
+        if(term->reload) term->reload=dropObject(term->reload);
         dropObject(term->def);
         term->def=nb_Undefined;
         }
@@ -1800,6 +1825,35 @@ int nbCmdDefine(nbCELL context,void *handle,char *verb,char *cursor){
   else outMsg(0,'E',"Type \"%s\" not recognized.",type);
   return(0);
   }
+
+// 2026-10-18 eat 0.9.04 - compare and record definition text for the reload command
+//            A reloaded definition with the same text is ignored, and one with
+//            different text is processed as a redefinition.  Other definitions
+//            go straight to nbCmdDefineTerm.  Symbolic (%) and root (@.) terms
+//            are not tracked.
+int nbCmdDefine(nbCELL context,void *handle,char *verb,char *cursor){
+  char ident[256],*cursave=cursor;
+  NB_Term *term;
+  NB_String *text;
+  int rc;
+
+  if(!nb_reloadDefine) return(nbCmdDefineTerm(context,handle,verb,cursor));
+  nb_reloadDefine=0;
+  if(nbParseSymbol(ident,sizeof(ident),&cursor)!='t' || *ident=='%' || *ident=='@')
+    return(nbCmdDefineTerm(context,handle,verb,cursave));
+  text=nbReloadText(cursor);
+  term=nbTermFindDown((NB_Term *)context,ident);
+  if(nbReloadSame(term,text)){
+    dropObject(text);
+    return(0);
+    }
+  if(term) verb="redefine";
+  rc=nbCmdDefineTerm(context,handle,verb,cursave);
+  if(rc==0 && (term=nbTermFindDown((NB_Term *)context,ident))!=NULL && term->def!=nb_Undefined)
+    nbReloadRecord(term,text);
+  dropObject(text);
+  return(rc);
+  }
   
 int nbCmdUndefine(nbCELL context,void *handle,char *verb,char *cursor){
   char symid,ident[256];
@@ -1866,8 +1920,93 @@ int nbCmdProfile(nbCELL context,void *handle,char *verb,char *cursor){
   return(0);
   }
 
+/*
+*  Time the casting of a time condition over a number of days
+*
+*    The cast is repeated for at least half a second of processor time to
+*    get a usable average.
+*/
+static int nbCmdForecastCast(struct SCHED *sched,long days){
+  tc tcdef;
+  bfi f,s;
+  long begin,end;
+  int intervals=0,casts=0;
+  clock_t clockBegin,clockEnd;
+
+  if(sched->cell.object.type!=schedTypeTime || sched->queue->tcdef->operation==tcPlan){
+    outMsg(0,'E',"Cast is only supported for time conditions without a plan.");
+    return(1);
+    }
+  if(days<1 || days>36500){
+    outMsg(0,'E',"Cast days must be from 1 to 36500.");
+    return(1);
+    }
+  tcdef=sched->queue->tcdef;
+  begin=tcTime();
+  end=begin+days*86400;
+  if(end<begin || end>maxtime) end=maxtime;
+  clockBegin=clock();
+  do{
+    f=tcCast(begin,end,tcdef);
+    if(casts==0) for(s=f->next;s!=f;s=s->next) intervals++;
+    bfiDispose(f);
+    casts++;
+    clockEnd=clock();
+    }while(clockEnd-clockBegin<CLOCKS_PER_SEC/2 && casts<1000);
+  outMsg(0,'I',"Cast %d intervals over %ld days in %.3f milliseconds (average of %d casts)",
+    intervals,days,(double)(clockEnd-clockBegin)*1000/CLOCKS_PER_SEC/casts,casts);
+  return(0);
+  }
+
+/*
+*  Compare array form and list form casts of a time condition
+*
+*    The time condition is cast over the same days with bfiListForm set and
+*    not set.  The first differing interval is reported if the casts differ.
+*/
+static int nbCmdForecastCompare(struct SCHED *sched,long days){
+  tc tcdef;
+  bfi f,g,s,t;
+  long begin,end;
+  int rc=0;
+
+  if(sched->cell.object.type!=schedTypeTime || sched->queue->tcdef->operation==tcPlan){
+    outMsg(0,'E',"Compare is only supported for time conditions without a plan.");
+    return(1);
+    }
+  if(days<1 || days>36500){
+    outMsg(0,'E',"Compare days must be from 1 to 36500.");
+    return(1);
+    }
+  tcdef=sched->queue->tcdef;
+  begin=tcTime();
+  end=begin+days*86400;
+  if(end<begin || end>maxtime) end=maxtime;
+  bfiListForm=1;
+  g=tcCast(begin,end,tcdef);
+  bfiListForm=0;
+  f=tcCast(begin,end,tcdef);
+  if(bfiCompare(f,g)) outMsg(0,'I',"Array and list casts are identical over %ld days",days);
+  else{
+    for(s=f->next,t=g->next;s!=f && t!=g && s->start==t->start && s->end==t->end;s=s->next,t=t->next);
+    if(s==f) outMsg(0,'E',"Array cast is missing list interval (%ld,%ld) at offset (%ld,%ld)",t->start,t->end,t->start-begin,t->end-begin);
+    else if(t==g) outMsg(0,'E',"Array cast has extra interval (%ld,%ld) at offset (%ld,%ld)",s->start,s->end,s->start-begin,s->end-begin);
+    else outMsg(0,'E',"Array cast interval (%ld,%ld) differs from list interval (%ld,%ld)",s->start,s->end,t->start,t->end);
+    rc=1;
+    }
+  bfiDispose(f);
+  bfiDispose(g);
+  return(rc);
+  }
+
 /*
 *  Forecast schedules
+*
+*    forecast <schedule>[ cast|compare [<days>]]
+*
+*    The cast option times casting of the schedule's time condition over
+*    the specified number of days (default 366) instead of listing intervals.
+*    The compare option checks that array and list form casts are identical.
 */
 int nbCmdForecast(nbCELL context,void *handle,char *verb,char *cursor){
   char *delim,msg[1024];
@@ -1910,6 +2049,23 @@ int nbCmdForecast(nbCELL context,void *handle,char *verb,char *cursor){
     return(1);
     }
   cursave=cursor;
+  while(*cursor==' ') cursor++;
+  if((strncmp(cursor,"cast",4)==0 && (*(cursor+4)==' ' || *(cursor+4)==';' || *(cursor+4)==0)) ||
+     (strncmp(cursor,"compare",7)==0 && (*(cursor+7)==' ' || *(cursor+7)==';' || *(cursor+7)==0))){  // 2026-10-18 eat 0.9.04
+    long days=366;
+    int compare=(*(cursor+1)=='o');
+    cursor+=compare? 7 : 4;
+    while(*cursor==' ') cursor++;
+    if(*cursor>='0' && *cursor<='9') days=strtol(cursor,&cursor,10);
+    cursave=cursor;
+    symid=nbParseSymbol(ident,sizeof(ident),&cursor);
+    if(symid!=';'){
+      outMsg(0,'E',"Expecting end of command at-->\"%s\".",cursave);
+      return(1);
+      }
+    if(compare) return(nbCmdForecastCompare(sched,days));
+    return(nbCmdForecastCast(sched,days));
+    }
   symid=nbParseSymbol(ident,sizeof(ident),&cursor);
   if(symid!=';'){
     outMsg(0,'E',"Expecting end of command at-->\"%s\".",cursave);
@@ -2314,7 +2470,7 @@ static int nbCmdParse(nbCELL context,char *cursor,unsigned char cmdopt,NB_Instru
 //                       
 //            Note: need to finish verb tree
 
-void nbCmd(nbCELL context,char *cursor,unsigned char cmdopt){ 
+static void nbCmdInterpret(nbCELL context,char *cursor,unsigned char cmdopt){ 
   NB_Stem *stem=context->object.type->stem;
   char symid,verb[256],*cursave;
   //char *cmdbuf=cursor;
@@ -2322,6 +2478,12 @@ void nbCmd(nbCELL context,char *cursor,unsigned char cmdopt){
   NB_Term *saveContext;
   //int cmdlen;
   struct NB_VERB *verbObject;
+  int imageLine=nb_imageLine;   // 2026-10-18 eat - source line to record in rule image
+  int reloadLine=nb_reloadLine; // 2026-10-18 eat - source line of a reloaded file
+
+  nb_metricCommands.value++;    // 2026-10-18 eat - count for metrics
+  nb_imageLine=0;
+  nb_reloadLine=0;
 
   if(trace) outMsg(0,'T',"nbCmd: called with cmdopt=%x :%s",cmdopt,cursor);
   // 2008-06-20 eat - this is a good place to check for schedule events
@@ -2339,6 +2501,11 @@ void nbCmd(nbCELL context,char *cursor,unsigned char cmdopt){
     addrContext=saveContext;
     return;
     }
+  if(imageLine) nbImageCommand(context,symid,verb,cursave);  // record resolved command
+  if(reloadLine && !nbReloadCommand(symid,verb)){  // reload skips all but definitions
+    addrContext=saveContext;
+    return;
+    }
   addrContext=(NB_Term *)context;
 
   //outMsg(0,'T',"nbCmd: symid=%c,verb=%s,cursor=%s",symid,verb,cursor);
@@ -2372,6 +2539,7 @@ void nbCmd(nbCELL context,char *cursor,unsigned char cmdopt){
         // 2010-06-20 eat 0.8.2 - included handle - but we should also get the return code
         // we need to modify nbCmd to provide a return code
         (*verbObject->parse)(context,verbObject->handle,verb,cursor);
+        nb_reloadDefine=0;
         }
       else outMsg(0,'E',"Verb \"%s\" not recognized.",verb);
       break;
@@ -2429,6 +2597,30 @@ void nbCmd(nbCELL context,char *cursor,unsigned char cmdopt){
   addrContext=saveContext;
   }
 
+// 2026-10-18 eat 0.9.04 - record commands entering from outside when capture is active
+//            Nested commands (rule actions, sourced files, etc.) are not recorded
+//            because a replay of the outer command reproduces them.
+// 2026-10-18 eat 0.9.04 - time commands for latency histograms
+//            A command is the start of an event unless a listener started it.
+void nbCmd(nbCELL context,char *cursor,unsigned char cmdopt){
+  unsigned long long start=nbLatencyNow();
+  int event=!nb_latencyEvent;
+
+  if(event) nb_latencyEvent=start;
+  if(!nb_capture) nbCmdInterpret(context,cursor,cmdopt);
+  else{
+    if(!nb_captureHold && !nb_ClockAlerting){
+      while(*cursor==' ') cursor++;
+      if(*cursor!=0 && *cursor!='\n') nbCaptureCommand(context,cursor,cmdopt);
+      }
+    nb_captureHold++;
+    nbCmdInterpret(context,cursor,cmdopt);
+    nb_captureHold--;
+    }
+  nbLatencyObserve(NB_LATENCY_COMMAND,start);
+  if(event) nb_latencyEvent=0;
+  }
+
 void nbCmdSid(nbCELL context,char *cursor,char cmdopt,struct IDENTITY *identity){
   struct IDENTITY *clientIdentitySave=clientIdentity;
 
@@ -2460,7 +2652,7 @@ void nbCmdInit(NB_Stem *stem){
   nbVerbDeclare(context,"disable",AUTH_DEFINE,0,stem,&nbCmdEnable,"<term>");  // nbCmdEnable checks verb
   nbVerbDeclare(context,"enable",AUTH_DEFINE,0,stem,&nbCmdEnable,"<term>");
   nbVerbDeclare(context,"exit",AUTH_CONTROL,0,stem,&nbCmdExit,"<cell>");
-  nbVerbDeclare(context,"forecast",AUTH_CONNECT,0,stem,&nbCmdForecast,"~(<timeCondition>)");
+  nbVerbDeclare(context,"forecast",AUTH_CONNECT,0,stem,&nbCmdForecast,"~(<timeCondition>) [cast|compare [<days>]]");
   nbVerbDeclare(context,"grant",AUTH_CONTROL,0,stem,&nbCmdGrant,"*** future ***");
   nbVerbDeclare(context,"load",AUTH_CONTROL,0,stem,&nbCmdLoad,"<library>");
   nbVerbDeclare(context,"profile",AUTH_CONTROL,0,stem,&nbCmdProfile,"<command>");
@@ -2479,4 +2671,9 @@ void nbCmdInit(NB_Stem *stem){
 #if defined(WIN32)
   nbVerbDeclare(context,"windows",AUTH_CONTROL,0,stem,&nbwCommand,"service(Start|Stop) <service>");
 #endif
+  nbCaptureInit(stem);
+  nbCheckpointInit(stem);
+  nbReloadInit(stem);
+  nbShardInit(stem);
+  nbMetricInit(stem);
   }
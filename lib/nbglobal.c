@@ -49,6 +49,7 @@
 * 2010-10-16 eat 0.8.4  Included servegroup.
 * 2012-12-25 eat 0.8.13 Included nb_charset.
 * 2014-01-06 eat 0.9.00 Included performance testing options.
+* 2026-10-18 eat 0.9.04 Included nb_opt_latency.
 *============================================================================
 */
 #include <stdio.h> 
@@ -78,6 +79,7 @@ int  nb_opt_hush=0;      // suppress calls to log routines
 int  nb_opt_stats=0;     // print statistics when terminating
 int  nb_opt_boolnotrel=0;// boolean not relational - a<>1 ==> !(a=1), a<=1 ==> !(a>1), a>=1 ==> !(a<1)
 int  nb_opt_test=0;      // test mode - display pretend time stamps to simplify output diff
+int  nb_opt_latency=0;   // time event pipeline stages for latency histograms
 int  nb_opt_safe=0;      // safe mode prevents unsaf interactions with host environment
                          // e.g. spawning child processes, source command, modules other than tree, and cache
 
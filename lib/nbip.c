@@ -56,6 +56,7 @@
 * 2012-12-27 eat 0.8.13 Checker updates
 * 2012-12-31 eat 0.8.13 Checker updates
 * 2013-01-11 eat 0.8.13 Checker updates
+* 2026-10-18 eat 0.9.04 Included datagram record and replay functions
 *=====================================================================
 */
 #include <nb/nbi.h>
@@ -819,3 +820,168 @@ int nbIpTcpConnect(char *addr,unsigned short port){
   return(tcpSocket);
   }
 
+/*
+*  Datagram record files
+*
+*    Modules that receive datagrams record them to a file and replay them
+*    with these functions, so problems seen in the field can be reproduced
+*    and decoding can be benchmarked.  A record file starts with an 8 byte
+*    magic string that identifies the module.  Each datagram is written as
+*    the sender address (4 bytes in network byte order), the datagram
+*    length (4 bytes in network byte order), and the datagram.
+*
+*    The module command syntax is
+*
+*      <node>:record <file>             - append received datagrams to a file
+*      <node>:record                    - stop recording
+*      <node>:replay <file>             - process recorded datagrams
+*      <node>:benchmark <file>[,<n>]    - process recorded datagrams n times
+*/
+
+/*
+*  Parse a record, replay or benchmark command
+*
+*  Returns: 1 - parsed, 0 - not one of these verbs, -1 - error
+*/
+int nbIpRecordParse(nbCELL context,char *text,char *verb,size_t verbSize,char *filename,size_t fileSize,int *repeat){
+  char *cursor=text,*delim;
+  size_t len;
+
+  *repeat=1;
+  while(*cursor==' ') cursor++;
+  for(delim=cursor;*delim>='a' && *delim<='z';delim++);
+  len=delim-cursor;
+  if(len==0 || len>=verbSize) return(0);
+  strncpy(verb,cursor,len);
+  *(verb+len)=0;
+  if(strcmp(verb,"record")!=0 && strcmp(verb,"replay")!=0 && strcmp(verb,"benchmark")!=0) return(0);
+  cursor=delim;
+  while(*cursor==' ') cursor++;
+  for(delim=cursor;*delim!=0 && *delim!=',' && *delim!=';' && *delim!=' ';delim++);
+  len=delim-cursor;
+  if(len>=fileSize){
+    nbLogMsg(context,0,'E',"File name too long");
+    return(-1);
+    }
+  strncpy(filename,cursor,len);
+  *(filename+len)=0;
+  cursor=delim;
+  while(*cursor==' ') cursor++;
+  if(*cursor==','){
+    *repeat=atoi(cursor+1);
+    if(*repeat<1) *repeat=1;
+    }
+  if(strcmp(verb,"record")!=0 && *filename==0){
+    nbLogMsg(context,0,'E',"Expecting file name");
+    return(-1);
+    }
+  return(1);
+  }
+
+/*
+*  Stop recording, and start recording to a file if a name is given
+*
+*  Returns the record file, or NULL when not recording.
+*/
+FILE *nbIpRecord(nbCELL context,FILE *record,char *filename,char *magic){
+  if(record){
+    fclose(record);
+    record=NULL;
+    nbLogMsg(context,0,'I',"Recording stopped");
+    }
+  if(*filename==0) return(NULL);
+  if((record=fopen(filename,"ab"))==NULL){
+    nbLogMsg(context,0,'E',"Unable to open %s - %s",filename,strerror(errno));
+    return(NULL);
+    }
+  if(ftell(record)==0) fwrite(magic,8,1,record);
+  nbLogMsg(context,0,'I',"Recording datagrams to %s",filename);
+  return(record);
+  }
+
+/*
+*  Write a datagram to a record file
+*
+*  Returns the record file, or NULL when the write failed and recording stopped.
+*/
+FILE *nbIpRecordPut(nbCELL context,FILE *record,unsigned int addr,unsigned char *buffer,int len){
+  unsigned char recHdr[8];
+
+  memcpy(recHdr,&addr,4);
+  recHdr[4]=len>>24;
+  recHdr[5]=len>>16;
+  recHdr[6]=len>>8;
+  recHdr[7]=len;
+  if(fwrite(recHdr,8,1,record)!=1 || fwrite(buffer,len,1,record)!=1){
+    nbLogMsg(context,0,'E',"Unable to write record file - %s",strerror(errno));
+    fclose(record);
+    return(NULL);
+    }
+  return(record);
+  }
+
+/*
+*  Get a monotonic clock time in seconds
+*/
+static double nbIpClock(void){
+#if defined(WIN32)
+  return((double)GetTickCount64()/1000);
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+  return((double)ts.tv_sec+(double)ts.tv_nsec/1000000000);
+#endif
+  }
+
+/*
+*  Replay recorded datagrams
+*
+*    The file is read into memory first, so a benchmark measures the handler
+*    without file input.  Each datagram is passed to the handler with the
+*    sender address, and the time spent in the handler is returned in
+*    elapsed.
+*
+*  Returns the number of datagrams replayed, or -1 on error.
+*/
+int nbIpReplay(nbCELL context,char *filename,char *magic,size_t maxlen,int repeat,void *handle,void (*handler)(nbCELL context,void *handle,unsigned int addr,unsigned char *buffer,int len),double *elapsed){
+  FILE *file;
+  unsigned char *data=NULL,*cursor,*end;
+  long size;
+  unsigned int addr,len;
+  double start;
+  int datagrams=0,i;
+
+  if((file=fopen(filename,"rb"))==NULL){
+    nbLogMsg(context,0,'E',"Unable to open %s - %s",filename,strerror(errno));
+    return(-1);
+    }
+  fseek(file,0,SEEK_END);
+  size=ftell(file);
+  fseek(file,0,SEEK_SET);
+  if(size<8 || (data=malloc(size))==NULL || fread(data,size,1,file)!=1){
+    nbLogMsg(context,0,'E',"Unable to read %s",filename);
+    if(data) free(data);
+    fclose(file);
+    return(-1);
+    }
+  fclose(file);
+  if(memcmp(data,magic,8)!=0){
+    nbLogMsg(context,0,'E',"File %s is not a record file for this module",filename);
+    free(data);
+    return(-1);
+    }
+  end=data+size;
+  start=nbIpClock();
+  for(i=0;i<repeat;i++){
+    for(cursor=data+8;cursor+8<=end;cursor+=8+len){
+      len=(unsigned int)*(cursor+4)<<24|(unsigned int)*(cursor+5)<<16|(unsigned int)*(cursor+6)<<8|*(cursor+7);
+      if(len>maxlen || cursor+8+len>end) break;
+      memcpy(&addr,cursor,4);
+      (*handler)(context,handle,addr,cursor+8,len);
+      datagrams++;
+      }
+    }
+  *elapsed=nbIpClock()-start;
+  free(data);
+  return(datagrams);
+  }
@@ -88,6 +88,8 @@
 * 2012-10-13 eat 0.8.12 Replaced malloc/free with nbAlloc/nbFree
 * 2012-12-27 eat 0.8.13 Checker updates
 * 2012-12-31 eat 0.8.13 Checker updates
+* 2026-10-18 eat 0.9.04 Count listener events for metrics
+* 2026-10-18 eat 0.9.04 Observe wait and handler latency by node
 *=============================================================================
 */
 #include <nb/nbi.h>
@@ -110,6 +112,8 @@ int nb_listener_serving=0;  // set when serving
 
 int nbListenerReader(void *session){
   NB_Listener *sel=(NB_Listener *)session;
+  NB_LatencySet *latencySave=nb_latency;
+  unsigned long long eventSave=nb_latencyEvent,start;
 
 #if defined(WIN32)
   int mode=0;
@@ -117,7 +121,15 @@ int nbListenerReader(void *session){
   WSAEventSelect((SOCKET)sel->fildes,sel->hEvent,0);
   ioctlsocket((SOCKET)sel->fildes,FIONBIO,&mode); // Make the socket blocking
 #endif 
-  (sel->handler)(sel->context,sel->fildes,sel->session);
+  sel->events++;
+  if(!sel->latency) sel->latency=nbLatencySet(sel->context);
+  nb_latency=sel->latency;
+  start=nbLatencyObserve(NB_LATENCY_WAIT,nb_latencyReady);
+  nb_latencyEvent=nb_latencyReady;
+  (sel->handler)(sel->context,sel->fildes,sel->session);  // may remove sel
+  nbLatencyObserve(NB_LATENCY_HANDLER,start);
+  nb_latency=latencySave;
+  nb_latencyEvent=eventSave;
 #if defined(WIN32)
   WSAEventSelect((SOCKET)sel->fildes,sel->hEvent,FD_ACCEPT|FD_READ);
 #endif
@@ -163,6 +175,8 @@ int nbListenerAdd(NB_Cell *context,int fildes,void *session,void (*handler)(stru
   sel->fildes=fildes;
   sel->session=session;
   sel->handler=handler;
+  sel->events=0;
+  sel->latency=NULL;
   sel->next=selectUsed;
   selectUsed=sel;
 #if defined(WIN32)
@@ -187,6 +201,8 @@ int nbListenerAddWrite(NB_Cell *context,int fildes,void *session,void (*handler)
   sel->fildes=fildes;
   sel->session=session;
   sel->handler=handler;
+  sel->events=0;
+  sel->latency=NULL;
   sel->next=selectUsed;
   selectUsed=sel;
 #if defined(WIN32)
@@ -83,6 +83,29 @@
 *
 *   This function is called by one of the handler routines to force the
 *   call to the start routine to return.
+*
+*   nbMedullaWorkerCreate()
+*
+*   Medulla threads take turns on the main thread.  For blocking work (file
+*   reads, name lookups, compression) a skill module may start an operating
+*   system thread instead.  A worker must not use the interpreter or nbAlloc,
+*   which are not thread safe.
+*
+*   nbMedullaPost()
+*
+*   A worker returns a result by posting a handler call, which is made by
+*   nbMedullaPulse() on the main thread.  The post queue is a bounded ring of
+*   slots, each with a sequence number.  A poster claims a slot by advancing
+*   the put position with a compare-and-swap, fills it, and then publishes it
+*   by setting the sequence.  The main thread is the only consumer, so it
+*   takes slots in order without locks until it reaches one not yet
+*   published.  When the ring is full, nbMedullaPost() returns 1 and the
+*   worker may retry or drop the result.
+*
+*   The main thread watches an eventfd (a pipe where not supported) like any
+*   other file.  A poster only writes to it when it is the first to set the
+*   wake flag since the main thread last cleared it, so a burst of posts
+*   costs one system call.
 *   
 *=============================================================================
 * Change History:
@@ -112,6 +135,19 @@
 *            and the problem is resolved.
 * 2014-01-25 eat 0.9.00 Checker updates
 * 2014-12-13 eat 0.9.03 Include memset after nbAlloc for cases that might need it
+* 2026-10-18 eat 0.9.04 Included pid hash for nbMedullaProcessFind
+* 2026-10-18 eat 0.9.04 Read SIGCHLD from a signalfd where supported
+*            SIGCHLD is blocked and read from a signalfd watched by select(), so
+*            a child ending just before select() is called no longer leaves it
+*            waiting for the timeout before the child is reaped.  Children are
+*            started with SIGCHLD unblocked.
+* 2026-10-18 eat 0.9.04 Included post queue and worker threads
+* 2026-10-18 eat 0.9.04 Frame child stdout and stderr lines in place
+*            Lines were copied into chained 4K queue buffers and copied out
+*            again for the consumer.  Now they are read into a 64K line
+*            buffer and passed to the consumer where they are.
+* 2026-10-18 eat 0.9.04 Record when files are found ready for latency histograms
+* 2026-10-18 eat 0.9.04 Included nbMedullaSigChildUnblock for children we don't start
 *=============================================================================
 */
 #define NB_INTERNAL
@@ -122,12 +158,23 @@
 #endif
 #include <nb/nbi.h>
 #include <nb/nbmedulla.h>
+#if defined(HAVE_SYS_SIGNALFD_H)
+#include <sys/signalfd.h>
+#endif
+#if defined(HAVE_SYS_EVENTFD_H)
+#include <sys/eventfd.h>
+#endif
+#if defined(HAVE_PTHREAD_H)
+#include <pthread.h>
+#endif
 
 nbMEDULLA nb_medulla=NULL;
 nbPROCESS nb_process=NULL;      // list of child processes
 int nb_medulla_child_count=0;   // number of children
 int nb_medulla_child_max=50;    // maximum number of children
 int nb_medulla_sigchld=0;       // flag indicating a child has ended
+int nb_medulla_sigchld_fd=-1;   // signalfd for SIGCHLD when supported
+static nbPROCESS nb_medulla_pid_hash[NB_MEDULLA_PID_HASH_SIZE]; // processes by pid
 
 struct NB_MEDULLA_BUFFER *nb_free_buffer;
 int nb_free_buffer_count=0;
@@ -283,6 +330,252 @@ void nbMedullaSigChildHandler(int sig){
   nb_medulla_sigchld=1;
   }
 
+#if defined(HAVE_SYS_SIGNALFD_H)
+// Drain the SIGCHLD signalfd
+//
+//   This only sets the flag.  Children are reaped by nbMedullaProcessHandler()
+//   after the file handlers are called, because closing a process may disable
+//   handlers still to be called in the same pulse.
+//
+static int nbMedullaSigChildReader(void *session){
+  struct signalfd_siginfo info[16];
+
+  while(read(nb_medulla_sigchld_fd,info,sizeof(info))>0);
+  nb_medulla_sigchld=1;
+  return(0);
+  }
+#endif
+
+#if !defined(WIN32)
+// Unblock SIGCHLD for a child the medulla didn't start
+//
+//   The medulla blocks SIGCHLD when it reads it from a signalfd, and the mask
+//   is inherited.  Children started by nbChildOpen() unblock it themselves.
+//   Call this in a child from fork() or vfork() that is not an agent before
+//   it starts processes of its own, or in the agent around popen() and
+//   system(), followed by nbMedullaSigChildBlock().  It only changes the
+//   signal mask, so it is safe in a vfork() child.
+
+void nbMedullaSigChildUnblock(void){
+#if defined(HAVE_SYS_SIGNALFD_H)
+  sigset_t sigchld;
+
+  if(nb_medulla_sigchld_fd<0) return;
+  sigemptyset(&sigchld);
+  sigaddset(&sigchld,SIGCHLD);
+  sigprocmask(SIG_UNBLOCK,&sigchld,NULL);
+#endif
+  }
+
+// Block SIGCHLD again after nbMedullaSigChildUnblock()
+//
+//   A child ending while SIGCHLD was unblocked is not queued to the signalfd,
+//   so flag a check for ended children.
+
+void nbMedullaSigChildBlock(void){
+#if defined(HAVE_SYS_SIGNALFD_H)
+  sigset_t sigchld;
+
+  if(nb_medulla_sigchld_fd<0) return;
+  sigemptyset(&sigchld);
+  sigaddset(&sigchld,SIGCHLD);
+  sigprocmask(SIG_BLOCK,&sigchld,NULL);
+  nb_medulla_sigchld=1;
+#endif
+  }
+#endif
+
+#if !defined(WIN32)
+//====================================================================
+// Post queue - see nbMedullaPost() in the description above
+
+struct NB_MEDULLA_POST{
+  unsigned int sequence;           // slot position when free, position+1 when published
+  NB_MEDULLA_POST_HANDLER handler;
+  void *session;
+  void *data;
+  };
+
+static struct NB_MEDULLA_POST *nb_medulla_post=NULL;
+static volatile unsigned int nb_medulla_post_put=0;  // next position to claim
+static unsigned int nb_medulla_post_get=0;           // next position to take
+static volatile int nb_medulla_post_wake=0;          // 1 when a wakeup is pending
+static int nb_medulla_post_fd[2]={-1,-1};            // read and write ends of wakeup
+
+// Write the wakeup
+
+static void nbMedullaPostWake(void){
+#if defined(HAVE_SYS_EVENTFD_H)
+  uint64_t one=1;
+#else
+  char one=1;
+#endif
+
+  if(write(nb_medulla_post_fd[1],&one,sizeof(one))<0 && errno!=EAGAIN)
+    fprintf(stderr,"nbMedullaPostWake: unable to write wakeup - %s\n",strerror(errno));
+  }
+
+// Call the handlers of published posts
+//
+//   We take at most one ring of posts per pulse, so workers can't keep the
+//   main thread from its other files.  When more remain, we wake ourselves.
+
+static int nbMedullaPostReader(void *session){
+  struct NB_MEDULLA_POST *slot;
+  NB_MEDULLA_POST_HANDLER handler;
+  void *postSession,*data;
+  char buffer[64];
+  int n;
+
+  while(read(nb_medulla_post_fd[0],buffer,sizeof(buffer))>0);
+  nb_medulla_post_wake=0;
+  __sync_synchronize();   // clear the flag before we look, so a later post wakes us
+  for(n=0;n<NB_MEDULLA_POST_SIZE;n++){
+    slot=&nb_medulla_post[nb_medulla_post_get&(NB_MEDULLA_POST_SIZE-1)];
+    if(*(volatile unsigned int *)&slot->sequence!=nb_medulla_post_get+1) return(0);
+    __sync_synchronize();
+    handler=slot->handler;
+    postSession=slot->session;
+    data=slot->data;
+    __sync_synchronize();
+    slot->sequence=nb_medulla_post_get+NB_MEDULLA_POST_SIZE;  // free for the next lap
+    nb_medulla_post_get++;
+    (*handler)(postSession,data);
+    }
+  if(__sync_bool_compare_and_swap(&nb_medulla_post_wake,0,1)) nbMedullaPostWake();
+  return(0);
+  }
+
+// Create the post queue and watch for wakeups
+
+static int nbMedullaPostOpen(void){
+  unsigned int i;
+
+#if defined(HAVE_SYS_EVENTFD_H)
+  nb_medulla_post_fd[0]=eventfd(0,EFD_NONBLOCK|EFD_CLOEXEC);
+  nb_medulla_post_fd[1]=nb_medulla_post_fd[0];
+  if(nb_medulla_post_fd[0]<0){
+#else
+  if(pipe(nb_medulla_post_fd)<0){
+#endif
+    fprintf(stderr,"nbMedullaPostOpen: unable to create wakeup - %s\n",strerror(errno));
+    nb_medulla_post_fd[0]=-1;
+    nb_medulla_post_fd[1]=-1;
+    return(-1);
+    }
+#if !defined(HAVE_SYS_EVENTFD_H)
+  for(i=0;i<2;i++){
+    fcntl(nb_medulla_post_fd[i],F_SETFL,fcntl(nb_medulla_post_fd[i],F_GETFL)|O_NONBLOCK);
+    fcntl(nb_medulla_post_fd[i],F_SETFD,FD_CLOEXEC);
+    }
+#endif
+  nb_medulla_post=nbAlloc(NB_MEDULLA_POST_SIZE*sizeof(struct NB_MEDULLA_POST));
+  memset(nb_medulla_post,0,NB_MEDULLA_POST_SIZE*sizeof(struct NB_MEDULLA_POST));
+  for(i=0;i<NB_MEDULLA_POST_SIZE;i++) nb_medulla_post[i].sequence=i;
+  nbMedullaWaitEnable(0,nb_medulla_post_fd[0],NULL,nbMedullaPostReader);
+  return(0);
+  }
+
+// Give a forked copy of the process its own post queue
+//
+//   The wakeup file is shared with the parent after fork(), so either process
+//   could consume the other's wakeups.  Worker threads are not copied, so any
+//   posts pending in the copied ring belong to the parent.
+
+void nbMedullaPostFork(void){
+  if(nb_medulla_post==NULL) return;
+  nbMedullaWaitDisable(0,nb_medulla_post_fd[0]);
+  close(nb_medulla_post_fd[0]);
+  if(nb_medulla_post_fd[1]!=nb_medulla_post_fd[0]) close(nb_medulla_post_fd[1]);
+  nbFree(nb_medulla_post,NB_MEDULLA_POST_SIZE*sizeof(struct NB_MEDULLA_POST));
+  nb_medulla_post=NULL;
+  nb_medulla_post_put=0;
+  nb_medulla_post_get=0;
+  nb_medulla_post_wake=0;
+  nbMedullaPostOpen();
+  }
+
+// Post a handler call to the main thread
+//
+//   This may be called by any thread, including the main thread.
+//
+//   Returns: 0 - posted, 1 - queue is full, -1 - no queue
+
+int nbMedullaPost(NB_MEDULLA_POST_HANDLER handler,void *session,void *data){
+  struct NB_MEDULLA_POST *slot;
+  unsigned int pos,sequence;
+
+  if(nb_medulla_post==NULL) return(-1);
+  pos=nb_medulla_post_put;
+  while(1){
+    slot=&nb_medulla_post[pos&(NB_MEDULLA_POST_SIZE-1)];
+    sequence=*(volatile unsigned int *)&slot->sequence;
+    __sync_synchronize();
+    if(sequence==pos){
+      if(__sync_bool_compare_and_swap(&nb_medulla_post_put,pos,pos+1)) break;
+      }
+    else if((int)(sequence-pos)<0) return(1);  // taken on the last lap and not yet freed
+    pos=nb_medulla_post_put;
+    }
+  slot->handler=handler;
+  slot->session=session;
+  slot->data=data;
+  __sync_synchronize();
+  slot->sequence=pos+1;   // publish
+  __sync_synchronize();
+  if(__sync_bool_compare_and_swap(&nb_medulla_post_wake,0,1)) nbMedullaPostWake();
+  return(0);
+  }
+
+// Start a worker thread
+//
+//   The worker is detached and runs with all signals blocked, so signals are
+//   still delivered to the main thread.
+//
+//   Returns: 0 - started, -1 - error (see errno)
+
+int nbMedullaWorkerCreate(void *(*worker)(void *arg),void *arg){
+#if defined(HAVE_PTHREAD_H)
+  pthread_t thread;
+  pthread_attr_t attr;
+  sigset_t sigall,sigsave;
+  int rc;
+
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr,PTHREAD_CREATE_DETACHED);
+  sigfillset(&sigall);
+  pthread_sigmask(SIG_SETMASK,&sigall,&sigsave);
+  rc=pthread_create(&thread,&attr,worker,arg);
+  pthread_sigmask(SIG_SETMASK,&sigsave,NULL);
+  pthread_attr_destroy(&attr);
+  if(rc!=0){
+    errno=rc;
+    return(-1);
+    }
+  return(0);
+#else
+  errno=ENOSYS;
+  return(-1);
+#endif
+  }
+#endif
+
+// Maintain pid hash - entries are the processes in the nb_process list
+
+static void nbMedullaProcessHash(nbPROCESS process){
+  nbPROCESS *processP=&nb_medulla_pid_hash[process->pid&(NB_MEDULLA_PID_HASH_SIZE-1)];
+
+  process->pidNext=*processP;
+  *processP=process;
+  }
+
+static void nbMedullaProcessUnhash(nbPROCESS process){
+  nbPROCESS *processP=&nb_medulla_pid_hash[process->pid&(NB_MEDULLA_PID_HASH_SIZE-1)];
+
+  while(*processP!=NULL && *processP!=process) processP=&(*processP)->pidNext;
+  if(*processP!=NULL) *processP=process->pidNext;
+  }
+
 
 
 // Medulla process handler 
@@ -463,6 +756,9 @@ BOOL nbCtrlHandler(DWORD fdwCtrlType){
 int nbMedullaOpen(void *session,int (*scheduler)(void *session),int (*processHandler)(nbPROCESS process,int pid,char *exittype,int exitcode)){
   //struct sigaction sigact;
   NB_Thread *thread;
+#if defined(HAVE_SYS_SIGNALFD_H)
+  sigset_t sigchld;
+#endif
 
 #if defined(WIN32)
   nbMedullaEventInit();
@@ -504,17 +800,30 @@ int nbMedullaOpen(void *session,int (*scheduler)(void *session),int (*processHan
   nb_process->getfile=0;
   nb_process->putfile=1;
   nb_process->logfile=-1;
-  nb_process->getQueue=nbMedullaQueueOpen();
+  nb_process->getLines=nbMedullaLinesOpen();
   nb_process->putQueue=nbMedullaQueueOpen();
-  nb_process->logQueue=NULL;
+  nb_process->logLines=NULL;
 #endif
   strncpy(nb_process->cmd,"root",sizeof(nb_process->cmd));
   nb_process->next=nb_process;
   nb_process->prior=nb_process;
 
 // on windows use WaitForSingleObject
-#if !defined(WIN32)
+#if defined(HAVE_SYS_SIGNALFD_H)
+  // 2026-10-18 eat 0.9.04 - a child ending is a read event on a signalfd
+  sigemptyset(&sigchld);
+  sigaddset(&sigchld,SIGCHLD);
+  if(sigprocmask(SIG_BLOCK,&sigchld,NULL)==0){
+    nb_medulla_sigchld_fd=signalfd(-1,&sigchld,SFD_NONBLOCK|SFD_CLOEXEC);
+    if(nb_medulla_sigchld_fd<0) sigprocmask(SIG_UNBLOCK,&sigchld,NULL);
+    }
+  if(nb_medulla_sigchld_fd>=0) nbMedullaWaitEnable(0,nb_medulla_sigchld_fd,NULL,nbMedullaSigChildReader);
+  else signal(SIGCHLD,nbMedullaSigChildHandler);
+#elif !defined(WIN32)
   signal(SIGCHLD,nbMedullaSigChildHandler);
+#endif
+#if !defined(WIN32)
+  nbMedullaPostOpen();  // 2026-10-18 eat 0.9.04
 #endif
   // Here's how we might do this with sigaction() if we decide it is better than signal() for our needs
   //sigaction(SIGCLD,NULL,&sigact);
@@ -658,7 +967,9 @@ void nbMedullaThreadServe(void);
 //
 // Under UNIX/Linux we depend on signals to interrupt the select()
 // function to know when child processes end and we only directly
-// watch for files ready for I/O with the select() function.
+// watch for files ready for I/O with the select() function.  Where
+// signalfd() is supported, SIGCHLD is read from a file watched by
+// select() instead.
 //
 // Under Windows we watch for file I/O completion and child process
 // completion using WaitForMultpleObjects().
@@ -707,6 +1018,7 @@ int nbMedullaPulse(int serve){
       if(!serve) nb_medulla->serving=0;
       }
     else{
+      nb_latencyReady=nbLatencyNow();  // 2026-10-18 eat - start of wait for latency histograms
       waitIndex-=WAIT_OBJECT_0;
       if(waitIndex<0 || waitIndex>=nb_medulla->waitCount){
         fprintf(stderr,"nbMedullaPulse() waitIndex %d out of bounds - terminating",waitIndex);
@@ -780,6 +1092,7 @@ int nbMedullaPulse(int serve){
         }
       }
     else if(readyfd>0){             // invoke file handlers if any are set
+      nb_latencyReady=nbLatencyNow();  // 2026-10-18 eat - start of wait for latency histograms
       for(handler=nb_medulla->handler;handler!=NULL;handler=handler->next){
         switch(handler->type){
           case 0: setP=&nb_medulla->readfds;   break;
@@ -1010,8 +1323,7 @@ int nbMedullaProcessReadBlocking(nbPROCESS process){
  
 int nbMedullaProcessReadBlocking(nbPROCESS process){
   fd_set fdset;
-  char buffer[NB_BUFSIZE];
-  int len,sent,rc;
+  int len;
   int readyfd;
   int maxfile;
 
@@ -1053,46 +1365,28 @@ int nbMedullaProcessReadBlocking(nbPROCESS process){
       return(1);
       }
     if(process->logfile>0 && FD_ISSET(process->logfile,&fdset)){
-      len=read(process->logfile,buffer,sizeof(buffer));
-      while(len==-1 && errno==EINTR) len=read(process->logfile,buffer,sizeof(buffer));
+      len=nbMedullaLinesRead(process->logLines,process->logfile,process,process->logger);
       if(len<=0){
         if(len<0) fprintf(stderr,"[%d] Error reading from process stderr\n",process->pid);
         //else fprintf(stderr,"[%d] End of file on stderr\n",process->pid);
         close(process->logfile);
         process->logfile=-1;
-        if(process->logQueue!=NULL) process->logQueue=nbMedullaQueueClose(process->logQueue);
+        if(process->logLines!=NULL) process->logLines=nbMedullaLinesClose(process->logLines);
         if(process->getfile<0 && process->status&NB_MEDULLA_PROCESS_STATUS_ENDED)
           nbMedullaProcessClose(process);
         }
-      else{
-        sent=nbMedullaQueuePut(process->logQueue,buffer,len);
-        len=nbMedullaQueueGet(process->logQueue,buffer,sizeof(buffer));
-        while(len>=0){
-          rc=(process->logger)(process,process->pid,process->session,buffer);
-          len=nbMedullaQueueGet(process->logQueue,buffer,sizeof(buffer));
-          }
-        }
       }
     if(process->getfile>0 && FD_ISSET(process->getfile,&fdset)){
-      len=read(process->getfile,buffer,sizeof(buffer));
-      while(len==-1 && errno==EINTR) len=read(process->getfile,buffer,sizeof(buffer));
+      len=nbMedullaLinesRead(process->getLines,process->getfile,process,process->consumer);
       if(len<=0){
         if(len<0) fprintf(stderr,"[%d] Error reading from process stdout\n",process->pid);
         //else fprintf(stderr,"[%d] End of file on stdout\n",process->pid);
         close(process->getfile);
         process->getfile=-1;
-        if(process->getQueue!=NULL) process->getQueue=nbMedullaQueueClose(process->getQueue);
+        if(process->getLines!=NULL) process->getLines=nbMedullaLinesClose(process->getLines);
         if(process->logfile<0 && process->status&NB_MEDULLA_PROCESS_STATUS_ENDED)
           nbMedullaProcessClose(process);
         }
-      else{
-        sent=nbMedullaQueuePut(process->getQueue,buffer,len);
-        len=nbMedullaQueueGet(process->getQueue,buffer,sizeof(buffer));
-        while(len>=0){
-          rc=(process->consumer)(process,process->pid,process->session,buffer);
-          len=nbMedullaQueueGet(process->getQueue,buffer,sizeof(buffer));
-          }
-        }
       }
     }
   }
@@ -1266,29 +1560,20 @@ int nbMedullaProcessReader(void *session){
 int nbMedullaProcessReader(void *session){
   nbPROCESS process=(nbPROCESS)session;
   nbFILE fildes=process->getfile;
-  char buffer[NB_BUFSIZE];
-  int len,sent,rc;
+  int len;
 
   //fprintf(stderr,"[%d] nbMedullaProcessReader fildes=%d\n",process->pid,fildes);
-  len=read(fildes,buffer,sizeof(buffer));
-  while(len==-1 && errno==EINTR) len=read(fildes,buffer,sizeof(buffer));
+  len=nbMedullaLinesRead(process->getLines,fildes,process,process->consumer);
   if(len<=0){
     if(len<0) fprintf(stderr,"[%d] Error reading from process stdout\n",process->pid);
     //else fprintf(stderr,"[%d] End of file on stdout\n",process->pid);
     close(fildes);
     process->getfile=-1;
-    if(process->getQueue!=NULL) process->getQueue=nbMedullaQueueClose(process->getQueue);
+    if(process->getLines!=NULL) process->getLines=nbMedullaLinesClose(process->getLines);
     if(process->logfile<0 && process->status&NB_MEDULLA_PROCESS_STATUS_ENDED)
       nbMedullaProcessClose(process);
     return(1);  // end of file
     }
-  sent=nbMedullaQueuePut(process->getQueue,buffer,len);
-  len=nbMedullaQueueGet(process->getQueue,buffer,sizeof(buffer));
-  while(len>=0){
-    //fprintf(stderr,"calling consumer:%s\n",buffer);
-    rc=(process->consumer)(process,process->pid,process->session,buffer);
-    len=nbMedullaQueueGet(process->getQueue,buffer,sizeof(buffer));
-    }
   //fprintf(stderr,"[%d] nbMedullaProcessReader fildes=%d returning\n",process->pid,fildes);
   return(0);
   }
@@ -1319,32 +1604,20 @@ int nbMedullaProcessLogger(void *session){
 int nbMedullaProcessLogger(void *session){
   nbPROCESS process=(nbPROCESS)session;
   nbFILE fildes=process->logfile;
-  char buffer[NB_BUFSIZE];
-  int len,sent,rc;
+  int len;
   
   //fprintf(stderr,"nbMedullaProcessLogger(%d,...): called\n",fildes);
-  len=read(fildes,buffer,sizeof(buffer));
-  while(len==-1 && errno==EINTR) len=read(fildes,buffer,sizeof(buffer));
+  len=nbMedullaLinesRead(process->logLines,fildes,process,process->logger);
   if(len<=0){
     if(len<0) fprintf(stderr,"[%d] Error reading from process stderr\n",process->pid);
     //else fprintf(stderr,"[%d] End of file on stderr\n",process->pid);
     close(fildes);
     process->logfile=-1;
-    if(process->logQueue!=NULL) process->logQueue=nbMedullaQueueClose(process->logQueue);
+    if(process->logLines!=NULL) process->logLines=nbMedullaLinesClose(process->logLines);
     if(process->getfile<0 && process->status&NB_MEDULLA_PROCESS_STATUS_ENDED)
       nbMedullaProcessClose(process);
     return(1);  // end of file
     }
-  //fprintf(stderr,"buffer[%d]: %s\n",len,buffer);
-  sent=nbMedullaQueuePut(process->logQueue,buffer,len);
-  //fprintf(stderr,"sent [%d] to queue\n",sent);
-  len=nbMedullaQueueGet(process->logQueue,buffer,sizeof(buffer));
-  while(len>=0){
-    //fprintf(stderr,"calling logger[%d]:%s\n",len,buffer);
-    rc=(process->logger)(process,process->pid,process->session,buffer);
-    len=nbMedullaQueueGet(process->logQueue,buffer,sizeof(buffer));
-    }
-  //fprintf(stderr,"queue msg len %d\n",len);
   return(0);
   }
 #endif
@@ -1776,8 +2049,8 @@ nbPROCESS nbMedullaProcessOpen(
   process->getfile=-1;
   process->logfile=-1;
   process->putQueue=NULL;
-  process->getQueue=NULL;
-  process->logQueue=NULL;
+  process->getLines=NULL;
+  process->logLines=NULL;
 #endif
   process->prior=nb_process->prior;  // insert at end of list
   process->next=nb_process;  
@@ -1868,6 +2141,7 @@ nbPROCESS nbMedullaProcessOpen(
   // insert in the process list
   process->prior->next=process;
   nb_process->prior=process;
+  nbMedullaProcessHash(process);
   nb_medulla_child_count++;
 
   if(mode=='-'){
@@ -1875,8 +2149,8 @@ nbPROCESS nbMedullaProcessOpen(
 // We need to unify the Windows and Unix code better
 // For now, we only need to open the queues for the Unix code
 #if !defined(WIN32)
-    if(consumer!=NULL) process->getQueue=nbMedullaQueueOpen();
-    if(logger!=NULL) process->logQueue=nbMedullaQueueOpen();
+    if(consumer!=NULL) process->getLines=nbMedullaLinesOpen();
+    if(logger!=NULL) process->logLines=nbMedullaLinesOpen();
 #endif
     }
   else{
@@ -1898,7 +2172,7 @@ nbPROCESS nbMedullaProcessOpen(
       nbMedullaFileEnable(process->getpipe,process);
 #else
       nbMedullaWaitEnable(0,process->getfile,process,nbMedullaProcessReader);
-      process->getQueue=nbMedullaQueueOpen();
+      process->getLines=nbMedullaLinesOpen();
 #endif
       }
     if(logger!=NULL){
@@ -1907,7 +2181,7 @@ nbPROCESS nbMedullaProcessOpen(
       nbMedullaFileEnable(process->logpipe,process);
 #else
       nbMedullaWaitEnable(0,process->logfile,process,nbMedullaProcessLogger);
-      process->logQueue=nbMedullaQueueOpen();
+      process->logLines=nbMedullaLinesOpen();
 #endif
       }
     }
@@ -1932,6 +2206,7 @@ nbPROCESS nbMedullaProcessAdd(int pid,char *cmd){
   process->next=nb_process->next;    // insert in list
   process->prior=nb_process;
   nb_process->next=process;
+  nbMedullaProcessHash(process);
   nb_medulla_child_count++;          // increment child count without checking child_max
   return(process);
   }
@@ -2070,13 +2345,14 @@ nbPROCESS nbMedullaProcessClose(nbPROCESS process){
     }
 #if !defined(WIN32)
   if(process->putQueue!=NULL) process->putQueue=nbMedullaQueueClose(process->putQueue);
-  if(process->getQueue!=NULL) process->getQueue=nbMedullaQueueClose(process->getQueue);
-  if(process->logQueue!=NULL) process->logQueue=nbMedullaQueueClose(process->logQueue);
+  if(process->getLines!=NULL) process->getLines=nbMedullaLinesClose(process->getLines);
+  if(process->logLines!=NULL) process->logLines=nbMedullaLinesClose(process->logLines);
 #endif
   // check for reuse flag and don't destroy the process structure when set
   if(!(process->status&NB_MEDULLA_PROCESS_STATUS_REUSE)){ // release memory if not reused
     process->prior->next=process->next;
     process->next->prior=process->prior;
+    nbMedullaProcessUnhash(process);
     nbFree(process,sizeof(struct NB_MEDULLA_PROCESS)); // put this back just checking
     }
   nb_medulla_child_count--;
@@ -2087,9 +2363,10 @@ nbPROCESS nbMedullaProcessClose(nbPROCESS process){
 nbPROCESS nbMedullaProcessFind(int pid){
   nbPROCESS process;
   if(pid==0) return(nb_process);  // return root process when pid is zero
-  for(process=nb_process->next;process!=nb_process && pid!=process->pid;process=process->next);
-  if(pid==process->pid) return(process);
-  return(NULL);
+  // 2026-10-18 eat 0.9.04 - use pid hash instead of scanning the process list
+  for(process=nb_medulla_pid_hash[pid&(NB_MEDULLA_PID_HASH_SIZE-1)];process!=NULL && pid!=process->pid;process=process->pidNext);
+  if(process==NULL && pid==nb_process->pid) return(nb_process);
+  return(process);
   } 
 
 //=======================================================================================
@@ -2222,6 +2499,76 @@ int nbMedullaQueueGet(nbQUEUE queue,char *msg,size_t size){
   return(fullsize);
   }
 
+#if !defined(WIN32)
+//====================================================================
+// Line buffers for child stdout and stderr
+//
+// A line is passed to the consumer where it was read, with the newline
+// replaced by a null, so the consumer gets it without a copy.  The newline
+// search is memchr(), which the C library vectorizes.
+//
+// We read once per call, into the space left in the buffer, and pass every
+// complete line to the consumer before returning.  We don't read again until
+// the medulla calls us on the next pulse, so when the interpreter falls
+// behind, the pipe fills and the child blocks on write instead of us piling
+// up lines in memory.
+
+nbLINES nbMedullaLinesOpen(void){
+  nbLINES lines;
+
+  lines=nbAlloc(sizeof(NB_Lines));
+  lines->data=lines->buffer;
+  lines->scan=lines->buffer;
+  lines->free=lines->buffer;
+  lines->end=lines->buffer+sizeof(lines->buffer)-1;
+  return(lines);
+  }
+
+nbLINES nbMedullaLinesClose(nbLINES lines){
+  nbFree(lines,sizeof(NB_Lines));
+  return(NULL);
+  }
+
+// Read from a file and pass complete lines to a consumer
+//
+//   Returns the read() result: >0 length read, 0 end of file, -1 error
+//
+//   A partial line at the end of file is not passed to the consumer.  A line
+//   that fills the buffer is passed in pieces.
+
+int nbMedullaLinesRead(nbLINES lines,nbFILE fildes,nbPROCESS process,int (*consumer)(nbPROCESS process,int pid,void *session,char *msg)){
+  char *msg,*eol;
+  int len;
+
+  if(lines->data==lines->free) lines->data=lines->scan=lines->free=lines->buffer;
+  else if(lines->end-lines->free<NB_BUFSIZE && lines->data>lines->buffer){
+    len=lines->free-lines->data;   // move the partial line to the front
+    memmove(lines->buffer,lines->data,len);
+    lines->scan-=lines->data-lines->buffer;
+    lines->data=lines->buffer;
+    lines->free=lines->buffer+len;
+    }
+  else if(lines->free==lines->end){
+    *lines->free=0;
+    msg=lines->data;
+    lines->data=lines->scan=lines->free=lines->buffer;
+    (*consumer)(process,process->pid,process->session,msg);
+    }
+  len=read(fildes,lines->free,lines->end-lines->free);
+  while(len==-1 && errno==EINTR) len=read(fildes,lines->free,lines->end-lines->free);
+  if(len<=0) return(len);
+  lines->free+=len;
+  while((eol=memchr(lines->scan,'\n',lines->free-lines->scan))!=NULL){
+    *eol=0;
+    msg=lines->data;
+    lines->data=lines->scan=eol+1;
+    (*consumer)(process,process->pid,process->session,msg);
+    }
+  lines->scan=lines->free;
+  return(len);
+  }
+#endif
+
 //====================================================================
 
 NB_MedullaFile *nbMedullaFileOpen(int option,nbFILE file,void *session,int (*handler)(void *medFile)){
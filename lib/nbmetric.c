@@ -0,0 +1,876 @@
+/*
+* Copyright (C) 2014 Ed Trettevik <eat@nodebrain.org>
+*
+* NodeBrain is free software; you can modify and/or redistribute it under the
+* terms of either the MIT License (Expat) or the following NodeBrain License.
+*
+* Permission to use and redistribute with or without fee, in source and binary
+* forms, with or without modification, is granted free of charge to any person
+* obtaining a copy of this software and included documentation, provided that
+* the above copyright notice, this permission notice, and the following
+* disclaimer are retained with source files and reproduced in documention
+* included with source and binary distributions.
+*
+* Unless required by applicable law or agreed to in writing, this software is
+* distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+* KIND, either express or implied.
+*
+*=============================================================================
+* Program:  NodeBrain
+*
+* File:     nbmetric.c
+*
+* Title:    Metric Routines
+*
+* Function:
+*
+*   This file provides a registry of counters, gauges, and histograms, the
+*   "metric" command, and routines that expose the registry in the
+*   Prometheus text format.
+*
+* Synopsis:
+*
+*   #include "nbi.h"
+*
+*   void nbMetricInit(NB_Stem *stem);
+*   void nbMetricStop(void);
+*
+*   nbMETRIC nbMetricCounter(nbCELL context,char *name,char *labels,char *help);
+*   nbMETRIC nbMetricGauge(nbCELL context,char *name,char *labels,char *help,double (*sample)(void *handle),void *handle);
+*   nbMETRIC nbMetricHistogram(nbCELL context,char *name,char *labels,char *help,int buckets,double *bound);
+*   void nbMetricAdd(nbMETRIC metric,double value);
+*   void nbMetricSet(nbMETRIC metric,double value);
+*   void nbMetricObserve(nbMETRIC metric,double value);
+*   void nbMetricDrop(nbCELL context,nbMETRIC metric);
+*   void nbMetricExpose(nbCELL context,void *handle,void (*put)(nbCELL context,void *handle,char *text));
+*
+* Description
+*
+*   A metric is a named value with optional labels.  Metrics with the same
+*   name form a family and are kept together in the registry so each family
+*   is exposed with a single HELP and TYPE line.  Labels are given as the
+*   text between the braces of the exposition format.
+*
+*     nb_listener_events_total{node="syslog",fd="7"} 10412
+*
+*   Counters and histograms are updated in place by the code they measure,
+*   so the cost of a metric on a hot path is an increment.  A gauge either
+*   holds a value set by its owner or provides a sample function that is
+*   called only when the metrics are exposed.  The engine metrics are
+*   static so they count from the first allocation, before the registry is
+*   initialized.
+*
+*     nb_commands_total          commands interpreted
+*     nb_rule_firings_total      rule firings
+*     nb_react_cycles_total      react cycles
+*     nb_eval_depth              eval vector levels per cell reaction
+*     nb_alloc_pages_total       object pages allocated
+*     nb_timer_queue_depth       scheduled timers
+*     nb_medulla_handlers        file descriptors the medulla waits on
+*     nb_medulla_threads         medulla threads
+*     nb_listener_events_total   listener handler calls by node and fd
+*     nb_listener_drops_total    kernel datagram drops by node and fd (Linux)
+*     nb_shard_received_total    shard inbox commands received
+*     nb_shard_dropped_total     shard inbox commands dropped
+*
+*   The metrics are displayed by the "metric" command, served to any
+*   client that connects to a local domain socket, and served by webster
+*   as the ":metrics" resource.
+*
+*     metric                     - display metrics
+*     metric listen <path>       - serve metrics on a local domain socket
+*     metric close               - stop serving metrics on the socket
+*
+*   A socket client receives the metrics and the connection is closed, so
+*   a scraper can read them with a command like "socat - UNIX:<path>".
+*   The socket is non-blocking and text a slow client doesn't take is
+*   written by a write listener, so a scrape never stalls the agent.
+*
+*   Latency:
+*
+*   The time an event spends in each stage of the pipeline is recorded by
+*   node in log-linear histograms like those of HdrHistogram.  A bucket is
+*   found from the position of the highest bit and the next three bits of
+*   the value in nanoseconds, so an observation costs a clock read and an
+*   increment.  The set for a node is found when a listener first handles
+*   an event and is cached in the listener.  Events that don't come from a
+*   listener, like sourced commands and timers, are recorded for the agent
+*   under the node name "_".
+*
+*     wait      medulla finding files ready to the listener handler call
+*     handler   listener handler
+*     command   command including the reactions it causes
+*     react     cell reaction
+*     rule      rule action
+*     fire      start of the event to a rule action
+*
+*   The wait stage shows queueing behind other handlers of the same medulla
+*   pulse and the fire stage shows how long an event waits before its rule
+*   fires.  The histograms are displayed by "show %latency" and exposed as
+*   nb_event_latency_seconds with buckets at every other power of 2.
+*
+*   The stages are only timed when the latency option is set ("set latency"
+*   or --latency).  Each stage reads the clock about twice.  At about 40ns a
+*   read that was 5% of the time of an assertion firing two rules and 8% of
+*   a simple assertion on a test machine, too much to pay all the time.
+*   Without the option nbLatencyNow() and nbLatencyObserve() return 0
+*   without reading the clock.
+*
+*=============================================================================
+* Change History:
+*
+*    Date    Name/Change
+* ---------- -----------------------------------------------------------------
+* 2026-10-18 eat 0.9.04 (original prototype)
+* 2026-10-18 eat 0.9.04 Included latency histograms for event pipeline stages
+* 2026-10-18 eat 0.9.04 Write metrics to a non-blocking socket with a write listener
+* 2026-10-18 eat 0.9.04 Only time event pipeline stages when the latency option is set
+*=============================================================================
+*/
+#include <nb/nbi.h>
+#if !defined(WIN32)
+#include <sys/un.h>
+#endif
+
+NB_Metric nb_metricCommands={NULL,"nb_commands_total",NULL,"Commands interpreted.",NB_METRIC_COUNTER};
+NB_Metric nb_metricFirings={NULL,"nb_rule_firings_total",NULL,"Rule firings.",NB_METRIC_COUNTER};
+NB_Metric nb_metricReacts={NULL,"nb_react_cycles_total",NULL,"React cycles.",NB_METRIC_COUNTER};
+NB_Metric nb_metricPages={NULL,"nb_alloc_pages_total",NULL,"Object pages allocated.",NB_METRIC_COUNTER};
+NB_Metric nb_metricEvalDepth={NULL,"nb_eval_depth",NULL,"Eval vector levels per cell reaction.",NB_METRIC_HISTOGRAM,
+  10,0,0,NULL,NULL,{1,2,3,4,6,8,12,16,24,32}};
+
+static NB_Metric nb_metricTimers={NULL,"nb_timer_queue_depth",NULL,"Scheduled timers.",NB_METRIC_GAUGE};
+static NB_Metric nb_metricHandlers={NULL,"nb_medulla_handlers",NULL,"File descriptors the medulla waits on.",NB_METRIC_GAUGE};
+static NB_Metric nb_metricThreads={NULL,"nb_medulla_threads",NULL,"Medulla threads.",NB_METRIC_GAUGE};
+
+static NB_Metric *nb_metricRegistry=NULL;  // registered metrics grouped by name
+
+static NB_LatencySet nb_latencyAgent;      // latency set for events not from a listener
+static NB_LatencySet *nb_latencySets=&nb_latencyAgent;  // latency sets by node
+NB_LatencySet *nb_latency=NULL;            // latency set for the event being processed
+unsigned long long nb_latencyReady=0;      // time the medulla found files ready
+unsigned long long nb_latencyEvent=0;      // time the current event started
+
+static char *nb_latencyStage[NB_LATENCY_STAGES]={"wait","handler","command","react","rule","fire"};
+
+#if !defined(WIN32)
+static int  nb_metricSocket=-1;            // local domain socket for scrapes
+static int  nb_metricSocketPid=0;          // process that created the socket
+static char nb_metricSocketPath[108];      // socket path
+#endif
+
+/*
+*  Add a metric to the registry after the last metric of the same name
+*/
+static void nbMetricRegister(NB_Metric *metric){
+  NB_Metric **metricP,**lastP=NULL;
+
+  for(metricP=&nb_metricRegistry;*metricP!=NULL;metricP=&(*metricP)->next)
+    if(strcmp((*metricP)->name,metric->name)==0) lastP=&(*metricP)->next;
+  if(lastP) metricP=lastP;
+  metric->next=*metricP;
+  *metricP=metric;
+  }
+
+static char *nbMetricString(char *text){
+  char *string=nbAlloc(strlen(text)+1);
+  strcpy(string,text);
+  return(string);
+  }
+
+static void nbMetricStringFree(char *string){
+  if(string) nbFree(string,strlen(string)+1);
+  }
+
+/*
+*  Allocate and register a metric
+*
+*    Names must match [a-zA-Z_:][a-zA-Z0-9_:]*.  Labels are not checked.
+*/
+static NB_Metric *nbMetricNew(nbCELL context,int type,char *name,char *labels,char *help){
+  NB_Metric *metric;
+  char *cursor=name;
+
+  if(!isalpha(*cursor) && *cursor!='_' && *cursor!=':'){
+    nbLogMsg(context,0,'E',"Metric name \"%s\" not valid",name);
+    return(NULL);
+    }
+  for(cursor++;isalnum(*cursor) || *cursor=='_' || *cursor==':';cursor++);
+  if(*cursor!=0){
+    nbLogMsg(context,0,'E',"Metric name \"%s\" not valid",name);
+    return(NULL);
+    }
+  metric=nbAlloc(sizeof(NB_Metric));
+  memset(metric,0,sizeof(NB_Metric));
+  metric->name=nbMetricString(name);
+  if(labels && *labels) metric->labels=nbMetricString(labels);
+  metric->help=nbMetricString(help ? help : "");
+  metric->type=type;
+  nbMetricRegister(metric);
+  return(metric);
+  }
+
+//==================================================================================
+// External API
+//==================================================================================
+
+nbMETRIC nbMetricCounter(nbCELL context,char *name,char *labels,char *help){
+  return(nbMetricNew(context,NB_METRIC_COUNTER,name,labels,help));
+  }
+
+/*
+*  Register a gauge
+*
+*    When sample is not NULL, it is called for the value each time metrics
+*    are exposed.  Otherwise the value is set with nbMetricSet or nbMetricAdd.
+*/
+nbMETRIC nbMetricGauge(nbCELL context,char *name,char *labels,char *help,double (*sample)(void *handle),void *handle){
+  NB_Metric *metric;
+
+  if((metric=nbMetricNew(context,NB_METRIC_GAUGE,name,labels,help))==NULL) return(NULL);
+  metric->sample=sample;
+  metric->handle=handle;
+  return(metric);
+  }
+
+/*
+*  Register a histogram
+*
+*    The bucket bounds must be in ascending order.  The +Inf bucket is
+*    implied.
+*/
+nbMETRIC nbMetricHistogram(nbCELL context,char *name,char *labels,char *help,int buckets,double *bound){
+  NB_Metric *metric;
+  int i;
+
+  if(buckets<1 || buckets>NB_METRIC_BUCKETS){
+    nbLogMsg(context,0,'E',"Metric \"%s\" must have 1 to %d buckets",name,NB_METRIC_BUCKETS);
+    return(NULL);
+    }
+  for(i=1;i<buckets;i++){
+    if(bound[i]<=bound[i-1]){
+      nbLogMsg(context,0,'E',"Metric \"%s\" bucket bounds must be ascending",name);
+      return(NULL);
+      }
+    }
+  if((metric=nbMetricNew(context,NB_METRIC_HISTOGRAM,name,labels,help))==NULL) return(NULL);
+  metric->buckets=buckets;
+  memcpy(metric->bound,bound,buckets*sizeof(double));
+  return(metric);
+  }
+
+void nbMetricAdd(nbMETRIC metric,double value){
+  metric->value+=value;
+  }
+
+void nbMetricSet(nbMETRIC metric,double value){
+  metric->value=value;
+  }
+
+void nbMetricObserve(nbMETRIC metric,double value){
+  int i;
+
+  for(i=0;i<metric->buckets && value>metric->bound[i];i++);
+  if(i<metric->buckets) metric->bucket[i]++;
+  metric->value+=value;
+  metric->count++;
+  }
+
+/*
+*  Remove a metric from the registry and free it
+*/
+void nbMetricDrop(nbCELL context,nbMETRIC metric){
+  NB_Metric **metricP;
+
+  for(metricP=&nb_metricRegistry;*metricP!=NULL && *metricP!=metric;metricP=&(*metricP)->next);
+  if(*metricP==NULL){
+    nbLogMsg(context,0,'L',"nbMetricDrop: metric not registered");
+    return;
+    }
+  *metricP=metric->next;
+  nbMetricStringFree(metric->name);
+  nbMetricStringFree(metric->labels);
+  nbMetricStringFree(metric->help);
+  nbFree(metric,sizeof(NB_Metric));
+  }
+
+//==================================================================================
+// Latency
+//==================================================================================
+
+/*
+*  Get the monotonic clock in nanoseconds
+*/
+unsigned long long nbLatencyNow(void){
+#if defined(WIN32)
+  LARGE_INTEGER count,frequency;
+
+  if(!nb_opt_latency) return(0);
+  QueryPerformanceCounter(&count);
+  QueryPerformanceFrequency(&frequency);
+  return((unsigned long long)(count.QuadPart*(1e9/frequency.QuadPart)));
+#else
+  struct timespec now;
+
+  if(!nb_opt_latency) return(0);
+  clock_gettime(CLOCK_MONOTONIC,&now);
+  return((unsigned long long)now.tv_sec*1000000000+now.tv_nsec);
+#endif
+  }
+
+/*
+*  Histogram bucket for a value
+*
+*    Values below NB_LATENCY_SUB have a bucket of their own.  Above that,
+*    each power of 2 is split into NB_LATENCY_SUB linear sub-buckets.  This
+*    is also used for the replay latency histogram in nbcapture.c.
+*/
+int nbLatencyIndex(unsigned long long value){
+  int msb;
+
+  if(value<NB_LATENCY_SUB) return((int)value);
+#if defined(__GNUC__)
+  msb=63-__builtin_clzll(value);
+#else
+  for(msb=NB_LATENCY_SUBBITS;value>>(msb+1);msb++);
+#endif
+  if(msb>=NB_LATENCY_BITS) return(NB_LATENCY_SIZE-1);
+  return((msb-NB_LATENCY_SUBBITS+1)*NB_LATENCY_SUB+(int)((value>>(msb-NB_LATENCY_SUBBITS))&(NB_LATENCY_SUB-1)));
+  }
+
+/*
+*  Lowest value recorded in a bucket
+*/
+unsigned long long nbLatencyLow(int index){
+  int msb;
+
+  if(index<NB_LATENCY_SUB) return(index);
+  msb=index/NB_LATENCY_SUB+NB_LATENCY_SUBBITS-1;
+  return((unsigned long long)(NB_LATENCY_SUB+index%NB_LATENCY_SUB)<<(msb-NB_LATENCY_SUBBITS));
+  }
+
+/*
+*  Record the time since start for a stage of the current event
+*
+*    Returns the current time so a caller can time the next stage without
+*    reading the clock again.
+*/
+unsigned long long nbLatencyObserve(int stage,unsigned long long start){
+  NB_Latency *latency=&(nb_latency ? nb_latency : &nb_latencyAgent)->stage[stage];
+  unsigned long long now,value;
+
+  if(!nb_opt_latency) return(0);
+  now=nbLatencyNow();
+  if(!start) return(now);  // stage started before the latency option was set
+  value=now>start ? now-start : 0;
+  latency->bucket[nbLatencyIndex(value)]++;
+  latency->count++;
+  latency->sum+=value;
+  if(value>latency->max) latency->max=value;
+  return(now);
+  }
+
+/*
+*  Get the latency set for a node
+*/
+NB_LatencySet *nbLatencySet(nbCELL context){
+  NB_LatencySet *set;
+  char name[1024];
+
+  if(!context || context->object.type!=termType) return(&nb_latencyAgent);
+  for(set=nb_latencySets;set!=NULL;set=set->next) if(set->context==context) return(set);
+  nbTermName(rootGloss,(NB_Term *)context,name,sizeof(name));
+  set=nbAlloc(sizeof(NB_LatencySet));
+  memset(set,0,sizeof(NB_LatencySet));
+  set->context=grabObject(context);
+  set->name=nbMetricString(name);
+  set->next=nb_latencySets->next;  // keep the agent first
+  nb_latencySets->next=set;
+  return(set);
+  }
+
+/*
+*  Value at a quantile - the highest value of the bucket reaching it
+*/
+static double nbLatencyQuantile(NB_Latency *latency,double quantile){
+  double count=0,target=latency->count*quantile;
+  int i;
+
+  for(i=0;i<NB_LATENCY_SIZE-1;i++){
+    count+=latency->bucket[i];
+    if(count>=target && count>0) break;
+    }
+  if(i>=NB_LATENCY_SIZE-1) return(latency->max);
+  return(nbLatencyLow(i+1)-1<latency->max ? nbLatencyLow(i+1)-1 : latency->max);
+  }
+
+/*
+*  Show latency histograms in microseconds
+*/
+void nbLatencyShow(void){
+  NB_LatencySet *set;
+  NB_Latency *latency;
+  int stage;
+
+  if(!nb_opt_latency) outMsg(0,'I',"Latency is not being timed - use \"set latency\" to time event stages");
+  outPut("Node             Stage       Count       Mean(us)    p50(us)     p90(us)     p99(us)     Max(us)\n");
+  outPut("---------------- -------- ----------- ----------- ----------- ----------- ----------- -----------\n");
+  for(set=nb_latencySets;set!=NULL;set=set->next){
+    for(stage=0;stage<NB_LATENCY_STAGES;stage++){
+      latency=&set->stage[stage];
+      if(latency->count==0) continue;
+      outPut("%-16s %-8s %11.0f %11.3f %11.3f %11.3f %11.3f %11.3f\n",set->name ? set->name : "_",nb_latencyStage[stage],
+        latency->count,latency->sum/latency->count/1000,nbLatencyQuantile(latency,0.5)/1000,
+        nbLatencyQuantile(latency,0.9)/1000,nbLatencyQuantile(latency,0.99)/1000,latency->max/1000.0);
+      }
+    }
+  }
+
+//==================================================================================
+// Exposition
+//==================================================================================
+
+static void nbMetricPutFamily(nbCELL context,void *handle,void (*put)(nbCELL context,void *handle,char *text),
+  char *name,int type,char *help){
+  char line[1024];
+
+  snprintf(line,sizeof(line),"# HELP %s %s\n# TYPE %s %s\n",name,help,name,
+    type==NB_METRIC_COUNTER ? "counter" : type==NB_METRIC_GAUGE ? "gauge" : "histogram");
+  put(context,handle,line);
+  }
+
+static void nbMetricPutSample(nbCELL context,void *handle,void (*put)(nbCELL context,void *handle,char *text),
+  char *name,char *suffix,char *labels,char *le,double value){
+  char line[2048],*sep=labels && le ? "," : "";  // room for latency labels of a long node name
+
+  if(!labels) labels="";
+  if(*labels || le) snprintf(line,sizeof(line),"%s%s{%s%s%s%s%s} %.15g\n",name,suffix,labels,sep,
+    le ? "le=\"" : "",le ? le : "",le ? "\"" : "",value);
+  else snprintf(line,sizeof(line),"%s%s %.15g\n",name,suffix,value);
+  put(context,handle,line);
+  }
+
+static void nbMetricPut(nbCELL context,void *handle,void (*put)(nbCELL context,void *handle,char *text),NB_Metric *metric){
+  char le[32];
+  double count=0;
+  int i;
+
+  switch(metric->type){
+    case NB_METRIC_HISTOGRAM:
+      for(i=0;i<metric->buckets;i++){
+        count+=metric->bucket[i];
+        snprintf(le,sizeof(le),"%.15g",metric->bound[i]);
+        nbMetricPutSample(context,handle,put,metric->name,"_bucket",metric->labels,le,count);
+        }
+      nbMetricPutSample(context,handle,put,metric->name,"_bucket",metric->labels,"+Inf",metric->count);
+      nbMetricPutSample(context,handle,put,metric->name,"_sum",metric->labels,NULL,metric->value);
+      nbMetricPutSample(context,handle,put,metric->name,"_count",metric->labels,NULL,metric->count);
+      break;
+    case NB_METRIC_GAUGE:
+      if(metric->sample) metric->value=metric->sample(metric->handle);
+      // fall through
+    default:
+      nbMetricPutSample(context,handle,put,metric->name,"",metric->labels,NULL,metric->value);
+    }
+  }
+
+/*
+*  Build a node="<name>",fd="<fildes>" label set for a listener
+*/
+static void nbMetricListenerLabels(NB_Listener *sel,char *labels,size_t size){
+  char name[1024],*cursor,*label,*end=labels+size-16;
+
+  *name=0;
+  if(sel->context && sel->context->object.type==termType) nbTermName(rootGloss,(NB_Term *)sel->context,name,sizeof(name));
+  label=labels;
+  label+=sprintf(label,"node=\"");
+  for(cursor=name;*cursor && label<end;cursor++){
+    if(*cursor=='"' || *cursor=='\\') *label++='\\';
+    *label++=*cursor;
+    }
+  sprintf(label,"\",fd=\"%d\"",sel->fildes);
+  }
+
+#if defined(__linux__)
+#define NB_METRIC_UDP_SOCKETS 64
+/*
+*  Get kernel drop counts for UDP listener sockets
+*
+*    The drop count is the last column of /proc/net/udp and /proc/net/udp6
+*    and sockets are identified by inode.
+*/
+static int nbMetricUdpDrops(unsigned long *inode,double *drops,int count){
+  char *file[2]={"/proc/net/udp","/proc/net/udp6"},line[512];
+  unsigned long lineInode;
+  unsigned long long lineDrops;
+  FILE *proc;
+  int i,f,found=0;
+
+  for(f=0;f<2;f++){
+    if((proc=fopen(file[f],"r"))==NULL) continue;
+    if(!fgets(line,sizeof(line),proc)) *line=0;  // skip heading
+    while(fgets(line,sizeof(line),proc)){
+      if(sscanf(line,"%*s %*s %*s %*s %*s %*s %*s %*s %*s %lu %*s %*s %llu",&lineInode,&lineDrops)!=2) continue;
+      for(i=0;i<count;i++) if(inode[i]==lineInode){
+        drops[i]=lineDrops;
+        found++;
+        }
+      }
+    fclose(proc);
+    }
+  return(found);
+  }
+#endif
+
+static void nbMetricPutListeners(nbCELL context,void *handle,void (*put)(nbCELL context,void *handle,char *text)){
+  NB_Listener *sel;
+  char labels[256];
+  int udp=0,i;
+#if defined(__linux__)
+  unsigned long inode[NB_METRIC_UDP_SOCKETS];
+  double drops[NB_METRIC_UDP_SOCKETS];
+  struct stat st;
+  int type;
+  socklen_t len;
+#endif
+
+  if(!selectUsed) return;
+  nbMetricPutFamily(context,handle,put,"nb_listener_events_total",NB_METRIC_COUNTER,"Listener handler calls.");
+  for(sel=selectUsed;sel!=NULL;sel=sel->next){
+    nbMetricListenerLabels(sel,labels,sizeof(labels));
+    nbMetricPutSample(context,handle,put,"nb_listener_events_total","",labels,NULL,sel->events);
+    }
+#if defined(__linux__)
+  for(sel=selectUsed;sel!=NULL && udp<NB_METRIC_UDP_SOCKETS;sel=sel->next){
+    len=sizeof(type);
+    if(sel->type==0 && fstat(sel->fildes,&st)==0 && S_ISSOCK(st.st_mode)
+      && getsockopt(sel->fildes,SOL_SOCKET,SO_TYPE,&type,&len)==0 && type==SOCK_DGRAM){
+      inode[udp]=st.st_ino;
+      drops[udp]=-1;
+      udp++;
+      }
+    }
+  if(udp==0 || nbMetricUdpDrops(inode,drops,udp)==0) return;
+  nbMetricPutFamily(context,handle,put,"nb_listener_drops_total",NB_METRIC_COUNTER,"Datagrams dropped by the kernel for a listener socket.");
+  for(sel=selectUsed,i=0;sel!=NULL && i<udp;sel=sel->next){
+    if(sel->type!=0 || fstat(sel->fildes,&st)!=0 || st.st_ino!=inode[i]) continue;
+    if(drops[i]>=0){
+      nbMetricListenerLabels(sel,labels,sizeof(labels));
+      nbMetricPutSample(context,handle,put,"nb_listener_drops_total","",labels,NULL,drops[i]);
+      }
+    i++;
+    }
+#endif
+  }
+
+/*
+*  Expose latency histograms with buckets at every other power of 2 nanoseconds
+*/
+static void nbMetricPutLatency(nbCELL context,void *handle,void (*put)(nbCELL context,void *handle,char *text)){
+  NB_LatencySet *set;
+  NB_Latency *latency;
+  char labels[1100],le[32];
+  double count;
+  int stage,bit,i,index;
+
+  nbMetricPutFamily(context,handle,put,"nb_event_latency_seconds",NB_METRIC_HISTOGRAM,"Event pipeline stage latency by node.");
+  for(set=nb_latencySets;set!=NULL;set=set->next){
+    for(stage=0;stage<NB_LATENCY_STAGES;stage++){
+      latency=&set->stage[stage];
+      if(latency->count==0) continue;
+      snprintf(labels,sizeof(labels),"node=\"%s\",stage=\"%s\"",set->name ? set->name : "_",nb_latencyStage[stage]);
+      count=0;
+      i=0;
+      for(bit=10;bit<=34;bit+=2){
+        index=(bit-NB_LATENCY_SUBBITS+1)*NB_LATENCY_SUB;  // first bucket at or above 2^bit
+        for(;i<index;i++) count+=latency->bucket[i];
+        snprintf(le,sizeof(le),"%.6g",(double)(1ULL<<bit)/1e9);
+        nbMetricPutSample(context,handle,put,"nb_event_latency_seconds","_bucket",labels,le,count);
+        }
+      nbMetricPutSample(context,handle,put,"nb_event_latency_seconds","_bucket",labels,"+Inf",latency->count);
+      nbMetricPutSample(context,handle,put,"nb_event_latency_seconds","_sum",labels,NULL,latency->sum/1e9);
+      nbMetricPutSample(context,handle,put,"nb_event_latency_seconds","_count",labels,NULL,latency->count);
+      }
+    }
+  }
+
+static void nbMetricPutShards(nbCELL context,void *handle,void (*put)(nbCELL context,void *handle,char *text)){
+  char labels[NB_SHARD_NAME_SIZE+16];
+  int i;
+
+  if(!nb_shardTable) return;
+  nbMetricPutFamily(context,handle,put,"nb_shard_received_total",NB_METRIC_COUNTER,"Shard inbox commands received.");
+  for(i=0;i<nb_shardTable->count;i++){
+    snprintf(labels,sizeof(labels),"shard=\"%s\"",nb_shardTable->shard[i].name);
+    nbMetricPutSample(context,handle,put,"nb_shard_received_total","",labels,NULL,nb_shardTable->shard[i].received);
+    }
+  nbMetricPutFamily(context,handle,put,"nb_shard_dropped_total",NB_METRIC_COUNTER,"Shard inbox commands dropped because the inbox was full.");
+  for(i=0;i<nb_shardTable->count;i++){
+    snprintf(labels,sizeof(labels),"shard=\"%s\"",nb_shardTable->shard[i].name);
+    nbMetricPutSample(context,handle,put,"nb_shard_dropped_total","",labels,NULL,nb_shardTable->shard[i].dropped);
+    }
+  }
+
+/*
+*  Expose metrics in the Prometheus text format
+*
+*    The put function is called with one or more complete lines at a time.
+*/
+void nbMetricExpose(nbCELL context,void *handle,void (*put)(nbCELL context,void *handle,char *text)){
+  NB_Metric *metric;
+  char *family="";
+
+  for(metric=nb_metricRegistry;metric!=NULL;metric=metric->next){
+    if(strcmp(metric->name,family)!=0){
+      family=metric->name;
+      nbMetricPutFamily(context,handle,put,metric->name,metric->type,metric->help);
+      }
+    nbMetricPut(context,handle,put,metric);
+    }
+  nbMetricPutListeners(context,handle,put);
+  nbMetricPutLatency(context,handle,put);
+  nbMetricPutShards(context,handle,put);
+  }
+
+//==================================================================================
+// Engine gauges
+//==================================================================================
+
+static double nbMetricTimerSample(void *handle){
+  NB_Timer *timer;
+  double count=0;
+
+  for(timer=nb_timerQueue;timer!=NULL;timer=timer->next) count++;
+  return(count);
+  }
+
+static double nbMetricHandlerSample(void *handle){
+  double count=0;
+#if !defined(WIN32)
+  struct NB_MEDULLA_WAIT *wait;
+
+  if(nb_medulla) for(wait=nb_medulla->handler;wait!=NULL;wait=wait->next) count++;
+#else
+  if(nb_medulla) count=nb_medulla->waitCount;
+#endif
+  return(count);
+  }
+
+static double nbMetricThreadSample(void *handle){
+  return(nb_medulla ? nb_medulla->thread_count : 0);
+  }
+
+//==================================================================================
+// Local domain socket
+//==================================================================================
+
+#if !defined(WIN32)
+typedef struct NB_METRIC_TEXT{
+  char   *data;
+  size_t len;
+  size_t size;
+  } NB_MetricText;
+
+static void nbMetricPutText(nbCELL context,void *handle,char *text){
+  NB_MetricText *buf=(NB_MetricText *)handle;
+  size_t len=strlen(text);
+  char *data;
+
+  if(buf->len+len>buf->size){
+    data=nbAlloc(buf->size*2+len);
+    memcpy(data,buf->data,buf->len);
+    nbFree(buf->data,buf->size);
+    buf->data=data;
+    buf->size=buf->size*2+len;
+    }
+  memcpy(buf->data+buf->len,text,len);
+  buf->len+=len;
+  }
+
+typedef struct NB_METRIC_SCRAPE{
+  NB_MetricText buf;
+  size_t pos;                  // next byte to write
+  int    waiting;              // write listener added
+  } NB_MetricScrape;
+
+/*
+*  Write metrics to a scrape connection and close it when done
+*
+*    The socket is non-blocking.  When the client isn't ready for more we
+*    return and are called again by a write listener.
+*/
+static void nbMetricScrapeWriter(nbCELL context,int sd,void *session){
+  NB_MetricScrape *scrape=(NB_MetricScrape *)session;
+  ssize_t written;
+
+  while(scrape->pos<scrape->buf.len){
+    written=write(sd,scrape->buf.data+scrape->pos,scrape->buf.len-scrape->pos);
+    if(written<0){
+      if(errno==EINTR) continue;
+      if(errno==EAGAIN || errno==EWOULDBLOCK){
+        if(!scrape->waiting) nbListenerAddWrite(context,sd,scrape,nbMetricScrapeWriter);
+        scrape->waiting=1;
+        return;
+        }
+      outMsg(0,'W',"Unable to write metrics to socket - %s",strerror(errno));
+      break;
+      }
+    scrape->pos+=written;
+    }
+  if(scrape->waiting) nbListenerRemoveWrite(context,sd);
+  close(sd);
+  nbFree(scrape->buf.data,scrape->buf.size);
+  nbFree(scrape,sizeof(NB_MetricScrape));
+  }
+
+/*
+*  Accept a scrape connection and write the metrics
+*/
+static void nbMetricAccept(nbCELL context,int fildes,void *session){
+  NB_MetricScrape *scrape;
+  int sd;
+
+  if((sd=accept(fildes,NULL,NULL))<0) return;
+  fcntl(sd,F_SETFD,FD_CLOEXEC);
+  fcntl(sd,F_SETFL,O_NONBLOCK);
+  scrape=nbAlloc(sizeof(NB_MetricScrape));
+  scrape->buf.size=16*1024;
+  scrape->buf.len=0;
+  scrape->buf.data=nbAlloc(scrape->buf.size);
+  scrape->pos=0;
+  scrape->waiting=0;
+  nbMetricExpose(context,&scrape->buf,nbMetricPutText);
+  nbMetricScrapeWriter(context,sd,scrape);
+  }
+
+static void nbMetricClose(void){
+  if(nb_metricSocket<0) return;
+  nbListenerRemove(NULL,nb_metricSocket);
+  close(nb_metricSocket);
+  nb_metricSocket=-1;
+  if(nb_metricSocketPid==getpid()) unlink(nb_metricSocketPath);
+  }
+
+static int nbMetricListen(nbCELL context,char *path){
+  struct sockaddr_un addr;
+  struct stat st;
+  int sd;
+
+  if(strlen(path)>=sizeof(addr.sun_path)){
+    outMsg(0,'E',"Metric socket path too long - %s",path);
+    return(1);
+    }
+  if(lstat(path,&st)==0 && !S_ISSOCK(st.st_mode)){
+    outMsg(0,'E',"Metric socket path %s exists and is not a socket",path);
+    return(1);
+    }
+  nbMetricClose();
+  if((sd=socket(AF_UNIX,SOCK_STREAM,0))<0){
+    outMsg(0,'E',"Unable to create metric socket - %s",strerror(errno));
+    return(1);
+    }
+  fcntl(sd,F_SETFD,FD_CLOEXEC);
+  fcntl(sd,F_SETFL,O_NONBLOCK);
+  memset(&addr,0,sizeof(addr));
+  addr.sun_family=AF_UNIX;
+  strcpy(addr.sun_path,path);
+  unlink(path);                           // only a stale socket gets here
+  if(bind(sd,(struct sockaddr *)&addr,sizeof(addr))<0 || listen(sd,16)<0){
+    outMsg(0,'E',"Unable to listen on metric socket %s - %s",path,strerror(errno));
+    close(sd);
+    return(1);
+    }
+  nb_metricSocket=sd;
+  nb_metricSocketPid=getpid();
+  strcpy(nb_metricSocketPath,path);
+  nbListenerAdd(context,sd,NULL,nbMetricAccept);
+  outMsg(0,'I',"Serving metrics on %s",path);
+  return(0);
+  }
+#endif
+
+/*
+*  Close the metric socket when the agent stops
+*/
+void nbMetricStop(void){
+#if !defined(WIN32)
+  nbMetricClose();
+#endif
+  }
+
+//==================================================================================
+// Command
+//==================================================================================
+
+static void nbMetricPutOut(nbCELL context,void *handle,char *text){
+  outPut("%s",text);
+  }
+
+/*
+*  Command
+*
+*    metric
+*    metric listen <path>
+*    metric close
+*/
+static int nbMetricCmd(nbCELL context,void *handle,char *verb,char *cursor){
+  char ident[256],path[108],*delim;
+
+  while(*cursor==' ') cursor++;
+  if(*cursor==0 || *cursor==';'){
+    nbMetricExpose(context,NULL,nbMetricPutOut);
+    return(0);
+    }
+  if(!(clientIdentity->authority&AUTH_CONTROL)){
+    outMsg(0,'E',"Identity \"%s\" not authorized to %s %s.",clientIdentity->name->value,verb,cursor);
+    return(1);
+    }
+  if(nbParseSymbol(ident,sizeof(ident),&cursor)!='t'){
+    outMsg(0,'E',"Expecting \"listen\" or \"close\" at \"%s\"",cursor);
+    return(1);
+    }
+#if defined(WIN32)
+  outMsg(0,'E',"Metric sockets are not supported on Windows.");
+  return(1);
+#else
+  if(strcmp(ident,"close")==0){
+    nbMetricClose();
+    return(0);
+    }
+  if(strcmp(ident,"listen")!=0){
+    outMsg(0,'E',"Expecting \"listen\" or \"close\" at \"%s\"",ident);
+    return(1);
+    }
+  while(*cursor==' ') cursor++;
+  if((delim=strchr(cursor,';'))==NULL) delim=cursor+strlen(cursor);
+  while(delim>cursor && *(delim-1)==' ') delim--;
+  if(delim==cursor){
+    outMsg(0,'E',"Expecting socket path");
+    return(1);
+    }
+  if(delim-cursor>=sizeof(path)){
+    outMsg(0,'E',"Metric socket path too long");
+    return(1);
+    }
+  strncpy(path,cursor,delim-cursor);
+  *(path+(delim-cursor))=0;
+  return(nbMetricListen(context,path));
+#endif
+  }
+
+void nbMetricInit(NB_Stem *stem){
+  nbCELL context=(nbCELL)stem->verbs;
+
+  nbMetricRegister(&nb_metricCommands);
+  nbMetricRegister(&nb_metricFirings);
+  nbMetricRegister(&nb_metricReacts);
+  nbMetricRegister(&nb_metricEvalDepth);
+  nbMetricRegister(&nb_metricPages);
+  nb_metricTimers.sample=nbMetricTimerSample;
+  nbMetricRegister(&nb_metricTimers);
+  nb_metricHandlers.sample=nbMetricHandlerSample;
+  nbMetricRegister(&nb_metricHandlers);
+  nb_metricThreads.sample=nbMetricThreadSample;
+  nbMetricRegister(&nb_metricThreads);
+  nbVerbDeclare(context,"metric",AUTH_CONNECT,0,stem,&nbMetricCmd,"[listen <path> | close]");
+  }
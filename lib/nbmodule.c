@@ -120,6 +120,7 @@
 * 2013-04-06 eat 0.8.15 Modified nbModuleDeclare to avoid buffer overflow
 * 2014-04-05 eat 0.9.01 Checker update
 * 2014-05-04 eat 0.9.02 Replaced newType with nbObjectType
+* 2026-10-18 eat 0.9.04 Included save and restore methods for checkpoints
 *=============================================================================
 */
 #include <nb/nbi.h>
@@ -838,6 +839,8 @@ int nbSkillMethod(nbCELL context,nbCELL facetHandle,int methodId,void *method){
       case NB_NODE_COMMAND:   facet->command=method;   break;
       case NB_NODE_ALARM:     facet->alarm=method;     break;
       case NB_NODE_ALERT:     facet->alert=method;     break; // undocumented experiment
+      case NB_NODE_SAVE:      facet->save=method;      break;
+      case NB_NODE_RESTORE:   facet->restore=method;   break;
       default:
         outMsg(0,'L',"nbSkillSetMethod() called with unrecognized methodId - %d",methodId);
         return(-1);
@@ -859,6 +862,8 @@ int nbSkillMethod(nbCELL context,nbCELL facetHandle,int methodId,void *method){
       case NB_NODE_COMMAND:   facet->command=method;   break;
       case NB_NODE_ALARM:     facet->alarm=method;     break;
       case NB_NODE_ALERT:     facet->alert=method;     break; // undocumented experiment
+      case NB_NODE_SAVE:      facet->save=method;      break;
+      case NB_NODE_RESTORE:   facet->restore=method;   break;
       default:
         outMsg(0,'L',"nbSkillSetMethod() called with unrecognized methodId - %d",methodId);
         return(-1);
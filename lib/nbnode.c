@@ -93,6 +93,7 @@
 * 2013-12-07 eat 0.9.00 Implementing node facets
 * 2014-01-27 eat 0.9.00 Changed node.ifrule list to only haved True IF rules
 * 2014-05-04 eat 0.9.02 Replaced newType with nbObjectType
+* 2026-10-18 eat 0.9.04 Initialize optional save and restore facet methods
 *=============================================================================
 */
 #include <nb/nbi.h>
@@ -439,6 +440,8 @@ struct NB_FACET *nbFacetNew(NB_Skill *skill,const char *ident){
   facet->command=&nbSkillNullCommand;
   facet->alarm=&nbSkillNullAlarm;
   facet->alert=&nbSkillNullAssert;
+  facet->save=NULL;     // 2026-10-18 eat - optional checkpoint methods
+  facet->restore=NULL;
   return(facet);
   }
 
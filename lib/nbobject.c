@@ -186,6 +186,7 @@
 * 2014-05-04 eat 0.9.02 Renamed newType to nbObjectType
 * 2014-05-04 eat 0.9.02 Introduced type.kind
 * 2014-06-07 eat 0.9.02 Replaced TYPE_NOT_TRUE with not NB_OBJECT_KIND_TRUE
+* 2026-10-18 eat 0.9.04 Count object pages for metrics
 *=============================================================================
 */
 #include <nb/nbi.h>
@@ -298,6 +299,7 @@ void nbHeap(){
     }
   objectHeap->next=NULL;
   objectHeap->top=(char *)objectHeap+NB_OBJECT_PAGE_SIZE;
+  nb_metricPages.value++;
   nb_ObjectPool=malloc(sizeof(struct NB_OBJECT_POOL));
   if(!objectHeap){
     fprintf(stderr,"NodeBrain out of memory.  Terminating\n");
@@ -419,6 +421,7 @@ void *nbAlloc(int size){
         }
       newPage->next=objectHeap;
       objectHeap=newPage;
+      nb_metricPages.value++;
       objectHeap->top=(char *)objectHeap+NB_OBJECT_PAGE_SIZE;
       }
     objectHeap->top-=size;
@@ -46,7 +46,7 @@
 *     int (*producer)(nbCELL context,nbPeer *peer,void *handle,int code),
 *     int (*consumer)(nbCELL context,nbPeer *peer,void *handle,void *data,int len),
 *     void (*shutdown)(nbCELL context,nbPeer *peer,void *handle,int code));
-*   int nbPeerSend(nbCELL context,nbPeer *peer,void *data,int len);
+*   int nbPeerSend(nbCELL context,nbPeer *peer,void *data,size_t len);
 *   int nbPeerShutdown(nbCELL context,nbPeer *peer,code);
 *   int nbPeerDestroy(nbCELL context,nbPeer *peer);
 *
@@ -60,7 +60,7 @@
 * Description:
 *
 *   This API provides a simple layer on top of the NodeBrain Medulla API and
-*   NodeBrain TLS API to exchange data blocks up to 64KB using non-blocking
+*   NodeBrain TLS API to exchange data blocks up to 64MB using non-blocking
 *   IO via encrypted and authenticated connection.  
 *
 *   The Medulla API manages when sockets are ready for read or write.  This
@@ -97,6 +97,17 @@
 *   their own prefix.  This may seem redundant, but it enables modifications
 *   here without impacting applications.
 *
+*   Records are written with a 2 byte length that includes the length field.
+*   Records too large for a 2 byte length are written with a zero length
+*   followed by a 4 byte length that includes the 6 bytes of length fields.
+*
+*   Records are queued in a chain of buffers.  A record is copied once, into
+*   the last buffer of the chain, and never moved.  When the peer is ready
+*   for writing, all queued buffers are written with one nbTlsWritev call.
+*   A buffer holds many small records, so they share a TLS record.  A record
+*   larger than NB_PEER_BUFLEN gets a buffer of its own.  nbPeerSend returns
+*   1 when NB_PEER_WRITE_MAX bytes are already queued.
+*
 *   A void pointer called "handle" is provided to these functions for use
 *   as a session handle. The user's notion of a protocol state can be
 *   managed as an attribute in the session handle, or by updating the
@@ -124,6 +135,12 @@
 * 2013-01-01 eat 0.8.13 Checker updates
 * 2013-01-11 eat 0.8.13 Checker updates
 * 2014-02-01 eat 0.8.16 Made TLS optional
+* 2026-10-18 eat 0.9.04 Replaced fixed write buffer with a chain of buffers
+*            Records larger than 64KB are now supported with a 4 byte length.
+*            The writer no longer moves unwritten data to the start of the
+*            buffer after a partial write, and writes multiple buffers with
+*            a single nbTlsWritev call.
+* 2026-10-18 eat 0.9.04 Wait for a TCP connect in progress in nbPeerConnect
 *==============================================================================
 */
 #include "../config.h"
@@ -136,37 +153,103 @@ int peerTrace;          // debugging trace flag for peer routines
 * Medulla Event Handlers
 *********************************************************************/
 
+/*
+*  Allocate a write buffer
+*/
+static nbPeerBuf *nbPeerBufAlloc(int size){
+  nbPeerBuf *buf;
+
+  buf=(nbPeerBuf *)nbAlloc(sizeof(nbPeerBuf)+size);
+  buf->next=NULL;
+  buf->size=size;
+  buf->start=buf->data;
+  buf->end=buf->data;
+  return(buf);
+  }
+
+/*
+*  Free the write buffer chain
+*/
+static void nbPeerBufFree(nbPeer *peer){
+  nbPeerBuf *buf;
+
+  while((buf=peer->wbuf)!=NULL){
+    peer->wbuf=buf->next;
+    nbFree(buf,sizeof(nbPeerBuf)+buf->size);
+    }
+  peer->wend=NULL;
+  peer->wsize=0;
+  peer->wretry=0;
+  }
+
+/*
+*  Release written data from the front of the write buffer chain
+*
+*    Written buffers are freed, except a last buffer of the standard size,
+*    which is reset for reuse.
+*/
+static void nbPeerBufWritten(nbPeer *peer,size_t len){
+  nbPeerBuf *buf;
+
+  peer->wsize-=len;
+  while((buf=peer->wbuf)!=NULL && len>=(size_t)(buf->end-buf->start)){
+    len-=buf->end-buf->start;
+    if(!buf->next && buf->size==NB_PEER_BUFLEN){
+      buf->start=buf->data;
+      buf->end=buf->data;
+      return;
+      }
+    peer->wbuf=buf->next;
+    if(!peer->wbuf) peer->wend=NULL;
+    nbFree(buf,sizeof(nbPeerBuf)+buf->size);
+    }
+  if(buf) buf->start+=len;
+  }
+
 /*
 *  Write data to peer
 */ 
 static void nbPeerWriter(nbCELL context,int sd,void *handle){
   nbPeer *peer=(nbPeer *)handle;
+  nbPeerBuf *buf;
+  struct iovec iov[NB_PEER_IOV];
+  int iovcnt=0;
   int len;
-  size_t size;
   int code;
 
-  if(peerTrace) nbLogMsg(context,0,'T',"nbPeerWriter: called for sd=%d",sd);
-  size=peer->wloc-peer->wbuf;
-  if(peerTrace) nbLogMsg(context,0,'T',"nbPeerWriter: called for sd=%d size=%d",sd,size);
-  if(size){
-    len=nbTlsWrite(peer->tls,(char *)peer->wbuf,size);
+  if(peerTrace) nbLogMsg(context,0,'T',"nbPeerWriter: called for sd=%d size=%zu",sd,peer->wsize);
+  if(peer->wsize){
+    for(buf=peer->wbuf;buf->end==buf->start;buf=buf->next);  // skip empty buffer
+    if(peer->wretry){  // SSL_write must be retried with the same buffer and length
+      iov[0].iov_base=buf->start;
+      iov[0].iov_len=peer->wretry;
+      iovcnt=1;
+      }
+    else for(;buf && iovcnt<NB_PEER_IOV;buf=buf->next){
+      if(buf->end==buf->start) continue;
+      iov[iovcnt].iov_base=buf->start;
+      iov[iovcnt].iov_len=buf->end-buf->start;
+      iovcnt++;
+      }
+    len=nbTlsWritev(peer->tls,iov,iovcnt);
     if(len<0){
-      if(peer->tls->error==NB_TLS_ERROR_WANT_WRITE) return; // will try again later
+      if(peer->tls->error==NB_TLS_ERROR_WANT_WRITE){
+        if(peer->tls->ssl) peer->wretry=iov[0].iov_len;
+        return; // will try again later
+        }
       nbLogMsg(context,0,'E',"nbPeerWriter: nbTlsWrite failed - %s",strerror(errno));
       peer->flags|=NB_PEER_FLAG_WRITE_ERROR;
       }
-    if(len<size){
-      size-=len;
-      memcpy(peer->wbuf,peer->wloc+len,size);
-      peer->wloc=peer->wbuf+size;
-      } 
-    else peer->wloc=peer->wbuf;
+    else{
+      peer->wretry=0;
+      nbPeerBufWritten(peer,len);
+      }
     }
   if(peer->producer){
     if((code=(*peer->producer)(context,peer,peer->handle))){  // call producer for more data
       nbPeerShutdown(context,peer,code);
       }
-    if(peer->wloc==peer->wbuf){  // if we don't have more data to write, stop waiting to write
+    if(!peer->wsize){  // if we don't have more data to write, stop waiting to write
       if(peerTrace) nbLogMsg(context,0,'T',"nbPeerWriter: removing WRITE_WAIT on SD=%d because we have no more data at the moment",sd);
       nbListenerRemoveWrite(context,sd);
       peer->flags&=0xff-NB_PEER_FLAG_WRITE_WAIT;
@@ -187,7 +270,8 @@ static void nbPeerReader(nbCELL context,int sd,void *handle){
   int len;
   size_t size;
   nbTLS *tls=peer->tls;
-  unsigned char *bufcur,*dataend;
+  unsigned char *bufcur,*dataend,*rbuf;
+  int hlen;
   int code;
   
   if(peerTrace) nbLogMsg(context,0,'T',"nbPeerReader: called for sd=%d",sd);
@@ -198,7 +282,7 @@ static void nbPeerReader(nbCELL context,int sd,void *handle){
     nbPeerShutdown(context,peer,-1);
     return;
     }
-  size=NB_PEER_BUFLEN-(peer->rloc-peer->rbuf);
+  size=peer->rsize-(peer->rloc-peer->rbuf);
   len=nbTlsRead(tls,(char *)peer->rloc,size);
   if(len<=0){
     if(len<0 && tls->error==NB_TLS_ERROR_WANT_READ) return; // will try again later
@@ -214,36 +298,35 @@ static void nbPeerReader(nbCELL context,int sd,void *handle){
   bufcur=peer->rbuf;
 
   while(bufcur<dataend && peer->consumer){
-    if(dataend-peer->rbuf<2){
-      if(peerTrace) nbLogMsg(context,0,'T',"nbPeerReader: message length is split - have to read again");
-      peer->rloc+=len;
-      if(bufcur!=peer->rbuf){
-        memcpy(peer->rbuf,bufcur,peer->rloc-bufcur);
-        peer->rloc-=bufcur-peer->rbuf;
-        if(peer->rloc<peer->rbuf){
-           nbLogMsg(context,0,'L',"nbPeerReader: Peer %d %s fatal logic error - rloc %p < rbuf %p",sd,tls->uriMap[tls->uriIndex].uri,peer->rloc,peer->rbuf);
-           exit(1);
-           }
-        }
+    hlen=2;
+    if(dataend-bufcur<hlen) break;
+    len=(*bufcur<<8)|*(bufcur+1);
+    if(len==0){  // 2026-10-18 eat 0.9.04 - large record has a 4 byte length
+      hlen=6;
+      if(dataend-bufcur<hlen) break;
+      len=(*(bufcur+2)<<24)|(*(bufcur+3)<<16)|(*(bufcur+4)<<8)|*(bufcur+5);
+      }
+    if(len<hlen || len>NB_PEER_FRAME_MAX+hlen){
+      nbLogMsg(context,0,'E',"nbPeerReader: Peer %d %s sent record with invalid length %d - shutting down",sd,tls->uriMap[tls->uriIndex].uri,len);
+      nbPeerShutdown(context,peer,-1);
       return;
       }
-    len=(*bufcur<<8)|*(bufcur+1);
-    if(bufcur+len>dataend){
+    if(len>dataend-bufcur){
       if(peerTrace) nbLogMsg(context,0,'T',"nbPeerReader: didn't get full message - have to read again");
-      peer->rloc=dataend;
-      if(bufcur!=peer->rbuf){
-        memcpy(peer->rbuf,bufcur,dataend-bufcur);
-        peer->rloc-=bufcur-peer->rbuf;
-        if(peer->rloc<peer->rbuf){
-           nbLogMsg(context,0,'L',"nbPeerReader: Peer %d %s fatal logic error - rloc %p < rbuf %p",sd,tls->uriMap[tls->uriIndex].uri,peer->rloc,peer->rbuf);
-           exit(1);
-           }
+      if(len>peer->rsize){  // get a buffer large enough for the record
+        rbuf=(unsigned char *)nbAlloc(len);
+        memcpy(rbuf,bufcur,dataend-bufcur);
+        nbFree(peer->rbuf,peer->rsize);
+        peer->rbuf=rbuf;
+        peer->rsize=len;
+        peer->rloc=rbuf+(dataend-bufcur);
+        return;
         }
-      return;
+      break;
       }
     // call the consumer
     if(peerTrace) nbLogMsg(context,0,'T',"nbPeerReader: calling the consumer exit - peer->handle=%p",peer->handle);
-    if((code=(*peer->consumer)(context,peer,peer->handle,bufcur+2,len-2))){
+    if((code=(*peer->consumer)(context,peer,peer->handle,bufcur+hlen,len-hlen))){
       nbLogMsg(context,0,'T',"nbPeerReader: Peer %d %s shutting down by consumer request",sd,tls->uriMap[tls->uriIndex].uri);
       nbListenerRemove(context,sd); // shutdown should do this for us
       peer->flags&=0xff-NB_PEER_FLAG_READ_WAIT;
@@ -253,21 +336,25 @@ static void nbPeerReader(nbCELL context,int sd,void *handle){
     bufcur+=len;
     //nbLogMsg(context,0,'T',"nbPeerReader: new bufcur=%p",bufcur);
     }
-  if(peer->consumer){
-    if(bufcur!=dataend){
-      nbLogMsg(context,0,'T',"nbPeerReader: Peer %d %s fatal error - didn't finish at end of data - terminating",sd,tls->uriMap[tls->uriIndex].uri);
-      exit(1);
-      }
-    peer->rloc=peer->rbuf;  // next read will be at start of buffer
-    }
-  else{ // the consumer has been cancelled in the middle of reading
+  if(!peer->consumer){ // the consumer has been cancelled in the middle of reading
     nbLogMsg(context,0,'L',"nbPeerReader: Peer %d %s fatal defect - consumer bailed in middle of sending buffer - terminating",sd,tls->uriMap[tls->uriIndex].uri);
     exit(1);
     }
+  // keep a partial record for the next read
+  size=dataend-bufcur;
+  if(peer->rsize>NB_PEER_BUFLEN && size<=NB_PEER_BUFLEN){  // return to a standard buffer after a large record
+    rbuf=(unsigned char *)nbAlloc(NB_PEER_BUFLEN);
+    if(size) memcpy(rbuf,bufcur,size);
+    nbFree(peer->rbuf,peer->rsize);
+    peer->rbuf=rbuf;
+    peer->rsize=NB_PEER_BUFLEN;
+    bufcur=rbuf;
+    }
+  if(size && bufcur!=peer->rbuf) memmove(peer->rbuf,bufcur,size);
+  peer->rloc=peer->rbuf+size;  // next read will follow the partial record
   if(peerTrace) nbLogMsg(context,0,'T',"nbPeerReader: returning");
   }
 
-
 /*
 *  Call producer after TLS handshake is complete 
 *
@@ -285,7 +372,7 @@ static void nbPeerConnecter(nbCELL context,int sd,void *handle){
       nbPeerShutdown(context,peer,code);
       return;
       }
-    if(peer->wloc>peer->wbuf) nbPeerWriter(context,sd,handle);
+    if(peer->wsize) nbPeerWriter(context,sd,handle);
     if(peer->producer){
       nbListenerAddWrite(context,sd,peer,nbPeerWriter);
       peer->flags|=NB_PEER_FLAG_WRITE_WAIT;
@@ -403,9 +490,11 @@ static void nbPeerAccepter(nbCELL context,int sd,void *handle){
   peer=(nbPeer *)nbAlloc(sizeof(nbPeer));
   memcpy(peer,lpeer,sizeof(nbPeer));
   peer->tls=tls;
-  if(!peer->wbuf) peer->wbuf=(unsigned char *)nbAlloc(NB_PEER_BUFLEN);
-  peer->wloc=peer->wbuf;
-  if(!peer->rbuf) peer->rbuf=(unsigned char *)nbAlloc(NB_PEER_BUFLEN);
+  if(!peer->wbuf) peer->wbuf=peer->wend=nbPeerBufAlloc(NB_PEER_BUFLEN);
+  if(!peer->rbuf){
+    peer->rbuf=(unsigned char *)nbAlloc(NB_PEER_BUFLEN);
+    peer->rsize=NB_PEER_BUFLEN;
+    }
   peer->rloc=peer->rbuf;
   // 2011-02-05 eat - this has been reworked for non-blocking IO
   if(tls->option==NB_TLS_OPTION_TCP || tls->error==NB_TLS_ERROR_UNKNOWN){
@@ -511,9 +600,11 @@ int nbPeerConnect(nbCELL context,nbPeer *peer,void *handle,
     }
   //nbLogMsg(context,0,'I',"Attempting peer connection with %s",peer->tls->uriMap[0].uri);
   nbLogMsg(context,0,'I',"Attempting peer connection with %s",nbTlsGetUri(peer->tls));
-  if(!peer->wbuf) peer->wbuf=(unsigned char *)nbAlloc(NB_PEER_BUFLEN);
-  peer->wloc=peer->wbuf;
-  if(!peer->rbuf) peer->rbuf=(unsigned char *)nbAlloc(NB_PEER_BUFLEN);
+  if(!peer->wbuf) peer->wbuf=peer->wend=nbPeerBufAlloc(NB_PEER_BUFLEN);
+  if(!peer->rbuf){
+    peer->rbuf=(unsigned char *)nbAlloc(NB_PEER_BUFLEN);
+    peer->rsize=NB_PEER_BUFLEN;
+    }
   peer->rloc=peer->rbuf;
   peer->handle=handle;
   peer->producer=producer;
@@ -531,6 +622,10 @@ int nbPeerConnect(nbCELL context,nbPeer *peer,void *handle,
       nbListenerAddWrite(context,peer->tls->socket,peer,nbPeerConnecter);
       peer->flags|=NB_PEER_FLAG_WRITE_WAIT;
       return(1);
+    case 4:  // 2026-10-18 eat 0.9.04 - TCP connect in progress completes when writable
+      nbListenerAddWrite(context,peer->tls->socket,peer,nbPeerConnecter);
+      peer->flags|=NB_PEER_FLAG_WRITE_WAIT;
+      return(0);
     case 1:
       nbListenerAddWrite(context,peer->tls->socket,peer,nbPeerConnectHandshaker);
       peer->flags|=NB_PEER_FLAG_WRITE_WAIT;
@@ -542,7 +637,7 @@ int nbPeerConnect(nbCELL context,nbPeer *peer,void *handle,
       if(peerTrace) nbLogMsg(context,0,'T',"nbPeerConnect: returning - good luck waiting for a connection");
       return(0); 
     }
-  nbLogMsg(context,0,'L',"nbPeerConnect: unexpected return code %d from nbTlsConnectNonBlocking");
+  nbLogMsg(context,0,'L',"nbPeerConnect: unexpected return code %d from nbTlsConnectNonBlocking",rc);
   return(rc);
   }
 
@@ -555,33 +650,51 @@ int nbPeerConnect(nbCELL context,nbPeer *peer,void *handle,
 *     0 - success
 *     1 - buffer is full - will call producer when ready for retry
 */
-int nbPeerSend(nbCELL context,nbPeer *peer,void *data,uint16_t size){
-  uint16_t mysize;
+int nbPeerSend(nbCELL context,nbPeer *peer,void *data,size_t size){
+  nbPeerBuf *buf;
+  unsigned char *cursor;
+  size_t len;
 
-  if(peerTrace) nbLogMsg(context,0,'I',"Sending %d bytes to %s",size,nbTlsGetUri(peer->tls));
-  if(peerTrace) nbLogMsg(context,0,'T',"nbPeerSend: called with peer=%p SD=%d size=%d flags=%x",peer,peer->tls->socket,size,peer->flags);
+  if(peerTrace) nbLogMsg(context,0,'I',"Sending %zu bytes to %s",size,nbTlsGetUri(peer->tls));
+  if(peerTrace) nbLogMsg(context,0,'T',"nbPeerSend: called with peer=%p SD=%d size=%zu flags=%x",peer,peer->tls->socket,size,peer->flags);
   if(peer->flags&NB_PEER_FLAG_WRITE_ERROR){
     nbLogMsg(context,0,'T',"nbPeerSend: error flag is set");
     return(-1);
     }
-  if(size>NB_PEER_BUFLEN-2){
+  if(size>NB_PEER_FRAME_MAX){
     nbLogMsg(context,0,'T',"nbPeerSend: size is too big for buffer");
     return(-1);
     }
-  if(peer->wloc+size+2>peer->wbuf+NB_PEER_BUFLEN){
+  len=size+2<=0xffff ? size+2 : size+6;
+  if(peer->wsize && peer->wsize+len>NB_PEER_WRITE_MAX){
     nbLogMsg(context,0,'T',"nbPeerSend: buffer is full");
     return(1);
     }
   if(peerTrace) nbLogMsg(context,0,'T',"nbPeerSend: made it past bail out conditions");
+  buf=peer->wend;
+  if(!buf || buf->end+len>buf->data+buf->size){  // start a new buffer
+    buf=nbPeerBufAlloc(len>NB_PEER_BUFLEN ? len : NB_PEER_BUFLEN);
+    if(peer->wend) peer->wend->next=buf;
+    else peer->wbuf=buf;
+    peer->wend=buf;
+    }
   // put message in buffer
-  memcpy(peer->wloc+2,data,size);
-  mysize=size+2;               // 2013-01-01 eat - VID 5268-0.8.13-1 FP but changed data type and moved here from init
-  *peer->wloc=(mysize>>8)%256; // 2013-01-01 eat - VID 5376-0.8.13-1 FP but changed data type of mysize from int to uint16_t
-                               // 2013-01-11 eat - VID 6583-0.8.13-2 FP but still trying to help checker by adding the %256
-  peer->wloc++;
-  *peer->wloc=mysize%256;      // 2013-01-01 eat - VID 4614,4849-0.8.13-1 FP but changed from &0xff to %256 and data type
-  peer->wloc++;
-  peer->wloc+=size;
+  cursor=buf->end;
+  if(len==size+2){
+    *cursor++=(unsigned char)(len>>8);
+    *cursor++=(unsigned char)len;
+    }
+  else{
+    *cursor++=0;
+    *cursor++=0;
+    *cursor++=(unsigned char)(len>>24);
+    *cursor++=(unsigned char)(len>>16);
+    *cursor++=(unsigned char)(len>>8);
+    *cursor++=(unsigned char)len;
+    }
+  memcpy(cursor,data,size);
+  buf->end+=len;
+  peer->wsize+=len;
   if(!(peer->flags&NB_PEER_FLAG_WRITE_WAIT)){
     if(peerTrace) nbLogMsg(context,0,'T',"nbPeerSend: nbListenerAddWrite SD=%d flags=%x",peer->tls->socket,peer->flags);
     nbListenerAddWrite(context,peer->tls->socket,peer,nbPeerWriter);
@@ -649,9 +762,8 @@ int nbPeerShutdown(nbCELL context,nbPeer *peer,int code){
     }
   if(peer->tls) nbTlsClose(peer->tls); // do this after the removes because it clears the socket
   peer->flags&=0xff-NB_PEER_FLAG_WRITE_ERROR;
-  if(peer->wbuf) nbFree(peer->wbuf,NB_PEER_BUFLEN);
-  peer->wbuf=NULL;
-  if(peer->rbuf) nbFree(peer->rbuf,NB_PEER_BUFLEN);
+  nbPeerBufFree(peer);
+  if(peer->rbuf) nbFree(peer->rbuf,peer->rsize);
   peer->rbuf=NULL;
   peer->producer=NULL;
   peer->consumer=NULL;
@@ -663,8 +775,8 @@ int nbPeerDestroy(nbCELL context,nbPeer *peer){
   if(peerTrace) nbLogMsg(context,0,'T',"nbPeerDestroy: called");
   if(peer->tls) nbLogMsg(context,0,'T',"nbPeerDestroy: uri=%s",peer->tls->uriMap[0].uri);
   if(peer->tls) nbTlsFree(peer->tls);
-  if(peer->wbuf) nbFree(peer->wbuf,NB_PEER_BUFLEN);
-  if(peer->rbuf) nbFree(peer->rbuf,NB_PEER_BUFLEN);
+  nbPeerBufFree(peer);
+  if(peer->rbuf) nbFree(peer->rbuf,peer->rsize);
   nbFree(peer,sizeof(nbPeer));
   return(0);
   }
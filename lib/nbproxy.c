@@ -143,6 +143,15 @@
 * 2012-12-27 eat 0.8.13 Checker updates
 * 2012-12-30 eat 0.8.13 Modified nbProxyConstuct to only load context for secure protocols
 * 2014-02-16 eat 0.6.18 Optional TLS
+* 2026-10-18 eat 0.9.04 Included cached pages and nbProxyPutFile
+*            A cached page references read-only data owned by the caller, so
+*            the same content can be queued on many connections without
+*            copying.  The owner's release function is called when the page
+*            is closed.  nbProxyPutFile sends a file with sendfile() after
+*            the output book on connections without SSL.
+* 2026-10-18 eat 0.9.04 Included nbProxyBookJoin for messages spanning input pages
+* 2026-10-18 eat 0.9.04 Use -1 for no file to send, since zero is a valid descriptor
+* 2026-10-18 eat 0.9.04 Return the number of bytes joined from nbProxyBookJoin
 *==============================================================================
 */
 #include "../config.h"
@@ -150,6 +159,9 @@
 
 #include <nb/nb.h>
 #include <nb/nbproxy.h>  // will move to nb.h after it settles down
+#if defined(HAVE_SYS_SENDFILE_H)
+#include <sys/sendfile.h>
+#endif
 
 int proxyTrace;          // debugging trace flag for proxy routines
 
@@ -174,6 +186,8 @@ nbProxyPage *nbProxyPageOpen(nbCELL context,void **data,size_t *size){
   page->next=NULL;
   page->dataLen=0;
   page->flags=0;
+  page->handle=NULL;
+  page->release=NULL;
   *data=page->data;
   *size=page->size;
   return(page);
@@ -193,11 +207,39 @@ int nbProxyPageProduced(nbCELL context,nbProxyPage *page,int len){
 
 void *nbProxyPageClose(nbCELL context,nbProxyPage *page){
   if(proxyTrace) nbLogMsg(context,0,'T',"nbProxyPageClose: page=%p",page);
+  if(page->flags&NB_PROXY_PAGE_FLAG_CACHED){  // 2026-10-18 eat 0.9.04 - data belongs to the owner
+    if(page->release) (*page->release)(page->handle);
+    nbFree(page,sizeof(nbProxyPage));
+    return(NULL);
+    }
   page->next=nb_proxy_page;
   nb_proxy_page=page;
   return(NULL);
   }
 
+/*
+*  Open a cached page
+*
+*    The page references len bytes of data owned by the caller.  The data
+*    must not change until the release function is called with the handle,
+*    which happens when the page is closed.  A cached page is full, so a
+*    book will not write to it.
+*/
+nbProxyPage *nbProxyPageOpenCached(nbCELL context,void *data,int len,void *handle,void (*release)(void *handle)){
+  nbProxyPage *page;
+
+  page=(nbProxyPage *)nbAlloc(sizeof(nbProxyPage));
+  page->next=NULL;
+  page->data=data;
+  page->size=len;
+  page->dataLen=len;
+  page->flags=NB_PROXY_PAGE_FLAG_CACHED;
+  page->handle=handle;
+  page->release=release;
+  if(proxyTrace) nbLogMsg(context,0,'T',"nbProxyPageOpenCached: page=%p len=%d",page,len);
+  return(page);
+  }
+
 /*********************************************************************
 * Proxy book functions
 *********************************************************************/
@@ -209,8 +251,8 @@ nbProxyBook *nbProxyBookOpen(nbCELL context){
   return(book);
   }
 
-// Note: this function should not be called with a cached page
-//       We'll need a change here or different function for cached pages
+// Note: A cached page may be put in a book, because each use of cached
+//       data gets its own page from nbProxyPageOpenCached
 int nbProxyBookPutPage(nbCELL context,nbProxyBook *book,nbProxyPage *page){
   if(proxyTrace) nbLogMsg(context,0,'T',"nbProxyBookPutPage: called");
   if(!book->writePage){
@@ -310,6 +352,39 @@ int nbProxyBookConsumed(nbCELL context,nbProxyBook *book,int len){
   return(0);
   }
 
+/*
+*  Join data on the next page to the unread data on the read page
+*
+*    A consumer that needs a message in contiguous memory calls this when
+*    a partial message ends the read page.  The unread data is moved to the
+*    start of the read page and filled out from the next page.
+*
+*    Returns the number of bytes joined, or zero when there is no next page
+*    with data or the read page is already full.
+*/
+int nbProxyBookJoin(nbCELL context,nbProxyBook *book){
+  nbProxyPage *page=book->readPage,*next;
+  int unread,len;
+
+  if(!page || !(next=page->next) || !next->dataLen) return(0);
+  unread=page->dataLen-book->readOffset;
+  if(unread>=page->size) return(0);
+  if(book->readOffset) memmove(page->data,(char *)page->data+book->readOffset,unread);
+  book->readOffset=0;
+  len=page->size-unread;
+  if(len>next->dataLen) len=next->dataLen;
+  memcpy((char *)page->data+unread,next->data,len);
+  page->dataLen=unread+len;
+  next->dataLen-=len;
+  if(next->dataLen) memmove(next->data,(char *)next->data+len,next->dataLen);
+  else if(next!=book->writePage){  // empty pages are only left at the end
+    page->next=next->next;
+    nbProxyPageClose(context,next);
+    }
+  if(proxyTrace) nbLogMsg(context,0,'T',"nbProxyBookJoin: joined %d bytes to %d unread",len,unread);
+  return(len);
+  }
+
 void *nbProxyBookClose(nbCELL context,nbProxyBook *book){
   nbProxyPage *page=book->readPage;
   while(page){
@@ -326,6 +401,37 @@ void *nbProxyBookClose(nbCELL context,nbProxyBook *book){
 * Medulla Event Handlers
 *********************************************************************/
 
+/*
+*  Send part of a file queued by nbProxyPutFile
+*
+*  Returns: -1 - error, 0 - continue
+*/
+static int nbProxyWriteFile(nbCELL context,nbProxy *proxy){
+#if defined(HAVE_SYS_SENDFILE_H)
+  ssize_t len;
+
+  len=sendfile(proxy->tls->socket,proxy->sendFile,&proxy->sendOffset,proxy->sendSize);
+  while(len<0 && errno==EINTR) len=sendfile(proxy->tls->socket,proxy->sendFile,&proxy->sendOffset,proxy->sendSize);
+  if(len<0 && errno==EAGAIN) return(0); // will try again later
+  if(len<=0){  // a file that got shorter is also an error since the length has been promised
+    if(len<0) nbLogMsg(context,0,'E',"nbProxyWriter: sendfile failed - %s",strerror(errno));
+    else nbLogMsg(context,0,'E',"nbProxyWriter: sendfile reached end of file with %zu bytes remaining",proxy->sendSize);
+    proxy->flags|=NB_PROXY_FLAG_WRITE_ERROR;
+    close(proxy->sendFile);
+    proxy->sendFile=-1;
+    proxy->sendSize=0;
+    return(-1);
+    }
+  if(proxyTrace) nbLogMsg(context,0,'T',"nbProxyWriter: sendfile wrote %ld bytes to sd=%d",(long)len,proxy->tls->socket);
+  proxy->sendSize-=len;
+  if(!proxy->sendSize){
+    close(proxy->sendFile);
+    proxy->sendFile=-1;
+    }
+#endif
+  return(0);
+  }
+
 /*
 *  Write data to proxy
 *
@@ -346,7 +452,10 @@ static void nbProxyWriter(nbCELL context,int sd,void *handle){
   if(proxyTrace) nbLogMsg(context,0,'T',"nbProxyWriter: called for sd=%d",sd);
   size=nbProxyBookReadWhere(context,&proxy->obook,&data);
   if(proxyTrace) nbLogMsg(context,0,'T',"nbProxyWriter: called for sd=%d size=%d",sd,size);
-  if(size){
+  if(!size && proxy->sendSize){  // 2026-10-18 eat 0.9.04 - send file after the output book
+    if(nbProxyWriteFile(context,proxy)<0) return;
+    }
+  else if(size){
     len=nbTlsWrite(proxy->tls,(char *)data,size);
     if(len<0){
       if(proxy->tls->error==NB_TLS_ERROR_WANT_WRITE) return; // will try again later
@@ -379,7 +488,7 @@ static void nbProxyWriter(nbCELL context,int sd,void *handle){
       if(code==2) proxy->flags|=NB_PROXY_FLAG_FINISH_OUTPUT;
       }
     }
-  if(!proxy->obook.readPage){  // if we don't have more data to write, stop waiting to write
+  if(!proxy->obook.readPage && !proxy->sendSize){  // if we don't have more data to write, stop waiting to write
     if(proxyTrace) nbLogMsg(context,0,'T',"nbProxyWriter: removing WRITE_WAIT on SD=%d because we have no more data at the moment",sd);
     nbListenerRemoveWrite(context,sd);
     proxy->flags&=0xff-NB_PROXY_FLAG_WRITE_WAIT;
@@ -662,6 +771,7 @@ static void nbProxyAccepter(nbCELL context,int sd,void *handle){
   if(proxyTrace) nbLogMsg(context,0,'T',"nbProxyAccepter: proxy->flags=%x",proxy->flags);
   proxy->flags=0;
   proxy->tls=tls;
+  proxy->sendFile=-1;
   // 2011-02-05 eat - this has been reworked for non-blocking IO
   if(tls->option==NB_TLS_OPTION_TCP || tls->error==NB_TLS_ERROR_UNKNOWN){
     nbLogMsg(context,0,'T',"nbProxyAccepter: setting up nbProxyConnecter");
@@ -701,6 +811,7 @@ nbProxy *nbProxyConstruct(nbCELL context,int client,nbCELL tlsContext,void *hand
   // allocate a proxy structure
   proxy=(nbProxy *)nbAlloc(sizeof(nbProxy));
   memset(proxy,0,sizeof(nbProxy));
+  proxy->sendFile=-1;  // 2026-10-18 eat 0.9.04 - zero is a valid descriptor
   proxy->handle=handle;
   proxy->producer=producer;
   proxy->consumer=consumer;
@@ -818,6 +929,7 @@ nbProxy *nbProxyConnect(nbCELL context,nbTLSX *tlsx,char *uri,void *handle,
 
   proxy=(nbProxy *)nbAlloc(sizeof(nbProxy));
   memset(proxy,0,sizeof(nbProxy));
+  proxy->sendFile=-1;
   proxy->tls=nbTlsCreate(tlsx,uri); 
   if(!proxy->tls){
     nbLogMsg(context,0,'E',"nbProxyConnect: unable to create tls handle");
@@ -944,6 +1056,37 @@ int nbProxyPutPage(nbCELL context,nbProxy *proxy,nbProxyPage *page){
   return(0);
   }
 
+/*
+* Send a file after the data in the output book
+*
+*   The file is sent with sendfile() when the connection does not use SSL.
+*   The proxy owns the file descriptor when 0 is returned and closes it
+*   when the file has been sent or the proxy is shutdown.
+*
+*   Returns:
+*     -1 - error
+*      0 - file will be sent
+*      1 - not supported for this connection - caller must produce the data
+*/
+int nbProxyPutFile(nbCELL context,nbProxy *proxy,int fd,off_t offset,size_t size){
+#if defined(HAVE_SYS_SENDFILE_H)
+  if(proxy->flags&NB_PROXY_FLAG_WRITE_ERROR) return(-1);
+  if(!proxy->tls || proxy->tls->ssl || proxy->sendSize || !size) return(1);
+  if(proxyTrace) nbLogMsg(context,0,'T',"nbProxyPutFile: sending %zu bytes of fd=%d to SD=%d",size,fd,proxy->tls->socket);
+  proxy->sendFile=fd;
+  proxy->sendOffset=offset;
+  proxy->sendSize=size;
+  proxy->flags&=0xff-NB_PROXY_FLAG_PRODUCER_STOP;
+  if(!(proxy->flags&NB_PROXY_FLAG_WRITE_WAIT)){
+    nbListenerAddWrite(context,proxy->tls->socket,proxy,nbProxyWriter);
+    proxy->flags|=NB_PROXY_FLAG_WRITE_WAIT;
+    }
+  return(0);
+#else
+  return(1);
+#endif
+  }
+
 /*
 * Tell proxy we have written to the output book after calling nbProxyBookWriteWhere
 * Here we schedule writing to peer.
@@ -1029,6 +1172,7 @@ int nbProxyShutdown(nbCELL context,nbProxy *proxy,int code){
   proxy->flags=0;
   nbProxyBookClose(context,&proxy->ibook);
   nbProxyBookClose(context,&proxy->obook);
+  if(proxy->sendFile>=0) close(proxy->sendFile);
   nbFree(proxy,sizeof(nbProxy));
   return(0);
   }
@@ -1039,6 +1183,7 @@ int nbProxyDestroy(nbCELL context,nbProxy *proxy){
   if(proxy->tls) nbTlsFree(proxy->tls);
   nbProxyBookClose(context,&proxy->ibook);
   nbProxyBookClose(context,&proxy->obook);
+  if(proxy->sendFile>=0) close(proxy->sendFile);
   nbFree(proxy,sizeof(nbProxy));
   return(0);
   }
@@ -83,6 +83,13 @@
 *   If they are locked, nbqNext steps over them.  After processsing
 *   a queue file, the file is deleted.
 *
+*   An identity directory may instead hold a segmented log, an append-only
+*   sequence of segment files with a consumer offset file.  See the
+*   nbQueueLog functions at the end of this file.
+*
+*     <queue>/<brain>/<identity>/L.offset
+*     <queue>/<brain>/<identity>/Lsssssssssss.log
+*
 * Exit Codes:
 *
 *   0 - Successful completion
@@ -140,6 +147,9 @@
 * 2012-10-13 eat 0.8.12 Replaced malloc/free with nbAlloc/nbFree
 * 2012-12-15 eat 0.8.13 Checker updates
 * 2013-01-01 eat 0.8.13 Checker updates
+* 2026-10-18 eat 0.9.04 Included segmented queue log with batched sync and a
+*            durable consumer offset, conversion, and a benchmark.
+* 2026-10-18 eat 0.9.04 Sync cached queue log producers from a timer and in nbStop
 *=============================================================================
 */
 #include <nb/nbi.h>
@@ -959,3 +969,792 @@ void nbQueueProcess(nbCELL context,char *dirname,nbCELL synapse){
   //nbSynapseSetTimer(context,qHandle->yieldSynapse,0);
   nbMedullaThreadCreate(nbqThread,qHandle);
   }
+
+#if !defined(WIN32)
+
+/*
+*  Segmented Queue Log
+*
+*    A queue directory with a file per transmission works well at low rates,
+*    but a busy queue accumulates many small files and every command costs a
+*    header update and a synchronous write.  An identity directory may instead
+*    hold an append-only log.  The log format is selected by the presence of
+*    an offset file.
+*
+*      <queue>/<identity>/L.offset          consumer position
+*      <queue>/<identity>/Lsssssssssss.log  segment sssssssssss
+*
+*    Names starting with "L" sort after the fence used by nbQueueOpenDir(),
+*    so the directory format functions ignore these files.
+*
+*    Producers append one record per line to the last segment.  The segment
+*    is locked while its size is checked and the record is written, and a
+*    producer finding the segment full moves to the next one.  A segment is
+*    never written again once a later segment exists.  Records are synced
+*    to disk in batches of NBQ_LOG_SYNC, at the next write after a second,
+*    and when the log is closed.  Cached producers are also synced by a
+*    timer a couple of seconds after an unsynced write, so a record is not
+*    left waiting for the next write, and are closed by nbStop().
+*
+*    A single consumer (serialized by a lock on the offset file) reads
+*    complete lines and periodically commits its position to the offset file.
+*    The offset is synced before segments it has passed are removed.  An
+*    incomplete line at the end of the last segment is a record still being
+*    written, and is read when complete.
+*/
+
+static struct NBQ_LOG *nbq_log_producers=NULL;  // cached producers - see nbQueueLogGet()
+static nbCELL nbq_log_synapse=NULL;              // timer for syncing cached producers
+static int    nbq_log_timer=0;                   // sync timer is set
+
+static int nbqLogDataSync(int fd){
+#if defined(HAVE_FDATASYNC)
+  return(fdatasync(fd));
+#else
+  return(fsync(fd));
+#endif
+  }
+
+/*
+*  Sync a directory so new and removed names are durable
+*/
+static void nbqLogDirSync(char *dirname){
+  int fd;
+
+  if((fd=open(dirname,O_RDONLY))<0) return;
+  fsync(fd);
+  close(fd);
+  }
+
+/*
+*  Get segment number from a file name - zero if not a segment
+*/
+static unsigned int nbqLogSegmentNumber(char *name){
+  char *cursor;
+
+  if(*name!='L' || strlen(name)!=15 || strcmp(name+11,".log")!=0) return(0);
+  for(cursor=name+1;cursor<name+11;cursor++) if(*cursor<'0' || *cursor>'9') return(0);
+  return((unsigned int)strtoul(name+1,NULL,10));
+  }
+
+/*
+*  Find the first and last segment numbers
+*
+*  Returns: -1 - error, 0 - no segments, 1 - segments found
+*/
+static int nbqLogScan(char *dirname,unsigned int *first,unsigned int *last){
+  DIR *dir;
+  struct dirent *ent;
+  unsigned int segment;
+
+  *first=0;
+  *last=0;
+  if((dir=opendir(dirname))==NULL){
+    outMsg(0,'E',"Unable to open %s - %s",dirname,strerror(errno));
+    return(-1);
+    }
+  while((ent=readdir(dir))!=NULL){
+    if((segment=nbqLogSegmentNumber(ent->d_name))==0) continue;
+    if(*first==0 || segment<*first) *first=segment;
+    if(segment>*last) *last=segment;
+    }
+  closedir(dir);
+  return(*last ? 1 : 0);
+  }
+
+static void nbqLogSegmentName(char *filename,size_t size,struct NBQ_LOG *log,unsigned int segment){
+  snprintf(filename,size,"%s/L%10.10u.log",log->dirname,segment);
+  }
+
+/*
+*  Open a segment
+*
+*  Returns: -1 - error or not found, otherwise file descriptor
+*/
+static int nbqLogSegmentOpen(struct NBQ_LOG *log,unsigned int segment,int create){
+  char filename[1024];
+  int fd;
+
+  nbqLogSegmentName(filename,sizeof(filename),log,segment);
+  if(log->type==NBQ_CONSUMER) fd=open(filename,O_RDONLY);
+  else if((fd=open(filename,O_WRONLY|O_APPEND))<0 && errno==ENOENT && create){
+    fd=open(filename,O_WRONLY|O_APPEND|O_CREAT,S_IRUSR|S_IWUSR);
+    if(fd>=0) nbqLogDirSync(log->dirname);
+    }
+  if(fd<0){
+    if(errno!=ENOENT) outMsg(0,'E',"Unable to open %s - %s",filename,strerror(errno));
+    return(-1);
+    }
+  fcntl(fd,F_SETFD,FD_CLOEXEC);
+  return(fd);
+  }
+
+/*
+*  Check for the log format in an identity directory
+*/
+int nbQueueLogExists(char *dirname,char *identityName){
+  char filename[1024];
+  struct stat st;
+
+  snprintf(filename,sizeof(filename),"%s/%s/%s",dirname,identityName,NBQ_LOG_OFFSET);
+  return(stat(filename,&st)==0);
+  }
+
+/*
+*  Switch an identity directory to the log format
+*
+*    The identity directory is created if necessary.
+*
+*  Returns: -1 - error, 0 - created, 1 - already a log
+*/
+int nbQueueLogCreate(char *dirname,char *identityName){
+  char filename[1024],text[NBQ_LOG_OFFSET_SIZE+1];
+  int fd;
+
+  if(nbQueueLogExists(dirname,identityName)) return(1);
+  if(mkdir(dirname,S_IRWXU)<0 && errno!=EEXIST){
+    outMsg(0,'E',"Unable to create queue directory %s - %s",dirname,strerror(errno));
+    return(-1);
+    }
+  snprintf(filename,sizeof(filename),"%s/%s",dirname,identityName);
+  if(mkdir(filename,S_IRWXU)<0 && errno!=EEXIST){
+    outMsg(0,'E',"Unable to create queue directory %s - %s",filename,strerror(errno));
+    return(-1);
+    }
+  if(snprintf(filename,sizeof(filename),"%s/%s/%s",dirname,identityName,NBQ_LOG_OFFSET)>=(int)sizeof(filename)){
+    outMsg(0,'E',"Queue directory name too long - %s/%s",dirname,identityName);
+    return(-1);
+    }
+  if((fd=open(filename,O_RDWR|O_CREAT|O_EXCL,S_IRUSR|S_IWUSR))<0){
+    if(errno==EEXIST) return(1);
+    outMsg(0,'E',"Unable to create %s - %s",filename,strerror(errno));
+    return(-1);
+    }
+  snprintf(text,sizeof(text),"%10.10u %20.20ld\n",1,0L);
+  if(write(fd,text,NBQ_LOG_OFFSET_SIZE)!=NBQ_LOG_OFFSET_SIZE || nbqLogDataSync(fd)<0){
+    outMsg(0,'E',"Unable to write %s - %s",filename,strerror(errno));
+    close(fd);
+    unlink(filename);
+    return(-1);
+    }
+  close(fd);
+  snprintf(filename,sizeof(filename),"%s/%s",dirname,identityName);
+  nbqLogDirSync(filename);
+  return(0);
+  }
+
+/*
+*  Open a queue log
+*
+*    type: NBQ_PRODUCER or NBQ_CONSUMER
+*
+*  Returns: NULL - error, busy, or not a log
+*/
+struct NBQ_LOG *nbQueueLogOpen(char *dirname,char *identityName,int type){
+  struct NBQ_LOG *log;
+  char filename[1024],text[NBQ_LOG_OFFSET_SIZE+1];
+  unsigned int first,last;
+  ssize_t len;
+  int fd=-1,rc;
+
+  if(strlen(dirname)+strlen(identityName)+2>sizeof(log->dirname)
+    || snprintf(filename,sizeof(filename),"%s/%s/%s",dirname,identityName,NBQ_LOG_OFFSET)>=(int)sizeof(filename)){
+    outMsg(0,'E',"Queue directory name too long - %s/%s",dirname,identityName);
+    return(NULL);
+    }
+  if(type==NBQ_CONSUMER){
+    if((fd=open(filename,O_RDWR))<0){
+      outMsg(0,'E',"Unable to open %s - %s",filename,strerror(errno));
+      return(NULL);
+      }
+    fcntl(fd,F_SETFD,FD_CLOEXEC);
+    if((rc=nbQueueLock(fd,NBQ_TEST,NBQ_CONSUMER))!=1){
+      if(rc<0) outMsg(0,'E',"Unable to lock %s - %s",filename,strerror(errno));
+      else if(trace) outMsg(0,'T',"Queue log %s/%s is busy",dirname,identityName);
+      close(fd);
+      return(NULL);
+      }
+    }
+  else if(!nbQueueLogExists(dirname,identityName)){
+    outMsg(0,'E',"Queue %s/%s is not a log",dirname,identityName);
+    return(NULL);
+    }
+  log=(struct NBQ_LOG *)nbAlloc(sizeof(struct NBQ_LOG));
+  memset(log,0,sizeof(struct NBQ_LOG)-sizeof(log->buffer));
+  snprintf(log->dirname,sizeof(log->dirname),"%s/%s",dirname,identityName);
+  log->type=type;
+  log->file=-1;
+  log->offsetFile=fd;
+  log->segmentSize=NBQ_LOG_SEGMENT;
+  log->syncRecords=NBQ_LOG_SYNC;
+  log->syncTime=time(NULL);
+  log->cursor=log->buffer;
+  log->bufend=log->buffer;
+  if(nbqLogScan(log->dirname,&first,&last)<0){
+    nbQueueLogClose(log);
+    return(NULL);
+    }
+  if(type==NBQ_CONSUMER){
+    len=pread(fd,text,NBQ_LOG_OFFSET_SIZE,0);
+    if(len!=NBQ_LOG_OFFSET_SIZE || *(text+10)!=' '){
+      outMsg(0,'E',"Offset file %s is not valid",filename);
+      nbQueueLogClose(log);
+      return(NULL);
+      }
+    *(text+NBQ_LOG_OFFSET_SIZE)=0;
+    log->segment=(unsigned int)strtoul(text,NULL,10);
+    log->pos=strtol(text+11,NULL,10);
+    if(log->segment<first){   // segments we passed were removed
+      log->segment=first;
+      log->pos=0;
+      }
+    log->firstSegment=first && first<log->segment ? first : log->segment;
+    }
+  else log->segment=last ? last : 1;
+  return(log);
+  }
+
+static struct NBQ_LOG *nbqLogCached(char *dirname,char *identityName){
+  struct NBQ_LOG *log;
+  char name[512];
+
+  snprintf(name,sizeof(name),"%s/%s",dirname,identityName);
+  for(log=nbq_log_producers;log!=NULL && strcmp(log->dirname,name)!=0;log=log->next);
+  return(log);
+  }
+
+/*
+*  Get a cached producer for an identity directory
+*
+*  Returns: NULL - not a log or error
+*/
+struct NBQ_LOG *nbQueueLogGet(char *dirname,char *identityName){
+  struct NBQ_LOG *log;
+
+  if((log=nbqLogCached(dirname,identityName))!=NULL) return(log);
+  if(!nbQueueLogExists(dirname,identityName)) return(NULL);
+  if((log=nbQueueLogOpen(dirname,identityName,NBQ_PRODUCER))==NULL) return(NULL);
+  log->next=nbq_log_producers;
+  nbq_log_producers=log;
+  return(log);
+  }
+
+/*
+*  Sync a producer's segment
+*/
+int nbQueueLogSync(struct NBQ_LOG *log){
+  log->syncTime=time(NULL);
+  if(log->unsynced==0 || log->file<0) return(0);
+  log->unsynced=0;
+  if(nbqLogDataSync(log->file)<0){
+    outMsg(0,'E',"Unable to sync queue log %s - %s",log->dirname,strerror(errno));
+    return(-1);
+    }
+  return(0);
+  }
+
+/*
+*  Sync cached producers when the timer expires
+*/
+static void nbqLogAlarm(nbCELL context,void *skillHandle,void *nodeHandle,nbCELL cell){
+  struct NBQ_LOG *log;
+
+  nbq_log_timer=0;
+  for(log=nbq_log_producers;log!=NULL;log=log->next) nbQueueLogSync(log);
+  }
+
+/*
+*  Set a timer to sync cached producers if not already set
+*/
+static void nbqLogSyncLater(void){
+  if(nbq_log_timer) return;
+  if(nbq_log_synapse==NULL) nbq_log_synapse=nbSynapseOpen((nbCELL)rootGloss,NULL,NULL,NULL,nbqLogAlarm);
+  nbSynapseSetTimer((nbCELL)rootGloss,nbq_log_synapse,2);
+  nbq_log_timer=1;
+  }
+
+/*
+*  Move a producer to the last segment, or a new one if we are on the last
+*/
+static int nbqLogRoll(struct NBQ_LOG *log){
+  unsigned int first,last;
+  int create=0;
+
+  nbQueueLogSync(log);
+  if(log->file>=0) close(log->file);
+  log->file=-1;
+  if(nbqLogScan(log->dirname,&first,&last)<0) return(-1);
+  if(last<=log->segment){
+    last=log->segment+1;
+    create=1;
+    }
+  log->segment=last;
+  if((log->file=nbqLogSegmentOpen(log,log->segment,create))<0) return(-1);
+  return(0);
+  }
+
+/*
+*  Append a record to a queue log
+*
+*    A record may not contain a newline.
+*
+*  Returns: -1 - error, 0 - record written
+*/
+int nbQueueLogWrite(struct NBQ_LOG *log,char *record,size_t len){
+  struct iovec iov[2];
+  struct stat st;
+  ssize_t wrote;
+
+  while(1){
+    if(log->file<0 && (log->file=nbqLogSegmentOpen(log,log->segment,1))<0) return(-1);
+    if(nbQueueLock(log->file,NBQ_WAIT,NBQ_PRODUCER)<0 || fstat(log->file,&st)<0){
+      outMsg(0,'E',"Unable to lock queue log %s - %s",log->dirname,strerror(errno));
+      return(-1);
+      }
+    if(st.st_size<log->segmentSize) break;
+    nbQueueLock(log->file,NBQ_UNLK,NBQ_PRODUCER);
+    if(nbqLogRoll(log)<0) return(-1);
+    }
+  iov[0].iov_base=record;
+  iov[0].iov_len=len;
+  iov[1].iov_base="\n";
+  iov[1].iov_len=1;
+  while((wrote=writev(log->file,iov,2))<0 && errno==EINTR);
+  if(wrote!=(ssize_t)len+1){
+    outMsg(0,'E',"Unable to write to queue log %s - %s",log->dirname,wrote<0 ? strerror(errno) : "short write");
+    if(wrote>0 && ftruncate(log->file,st.st_size)<0) outMsg(0,'L',"Unable to remove partial record from %s",log->dirname);
+    nbQueueLock(log->file,NBQ_UNLK,NBQ_PRODUCER);
+    return(-1);
+    }
+  nbQueueLock(log->file,NBQ_UNLK,NBQ_PRODUCER);
+  log->unsynced++;
+  if(log->unsynced>=log->syncRecords || time(NULL)>log->syncTime) return(nbQueueLogSync(log));
+  nbqLogSyncLater();
+  return(0);
+  }
+
+/*
+*  Move a consumer to the next segment if it exists
+*
+*  Returns: 0 - next segment opened, 1 - no next segment
+*/
+static int nbqLogNext(struct NBQ_LOG *log){
+  int fd;
+
+  if((fd=nbqLogSegmentOpen(log,log->segment+1,0))<0) return(1);
+  if(log->bufend>log->cursor) outMsg(0,'W',"Incomplete record at end of %s/L%10.10u.log ignored",log->dirname,log->segment);
+  if(log->file>=0) close(log->file);
+  log->file=fd;
+  log->segment++;
+  log->pos=0;
+  log->skip=0;
+  log->cursor=log->buffer;
+  log->bufend=log->buffer;
+  return(0);
+  }
+
+/*
+*  Read the next record from a queue log
+*
+*    The returned record is valid until the next call.
+*
+*  Returns: NULL - no complete record available
+*/
+char *nbQueueLogRead(struct NBQ_LOG *log){
+  char *record,*end;
+  size_t have;
+  ssize_t len;
+
+  while(1){
+    if(log->cursor<log->bufend && (end=memchr(log->cursor,'\n',log->bufend-log->cursor))!=NULL){
+      record=log->cursor;
+      log->pos+=end+1-record;
+      log->cursor=end+1;
+      log->records++;
+      if(log->skip){
+        log->skip=0;
+        continue;
+        }
+      *end=0;
+      if(end>record && *(end-1)=='\r') *(end-1)=0;
+      log->recordPos=log->pos-(end+1-record);
+      return(record);
+      }
+    have=log->bufend-log->cursor;
+    if(have>=sizeof(log->buffer)){
+      if(!log->skip){
+        outMsg(0,'E',"Record length exceeds %d at offset %ld in %s/L%10.10u.log - skipping",NB_BUFSIZE,log->pos,log->dirname,log->segment);
+        log->skipPos=log->pos;
+        log->skip=1;
+        }
+      log->pos+=have;
+      have=0;
+      }
+    else if(have>0 && log->cursor>log->buffer) memmove(log->buffer,log->cursor,have);
+    log->cursor=log->buffer;
+    log->bufend=log->buffer+have;
+    if(log->file<0 && (log->file=nbqLogSegmentOpen(log,log->segment,0))<0) return(NULL);
+    while((len=pread(log->file,log->bufend,sizeof(log->buffer)-have,log->pos+have))<0 && errno==EINTR);
+    if(len<0){
+      outMsg(0,'E',"Unable to read %s/L%10.10u.log - %s",log->dirname,log->segment,strerror(errno));
+      return(NULL);
+      }
+    if(len>0) log->bufend+=len;
+    else if(nbqLogNext(log)) return(NULL);
+    }
+  }
+
+/*
+*  Return the last record read to the log so it is read again
+*/
+void nbQueueLogRewind(struct NBQ_LOG *log){
+  log->pos=log->recordPos;
+  log->skip=0;
+  log->cursor=log->buffer;
+  log->bufend=log->buffer;
+  }
+
+/*
+*  Commit a consumer's position and remove segments it has passed
+*
+*  Returns: -1 - error, 0 - committed
+*/
+int nbQueueLogCommit(struct NBQ_LOG *log){
+  char filename[1024],text[NBQ_LOG_OFFSET_SIZE+1];
+  long pos=log->skip ? log->skipPos : log->pos;  // skip a long record again on restart
+  snprintf(text,sizeof(text),"%10.10u %20.20ld\n",log->segment,pos);
+  if(pwrite(log->offsetFile,text,NBQ_LOG_OFFSET_SIZE,0)!=NBQ_LOG_OFFSET_SIZE || nbqLogDataSync(log->offsetFile)<0){
+    outMsg(0,'E',"Unable to commit queue log %s offset - %s",log->dirname,strerror(errno));
+    return(-1);
+    }
+  log->records=0;
+  for(;log->firstSegment<log->segment;log->firstSegment++){
+    nbqLogSegmentName(filename,sizeof(filename),log,log->firstSegment);
+    if(unlink(filename)<0 && errno!=ENOENT) outMsg(0,'L',"Remove failed - %s",filename);
+    }
+  return(0);
+  }
+
+/*
+*  Close a queue log
+*
+*    Producers are synced and consumers commit their position.
+*/
+void nbQueueLogClose(struct NBQ_LOG *log){
+  struct NBQ_LOG **logP;
+
+  for(logP=&nbq_log_producers;*logP!=NULL && *logP!=log;logP=&(*logP)->next);
+  if(*logP) *logP=log->next;
+  if(log->type==NBQ_CONSUMER){
+    if(log->offsetFile>=0 && log->records) nbQueueLogCommit(log);
+    }
+  else nbQueueLogSync(log);
+  if(log->file>=0) close(log->file);
+  if(log->offsetFile>=0) close(log->offsetFile);
+  nbFree(log,sizeof(struct NBQ_LOG));
+  }
+
+/*
+*  Close cached producers when stopping
+*/
+void nbQueueLogStop(void){
+  while(nbq_log_producers!=NULL) nbQueueLogClose(nbq_log_producers);
+  if(nbq_log_synapse!=NULL){
+    if(nbq_log_timer) nbSynapseSetTimer((nbCELL)rootGloss,nbq_log_synapse,0);
+    nbq_log_synapse=nbSynapseClose((nbCELL)rootGloss,nbq_log_synapse);
+    nbq_log_timer=0;
+    }
+  }
+
+/*
+*  Move command queue files of an identity into its log
+*
+*    The identity directory is switched to the log format if necessary.
+*    Only command queue (.q) files are moved.  The log is synced before each
+*    file is removed, so a failure may repeat commands but not lose them.
+*
+*  Returns: -1 - error, otherwise number of records moved
+*/
+static int nbqLogConvertIdentity(char *dirname,char *identityName){
+  struct NBQ_HANDLE *qHandle;
+  struct NBQ_ENTRY *qEntry;
+  struct NBQ_LOG *log;
+  char *cmd;
+  int records=0,files=0,status;
+
+  if(nbQueueLogCreate(dirname,identityName)<0) return(-1);
+  if((log=nbQueueLogGet(dirname,identityName))==NULL) return(-1);
+  if((qHandle=nbQueueOpenDir(dirname,identityName,1))==NULL) return(-1);
+  while((qEntry=qHandle->entry)!=NULL){
+    if(qEntry->type=='q'){
+      status=nbQueueOpenFile(qHandle);
+      if(status<0) outMsg(0,'E',"Unable to open queue file %s",qHandle->filename);
+      else if(status==0) outMsg(0,'W',"Busy queue file %s",qHandle->filename);
+      else{
+        while((cmd=nbQueueRead(qHandle))!=NULL){
+          if(*cmd=='>') cmd++;
+          if(nbQueueLogWrite(log,cmd,strlen(cmd))<0){
+            nbQueueCloseFile(qHandle->file);
+            nbQueueCloseDir(qHandle);
+            return(-1);
+            }
+          records++;
+          }
+        nbQueueCloseFile(qHandle->file);
+        if(nbQueueLogSync(log)<0){
+          nbQueueCloseDir(qHandle);
+          return(-1);
+          }
+        if(remove(qHandle->filename)<0) outMsg(0,'L',"Remove failed - %s",qHandle->filename);
+        files++;
+        }
+      }
+    qHandle->entry=qEntry->next;
+    nbFree(qEntry,sizeof(struct NBQ_ENTRY));
+    }
+  nbQueueCloseDir(qHandle);
+  if(files && trace) outMsg(0,'T',"Moved %d records from %d files into queue log %s",records,files,log->dirname);
+  return(records);
+  }
+
+/*
+*  Call a function for each identity directory of a queue
+*
+*    logOnly: 1 to skip identity directories in the file format
+*
+*  Returns: -1 - error, otherwise sum of values returned
+*/
+static int nbqLogForEach(char *dirname,int logOnly,int drop,int (*handler)(char *dirname,char *identityName,int drop)){
+  DIR *dir;
+  struct dirent *ent;
+  struct stat st;
+  char filename[1024];
+  int sum=0,rc;
+
+  if((dir=opendir(dirname))==NULL){
+    outMsg(0,'E',"Unable to open %s - %s",dirname,strerror(errno));
+    return(-1);
+    }
+  while((ent=readdir(dir))!=NULL){
+    if(*ent->d_name=='.') continue;
+    if(logOnly){
+      if(!nbQueueLogExists(dirname,ent->d_name)) continue;
+      }
+    else{
+      snprintf(filename,sizeof(filename),"%s/%s",dirname,ent->d_name);
+      if(stat(filename,&st)<0 || !S_ISDIR(st.st_mode) || getIdentity(ent->d_name)==NULL) continue;
+      }
+    if((rc=(*handler)(dirname,ent->d_name,drop))<0) sum=-1;
+    else if(sum>=0) sum+=rc;
+    }
+  closedir(dir);
+  return(sum);
+  }
+
+static int nbqLogConvertHandler(char *dirname,char *identityName,int drop){
+  return(nbqLogConvertIdentity(dirname,identityName));
+  }
+
+/*
+*  Convert a queue to the log format
+*
+*    identityName: NULL for every identity directory
+*
+*  Returns: -1 - error, otherwise number of records moved
+*/
+int nbQueueLogConvert(char *dirname,char *identityName){
+  if(identityName) return(nbqLogConvertIdentity(dirname,identityName));
+  return(nbqLogForEach(dirname,0,0,nbqLogConvertHandler));
+  }
+
+/*
+*  Move unread log records of an identity to a command queue file
+*
+*    drop: 1 to switch the identity directory back to the file format
+*
+*    When switching back, producers in other processes must be stopped first.
+*
+*  Returns: -1 - error, otherwise number of records moved
+*/
+static int nbqLogUnloadIdentity(char *dirname,char *identityName,int drop){
+  struct NBQ_LOG *log;
+  char filename[1024],*record;
+  unsigned int first,last,segment;
+  FILE *file=NULL;
+  int records=0;
+
+  if((log=nbqLogCached(dirname,identityName))!=NULL) nbQueueLogClose(log);  // sync and release cached producer
+  if((log=nbQueueLogOpen(dirname,identityName,NBQ_CONSUMER))==NULL) return(-1);
+  while((record=nbQueueLogRead(log))!=NULL){
+    if(file==NULL){
+      if(nbQueueGetFile(filename,sizeof(filename),dirname,identityName,0,NBQ_UNIQUE,'q')!=0){
+        nbQueueLogClose(log);
+        return(-1);
+        }
+      *(filename+strlen(filename)-2)='%';  // hide from consumers until complete
+      if((file=fopen(filename,"w"))==NULL){
+        outMsg(0,'E',"Unable to open %s - %s",filename,strerror(errno));
+        nbQueueLogClose(log);
+        return(-1);
+        }
+      }
+    fprintf(file,">%s\n",record);
+    records++;
+    }
+  if(file){
+    if(fflush(file)!=0 || fsync(fileno(file))<0){
+      outMsg(0,'E',"Unable to write %s - %s",filename,strerror(errno));
+      fclose(file);
+      nbQueueLogClose(log);
+      return(-1);
+      }
+    fclose(file);
+    nbQueueCommit(filename);
+    }
+  if(nbQueueLogCommit(log)<0){
+    nbQueueLogClose(log);
+    return(-1);
+    }
+  if(drop){
+    if(nbqLogScan(log->dirname,&first,&last)>0) for(segment=first;segment<=last;segment++){
+      nbqLogSegmentName(filename,sizeof(filename),log,segment);
+      unlink(filename);
+      }
+    snprintf(filename,sizeof(filename),"%s/%s",log->dirname,NBQ_LOG_OFFSET);
+    unlink(filename);
+    nbqLogDirSync(log->dirname);
+    }
+  nbQueueLogClose(log);
+  return(records);
+  }
+
+/*
+*  Move unread log records to command queue files
+*
+*    identityName: NULL for every identity directory in the log format
+*/
+int nbQueueLogUnload(char *dirname,char *identityName,int drop){
+  if(identityName) return(nbqLogUnloadIdentity(dirname,identityName,drop));
+  return(nbqLogForEach(dirname,1,drop,nbqLogUnloadIdentity));
+  }
+
+/*
+*  Process the log of every identity directory in the log format
+*
+*    Commands are issued as the originating identity.  The position is
+*    committed every NBQ_LOG_SYNC commands, so a failure may repeat a few.
+*
+*  Returns: number of commands processed
+*/
+int nbQueueLogProcess(nbCELL context,char *dirname){
+  DIR *dir;
+  struct dirent *ent;
+  struct IDENTITY *identity,*saveClientIdentity=clientIdentity;
+  struct NBQ_LOG *log;
+  char *cmd;
+  int count=0;
+
+  if((dir=opendir(dirname))==NULL){
+    outMsg(0,'E',"Unable to open %s - %s",dirname,strerror(errno));
+    return(0);
+    }
+  while((ent=readdir(dir))!=NULL){
+    if(*ent->d_name=='.' || !nbQueueLogExists(dirname,ent->d_name)) continue;
+    if((identity=getIdentity(ent->d_name))==NULL){
+      outMsg(0,'W',"Identity %s not recognized",ent->d_name);
+      continue;
+      }
+    if((log=nbQueueLogOpen(dirname,ent->d_name,NBQ_CONSUMER))==NULL) continue;
+    while((cmd=nbQueueLogRead(log))!=NULL){
+      nbCmdSid(context,cmd,1,identity);
+      count++;
+      if(log->records>=NBQ_LOG_SYNC) nbQueueLogCommit(log);
+      }
+    nbQueueLogClose(log);
+    }
+  closedir(dir);
+  clientIdentity=saveClientIdentity;
+  if(count) outFlush();
+  return(count);
+  }
+
+/*
+*  Benchmark the file and log formats
+*
+*    Records are written the way nbqStoreCmd() writes commands to a
+*    command queue file, and read back without processing them.  The
+*    directory <dirname>/<identity> is used and left empty.
+*
+*    seconds[0] - file format write    seconds[2] - log format write
+*    seconds[1] - file format read     seconds[3] - log format read
+*
+*  Returns: -1 - error, otherwise number of records lost
+*/
+int nbQueueBench(char *dirname,char *identityName,int records,double *seconds){
+  struct NBQ_HANDLE *qHandle;
+  struct NBQ_ENTRY *qEntry;
+  struct NBQ_LOG *log;
+  struct timespec t0,t1;
+  char filename[512],record[128],*cmd;
+  NBQFILE file;
+  int i,len,count=0;
+
+  if(nbQueueLogExists(dirname,identityName)){
+    outMsg(0,'E',"Benchmark directory %s/%s must not be in use",dirname,identityName);
+    return(-1);
+    }
+  if(mkdir(dirname,S_IRWXU)<0 && errno!=EEXIST) return(-1);
+  snprintf(filename,sizeof(filename),"%s/%s",dirname,identityName);
+  if(mkdir(filename,S_IRWXU)<0 && errno!=EEXIST) return(-1);
+  clock_gettime(CLOCK_MONOTONIC,&t0);
+  for(i=0;i<records;i++){
+    if(nbQueueGetFile(filename,sizeof(filename),dirname,identityName,86400,NBQ_INTERVAL,'q')!=0) return(-1);
+    if((file=nbQueueOpenFileName(filename,NBQ_WAIT,NBQ_PRODUCER))==NBQFILE_ERROR) return(-1);
+    len=snprintf(record,sizeof(record),">assert bench.a=%d,bench.b=\"record %d\";\n",i,i);
+    if(nbQueueSeekFile(file,-1)<0 || nbQueueWriteFile(file,record,len)!=len){
+      nbQueueCloseFile(file);
+      return(-1);
+      }
+    nbQueueCloseFile(file);
+    }
+  clock_gettime(CLOCK_MONOTONIC,&t1);
+  seconds[0]=(t1.tv_sec-t0.tv_sec)+(t1.tv_nsec-t0.tv_nsec)/1e9;
+  if((qHandle=nbQueueOpenDir(dirname,identityName,1))==NULL) return(-1);
+  while((qEntry=qHandle->entry)!=NULL){
+    if(nbQueueOpenFile(qHandle)>0){
+      while((cmd=nbQueueRead(qHandle))!=NULL) count++;
+      nbQueueCloseFile(qHandle->file);
+      remove(qHandle->filename);
+      }
+    qHandle->entry=qEntry->next;
+    nbFree(qEntry,sizeof(struct NBQ_ENTRY));
+    }
+  nbQueueCloseDir(qHandle);
+  clock_gettime(CLOCK_MONOTONIC,&t0);
+  seconds[1]=(t0.tv_sec-t1.tv_sec)+(t0.tv_nsec-t1.tv_nsec)/1e9;
+  snprintf(filename,sizeof(filename),"%s/%s/00000000000.000000.Q",dirname,identityName);
+  remove(filename);
+
+  if(nbQueueLogCreate(dirname,identityName)<0) return(-1);
+  clock_gettime(CLOCK_MONOTONIC,&t0);
+  if((log=nbQueueLogOpen(dirname,identityName,NBQ_PRODUCER))==NULL) return(-1);
+  for(i=0;i<records;i++){
+    len=snprintf(record,sizeof(record),"assert bench.a=%d,bench.b=\"record %d\";",i,i);
+    if(nbQueueLogWrite(log,record,len)<0) break;
+    }
+  nbQueueLogClose(log);
+  clock_gettime(CLOCK_MONOTONIC,&t1);
+  seconds[2]=(t1.tv_sec-t0.tv_sec)+(t1.tv_nsec-t0.tv_nsec)/1e9;
+  if((log=nbQueueLogOpen(dirname,identityName,NBQ_CONSUMER))==NULL) return(-1);
+  while((cmd=nbQueueLogRead(log))!=NULL){
+    count++;
+    if(log->records>=NBQ_LOG_SYNC) nbQueueLogCommit(log);
+    }
+  nbQueueLogClose(log);
+  clock_gettime(CLOCK_MONOTONIC,&t0);
+  seconds[3]=(t0.tv_sec-t1.tv_sec)+(t0.tv_nsec-t1.tv_nsec)/1e9;
+  nbQueueLogUnload(dirname,identityName,1);
+  return(records*2-count);
+  }
+
+#endif
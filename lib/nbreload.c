@@ -0,0 +1,229 @@
+/*
+* Copyright (C) 2014 Ed Trettevik <eat@nodebrain.org>
+*
+* NodeBrain is free software; you can modify and/or redistribute it under the
+* terms of either the MIT License (Expat) or the following NodeBrain License.
+*
+* Permission to use and redistribute with or without fee, in source and binary
+* forms, with or without modification, is granted free of charge to any person
+* obtaining a copy of this software and included documentation, provided that
+* the above copyright notice, this permission notice, and the following
+* disclaimer are retained with source files and reproduced in documention
+* included with source and binary distributions.
+*
+* Unless required by applicable law or agreed to in writing, this software is
+* distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+* KIND, either express or implied.
+*
+*=============================================================================
+* Program:  NodeBrain
+*
+* File:     nbreload.c
+*
+* Title:    Incremental Rule Reload Routines
+*
+* Function:
+*
+*   This file provides the "reload" command, which sources a rule file
+*   again and redefines only the terms whose definitions have changed.
+*
+* Synopsis:
+*
+*   #include "nbi.h"
+*
+*   void       nbReloadInit(NB_Stem *stem);
+*   int        nbReloadCommand(char symid,char *verb);
+*   NB_String *nbReloadText(char *cursor);
+*   int        nbReloadSame(NB_Term *term,NB_String *text);
+*   void       nbReloadRecord(NB_Term *term,NB_String *text);
+*
+* Description
+*
+*   Sourcing a changed rule file again requires "redefine" commands, and
+*   every redefinition tears down and rebuilds the subscriptions of the
+*   term, even when the definition is the same.  A node redefinition
+*   also discards the knowledge of the node.
+*
+*     reload <file>[,<term>=<cell>[,...]]
+*
+*   The reload command sources the file with the same syntax as the source
+*   command.  The first reload of a file processes every command, so a file
+*   can be loaded with reload from the start.  Later reloads of the file
+*   differ from the source command as follows.
+*
+*     1) A define or redefine command for a term with the same definition
+*        text it was last defined with is ignored.  The term keeps its
+*        value, subscriptions, and node knowledge.
+*
+*     2) A define command for a term with a different definition is
+*        processed as a redefine command.
+*
+*     3) Commands other than define, redefine, and source are ignored, so
+*        assertions that initialize state are not repeated.  Directives
+*        (%if, %include, %assert, ...) are processed as usual.
+*
+*   Only definitions in a reloaded file are recorded, so other define
+*   commands, including those issued by rule actions, pay nothing for this
+*   feature.  A successful definition records its normalized text (the
+*   command after the term identifier, with white space outside of quotes
+*   reduced to a single space and the trailing ';' removed) as an interned
+*   string on the term itself.  The text is dropped when the term is
+*   assigned, redefined or destroyed, so a term that has since been changed
+*   is defined again, and a definition is considered unchanged when the
+*   interned text matches.
+*
+*   Terms that are no longer defined by a reloaded file are not undefined.
+*   Use the undefine command for that.
+*
+*=============================================================================
+* Change History:
+*
+*    Date    Name/Change
+* ---------- -----------------------------------------------------------------
+* 2026-10-18 eat 0.9.04 (original prototype)
+* 2026-10-18 eat 0.9.04 Record definition text on the term and only while reloading
+*            A file is processed like a source command the first time it is
+*            reloaded.
+*=============================================================================
+*/
+#include <nb/nbi.h>
+
+NB_Reload *nb_reload=NULL;     // active reload
+int        nb_reloadLine=0;    // next nbCmd() call is a line of a reloaded file
+int        nb_reloadDefine=0;  // next nbCmdDefine() call is a reloaded definition
+
+static NB_TreeNode *nb_reloadFileTree=NULL;  // files that have been reloaded
+
+/*
+*  Normalize definition text and return a grabbed string object
+*/
+NB_String *nbReloadText(char *cursor){
+  static char buffer[NB_BUFSIZE];
+  char *bufcur=buffer,*bufend=buffer+sizeof(buffer)-1;
+  int quoted=0;
+
+  while(*cursor==' ' || *cursor=='\t') cursor++;
+  while(*cursor && *cursor!='\n' && bufcur<bufend){
+    if(*cursor=='"') quoted=!quoted;
+    if(!quoted && (*cursor==' ' || *cursor=='\t')){
+      while(*(cursor+1)==' ' || *(cursor+1)=='\t') cursor++;
+      *bufcur=' ';
+      }
+    else *bufcur=*cursor;
+    bufcur++;
+    cursor++;
+    }
+  while(bufcur>buffer && *(bufcur-1)==' ') bufcur--;
+  if(bufcur>buffer && *(bufcur-1)==';') bufcur--;
+  while(bufcur>buffer && *(bufcur-1)==' ') bufcur--;
+  *bufcur=0;
+  return((NB_String *)grabObject(useString(buffer)));
+  }
+
+/*
+*  Compare a reloaded definition with the recorded definition of a term
+*
+*  Returns: 1 - same definition, 0 - new or changed definition
+*/
+int nbReloadSame(NB_Term *term,NB_String *text){
+  if(term==NULL || term->def==nb_Undefined){
+    nb_reload->added++;
+    return(0);
+    }
+  // A definition that is still Unknown may since have become an implicit node
+  if(term->reload==text && term->def!=nb_Unknown){
+    nb_reload->unchanged++;
+    return(1);
+    }
+  nb_reload->changed++;
+  return(0);
+  }
+
+/*
+*  Record the definition text of a term
+*/
+void nbReloadRecord(NB_Term *term,NB_String *text){
+  if(term->reload) dropObject(term->reload);
+  term->reload=grabObject(text);
+  }
+
+/*
+*  Mark a file as reloaded
+*
+*    The file name is taken from the reload command the same way nbSource()
+*    takes it, without the assertions that follow.
+*
+*  Returns: 1 - reloaded before, 0 - first reload
+*/
+static int nbReloadMark(char *cursor){
+  char filename[256],*fcursor;
+  NB_TreeNode *node;
+  NB_TreePath path;
+  nbCELL key;
+
+  if(*cursor=='"'){
+    cursor++;
+    for(fcursor=filename;*cursor!='"' && *cursor!=0 && fcursor<filename+sizeof(filename)-1;fcursor++) *fcursor=*cursor,cursor++;
+    }
+  else for(fcursor=filename;*cursor!=' ' && *cursor!=0 && *cursor!=';' && *cursor!=',' && fcursor<filename+sizeof(filename)-1;fcursor++) *fcursor=*cursor,cursor++;
+  *fcursor=0;
+  key=grabObject(useString(filename));
+  if(nbTreeLocate(&path,key,&nb_reloadFileTree)!=NULL){
+    dropObject(key);
+    return(1);
+    }
+  node=nbAlloc(sizeof(NB_TreeNode));
+  node->left=NULL;
+  node->right=NULL;
+  node->key=key;
+  nbTreeInsert(&path,node);
+  return(0);
+  }
+
+/*
+*  Filter a line of a reloaded file
+*
+*  Returns: 1 - interpret the command, 0 - skip it
+*/
+int nbReloadCommand(char symid,char *verb){
+  if(symid=='t' && (strcmp(verb,"define")==0 || strcmp(verb,"redefine")==0)){
+    nb_reloadDefine=1;
+    return(1);
+    }
+  if(nb_reload->first || symid=='#') return(1);
+  if(symid=='t' && strcmp(verb,"source")==0) return(1);
+  nb_reload->skipped++;
+  return(0);
+  }
+
+/*
+*  Command
+*
+*    reload <file>[,<term>=<cell>[,...]]
+*/
+static int nbReloadCmd(nbCELL context,void *handle,char *verb,char *cursor){
+  NB_Reload reload,*reloadSave=nb_reload;
+
+  if(!(clientIdentity->authority&AUTH_DEFINE)){
+    outMsg(0,'E',"Identity \"%s\" not authorized to reload rules.",clientIdentity->name->value);
+    return(1);
+    }
+  while(*cursor==' ') cursor++;
+  if(*cursor==0 || *cursor==';'){
+    outMsg(0,'E',"Expecting file name.");
+    return(1);
+    }
+  memset(&reload,0,sizeof(reload));
+  reload.first=!nbReloadMark(cursor);
+  nb_reload=&reload;
+  nbSource(context,0,cursor);
+  nb_reload=reloadSave;
+  outMsg(0,'I',"Reload: %lu unchanged, %lu changed, %lu added, %lu other commands skipped.",
+    reload.unchanged,reload.changed,reload.added,reload.skipped);
+  return(0);
+  }
+
+void nbReloadInit(NB_Stem *stem){
+  nbCELL context=(nbCELL)stem->verbs;
+  nbVerbDeclare(context,"reload",AUTH_DEFINE,0,stem,&nbReloadCmd,"<file>,<term>=<cell>[,...]");
+  }
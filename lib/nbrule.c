@@ -62,6 +62,10 @@
 *            and firing to create an endless loop in the list of actions
 *            associated with a node.  This has been fixed in destroyAction.
 *            Reference: Defect #8 - Corrupted Action List Loop
+* 2026-10-18 eat 0.9.04 Commands issued by rules are excluded from event capture
+* 2026-10-18 eat 0.9.04 Included nbRuleReactQuietly for checkpoint restore
+* 2026-10-18 eat 0.9.04 Count rule firings and react cycles for metrics
+* 2026-10-18 eat 0.9.04 Time rule actions and the wait from event start to firing
 *=============================================================================
 */
 #include <nb/nbi.h>
@@ -799,7 +803,11 @@ void nbRuleAct(struct ACTION *action){
   int  savetrace=trace;
   char cmdopt;
   
+  unsigned long long start;
+
   action->status='P';
+  nb_metricFirings.value++;
+  start=nb_latencyEvent ? nbLatencyObserve(NB_LATENCY_FIRE,nb_latencyEvent) : nbLatencyNow();
   // 2014-11-08 eat - need to move action options out of cmdopt
   //    and consider if all instructions should have a common options operand
   /* action can suppress sumbolic substition - context determines command echo option */
@@ -864,6 +872,7 @@ void nbRuleAct(struct ACTION *action){
   if(cond!=NULL && cond->cell.object.type==condTypeWhenRule) nbTermUndefine(action->term);
   trace=savetrace;
   action->status='A';
+  nbLatencyObserve(NB_LATENCY_RULE,start);
   }
 
 /*
@@ -877,7 +886,10 @@ void nbRuleReact(void){
   struct ACTION *action,*nextact;
   NB_Rule *rule,*ready;
   NB_Term *symContextSave;
+  unsigned long long start;
 
+  nb_captureHold++;  // 2026-10-18 eat - rule action commands are not captured
+  nb_metricReacts.value++;
   nbCellReact();
 
   if((action=actList)!=NULL){
@@ -913,7 +925,10 @@ void nbRuleReact(void){
         symContextSave=symContext;
         symContext=rule->localContext;
         outMsg(0,'T',"Rule %.8x.%.3d fired.",rule,rule->id);
+        nb_metricFirings.value++;
+        start=nb_latencyEvent ? nbLatencyObserve(NB_LATENCY_FIRE,nb_latencyEvent) : nbLatencyNow();
         nbCmdSid((nbCELL)rule->homeContext,rule->command->value,1,rule->identity);
+        nbLatencyObserve(NB_LATENCY_RULE,start);
         symContext=symContextSave;
         rule->command=NULL;
         }
@@ -928,6 +943,41 @@ void nbRuleReact(void){
       rule->cell.object.type->eval(rule);
       }
     }
+  nb_captureHold--;
+  }
+
+/*
+*  React to state changes without firing rules
+*
+*    This is used after a checkpoint is restored.  Cells are brought up to
+*    date with the restored values, but rules that would fire in response
+*    have already fired before the checkpoint was written.
+*/
+void nbRuleReactQuietly(void){
+  struct ACTION *action,*nextact;
+  NB_Rule *rule,*ready;
+
+  nbCellReact();
+  if((action=actList)!=NULL){
+    actList=NULL;
+    for(;action!=NULL;action=nextact){
+      nextact=action->nextAct;
+      action->nextAct=ashList;  // move to the ash list without acting
+      ashList=action;
+      }
+    nbRuleDouse();
+    }
+  if((ready=nb_RuleReady)!=NULL){
+    nb_RuleReady=NULL;
+    for(rule=ready;rule!=NULL;rule=rule->nextReady){
+      rule->assertions=NULL;
+      rule->command=NULL;
+      }
+    for(rule=ready;rule!=NULL;rule=rule->nextReady){
+      rule->state=NB_RuleStateRunning;
+      rule->cell.object.type->eval(rule);
+      }
+    }
   }
 
 /*
@@ -123,6 +123,7 @@
 * 2012-12-31 eat 0.8.13 schedInit n from int to size_t
 * 2014-01-12 eat 0.9.00 nbSchedInit replaces schedInit
 * 2014-05-04 eat 0.9.02 Replaced newType with nbObjectType
+* 2026-10-18 eat 0.9.04 Reused schedules share time condition queues by normalized expression
 *=============================================================================
 */
 #include <nb/nbi.h>
@@ -226,7 +227,8 @@ struct SCHED *newSched(nbCELL context,char symid,char *source,char **delim,char
       return(NULL);
       }
     domainBegin=tcTime();
-    queue=tcQueueNew(tcdef,domainBegin,domainBegin+60);
+    if(reuse) queue=tcQueueShare(tcdef,source,cursor-source,domainBegin,domainBegin+60);  // 2026-10-18 eat 0.9.04
+    else queue=tcQueueNew(tcdef,domainBegin,domainBegin+60);
     }
   else{  /* Pulse or Delay schedule */
     if(trace) fprintf(stderr,"NB000T Assuming pulse schedule.\n");
@@ -568,6 +568,8 @@ void daemonize(){
   fflush(NULL);
   if(ppid!=1){
     sighandler=signal(SIGHUP,SIG_IGN);
+    // 2026-10-18 eat 0.9.04 - the daemon continues as this agent, so it keeps
+    // SIGCHLD blocked and reads it from the medulla's signalfd
     pid = fork();
     if(pid > 0)  exit(0);                /* parent */
     if(pid < 0){
@@ -0,0 +1,378 @@
+/*
+* Copyright (C) 2014 Ed Trettevik <eat@nodebrain.org>
+*
+* NodeBrain is free software; you can modify and/or redistribute it under the
+* terms of either the MIT License (Expat) or the following NodeBrain License.
+*
+* Permission to use and redistribute with or without fee, in source and binary
+* forms, with or without modification, is granted free of charge to any person
+* obtaining a copy of this software and included documentation, provided that
+* the above copyright notice, this permission notice, and the following
+* disclaimer are retained with source files and reproduced in documention
+* included with source and binary distributions.
+*
+* Unless required by applicable law or agreed to in writing, this software is
+* distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+* KIND, either express or implied.
+*
+*=============================================================================
+* Program:  NodeBrain
+*
+* File:     nbshard.c
+*
+* Title:    Shard Routines
+*
+* Function:
+*
+*   This file provides the "shard" command, which partitions independent
+*   rule sets of one agent across processor cores.
+*
+* Synopsis:
+*
+*   #include "nbi.h"
+*
+*   void nbShardInit(NB_Stem *stem);
+*   void nbShardStop(void);
+*
+* Description
+*
+*   The interpreter is single threaded by design.  The glossaries, the
+*   cell hashes that make cells shared, the rule and timer queues, the
+*   evaluation state, and the memory free lists are all process wide, and
+*   every object is reference counted without locks.  Rather than threading
+*   all of that through a context structure, a shard is a forked copy of
+*   the agent that serves its own rule file.  The shards of an agent share
+*   nothing but a table in shared memory that gives each shard an inbox.
+*
+*     shard <name> <file>[,<term>=<cell>[,...]]   - start a shard
+*     shard <name>:<command>                      - send a command to a shard
+*     shard                                       - list shards
+*
+*   A shard starts with a copy of the agent as it was when the shard
+*   command was issued, so shards should be started at the top of the
+*   startup script, before listeners and rules of the main agent are
+*   defined.  Common definitions (macros, calendars, translators) defined
+*   before the shard commands are inherited by every shard.  The shard
+*   then sources the named file, starts the listeners it defines, and
+*   serves until the main agent stops.
+*
+*   The name "main" addresses the agent that started the shards, so a rule
+*   in a shard can report back to it.
+*
+*     shard alerts:assert host="goofy",severity=3;
+*     shard main:alert type="summary",count=42;
+*
+*   Inbox:
+*
+*   Each inbox is a ring of variable length records.  Any number of
+*   processes may send, and only the owner receives.  A sender reserves
+*   space by advancing the reserve position with a compare-and-swap,
+*   copies the command, and then publishes the record by setting its
+*   state.  A record never wraps: when it doesn't fit at the end of the
+*   ring, the sender pads to the end first.  The receiver takes records in
+*   order until it reaches one that has not been published, clearing each
+*   before advancing the tail so a header read later is never stale.  When
+*   the inbox is full the command is dropped and counted.  A command is
+*   limited to NB_BUFSIZE bytes, like a command read from a source file, so
+*   the receiver can copy it out of the ring whole.
+*
+*   The receiver sleeps in the medulla like any other listener.  A sender
+*   writes a byte to a wake pipe only when it is the first to set the wake
+*   flag since the receiver last cleared it, so a burst of commands costs
+*   one system call.  The wake pipes are created with the table so their
+*   descriptors are the same in every shard.
+*
+*   Shards are supported on Unix and Linux only.
+*
+*=============================================================================
+* Change History:
+*
+*    Date    Name/Change
+* ---------- -----------------------------------------------------------------
+* 2026-10-18 eat 0.9.04 (original prototype)
+* 2026-10-18 eat 0.9.04 Give each shard its own medulla post queue
+* 2026-10-18 eat 0.9.04 Limit commands to the size the receiver accepts
+*=============================================================================
+*/
+#include <nb/nbi.h>
+#if !defined(WIN32)
+#include <sys/mman.h>
+#endif
+
+NB_ShardTable *nb_shardTable=NULL;  // shared shard table
+int            nb_shardSelf=0;      // index of this process in the shard table
+
+#if !defined(WIN32)
+
+/*
+*  Create the shard table in shared memory
+*/
+static int nbShardTableCreate(void){
+  NB_ShardTable *table;
+  NB_Shard *shard;
+  int fd[2],i;
+
+  table=mmap(NULL,sizeof(NB_ShardTable),PROT_READ|PROT_WRITE,MAP_SHARED|MAP_ANONYMOUS,-1,0);
+  if(table==MAP_FAILED){
+    outMsg(0,'E',"Unable to map shard table - %s",strerror(errno));
+    return(1);
+    }
+  memset(table,0,sizeof(NB_ShardTable));
+  for(i=0;i<NB_SHARD_MAX;i++){
+    shard=&table->shard[i];
+    if(pipe(fd)<0){
+      outMsg(0,'E',"Unable to create shard wake pipe - %s",strerror(errno));
+      while(i>0){
+        i--;
+        close(table->shard[i].wakeRead);
+        close(table->shard[i].wakeWrite);
+        }
+      munmap(table,sizeof(NB_ShardTable));
+      return(1);
+      }
+    fcntl(fd[0],F_SETFL,O_NONBLOCK);
+    fcntl(fd[1],F_SETFL,O_NONBLOCK);
+    fcntl(fd[0],F_SETFD,FD_CLOEXEC);
+    fcntl(fd[1],F_SETFD,FD_CLOEXEC);
+    shard->wakeRead=fd[0];
+    shard->wakeWrite=fd[1];
+    }
+  strcpy(table->shard[0].name,"main");
+  table->shard[0].pid=getpid();
+  table->count=1;
+  nb_shardTable=table;
+  return(0);
+  }
+
+static NB_Shard *nbShardFind(char *name){
+  int i;
+
+  if(!nb_shardTable) return(NULL);
+  for(i=0;i<nb_shardTable->count;i++)
+    if(strcmp(nb_shardTable->shard[i].name,name)==0) return(&nb_shardTable->shard[i]);
+  return(NULL);
+  }
+
+/*
+*  Send a command to a shard inbox
+*/
+static int nbShardSend(NB_Shard *shard,char *command){
+  NB_ShardRecord *record;
+  size_t len=strlen(command)+1;
+  unsigned long long pos,need,size,offset;
+
+  if(len>NB_BUFSIZE){
+    outMsg(0,'E',"Command too long to send to shard \"%s\" - limit is %d bytes.",shard->name,NB_BUFSIZE-1);
+    return(1);
+    }
+  size=(sizeof(NB_ShardRecord)+len+7)&~(unsigned long long)7;
+  do{
+    pos=shard->reserve;
+    offset=pos&(NB_SHARD_RING_SIZE-1);
+    need=size;
+    if(offset+size>NB_SHARD_RING_SIZE) need+=NB_SHARD_RING_SIZE-offset;  // pad to end of ring
+    if(pos+need-shard->tail>NB_SHARD_RING_SIZE){
+      __sync_fetch_and_add(&shard->dropped,1);
+      outMsg(0,'E',"Shard \"%s\" inbox is full - command dropped.",shard->name);
+      return(1);
+      }
+    }while(!__sync_bool_compare_and_swap(&shard->reserve,pos,pos+need));
+  if(need>size){
+    record=(NB_ShardRecord *)(shard->data+offset);
+    record->len=NB_SHARD_RING_SIZE-offset;
+    __sync_synchronize();
+    record->state=NB_SHARD_RECORD_PAD;
+    offset=0;
+    }
+  record=(NB_ShardRecord *)(shard->data+offset);
+  record->len=size;
+  memcpy((char *)(record+1),command,len);
+  __sync_synchronize();
+  record->state=NB_SHARD_RECORD_READY;
+  if(__sync_bool_compare_and_swap(&shard->wake,0,1)){
+    if(write(shard->wakeWrite,"",1)<0 && errno!=EAGAIN)
+      outMsg(0,'E',"Unable to wake shard \"%s\" - %s",shard->name,strerror(errno));
+    }
+  return(0);
+  }
+
+/*
+*  Receive commands from our inbox
+*/
+static void nbShardReader(nbCELL context,int fildes,void *session){
+  NB_Shard *shard=(NB_Shard *)session;
+  NB_ShardRecord *record;
+  char buffer[NB_BUFSIZE];
+  unsigned long long pos;
+  unsigned int len,state;
+
+  while(read(fildes,buffer,sizeof(buffer))>0);
+  shard->wake=0;
+  __sync_synchronize();
+  while(1){
+    pos=shard->tail;
+    record=(NB_ShardRecord *)(shard->data+(pos&(NB_SHARD_RING_SIZE-1)));
+    if((state=record->state)==NB_SHARD_RECORD_FREE) break;
+    __sync_synchronize();
+    len=record->len;
+    if(state==NB_SHARD_RECORD_READY){
+      strncpy(buffer,(char *)(record+1),sizeof(buffer)-1);
+      *(buffer+sizeof(buffer)-1)=0;
+      }
+    else *buffer=0;
+    memset(record,0,len);
+    __sync_synchronize();
+    shard->tail=pos+len;
+    if(*buffer){
+      shard->received++;
+      nbCmd(context,buffer,1);
+      }
+    }
+  }
+
+/*
+*  Start a shard
+*/
+static int nbShardStart(nbCELL context,char *name,char *cursor){
+  NB_Shard *shard;
+  int pid;
+
+  if(nb_shardSelf!=0){
+    outMsg(0,'E',"A shard may not start other shards.");
+    return(1);
+    }
+  if(!nb_shardTable){
+    if(nbShardTableCreate()) return(1);
+    nbListenerAdd(context,nb_shardTable->shard[0].wakeRead,&nb_shardTable->shard[0],nbShardReader);
+    }
+  if(nbShardFind(name)){
+    outMsg(0,'E',"Shard \"%s\" already defined.",name);
+    return(1);
+    }
+  if(nb_shardTable->count>=NB_SHARD_MAX){
+    outMsg(0,'E',"Shard limit of %d reached.",NB_SHARD_MAX-1);
+    return(1);
+    }
+  shard=&nb_shardTable->shard[nb_shardTable->count];
+  strcpy(shard->name,name);
+  nb_shardTable->count++;  // visible to the new shard
+  outFlush();
+  fflush(NULL);
+  if((pid=fork())<0){
+    outMsg(0,'E',"Unable to fork shard \"%s\" - %s",name,strerror(errno));
+    nb_shardTable->count--;
+    *shard->name=0;
+    return(1);
+    }
+  if(pid>0){
+    shard->pid=pid;
+    outMsg(0,'I',"Shard \"%s\" started - pid %d",name,pid);
+    return(0);
+    }
+  // shard process
+  nb_shardSelf=shard-nb_shardTable->shard;
+  shard->pid=getpid();
+  nbListenerRemove(context,nb_shardTable->shard[0].wakeRead);
+  nbListenerAdd((nbCELL)rootGloss,shard->wakeRead,shard,nbShardReader);
+  nbMedullaPostFork();  // 2026-10-18 eat 0.9.04 - don't share worker wakeups with the agent
+  *nb_checkpointName=0;  // the main agent owns the checkpoint and capture files
+  nb_capture=NULL;
+  nb_opt_prompt=0;
+  agent=1;
+  nbSource((nbCELL)rootGloss,0,cursor);
+  nbListenerStart((nbCELL)rootGloss);
+  exit(nbStop((nbCELL)rootGloss));
+  }
+
+static void nbShardShow(void){
+  NB_Shard *shard;
+  int i;
+
+  if(!nb_shardTable){
+    outPut("No shards defined.\n");
+    return;
+    }
+  outPut("Shard            Pid     Received    Dropped     Queued\n");
+  outPut("---------------- ------- ----------- ----------- -----------\n");
+  for(i=0;i<nb_shardTable->count;i++){
+    shard=&nb_shardTable->shard[i];
+    outPut("%-16s %7d %11llu %11llu %11llu%s\n",shard->name,shard->pid,shard->received,
+      shard->dropped,shard->reserve-shard->tail,i==nb_shardSelf ? " *" : "");
+    }
+  }
+
+/*
+*  Stop the shards we started
+*/
+void nbShardStop(void){
+  int i;
+
+  if(!nb_shardTable || nb_shardSelf!=0) return;
+  for(i=1;i<nb_shardTable->count;i++){
+    if(nb_shardTable->shard[i].pid>0) kill(nb_shardTable->shard[i].pid,SIGTERM);
+    }
+  }
+
+#else
+
+void nbShardStop(void){
+  }
+
+#endif
+
+/*
+*  Command
+*
+*    shard <name> <file>[,<term>=<cell>[,...]]
+*    shard <name>:<command>
+*    shard
+*/
+static int nbShardCmd(nbCELL context,void *handle,char *verb,char *cursor){
+  char name[256],symid,*cursave;
+
+  if(!(clientIdentity->authority&AUTH_CONTROL)){
+    outMsg(0,'E',"Identity \"%s\" not authorized to %s.",clientIdentity->name->value,verb);
+    return(1);
+    }
+#if defined(WIN32)
+  outMsg(0,'E',"Shards are not supported on Windows.");
+  return(1);
+#else
+  while(*cursor==' ') cursor++;
+  if(*cursor==0 || *cursor==';'){
+    nbShardShow();
+    return(0);
+    }
+  cursave=cursor;
+  symid=nbParseSymbol(name,sizeof(name),&cursor);
+  if(symid!='t' || strchr(name,'.')){
+    outMsg(0,'E',"Expecting shard name at \"%s\"",cursave);
+    return(1);
+    }
+  if(strlen(name)>=NB_SHARD_NAME_SIZE){
+    outMsg(0,'E',"Shard name may not exceed %d characters.",NB_SHARD_NAME_SIZE-1);
+    return(1);
+    }
+  if(*cursor==':'){
+    NB_Shard *shard;
+    cursor++;
+    while(*cursor==' ') cursor++;
+    if((shard=nbShardFind(name))==NULL){
+      outMsg(0,'E',"Shard \"%s\" not defined.",name);
+      return(1);
+      }
+    return(nbShardSend(shard,cursor));
+    }
+  while(*cursor==' ') cursor++;
+  if(*cursor==0 || *cursor==';'){
+    outMsg(0,'E',"Expecting file name or ':' at \"%s\"",cursor);
+    return(1);
+    }
+  return(nbShardStart(context,name,cursor));
+#endif
+  }
+
+void nbShardInit(NB_Stem *stem){
+  nbCELL context=(nbCELL)stem->verbs;
+  nbVerbDeclare(context,"shard",AUTH_CONTROL,0,stem,&nbShardCmd,"[<name> (<file>[,<term>=<cell>[,...]] | :<command>)]");
+  }
@@ -45,10 +45,15 @@
 *              3) A given file will only source once in a session.
 * 2013-05-25 eat 0.8.15 Fixed overlapping strcpy bug
 * 2014-01-31 eat 0.9.00 glossary back to hash and double link IF rule list
+* 2026-10-18 eat 0.9.04 Record sourced commands when building a rule image
+* 2026-10-18 eat 0.9.04 Flag lines of a reloaded file - see nbreload.c
+* 2026-10-18 eat 0.9.04 Only check lines of the outer file of a check script
 *=============================================================================
 */
 #include <nb/nbi.h>
 
+static int nbSourceCheckDepth=0;  // nested source depth within a check script
+
 /*
 *  Get a line from a source file
 *
@@ -257,7 +262,8 @@ int nbSourceTil(nbCELL context,FILE *file){
   //while(fgets(bufin,NB_BUFSIZE,file)!=NULL){
   while(nbSourceGet(bufin,NB_BUFSIZE,file)!=NULL){
     /* When we're not in check mode ignore check command "~" */
-    if((nb_mode_check==0 && *bufin!='~') || (nb_mode_check && outCheck(NB_CHECK_LINE,bufin))){
+    /* Files sourced by a check script are not check scripts, so their output is checked by the outer file */
+    if(((nb_mode_check==0 || nbSourceCheckDepth>1) && *bufin!='~') || (nb_mode_check && nbSourceCheckDepth<=1 && outCheck(NB_CHECK_LINE,bufin))){
       if(sourceTrace) outPut("] %s",bufin);
       buf=bufin;
       while(*buf==' ') buf++;
@@ -278,9 +284,11 @@ int nbSourceTil(nbCELL context,FILE *file){
           else if(strcmp(ident,"elseif")==0) return(3);
           else if(strcmp(ident,"if")==0) nbSourceIf(context,file,buf,cursor);
           else if(strcmp(ident,"assert")==0){
+            nbImageLet(cursor,0);
             if(nbLet(cursor,symContext,0)!=0) return(-1);
             }
           else if(strcmp(ident,"default")==0){
+            nbImageLet(cursor,1);
             if(nbLet(cursor,symContext,1)!=0) return(-1);
             }
           else if(strcmp(ident,"use")==0) nbSource((nbCELL)rootGloss,1,cursor);
@@ -298,6 +306,8 @@ int nbSourceTil(nbCELL context,FILE *file){
       else{
         // 2009-01-31 eat - uncommented
         if(!nb_ClockAlerting) nbClockAlert();
+        if(nb_image && nb_image->recording) nb_imageLine=1;  // record line for rule image
+        if(nb_reload) nb_reloadLine=1;                       // filter line for reload
         nbCmd((NB_Cell *)context,buf,1);
         }
       }
@@ -407,16 +417,18 @@ void nbSource(nbCELL context,int option,char *cursor){
     else if((file=fopen(filename,"r"))==NULL)
       outMsg(0,'E',"Source file \"%s\" not found.",filename);
     else{
-      if(nb_mode_check) outCheck(NB_CHECK_START,filename);
+      if(nb_mode_check && nbSourceCheckDepth++==0) outCheck(NB_CHECK_START,filename);
+      nbImageSource(filename,*cursor==',' ? cursor+1 : "");
       if(nbSourceTil(context,file)!=0){
-        if(nb_mode_check) outCheck(NB_CHECK_STOP,NULL);
+        if(nb_mode_check && --nbSourceCheckDepth==0) outCheck(NB_CHECK_STOP,NULL);
         outMsg(0,'E',"Source file \"%s\" terminated with errors.",filename);
         }
       else{
-        if(nb_mode_check) outCheck(NB_CHECK_STOP,NULL);
+        if(nb_mode_check && --nbSourceCheckDepth==0) outCheck(NB_CHECK_STOP,NULL);
         fileloc=ftell(file);
         outMsg(0,'I',"Source file \"%s\" included. size=%u",filename,fileloc);
         }
+      nbImageSourceEnd();
       fclose(file);
       }
     }
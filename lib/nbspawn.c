@@ -33,6 +33,7 @@
 *
 *   void nbSpawnChild(nbCELL context,int options,char *command)
 *   void nbSpawnSkull(nbCELL context,char *command)
+*   void nbSpawnPool(int max)
 * 
 *
 * Description
@@ -93,6 +94,7 @@
 * 2012-12-25 eat 0.8.13 Noting that prior change also fixed AST 42
 * 2013-01-01 eat 0.8.13 Checker updates
 * 2013-01-12 eat 0.8.13 Checker updates
+* 2026-10-18 eat 0.9.04 Included pooled servants for "=" commands - see nbSpawnPool()
 *=============================================================================
 */
 #include <nb/nbi.h>
@@ -119,6 +121,121 @@ int nbLogMsgReader(nbPROCESS process,int pid,void *session,char *msg){
   return(0);
   }
 
+/*
+*  Pooled servants
+*
+*    When "set servantPool=<n>" is greater than zero, plain asynchronous
+*    shell commands (=<command> with no user, output or program prefix) are
+*    written to the stdin of up to <n> long-lived shell processes instead of
+*    starting a new child for each command.  A pooled servant runs one command
+*    at a time with stdin, stdout and stderr on /dev/null, as a spawned "="
+*    command would have, and then writes the exit code to stdout where we
+*    read it to report completion.  An empty line asks a servant to end.
+*/
+struct NB_SPAWN_SERVANT{
+  struct NB_SPAWN_SERVANT *next;
+  nbPROCESS process;
+  int pending;                 // commands sent and not yet completed
+  };
+
+static struct NB_SPAWN_SERVANT *nb_spawn_pool=NULL;
+static int nb_spawn_pool_count=0;
+static int nb_spawn_pool_max=0;
+
+static char *nb_spawn_pool_cmd="|=:while read -r nb_cmd && test -n \"$nb_cmd\"; do (eval \"$nb_cmd\") </dev/null >/dev/null 2>&1; echo $?; done";
+
+static int nbSpawnPoolProducer(nbPROCESS process,int pid,void *session){
+  return(0);  // commands are queued by nbMedullaProcessPut
+  }
+
+static int nbSpawnPoolConsumer(nbPROCESS process,int pid,void *session,char *msg){
+  struct NB_SPAWN_SERVANT *servant=(struct NB_SPAWN_SERVANT *)session;
+
+  if(servant->pending>0) servant->pending--;
+  outMsg(0,'I',"[%d] Exit(%d)",nb_mode_check ? 0:pid,atoi(msg));
+  return(0);
+  }
+
+static int nbSpawnPoolCloser(nbPROCESS process,int pid,void *session){
+  struct NB_SPAWN_SERVANT *servant=(struct NB_SPAWN_SERVANT *)session,**servantP;
+
+  if(servant->pending) outMsg(0,'E',"[%d] Pooled servant ended with %d commands pending",nb_mode_check ? 0:pid,servant->pending);
+  for(servantP=&nb_spawn_pool;*servantP!=NULL && *servantP!=servant;servantP=&(*servantP)->next);
+  if(*servantP!=NULL){
+    *servantP=servant->next;
+    nb_spawn_pool_count--;
+    }
+  nbFree(servant,sizeof(struct NB_SPAWN_SERVANT));
+  return(0);
+  }
+
+/*
+*  Set the maximum number of pooled servants
+*
+*    Servants above the new maximum finish the commands they have and end.
+*/
+void nbSpawnPool(int max){
+  struct NB_SPAWN_SERVANT *servant;
+
+  if(max<0) max=0;
+  nb_spawn_pool_max=max;
+  while(nb_spawn_pool_count>max && (servant=nb_spawn_pool)!=NULL){
+    nb_spawn_pool=servant->next;
+    nb_spawn_pool_count--;
+    nbMedullaProcessPut(servant->process,"\n");
+    }
+  }
+
+/*
+*  Send a command to the least busy pooled servant
+*
+*    A new servant is started when all are busy and the pool is not full.
+*
+* Returns:
+*   0   - error
+*   PID - Process number of the servant
+*/
+static int nbSpawnPoolPut(char *command){
+  struct NB_SPAWN_SERVANT *servant,*least=NULL;
+  char buffer[NB_BUFSIZE],msg[NB_MSGSIZE];
+  int pid;
+
+  if(strlen(command)>=sizeof(buffer)-1){
+    outMsg(0,'E',"Command too long for pooled servant buffer");
+    return(0);
+    }
+  for(servant=nb_spawn_pool;servant!=NULL;servant=servant->next){
+    if(nbMedullaProcessStatus(servant->process)&NB_MEDULLA_PROCESS_STATUS_ENDED) continue;
+    if(least==NULL || servant->pending<least->pending) least=servant;
+    }
+  if(least==NULL || (least->pending && nb_spawn_pool_count<nb_spawn_pool_max)){
+    servant=nbAlloc(sizeof(struct NB_SPAWN_SERVANT));
+    memset(servant,0,sizeof(struct NB_SPAWN_SERVANT));
+    servant->process=nbMedullaProcessOpen(0,nb_spawn_pool_cmd,NULL,servant,nbSpawnPoolCloser,nbSpawnPoolProducer,nbSpawnPoolConsumer,NULL,msg,sizeof(msg));
+    if(servant->process==NULL){
+      nbFree(servant,sizeof(struct NB_SPAWN_SERVANT));
+      if(least==NULL){
+        outMsg(0,'E',"%s",msg);
+        return(0);
+        }
+      }
+    else{
+      servant->next=nb_spawn_pool;
+      nb_spawn_pool=servant;
+      nb_spawn_pool_count++;
+      least=servant;
+      outMsg(0,'I',"[%d] Started pooled servant",nb_mode_check ? 0:nbMedullaProcessPid(servant->process));
+      }
+    }
+  sprintf(buffer,"%s\n",command);
+  nbMedullaProcessPut(least->process,buffer);
+  least->pending++;
+  pid=nbMedullaProcessPid(least->process);
+  outMsg(0,'I',"[%d] Started: =%s",nb_mode_check ? 0:pid,command);
+  outFlush();
+  return(pid);
+  }
+
 //
 
 //#if defined(WIN32)
@@ -132,6 +249,7 @@ int nbSpawnChild(nbCELL context,int options,char *cursor){
   char *outdir=outDirName(NULL);
   nbPROCESS process;
   static unsigned short childwrap=0;
+  char *command;
 
   if(!(clientIdentity->authority&AUTH_SYSTEM)){
     outMsg(0,'E',"Identity \"%s\" does not have system authority.",clientIdentity->name->value);
@@ -150,6 +268,15 @@ int nbSpawnChild(nbCELL context,int options,char *cursor){
   // or perhaps it should be done at the command intepreter to cover all commands
   // We have to decide if we want special controls on the system commands
   
+  if(nb_spawn_pool_max>0 && options==0){  // 2026-10-18 eat 0.9.04 - plain "=" commands go to pooled servants
+    command=cursor;
+    while(*command==' ') command++;
+    if(*command=='='){
+      command++;
+      while(*command==' ') command++;
+      if(*command && !strchr("[!|%>:$@",*command)) return(nbSpawnPoolPut(command));
+      }
+    }
   childwrap=(childwrap+1)%1000; 
   snprintf(outname,sizeof(outname),"%sservant.%.10u.%.5u.%.3u.out",outdir,(unsigned int)time(NULL),getpid(),childwrap); // 2013-01-12 eat - VID 6544-0.8.13-2
   process=nbMedullaProcessOpen(options,cursor,outname,(NB_Term *)context,NULL,NULL,nbCmdMsgReader,nbLogMsgReader,msg,sizeof(msg));
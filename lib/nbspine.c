@@ -52,9 +52,21 @@
 * 2012-10-13 eat 0.8.12 Switched to nb header
 * 2012-12-27 eat 0.8.13 Checker updates
 * 2013-01-01 eat 0.8.13 Checker updates
+* 2026-10-18 eat 0.9.04 Used posix_spawn in nbChildOpen when the child needs no setuid or signal setup
+*            that only a forked child can do.  The fork path remains for those cases.
+* 2026-10-18 eat 0.9.04 Unblocked SIGCHLD in children because the medulla may block it
 *=============================================================================
 */
+#if defined(WIN32)
+#include <nbcfgw.h>
+#else
+#define _GNU_SOURCE      // 2026-10-18 eat 0.9.04 - posix_spawn_file_actions_addclosefrom_np and POSIX_SPAWN_SETSID
+#include "../config.h"
+#endif
 #include <nb/nb.h>
+#if defined(HAVE_SPAWN_H) && defined(HAVE_POSIX_SPAWN)
+#include <spawn.h>
+#endif
 
 // nbFileClose - maybe this should be a macro
 
@@ -258,6 +270,82 @@ nbCHILD nbChildOpen(int options,int uid,int gid,char *pgm,char *parms,nbFILE cld
   return(child);
   }
 #else  
+#if defined(HAVE_SPAWN_H) && defined(HAVE_POSIX_SPAWN)
+/*
+*  Spawn a child process with posix_spawn
+*
+*    This avoids copying the page tables of a large parent and closing every
+*    possible file descriptor in the child, which is most of the cost of a
+*    shell command action.  The file descriptor plumbing is done by spawn
+*    file actions.  Return -1 when a request needs the fork path, 1 on error
+*    with msg set, or 0 with pid set.
+*/
+extern char **environ;
+
+static int nbChildSpawn(int options,int uid,int gid,char *pgm,char **argv,nbFILE cldin,nbFILE cldout,nbFILE clderr,pid_t *pid,char *msg,size_t msglen){
+  posix_spawn_file_actions_t actions;
+  posix_spawnattr_t attr;
+  sigset_t sigdefault,sigmask;
+  struct sigaction action;
+  int sig[3]={SIGCHLD,SIGHUP,SIGTERM},ignore[3]={NB_CHILD_NOCHLD,NB_CHILD_NOHUP,NB_CHILD_NOTERM};
+  short flags=POSIX_SPAWN_SETSIGDEF;
+  int i,rc;
+#if !defined(HAVE_POSIX_SPAWN_FILE_ACTIONS_ADDCLOSEFROM_NP)
+  int fd;
+#endif
+
+  if(options&NB_CHILD_SHOWCLOSE) return(-1);
+  if(getuid()==0 && (uid!=0 || gid!=0)) return(-1);
+  if(options&NB_CHILD_SESSION){
+#if defined(POSIX_SPAWN_SETSID)
+    flags|=POSIX_SPAWN_SETSID;
+#else
+    return(-1);
+#endif
+    }
+  // A spawned child can be given default actions, but can only ignore a signal the parent ignores
+  sigemptyset(&sigdefault);
+  for(i=0;i<3;i++){
+    if(!(options&ignore[i])) sigaddset(&sigdefault,sig[i]);
+    else if(sigaction(sig[i],NULL,&action)!=0 || action.sa_handler!=SIG_IGN) return(-1);
+    }
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_adddup2(&actions,cldin,0);
+  posix_spawn_file_actions_adddup2(&actions,cldout,1);
+  posix_spawn_file_actions_adddup2(&actions,clderr,2);
+  if(options&NB_CHILD_NOCLOSE){
+    if(cldin>2) posix_spawn_file_actions_addclose(&actions,cldin);
+    if(cldout>2 && cldout!=cldin) posix_spawn_file_actions_addclose(&actions,cldout);
+    if(clderr>2 && clderr!=cldin && clderr!=cldout) posix_spawn_file_actions_addclose(&actions,clderr);
+    }
+  else{
+#if defined(HAVE_POSIX_SPAWN_FILE_ACTIONS_ADDCLOSEFROM_NP)
+    posix_spawn_file_actions_addclosefrom_np(&actions,3);
+#else
+    // only files without the close on exec flag need an action
+    for(fd=getdtablesize();fd>2;fd--) if(fcntl(fd,F_GETFD)==0) posix_spawn_file_actions_addclose(&actions,fd);
+#endif
+    }
+  posix_spawnattr_init(&attr);
+  posix_spawnattr_setsigdefault(&attr,&sigdefault);
+  // 2026-10-18 eat 0.9.04 - the medulla may block SIGCHLD to read it from a signalfd
+  sigprocmask(SIG_BLOCK,NULL,&sigmask);
+  sigdelset(&sigmask,SIGCHLD);
+  posix_spawnattr_setsigmask(&attr,&sigmask);
+  flags|=POSIX_SPAWN_SETSIGMASK;
+  posix_spawnattr_setflags(&attr,flags);
+  if(options&NB_CHILD_SHELL) rc=posix_spawn(pid,pgm,&actions,&attr,argv,environ);
+  else rc=posix_spawnp(pid,pgm,&actions,&attr,argv,environ);
+  posix_spawnattr_destroy(&attr);
+  posix_spawn_file_actions_destroy(&actions);
+  if(rc!=0){
+    snprintf(msg,msglen,"Unable to create child process %s - %s",pgm,strerror(rc));
+    return(1);
+    }
+  return(0);
+  }
+#endif
+
 nbCHILD nbChildOpen(int options,int uid,int gid,char *pgm,char *parms,nbFILE cldin,nbFILE cldout,nbFILE clderr,char *msg,size_t msglen){
   int pid,fd,closebit;
   char parmbuf[NB_BUFSIZE];
@@ -265,11 +353,79 @@ nbCHILD nbChildOpen(int options,int uid,int gid,char *pgm,char *parms,nbFILE cld
   char *argv[20];
   char *cursor,*delim;
   nbCHILD child;
+  sigset_t sigmask;
+#if defined(HAVE_SPAWN_H) && defined(HAVE_POSIX_SPAWN)
+  pid_t spawnpid;
+#endif
 
   if(!(options&NB_CHILD_SHELL) && strlen(parms)>=sizeof(parmbuf)){   // 2013-01-01 eat - VID 4613,5380,5423-0.8.13-1
     snprintf(msg,msglen,"Parm string is exceeds limit of %d - not spawning child",NB_BUFSIZE-1);
     return(NULL);
     }
+  // 2026-10-18 eat 0.9.04 - build argv[] in the parent so it can be passed to posix_spawn
+  if(options&NB_CHILD_SHELL){
+    if(pgm==NULL || *pgm==0) pgm="/bin/sh";
+    argv[0]=pgm;
+    argv[1]="-c";
+    argv[2]=parms;
+    argv[3]=NULL;
+    }
+  else{  // parse the program and parameters and build argv[]
+    if(pgm==NULL || *pgm==0) pgm="/usr/local/bin/nb";
+    // Here we have strange rules
+    //   If a parameter starts with '"', it is delimited by an unescaped '"'
+    //   otherwise it is delimited by a space and may contain quotes
+    //   An unbalanced quote is delimited by end of string
+    argv[argc]=pgm;
+    argc++;
+    strncpy(parmbuf,parms,sizeof(parmbuf)-1);  // Take a copy so we can chop it up with null terminators for each parm - length checked above
+    *(parmbuf+sizeof(parmbuf)-1)=0;  // 2013-01-13 eat - checked above but helping the checker here
+    cursor=parmbuf;          // 2013-01-01 eat - VID 4613,5380,5423-0.8.13-1 Changed this code to just work within parmbuf
+    while(*cursor==' ') cursor++;
+    while(*cursor){
+      if(argc>=sizeof(argv)/sizeof(char *)-1){  // 2026-10-18 eat 0.9.04 - was unchecked
+        snprintf(msg,msglen,"Parm string exceeds limit of %d parameters - not spawning child",(int)(sizeof(argv)/sizeof(char *)-2));
+        return(NULL);
+        }
+      if(*cursor=='"'){
+        cursor++;
+        argv[argc]=cursor;
+        delim=strchr(cursor,'"');
+        if(!delim) delim=cursor+strlen(cursor); // this is actually a syntax error
+        else while(delim>cursor && *(delim-1)=='\\'){ // handle escaped quotes
+          strcpy(delim-1,delim);     // consume the escape - always have room
+          delim=strchr(delim,'"');   // 2013-01-12 eat - looking beyond the previously found quote which moved left one byte
+          if(!delim) delim=cursor+strlen(cursor);
+          }
+        }
+      else{
+        argv[argc]=cursor;
+        delim=strchr(cursor,' ');
+        if(!delim) delim=cursor+strlen(cursor);
+        }
+      cursor=delim;
+      if(*cursor){
+        *cursor=0;
+        cursor++;
+        while(*cursor==' ') cursor++;
+        }
+      argc++;
+      }
+    argv[argc]=NULL;
+    }
+#if defined(HAVE_SPAWN_H) && defined(HAVE_POSIX_SPAWN)
+  // 2026-10-18 eat 0.9.04 - use posix_spawn unless the child needs setup only fork can do
+  if((i=nbChildSpawn(options,uid,gid,pgm,argv,cldin,cldout,clderr,&spawnpid,msg,msglen))>=0){
+    close(cldin);  // close the files in the parent process
+    close(cldout);
+    close(clderr);
+    if(i) return(NULL);
+    snprintf(msg,msglen,"child pid %d",(int)spawnpid);
+    child=nbAlloc(sizeof(NB_Child));
+    child->pid=spawnpid;
+    return(child);
+    }
+#endif
   if((pid=fork())<0){
     snprintf(msg,msglen,"Unable to create child process - %s",strerror(errno));
     return(NULL);
@@ -329,6 +485,9 @@ nbCHILD nbChildOpen(int options,int uid,int gid,char *pgm,char *parms,nbFILE cld
       }
 
     // switch major signals to SIG_IGN or SIG_DFT
+    sigemptyset(&sigmask);  // 2026-10-18 eat 0.9.04 - the medulla may block SIGCHLD
+    sigaddset(&sigmask,SIGCHLD);
+    sigprocmask(SIG_UNBLOCK,&sigmask,NULL);
     if(options&NB_CHILD_NOCHLD) signal(SIGCHLD,SIG_IGN);
     else signal(SIGCHLD,SIG_DFL);
     if(options&NB_CHILD_NOHUP) signal(SIGHUP,SIG_IGN);
@@ -341,50 +500,8 @@ nbCHILD nbChildOpen(int options,int uid,int gid,char *pgm,char *parms,nbFILE cld
       if(i<0) fprintf(stderr,"setsid() failed\n");
       //else fprintf(stderr,"setsid() was successful\n");
       }
-    if(options&NB_CHILD_SHELL){
-      if(pgm==NULL || *pgm==0) pgm="/bin/sh";
-      execl(pgm,pgm,"-c",parms,NULL);  // 2013-01-01 eat - VID 784-0.8.13-1 Intentional user specified command
-      }
-    else{  // parse the program and parameters and build argv[]
-      if(pgm==NULL || *pgm==0) pgm="/usr/local/bin/nb";
-      // Here we have strange rules
-      //   If a parameter starts with '"', it is delimited by an unescaped '"'
-      //   otherwise it is delimited by a space and may contain quotes
-      //   An unbalanced quote is delimited by end of string
-      argv[argc]=pgm;
-      argc++;
-      strncpy(parmbuf,parms,sizeof(parmbuf)-1);  // Take a copy so we can chop it up with null terminators for each parm - length checked above
-      *(parmbuf+sizeof(parmbuf)-1)=0;  // 2013-01-13 eat - checked above but helping the checker here
-      cursor=parmbuf;          // 2013-01-01 eat - VID 4613,5380,5423-0.8.13-1 Changed this code to just work within parmbuf
-      while(*cursor==' ') cursor++;
-      while(*cursor){
-        if(*cursor=='"'){
-          cursor++;
-          argv[argc]=cursor;
-          delim=strchr(cursor,'"');
-          if(!delim) delim=cursor+strlen(cursor); // this is actually a syntax error
-          else while(delim>cursor && *(delim-1)=='\\'){ // handle escaped quotes
-            strcpy(delim-1,delim);     // consume the escape - always have room
-            delim=strchr(delim,'"');   // 2013-01-12 eat - looking beyond the previously found quote which moved left one byte
-            if(!delim) delim=cursor+strlen(cursor);
-            }
-          }
-        else{
-          argv[argc]=cursor;
-          delim=strchr(cursor,' ');
-          if(!delim) delim=cursor+strlen(cursor);
-          }
-        cursor=delim;
-        if(*cursor){
-          *cursor=0;
-          cursor++;
-          while(*cursor==' ') cursor++;
-          }
-        argc++;
-        }
-      argv[argc]=NULL;
-      execvp(pgm,argv);  // 2013-01-01 eat - VID 684-0.8.13-1 Intentional
-      }
+    if(options&NB_CHILD_SHELL) execv(pgm,argv);  // 2013-01-01 eat - VID 784-0.8.13-1 Intentional user specified command
+    else execvp(pgm,argv);  // 2013-01-01 eat - VID 684-0.8.13-1 Intentional
     _exit(0);
     }  
   }
@@ -56,6 +56,12 @@
 * 2013-04-08 eat 0.8.15 Change prefix switch from -"'..." to -">..." to match command
 * 2013-04-27 eat 0.8.15 Included option parameter in nbSource calls
 * 2014-01-20 eat 0.9.00 glossary back to hash and double link IF rule list
+* 2026-10-18 eat 0.9.04 Close active event capture in nbStop
+* 2026-10-18 eat 0.9.04 Load or record rule image while processing arguments
+* 2026-10-18 eat 0.9.04 Restore checkpoint after arguments and write one in nbStop
+* 2026-10-18 eat 0.9.04 Stop shards in nbStop
+* 2026-10-18 eat 0.9.04 Remove metric socket in nbStop
+* 2026-10-18 eat 0.9.04 Close cached queue log producers in nbStop
 *============================================================================*/
 #include <nb/nbi.h>
 #include <nb/nbmedulla.h>
@@ -123,12 +129,21 @@ void nbServeParseArgs(nbCELL context,struct NB_STEM *stem,int argc,char *argv[])
   char *cursor;
   int i;
   char *comma,*equal;
+  int image=0;   // 1 when source arguments are satisfied by the rule image
   /* if(argc<2) nb_opt_prompt=1; */ /* default to prompt */
   
   for(i=1;i<argc && nb_flag_stop==0;i++){
     if(*argv[i]=='+') continue;
     outMsg(0,'I',"Argument [%u] %s",i,argv[i]);
     cursor=argv[i];
+    // 2026-10-18 eat 0.9.04 - load rule image at first source argument when image setting is specified
+    if(*cursor!='-' && *cursor!='='){
+      if(!image) image=nbImageStart(context,argc,argv,i);
+      if(image){
+        nb_flag_input=1;
+        continue;
+        }
+      }
     switch(*cursor){
       case '-':
         cursor++;
@@ -152,16 +167,25 @@ void nbServeParseArgs(nbCELL context,struct NB_STEM *stem,int argc,char *argv[])
         else nbCmdSet(context,stem,"set",cursor-1);
         break;
       case '=': nbSource(context,0,argv[i]); nb_flag_input=1; break;
-      case ':': nbCmd(context,cursor+1,1); nb_flag_input=1; break;
+      case ':':
+        if(nb_image && nb_image->recording) nb_imageLine=1;
+        nbCmd(context,cursor+1,1);
+        nb_flag_input=1;
+        break;
       default:
         if(NULL!=(equal=strchr(cursor,'='))){
           if(NULL!=(comma=strchr(cursor,',')) && comma<equal) nbSource(context,0,cursor);
-          else nbParseArgAssertion(cursor);
+          else{
+            nbImageArg(cursor);
+            nbParseArgAssertion(cursor);
+            }
           }
         else nbSource(context,0,cursor);
         nb_flag_input=1;
       }
     }
+  nbImageStop();  // write rule image if we recorded the startup
+  nbCheckpointStart(context);  // restore runtime state
      
   outFlush();
   }
@@ -581,6 +605,13 @@ int nbStop(nbCELL context){
   if(nb_opt_stats) nbHashStats(); // display hash metrics
 
   NB_Stem *stem=context->object.type->stem;
+  nbCheckpointStop();          // write final checkpoint
+  nbCaptureClose();            // flush any active event capture
+  nbShardStop();               // stop shards
+  nbMetricStop();              // remove metric socket
+#if !defined(WIN32)
+  nbQueueLogStop();            // sync and close cached queue log producers
+#endif
   nbMedullaExit();             // clean up processes
 #if !defined(WIN32)
   nbMedullaProcessHandler(1);  // wait for children to stop
@@ -111,6 +111,8 @@
 * 2014-09-14 eat 0.9.03 Experimenting with '_' separator for terms within node glossaries
 *            Under this scheme, period '.' represents a node boundary while '_'
 *            represents a term boundary within a node.
+* 2026-10-18 eat 0.9.04 Unblocked SIGCHLD for the shell started by popen
+* 2026-10-18 eat 0.9.04 Drop reload definition text when a definition changes
 *=============================================================================
 */
 #include <nb/nbi.h>
@@ -230,7 +232,10 @@ static void termAskCommand(char *name,char *value,size_t size,char *command){
 //#if !defined(mpe) && !defined(ANYBSD)
 //  signal(SIGCLD,SIG_DFL);
 //#endif
-  if((file=popen(cmd,"r"))==NULL){
+  nbMedullaSigChildUnblock();  // 2026-10-18 eat 0.9.04 - don't pass a blocked SIGCHLD to the shell
+  file=popen(cmd,"r");
+  nbMedullaSigChildBlock();
+  if(file==NULL){
     outMsg(0,'E',"Unable to execute command. errno=%d",errno);
     return;
     }
@@ -393,6 +398,7 @@ void destroyTerm(NB_Term *term){
 */
 
   if(trace) outMsg(0,'T',"destroyTerm() called for %s",term->word->value);
+  if(term->reload) term->reload=dropObject(term->reload);
   if(term->def!=NULL) term->def=dropObject(term->def);
   if(term->cell.object.value!=NULL) term->cell.object.value=dropObject(term->cell.object.value);  // 2006-01-13
   if(term->gloss!=NULL){
@@ -631,6 +637,7 @@ NB_Term *makeTerm(NB_Term *context,NB_String *word){
   term->context=context; 
   term->gloss=NULL;                                 // glossary of subordinate terms
   term->def=nb_Undefined;  
+  term->reload=NULL;
   term->word=word;
   grabObject(term);
   if(trace) outMsg(0,'T',"makeTerm returning");
@@ -655,6 +662,7 @@ void nbTermAssign(NB_Term *term,NB_Object *new){
 */
   if(new==NULL) new=nb_Unknown; /* we could make sure this doesn't happen */
   if(term->def==new) return;
+  if(term->reload) term->reload=dropObject(term->reload);  // no longer the reloaded definition
   if(term->def!=nb_Unknown && term->def!=nb_Disabled){
     nbAxonDisable((NB_Cell *)term->def,(NB_Cell *)term);  
     dropObject(term->def); 
@@ -160,6 +160,9 @@
 * 2013-01-01 eat 0.8.13 Checker updates
 * 2013-01-12 eat 0.8.13 Checker updates
 * 2014-05-04 eat 0.9.02 Replaced newType with nbObjectType
+* 2026-10-18 eat 0.9.04 Added shared queues and incremental casting in tcQueueTrue
+* 2026-10-18 eat 0.9.04 Collect tcComplex segments in array form
+* 2026-10-18 eat 0.9.04 Collect tcComplex segments in list form when bfiListForm is set
 *=============================================================================
 */
 #define _USE_32BIT_TIME_T
@@ -823,14 +826,20 @@ int tcCheckPattern(long timer,int pat[]){
   
 /*
 *  Complex Function - Supports all functions with parameters
+*
+*    Each parameter produces segments in order, but the parameters overlap
+*    in time, so the segments are collected in array form and sorted once.
+*    The list form is used when bfiListForm is set for comparison.
 */  
 bfi tcComplex(long begin,long end,struct tcFunction *function,struct tcParm *parm){
   long (*duration)()=function->duration;
   long start,stop,parmstart,parmstop;
   struct tcParm *p;
-  bfi f;
+  bfiv v=NULL;
+  bfi f=NULL;
 
-  f=bfiNew(begin,end);
+  if(bfiListForm) f=bfiNew(begin,end);
+  else v=bfivNew(begin,end,0);
   for(p=parm;p!=NULL;p=p->next){  /* for each parm */ 
     parmstart=tcAlignParentPattern(begin,p->start);
     while(parmstart>=0 && parmstart<end){         /* from begin to end */
@@ -840,7 +849,10 @@ bfi tcComplex(long begin,long end,struct tcFunction *function,struct tcParm *par
           if(0>(parmstop=tcAlignStopPattern(start,p->stop,function))) break;
           if(p->stop[0]>0){
             stop=parmstop;
-            if(stop>begin) bfiInsertUnique(f,start,stop);
+            if(stop>begin){
+              if(v) bfivInsert(v,start,stop);
+              else bfiInsertUnique(f,start,stop);
+              }
 		        }
           else{
             if(parmstop>end) parmstop=end;      
@@ -850,7 +862,8 @@ bfi tcComplex(long begin,long end,struct tcFunction *function,struct tcParm *par
                 }
               else if(0>(stop=(duration)(start,1))) break;
               if(stop>begin){
-				         bfiInsertUnique(f,start,stop);
+				         if(v) bfivInsert(v,start,stop);
+				         else bfiInsertUnique(f,start,stop);
                  }
               start=stop;
               }
@@ -861,6 +874,11 @@ bfi tcComplex(long begin,long end,struct tcFunction *function,struct tcParm *par
       if(0>(parmstart=(p->step)(parmstart,1))) break; /* step and stop if we hit limit */
       }
     } 
+  if(v){
+    bfivSort(v,1);
+    f=bfivList(v);
+    bfivFree(v);
+    }
   return(f);   
   }
 
@@ -1560,7 +1578,10 @@ tcq tcQueueNew(tc tcdef,long begin,long end){
   //if((queue=(tcq)malloc(sizeof(struct tcQueue)))==NULL) //2012-01-26 dtl: handled out of memory
   //  {outMsg(0,'E',"malloc error: out of memory");exit(NB_EXITCODE_FAIL);} //dtl:added
   queue=(tcq)nbAlloc(sizeof(struct tcQueue));
+  queue->next=NULL;
+  queue->key=NULL;
   queue->tcdef=tcdef;
+  queue->end=0;
   /* we don't cast a stand-alone time procedure */
   /* instead we let schedNext() call nbRuleStep() */
   if(tcdef->operation==tcPlan){
@@ -1571,33 +1592,142 @@ tcq tcQueueNew(tc tcdef,long begin,long end){
   return(queue);
   } 
 
+/*
+*  Normalize a time expression for use as a shared queue key
+*
+*    Built-in function names are replaced by their abbreviations and
+*    equivalent operators by a single form, so "hour.day(1)" and "h=d(1)"
+*    produce the same key.  Identifiers are taken whole, so a declared
+*    calendar like "Mday" is never confused with "Md".  Parameter lists and
+*    indexes are copied as is.
+*    Returns 1 if the expression can not be shared or the key doesn't fit.
+*/
+static int tcQueueKey(char *source,size_t len,char *key,size_t size){
+  char *cursor=source,*end=source+len,*name,*k=key,*kend=key+size-1,close;
+  struct tcFunction *function;
+  size_t n;
+
+  while(cursor<end){
+    if((*cursor>='a' && *cursor<='z') || (*cursor>='A' && *cursor<='Z') || (*cursor>='0' && *cursor<='9')){
+      /* take the whole identifier so only a complete built-in name is shortened */
+      for(name=cursor;cursor<end && ((*cursor>='a' && *cursor<='z') || (*cursor>='A' && *cursor<='Z') || (*cursor>='0' && *cursor<='9'));cursor++);
+      n=cursor-name;
+      function=NULL;
+      if(*name>='a' && *name<='z') for(function=&tcSecond;function!=NULL && (strncmp(name,function->name,n)!=0 || function->name[n]!=0);function=function->next);
+      if(function!=NULL){
+        name=function->abbr;
+        n=strlen(name);
+        }
+      if(k+n>kend) return(1);
+      strncpy(k,name,n);
+      k+=n;
+      }
+    else if((*cursor=='(' && k>key && isalnum((unsigned char)*(k-1))) || *cursor=='['){
+      close=*cursor=='(' ? ')' : ']';   /* parameter list or index */
+      for(;cursor<end && *cursor!=close;cursor++){
+        if(k>=kend) return(1);
+        *k++=*cursor;
+        }
+      if(cursor<end){
+        if(k>=kend) return(1);
+        *k++=*cursor++;
+        }
+      }
+    else if(*cursor=='{') return(1);  /* plans have state of their own */
+    else if(*cursor==' ') cursor++;
+    else{
+      if(k>=kend) return(1);
+      if(*cursor=='.') *k++='=';      /* selection */
+      else if(*cursor=='_') *k++='#'; /* partition and until */
+      else *k++=*cursor;
+      cursor++;
+      }
+    }
+  *k=0;
+  return(0);
+  }
+
+/*
+*  Get a time condition queue shared by equivalent expressions
+*
+*    Schedules with different spellings of the same time expression use the
+*    same queue, so the intervals are cast once for all of them.  Shared
+*    queues are retained indefinitely, as are the schedules that use them.
+*/
+tcq tcQueueShare(tc tcdef,char *source,size_t len,long begin,long end){
+  static tcq hash[256];
+  tcq queue,*queueP;
+  char key[512];
+  uint32_t hashcode;
+  int r=1;
+
+  if(tcdef->operation==tcPlan || tcQueueKey(source,len,key,sizeof(key))) return(tcQueueNew(tcdef,begin,end));
+  NB_HASH_STR(hashcode,key)
+  for(queueP=&hash[hashcode&255];(queue=*queueP)!=NULL && (r=strcmp(queue->key,key))<0;queueP=&queue->next);
+  if(queue!=NULL && r==0) return(queue);
+  queue=tcQueueNew(tcdef,begin,end);
+  queue->key=(char *)nbAlloc(strlen(key)+1);
+  strcpy(queue->key,key);
+  queue->next=*queueP;
+  *queueP=queue;
+  return(queue);
+  }
+
 /*
 *  Get time of next true state
 *    o Returns maximum time under implementation limits when no true state is found.
 *    o A casting domain is used to limit the number of intervals generated in advance.
 *      If no interval is found in the specified domain, the domain is expanded until
 *      an interval is found or the implementation limit is reached.  The domain size
-*      gets progressively larger on each recast.
+*      gets progressively larger on each extension.
 *    o We always expand the domain until the first "usable" interval is entirely
 *      contained within the domain.  This is necessary to make sure that normalization
 *      has fully extended the interval.  
+*    o The domain is extended by casting only the period not already covered by
+*      reliable intervals, starting at the end of the domain or at the start of an
+*      unreliable interval at the end of the domain.
+*    o A queue may be shared by multiple schedules, so intervals are only dropped
+*      when they end before the current time, and the interval found is remembered
+*      for tcQueueFalse instead of being moved to the front of the set.
 */  
 long tcQueueTrue(tcq queue,long begin,long end){
-  bfi interval;
+  bfi interval,set,s;
+  long trim=begin<nb_ClockTime ? begin : nb_ClockTime;
+  long cast;
   
   if(trace) outMsg(0,'T',"tcQueueTrue: called begin=%d,  end=%d.",begin,end);
-  for(interval=queue->set->next;interval!=queue->set && interval->end<=begin;interval=interval->next){
-    interval=bfiRemove(interval);  /* should we really be skipping intervals? */
+  for(interval=queue->set->next;interval!=queue->set && interval->end<=trim;interval=interval->next){
+    interval=bfiRemove(interval);
     }
-  while(queue->set->start!=maxtime && (interval==queue->set || interval->end>=queue->set->start)){  /* empty or unreliable set, get more intervals */
-	  if(interval->end>end) end=interval->end; /* expand to enclose the interval */
-    if(trace) outMsg(0,'T',"tcQueueTrue: casting new intervals");
+  if(begin<queue->set->end){  /* domain starts after begin - cast it again */
     queue->set=bfiDispose(queue->set);
     queue->set=tcCast(begin,end,queue->tcdef);
+    }
+  for(interval=queue->set->next;interval!=queue->set && interval->end<=begin;interval=interval->next);
+  while(queue->set->start!=maxtime && (interval==queue->set || interval->end>=queue->set->start)){  /* empty or unreliable set, get more intervals */
+    if(interval->end>end) end=interval->end; /* expand to enclose the interval */
+    cast=queue->set->start;
+    if(interval!=queue->set){  /* drop the unreliable interval and cast again from its start */
+      cast=interval->start;
+      s=interval->prior;
+      while(queue->set->prior!=s) bfiRemove(queue->set->prior);
+      }
+    if(cast<begin) cast=begin;
+    if(cast<end){
+      if(trace) outMsg(0,'T',"tcQueueTrue: casting new intervals");
+      set=tcCast(cast,end,queue->tcdef);
+      for(s=set->next;s!=set;s=s->next) bfiInsert(queue->set,s->start,s->end);
+      bfiDispose(set);
+      queue->set->start=end;
+      set=bfiOre_(queue->set);  /* normalize where new intervals meet the old */
+      bfiDispose(queue->set);
+      queue->set=set;
+      }
     end+=end-begin;    /* prepare for next try if it becomes necessary */
     if(end<=begin) end=maxtime;
-    interval=queue->set->next;
+    for(interval=queue->set->next;interval!=queue->set && interval->end<=begin;interval=interval->next);
     }
+  queue->end=interval->end;
   if(trace) outMsg(0,'T',"tcQueueTrue: return start=%d, stop=%d.",interval->start,interval->end); 
   return(interval->start);
   }
@@ -1606,7 +1736,7 @@ long tcQueueTrue(tcq queue,long begin,long end){
 *  Get time of next false state
 */  
 long tcQueueFalse(tcq queue){
-  return(queue->set->next->end);
+  return(queue->end);
   } 
 
 /**********************************************************************
@@ -79,6 +79,10 @@
 *
 *     int nbTlsWrite(nbTLS *tls,char *buffer,size_t size,int timeout);
 *
+*   The nbTlsWritev function is used to write a list of buffers to a peer.
+*
+*     int nbTlsWritev(nbTLS *tls,struct iovec *iov,int iovcnt);
+*
 *   The nbTlsClose function is used to close a connection and free up
 *   the TLS handle.
 *
@@ -178,6 +182,7 @@
 * 2013-01-01 eat 0.8.13 Checker updates
 * 2014-01-12 eat 0.9.00 added const to SSL_METHOD pointer
 * 2014-01-25 eat 0.9.00 Checker updates
+* 2026-10-18 eat 0.9.04 Included nbTlsWritev
 *==================================================================================
 */
 #include "../config.h"
@@ -1147,6 +1152,33 @@ int nbTlsWrite(nbTLS *tls,char *buffer,size_t size){
   return(len);
   }
 
+/*
+*  Write a list of buffers to peer
+*
+*    A clear connection writes the buffers with a single writev call.  An
+*    SSL connection writes only the first buffer, because SSL_write must be
+*    retried with the same buffer after NB_TLS_ERROR_WANT_WRITE.  Callers
+*    should put several records in each buffer so they share TLS records.
+*
+*  Returns the number of bytes written, or -1 as for nbTlsWrite.
+*/
+int nbTlsWritev(nbTLS *tls,struct iovec *iov,int iovcnt){
+  ssize_t len;
+
+  if(iovcnt<1) return(0);
+#if defined(WIN32)
+  return(nbTlsWrite(tls,(char *)iov->iov_base,iov->iov_len));
+#else
+  if(tls->ssl || iovcnt==1) return(nbTlsWrite(tls,(char *)iov->iov_base,iov->iov_len));
+  tls->error=NB_TLS_ERROR_UNKNOWN;
+  len=writev(tls->socket,iov,iovcnt);
+  while(len==-1 && errno==EINTR) len=writev(tls->socket,iov,iovcnt);
+  if(tlsTrace) fprintf(stderr,"nbTlsWritev: iovcnt=%d wrote len=%ld\n",iovcnt,(long)len);
+  if(len==-1 && errno==EAGAIN) tls->error=NB_TLS_ERROR_WANT_WRITE;
+  return(len);
+#endif
+  }
+
 /*
 *  Close a TLS connection and free the structure
 */
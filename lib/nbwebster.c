@@ -148,6 +148,24 @@
 * 2013-01-01 eat 0.8.13 - Checker updates
 * 2014-01-12 eat 0.9.00 - Added checks for chdir and getcwd return codes
 * 2014-01-25 eat 0.9.00 - Checker updates
+* 2026-10-18 eat 0.9.04 - Included static content cache and sendfile
+*            Files up to CacheFileSize KB are kept in memory with their
+*            header fields, up to CacheSize KB in total, and discarded least
+*            recently used first.  A cached file is reloaded when the file
+*            modification time or size changes.  A precompressed file.gz is
+*            served for file when the client accepts gzip encoding and it is
+*            not older than file.  Other files are sent with sendfile() on
+*            connections without SSL.
+* 2026-10-18 eat 0.9.04 - Implemented HTTP/1.1 persistent connections
+*            A connection is kept after a reply unless the client asks to
+*            close it, is using HTTP/1.0 without "Connection: keep-alive",
+*            has made KeepAliveMax requests, or we reply with an error.
+*            Pipelined requests are consumed one at a time and answered in
+*            order, holding the next request while a file, sendfile, or
+*            cgi reply is in progress.  A synapse timer closes connections
+*            idle for KeepAliveTimeout seconds by the medulla clock.
+* 2026-10-18 eat 0.9.04 - Use -1 for a session without a file, since zero is a valid descriptor
+* 2026-10-18 eat 0.9.04 - Reply 431 or 413 to a request too large for the request buffer
 *==============================================================================
 */
 #include "../config.h"
@@ -158,6 +176,8 @@
 int nb_websterTrace;          // debugging trace flag for webster routines
 
 static int nbWebsterShutdownProducer(nbCELL context,nbProxy *proxy,void *handle);
+static int nbWebsterSendProducer(nbCELL context,nbProxy *proxy,void *handle);
+static void nbWebsterRequestNext(nbCELL context,nbWebSession *session);
 //=============================================================================
 // Routines for managing GET and POST parameters 
 //=============================================================================
@@ -322,6 +342,8 @@ static int nbWebsterParamDecode(nbCELL context,nbWebSession *session,char *encod
 *   content   POST only
 *
 * Returns:
+*  -3 - content too large for request buffer
+*  -2 - header too large for request buffer
 *  -1 - error
 *   0 - success
 *   1 - don't have full request try again
@@ -329,33 +351,37 @@ static int nbWebsterParamDecode(nbCELL context,nbWebSession *session,char *encod
 * this is used by both blocking and non-blocking versions
 */
 static int nbWebsterDecodeRequest(nbCELL context,nbWebSession *session,char *request,int reqlen){
-  char *cursor,*delim,*end=request+reqlen;
+  char *cursor,*delim,*end=request+reqlen,*headEnd=NULL;
   int len;
   char value[512];
 
   if(nb_websterTrace) nbLogMsg(context,0,'T',"nbWebsterDecodeRequest: called - len=%d",reqlen);
-  if(reqlen>=sizeof(session->request)){
-    nbLogMsg(context,0,'E',"Request is too large for buffer");
-    return(-1);
-    }
   // 2012-05-11 - make sure we have a full request before processing
   if(reqlen<6) return(1); // 2012-03-03 eat - wait for more data if too short to check verb
-  delim=memchr(request,'\n',reqlen);
-  if(!delim) return(1);
-  cursor=delim+1;
-  while(cursor<end && *cursor!='\r' && *cursor!='\n'){
-    delim=memchr(cursor,'\n',reqlen);
-    if(!delim) return(1);
+  // 2026-10-18 eat 0.9.04 - the data may include pipelined requests following this one
+  for(cursor=request;cursor<end && (delim=memchr(cursor,'\n',end-cursor))!=NULL;){
     cursor=delim+1;
+    if(cursor>=end) break;
+    if(*cursor=='\n'){
+      headEnd=cursor+1;
+      break;
+      }
+    if(*cursor=='\r'){
+      if(cursor+1>=end) break;
+      if(*(cursor+1)!='\n') return(-1);
+      headEnd=cursor+2;
+      break;
+      }
     }
-  if(cursor>=end) return(1);
-  if(*cursor=='\r'){
-    cursor++;
-    if(cursor>end || *cursor!='\n') return(-1);
+  if(!headEnd || headEnd-request>=sizeof(session->request)){
+    if(reqlen<sizeof(session->request)) return(1);
+    nbLogMsg(context,0,'W',"Request header is too large for buffer");
+    return(-2);
     }
-
-  memcpy(session->request,request,reqlen);
-  *(session->request+reqlen)=0;
+  len=reqlen;
+  if(len>=sizeof(session->request)) len=sizeof(session->request)-1;
+  memcpy(session->request,request,len);
+  *(session->request+len)=0;
   cursor=session->request;
 
   // initialize side effect values in case we bail out on error
@@ -388,6 +414,8 @@ static int nbWebsterDecodeRequest(nbCELL context,nbWebSession *session,char *req
   else session->queryString=NULL;
   *cursor=0;  // end of resource or queryString
   cursor++;
+  // 2026-10-18 eat 0.9.04 - HTTP/1.1 connections are persistent unless the client asks to close
+  session->close=(strncmp(cursor,"HTTP/1.1",8)!=0);
   if(*session->resource==0){
     session->resource=session->webster->indexPage;
     session->queryString=session->webster->indexQuery;
@@ -404,6 +432,7 @@ static int nbWebsterDecodeRequest(nbCELL context,nbWebSession *session,char *req
   cursor=strchr(cursor,'\n');
   if(cursor==NULL) return(-1);
   cursor++;
+  session->gzip=0;
   while(cursor && *cursor && *cursor!='\r' && *cursor!='\n'){
     delim=strchr(cursor,'\n');
     if(!delim) delim=strchr(cursor,0);
@@ -426,6 +455,14 @@ static int nbWebsterDecodeRequest(nbCELL context,nbWebSession *session,char *req
       cursor+=17;
       session->close=1;
       }
+    else if(strncasecmp(cursor,"Connection: keep-alive",22)==0){  // 2026-10-18 eat 0.9.04 - HTTP/1.0 clients
+      cursor+=22;
+      session->close=0;
+      }
+    else if(strncasecmp(cursor,"Accept-Encoding: ",17)==0){  // 2026-10-18 eat 0.9.04
+      cursor+=17;
+      for(;cursor<delim;cursor++) if(strncasecmp(cursor,"gzip",4)==0) session->gzip=1;
+      }
     else if(strncasecmp(cursor,"Content-Length: ",16)==0){
       cursor+=16;
       len=delim-cursor;
@@ -454,6 +491,10 @@ static int nbWebsterDecodeRequest(nbCELL context,nbWebSession *session,char *req
   if(session->contentLength>0){
     int consumed=cursor-session->request;
     nbLogMsg(context,0,'T',"nbWebsterDecodeRequest: consumed=%d of %d leaving %d of %d content",consumed,reqlen,reqlen-consumed,session->contentLength);
+    if(consumed+session->contentLength>=sizeof(session->request)){
+      nbLogMsg(context,0,'W',"Request content is too large for buffer");
+      return(-3);
+      }
     if(session->contentLength>reqlen-consumed){
       nbLogMsg(context,0,'T',"nbWebsterDecodeRequest: do not have all the content yet");
       return(1); // don't have all the content
@@ -467,6 +508,8 @@ static int nbWebsterDecodeRequest(nbCELL context,nbWebSession *session,char *req
     else session->contentLength=0;  // default to zero
     }
   session->content=cursor;
+  *(cursor+session->contentLength)=0;  // 2026-10-18 eat 0.9.04 - don't include a pipelined request
+  session->reqlen=cursor-session->request+session->contentLength;
   return(0);
   }
 
@@ -505,6 +548,7 @@ static void nbWebsterError(nbCELL context,nbWebSession *session,char *text){
   strncpy(ctimeCurrent,asctime(gmtime(&currentTime)),sizeof(ctimeCurrent)-1); // 2014-01-25 eat - CID 1164437
   *(ctimeCurrent+sizeof(ctimeCurrent)-1)=0;
   if((newline=strchr(ctimeCurrent,'\n'))!=NULL) *newline=0;
+  session->close=1;  // 2026-10-18 eat 0.9.04 - this reply says "Connection: close"
   page=nbProxyPageOpen(context,&data,&size);
   nbLogMsg(context,0,'T',"Internal server error");
   len=snprintf(content,sizeof(content),html,text);
@@ -549,6 +593,7 @@ static void nbWebsterBadRequest(nbCELL context,nbWebSession *session,char *text)
   strncpy(ctimeCurrent,asctime(gmtime(&currentTime)),sizeof(ctimeCurrent)-1); // 2014-01-25 eat - CID 1164431
   *(ctimeCurrent+sizeof(ctimeCurrent)-1)=0;
   if((newline=strchr(ctimeCurrent,'\n'))!=NULL) *newline=0;
+  session->close=1;  // 2026-10-18 eat 0.9.04
   page=nbProxyPageOpen(context,&data,&size);
   nbLogMsg(context,0,'T',"Internal server error");
   len=snprintf((char *)data,size,response,ctimeCurrent,session->reqhost,session->resource,strlen(html),nb_charset,html); // 2012-12-27 eat CID 761997
@@ -558,8 +603,54 @@ static void nbWebsterBadRequest(nbCELL context,nbWebSession *session,char *text)
   nbProxyPutPage(context,session->client,page);
   }
 
+/*
+*  Reject a request too large for the request buffer
+*
+*    The status is "413 Content Too Large" or "431 Request Header Fields Too Large".
+*    The connection is closed after the reply, since we can't find the next request.
+*/
+static void nbWebsterTooLarge(nbCELL context,nbWebSession *session,char *status){
+  nbProxyPage *page;
+  void *data;
+  size_t size;
+  int   len;
+  char *newline;
+  const char *html=
+    "<!DOCTYPE HTML PUBLIC \"-//IETF//DTD HTML 2.0//EN\">\n"
+    "<html>\n<head>\n"
+    "<title>%s</title>\n"
+    "</head>\n<body>\n"
+    "<b><big>%s</big></b>\n"
+    "<p>The request is larger than %d bytes.</p>\n"
+    "<hr>\n"
+    "<i>NodeBrain Webster Server</i>\n"
+    "</body>\n</html>\n";
+  const char *response=
+    "HTTP/1.1 %s\r\n"
+    "Date: %s\r\n"
+    "Server: NodeBrain Webster\r\n"
+    "Connection: close\r\n"
+    "Content-Length: %d\r\n"
+    "Content-Type: text/html; charset=%s\r\n\r\n"
+    "%s";
+  char content[1024];
+  time_t currentTime;
+  char ctimeCurrent[32];
+  time(&currentTime);
+  strncpy(ctimeCurrent,asctime(gmtime(&currentTime)),sizeof(ctimeCurrent)-1);
+  *(ctimeCurrent+sizeof(ctimeCurrent)-1)=0;
+  if((newline=strchr(ctimeCurrent,'\n'))!=NULL) *newline=0;
+  session->close=1;
+  snprintf(content,sizeof(content),html,status,status,(int)sizeof(session->request)-1);
+  page=nbProxyPageOpen(context,&data,&size);
+  len=snprintf((char *)data,size,response,status,ctimeCurrent,(int)strlen(content),nb_charset,content);
+  nbLogMsg(context,0,'T',"Returning:\n%s\n",data);
+  nbProxyPageProduced(context,page,len);
+  nbProxyPutPage(context,session->client,page);
+  }
 
-static void webContentHeading(nbCELL context,nbWebSession *session,char *code,char *type,char *subtype,int length){
+
+static void webContentHeading(nbCELL context,nbWebSession *session,char *code,char *type,char *subtype,off_t length,char *encoding){
   char ctimeCurrent[32],ctimeExpires[32];
   time_t currentTime;
   nbProxyPage *page;
@@ -588,9 +679,11 @@ static void webContentHeading(nbCELL context,nbWebSession *session,char *code,ch
     "Expires: %s\r\n"
     "Connection: %s\r\n"
     "Accept-Ranges: none\r\n"
-    "Content-Length: %d\r\n"
-    "Content-Type: %s/%s\r\n\r\n",
-    code,ctimeCurrent,ctimeCurrent,ctimeExpires,connection,length,type,subtype);
+    "Content-Length: %ld\r\n"
+    "Content-Type: %s/%s\r\n"
+    "%s%s%s\r\n",
+    code,ctimeCurrent,ctimeCurrent,ctimeExpires,connection,(long)length,type,subtype,
+    encoding ? "Content-Encoding: " : "",encoding ? encoding : "",encoding ? "\r\nVary: Accept-Encoding\r\n" : "");
   if(len>=size) *((char *)data+size-1)=0; // 2012-12-25 eat - AST 9 
   nbLogMsg(context,0,'T',"webContentHeading:");
   nbLogPut(context,data);
@@ -630,6 +723,7 @@ static int nbWebsterCgiCloser(nbPROCESS process,int pid,void *processSession){
   if(length==0 && process->exitcode!=0){
     snprintf(msg,sizeof(msg),"CGI program terminated - exit code=%d",process->exitcode);
     nbWebsterError(context,session,msg);
+    nbProxyProducer(context,session->client,session,nbWebsterShutdownProducer);
     return(0);
     }
   page=nbProxyPageOpen(context,&data,&size);
@@ -649,10 +743,11 @@ static int nbWebsterCgiCloser(nbPROCESS process,int pid,void *processSession){
   // slip this page ahead - should be nbProxyBookPreface function
   page->next=session->book.readPage;
   session->book.readPage=page;
-  // move this book to the proxy and let it go
-  memcpy(&session->client->obook,&session->book,sizeof(nbProxyBook));
+  // 2026-10-18 eat 0.9.04 - append to the output book, which may still hold an earlier reply
+  if(nbProxyPutPage(context,session->client,page)<0) nbProxyBookClose(context,&session->book);
   memset(&session->book,0,sizeof(nbProxyBook));
-  nbProxyProduced(context,session->client,0); // make it schedule
+  if(session->close) nbProxyProducer(context,session->client,session,nbWebsterShutdownProducer);
+  else nbWebsterRequestNext(context,session);
   return(0);
   }
 
@@ -796,6 +891,7 @@ static int nbWebsterCgi(nbCELL context,nbWebSession *session,char *file,char *qu
       }
     }
   nbLogMsg(context,0,'T',"Process %d started",nbMedullaProcessPid(session->process));
+  session->busy=1;  // 2026-10-18 eat 0.9.04 - hold pipelined requests until nbWebsterCgiCloser
   return(0);
   }
 
@@ -806,7 +902,7 @@ static int nbWebsterFileProducer(nbCELL context,nbProxy *proxy,void *handle){
   void *data;
   size_t size;
 
-  if(!session->fd){
+  if(session->fd<0){
     nbLogMsg(context,0,'L',"nbWebsterFileProducer: called without session->fd set");
     return(-1);
     }
@@ -818,12 +914,197 @@ static int nbWebsterFileProducer(nbCELL context,nbProxy *proxy,void *handle){
     }
   else{
     close(session->fd);
-    session->fd=0;
+    session->fd=-1;
+    nbProxyProducer(context,proxy,session,NULL);
     if(session->close) return(2);  // 2012-05-12 eat - think we should return 2 here
+    nbWebsterRequestNext(context,session);  // 2026-10-18 eat 0.9.04
     }
   return(0);
   }
 
+//============================================================================================
+// Static content cache
+//
+//   Entries are found by path in a hash table and kept in a least recently
+//   used list.  The header fields that do not change between requests are
+//   stored ahead of the content, so a reply is a small page with the status,
+//   date and connection fields followed by a cached page referencing the
+//   entry.  An entry removed from the cache is freed when the last page
+//   referencing it has been written.
+//============================================================================================
+
+static unsigned int nbWebsterCacheHash(char *path){
+  unsigned int h=0;
+
+  while(*path) h=h*31+*(unsigned char *)path++;
+  return(h%NB_WEB_CACHE_HASH);
+  }
+
+static void nbWebsterCacheRelease(void *handle){
+  nbWebCache *cache=(nbWebCache *)handle;
+
+  cache->refcnt--;
+  if(cache->refcnt>0) return;
+  free(cache->path);
+  nbFree(cache->data,cache->len);
+  nbFree(cache,sizeof(nbWebCache));
+  }
+
+static void nbWebsterCacheRemove(nbWebServer *webster,nbWebCache *cache){
+  nbWebCache **cacheP;
+
+  for(cacheP=&webster->cacheHash[nbWebsterCacheHash(cache->path)];*cacheP!=cache;cacheP=&(*cacheP)->next);
+  *cacheP=cache->next;
+  if(cache->prior) cache->prior->after=cache->after;
+  else webster->cacheFirst=cache->after;
+  if(cache->after) cache->after->prior=cache->prior;
+  else webster->cacheLast=cache->prior;
+  webster->cacheSize-=cache->len;
+  nbWebsterCacheRelease(cache);
+  }
+
+static void nbWebsterCacheFlush(nbWebServer *webster){
+  while(webster->cacheLast) nbWebsterCacheRemove(webster,webster->cacheLast);
+  }
+
+/*
+*  Get a cache entry for an open file - loading it if necessary
+*
+*    Returns NULL if the file could not be loaded.  The file offset is
+*    restored in that case so the caller can serve the file.
+*/
+static nbWebCache *nbWebsterCacheGet(nbCELL context,nbWebServer *webster,char *path,int fd,struct stat *filestat,char *type,char *subtype,char *encoding){
+  nbWebCache *cache,**cacheP;
+  char head[512],ctimeModified[32],*newline;
+  int headLen,len;
+  ssize_t got;
+  off_t have;
+
+  if(!webster->cacheHash){
+    webster->cacheHash=(nbWebCache **)nbAlloc(NB_WEB_CACHE_HASH*sizeof(nbWebCache *));
+    memset(webster->cacheHash,0,NB_WEB_CACHE_HASH*sizeof(nbWebCache *));
+    }
+  cacheP=&webster->cacheHash[nbWebsterCacheHash(path)];
+  for(cache=*cacheP;cache && strcmp(cache->path,path)!=0;cache=cache->next);
+  if(cache){
+    if(cache->mtime==filestat->st_mtime && cache->fileSize==filestat->st_size){
+      if(cache->prior){  // move to front of list
+        cache->prior->after=cache->after;
+        if(cache->after) cache->after->prior=cache->prior;
+        else webster->cacheLast=cache->prior;
+        cache->prior=NULL;
+        cache->after=webster->cacheFirst;
+        webster->cacheFirst->prior=cache;
+        webster->cacheFirst=cache;
+        }
+      webster->cacheHits++;
+      return(cache);
+      }
+    nbWebsterCacheRemove(webster,cache);  // file has changed
+    }
+  webster->cacheMisses++;
+  strncpy(ctimeModified,asctime(gmtime(&filestat->st_mtime)),sizeof(ctimeModified)-1);
+  *(ctimeModified+sizeof(ctimeModified)-1)=0;
+  if((newline=strchr(ctimeModified,'\n'))!=NULL) *newline=0;
+  headLen=snprintf(head,sizeof(head),
+    "Server: NodeBrain Webster\r\n"
+    "Last-Modified: %s\r\n"
+    "Accept-Ranges: none\r\n"
+    "Content-Length: %ld\r\n"
+    "Content-Type: %s/%s\r\n"
+    "%s%s%s\r\n",
+    ctimeModified,(long)filestat->st_size,type,subtype,
+    encoding ? "Content-Encoding: " : "",encoding ? encoding : "",encoding ? "\r\nVary: Accept-Encoding\r\n" : "");
+  if(headLen>=sizeof(head)) return(NULL);
+  len=headLen+filestat->st_size;
+  cache=(nbWebCache *)nbAlloc(sizeof(nbWebCache));
+  cache->data=(unsigned char *)nbAlloc(len);
+  memcpy(cache->data,head,headLen);
+  for(have=0;have<filestat->st_size;have+=got){
+    got=read(fd,cache->data+headLen+have,filestat->st_size-have);
+    if(got<=0) break;
+    }
+  if(have<filestat->st_size){
+    nbLogMsg(context,0,'W',"Unable to cache %s - %s",path,got<0 ? strerror(errno) : "file is shorter than expected");
+    nbFree(cache->data,len);
+    nbFree(cache,sizeof(nbWebCache));
+    lseek(fd,0,SEEK_SET);
+    return(NULL);
+    }
+  cache->path=strdup(path);
+  if(!cache->path) nbExit("nbWebsterCacheGet: out of memory");
+  cache->mtime=filestat->st_mtime;
+  cache->fileSize=filestat->st_size;
+  cache->refcnt=1;
+  cache->len=len;
+  cache->next=*cacheP;
+  *cacheP=cache;
+  cache->prior=NULL;
+  cache->after=webster->cacheFirst;
+  if(webster->cacheFirst) webster->cacheFirst->prior=cache;
+  else webster->cacheLast=cache;
+  webster->cacheFirst=cache;
+  webster->cacheSize+=len;
+  while(webster->cacheSize>webster->cacheMax && webster->cacheLast!=cache) nbWebsterCacheRemove(webster,webster->cacheLast);
+  if(nb_websterTrace) nbLogMsg(context,0,'T',"nbWebsterCacheGet: cached %s - %zu bytes in cache",path,webster->cacheSize);
+  return(cache);
+  }
+
+/*
+*  Reply with a cached file
+*/
+static void nbWebsterCacheReply(nbCELL context,nbWebSession *session,nbWebCache *cache){
+  char ctimeCurrent[32],ctimeExpires[32];
+  time_t currentTime;
+  nbProxyPage *page;
+  void *data;
+  size_t size;
+  char *connection="keep-alive";
+  int len;
+  char *newline;
+
+  if(session->close) connection="close";
+  time(&currentTime);
+  strncpy(ctimeCurrent,asctime(gmtime(&currentTime)),sizeof(ctimeCurrent)-1);
+  *(ctimeCurrent+sizeof(ctimeCurrent)-1)=0;
+  if((newline=strchr(ctimeCurrent,'\n'))!=NULL) *newline=0;
+  currentTime+=24*60*60; // add one day
+  strncpy(ctimeExpires,asctime(gmtime(&currentTime)),sizeof(ctimeExpires)-1);
+  *(ctimeExpires+sizeof(ctimeExpires)-1)=0;
+  if((newline=strchr(ctimeExpires,'\n'))!=NULL) *newline=0;
+
+  page=nbProxyPageOpen(context,&data,&size);
+  len=snprintf(data,size,
+    "HTTP/1.1 200 OK\r\n"
+    "Date: %s\r\n"
+    "Expires: %s\r\n"
+    "Connection: %s\r\n",
+    ctimeCurrent,ctimeExpires,connection);
+  if(len>=size) *((char *)data+size-1)=0;
+  nbProxyPageProduced(context,page,strlen((char *)data));
+  nbProxyPutPage(context,session->client,page);
+  cache->refcnt++;
+  page=nbProxyPageOpenCached(context,cache->data,cache->len,cache,nbWebsterCacheRelease);
+  nbProxyPutPage(context,session->client,page);
+  }
+
+/*
+*  Select content type by file extension
+*/
+static void webContentType(char *ext,char **type,char **subtype){
+  // This needs to be cleaned up using a lookup tree
+  *type="image";  // gif, png, jpg - all others are images
+  *subtype=ext;
+  if(strcmp(ext,"html")==0 || strcmp(ext,"htm")==0) *type="text",*subtype="html";
+  else if(strcmp(ext,"pdf")==0) *type="application",*subtype="pdf";
+  else if(strcmp(ext,"jar")==0) *type="application",*subtype="java-archive";
+  else if(strcmp(ext,"class")==0) *type="application",*subtype="java-byte-code";
+  else if(strcmp(ext,"js")==0) *type="application",*subtype="x-javascript";
+  else if(strcmp(ext,"text")==0 || strcmp(ext,"txt")==0) *type="text",*subtype="plain";
+  else if(strcmp(ext,"ico")==0) *subtype="vnd.microsoft.icon";
+  else if(strcmp(ext,"css")==0) *type="text",*subtype="css";
+  }
+
 static void nbWebsterResourceNotFound(nbCELL context,nbWebServer *webster,nbWebSession *session){
   nbProxyPage *page;
   void *data;
@@ -853,6 +1134,7 @@ static void nbWebsterResourceNotFound(nbCELL context,nbWebServer *webster,nbWebS
   time(&currentTime);
   strncpy(ctimeCurrent,asctime(gmtime(&currentTime)),sizeof(ctimeCurrent)-1); // 2014-01-25 eat - CID 1164432
   *(ctimeCurrent+sizeof(ctimeCurrent)-1)=0;
+  session->close=1;  // 2026-10-18 eat 0.9.04
   page=nbProxyPageOpen(context,&data,&size);
   len=snprintf((char *)data,size,response,ctimeCurrent,session->reqhost,session->resource,strlen(html),nb_charset,html); // 2012-12-27 eat CID 761999
   if(len>=size) sprintf((char *)data,response,ctimeCurrent,"","",strlen(html),nb_charset,html);  // 2012-12-25 eat - AST 33  // 2012-12-27 eat CID 762000
@@ -879,9 +1161,11 @@ static void nbWebsterResourceNotFound(nbCELL context,nbWebServer *webster,nbWebS
 */
 static void webRequirePassword(nbCELL context,nbWebSession *session);
 static void nbWebsterServe(nbCELL context,nbWebServer *webster,nbWebSession *session){
-  struct stat filestat;      // file statistics
-  int fildes;
-  char filename[1024],content[NB_BUFSIZE],*cursor,*delim;
+  struct stat filestat,gzstat;  // file statistics
+  int fildes,gzfildes;
+  char filename[1024],gzname[1024],content[NB_BUFSIZE],*cursor,*delim;
+  char *type,*subtype,*encoding=NULL;
+  nbWebCache *cache;
   nbWebResource *resource;
   int contentLength;
   nbProxyPage *page;
@@ -957,6 +1241,7 @@ static void nbWebsterServe(nbCELL context,nbWebServer *webster,nbWebSession *ses
       *(ctimeCurrent+sizeof(ctimeCurrent)-1)=0;
       if((newline=strchr(ctimeCurrent,'\n'))!=NULL) *newline=0;
       nbLogMsg(context,0,'T',"Error returned by webCgi");
+      session->close=1;  // 2026-10-18 eat 0.9.04
       page=nbProxyPageOpen(context,&data,&size);
       len=snprintf((char *)data,size,response,ctimeCurrent,session->reqhost,filename,strlen(html),nb_charset,html); // 2012-12-27 eat - CID 762002
       if(len>=size) sprintf((char *)data,response,ctimeCurrent,"","",strlen(html),nb_charset,html);
@@ -997,6 +1282,7 @@ static void nbWebsterServe(nbCELL context,nbWebServer *webster,nbWebSession *ses
     strncpy(ctimeCurrent,asctime(gmtime(&currentTime)),sizeof(ctimeCurrent)-1); // 2014-01-25 eat - CID 1164435
     *(ctimeCurrent+sizeof(ctimeCurrent)-1)=0;
     if((newline=strchr(ctimeCurrent,'\n'))!=NULL) *newline=0;
+    session->close=1;  // 2026-10-18 eat 0.9.04
     page=nbProxyPageOpen(context,&data,&size);
     len=snprintf(content,sizeof(content),html,session->reqhost,filename);
     if(len>=sizeof(content)) sprintf(content,html,"","");
@@ -1038,6 +1324,7 @@ static void nbWebsterServe(nbCELL context,nbWebServer *webster,nbWebSession *ses
     strncpy(ctimeCurrent,asctime(gmtime(&currentTime)),sizeof(ctimeCurrent)-1); // 2014-01-25 eat - CID 1164435
     *(ctimeCurrent+sizeof(ctimeCurrent)-1)=0;
     if((newline=strchr(ctimeCurrent,'\n'))!=NULL) *newline=0;
+    session->close=1;  // 2026-10-18 eat 0.9.04
     page=nbProxyPageOpen(context,&data,&size);
     len=snprintf((char *)data,size,response,ctimeCurrent,session->reqhost,filename,strlen(html),nb_charset,html); // 2012-12-27 eat - CID 762001
     if(len>=size) sprintf((char *)data,response,ctimeCurrent,"","",strlen(html),nb_charset,html); // 2012-12-27 eat - fixed 
@@ -1052,23 +1339,42 @@ static void nbWebsterServe(nbCELL context,nbWebServer *webster,nbWebSession *ses
       cursor=delim+1;
       delim=strchr(cursor,'.');
       }
-    // This needs to be cleaned up using a lookup tree
     nbLogMsg(context,0,'T',"File name: %s",filename);
     nbLogMsg(context,0,'T',"File extension: %s",cursor);
+    webContentType(cursor,&type,&subtype);
+    if(session->gzip){  // 2026-10-18 eat 0.9.04 - use precompressed file when current
+      len=snprintf(gzname,sizeof(gzname),"%s.gz",filename);
+#if defined(WIN32)
+      if(len<sizeof(gzname) && stat(gzname,&gzstat)==0 && gzstat.st_mtime>=filestat.st_mtime && (gzfildes=open(gzname,O_RDONLY|O_BINARY))>=0){
+#else
+      if(len<sizeof(gzname) && stat(gzname,&gzstat)==0 && gzstat.st_mtime>=filestat.st_mtime && (gzfildes=open(gzname,O_RDONLY))>=0){
+#endif
+        close(fildes);
+        fildes=gzfildes;
+        filestat=gzstat;
+        strcpy(filename,gzname);
+        encoding="gzip";
+        }
+      }
+    // 2026-10-18 eat 0.9.04 - serve small files from the cache and others with sendfile when possible
+    if((size_t)filestat.st_size<=webster->cacheFileMax && webster->cacheMax
+      && (cache=nbWebsterCacheGet(context,webster,filename,fildes,&filestat,type,subtype,encoding))!=NULL){
+      close(fildes);
+      nbWebsterCacheReply(context,session,cache);
+      return;
+      }
+    webContentHeading(context,session,"200 OK",type,subtype,filestat.st_size,encoding);
+    if(nbProxyPutFile(context,session->client,fildes,0,filestat.st_size)==0){
+      if(session->close) nbProxyProducer(context,session->client,session,nbWebsterShutdownProducer);
+      else{
+        session->busy=1;
+        nbProxyProducer(context,session->client,session,nbWebsterSendProducer);
+        }
+      return;
+      }
+    session->busy=1;
     session->fd=fildes;
     nbLogMsg(context,0,'T',"Session fd=%d",session->fd);
-    if(strcmp(cursor,"html")==0 || strcmp(cursor,"htm")==0)
-      webContentHeading(context,session,"200 OK","text","html",filestat.st_size);
-    else if(strcmp(cursor,"pdf")==0) webContentHeading(context,session,"200 OK","application","pdf",filestat.st_size);
-    else if(strcmp(cursor,"jar")==0) webContentHeading(context,session,"200 OK","application","java-archive",filestat.st_size);
-    else if(strcmp(cursor,"class")==0) webContentHeading(context,session,"200 OK","application","java-byte-code",filestat.st_size);
-    else if(strcmp(cursor,"js")==0) webContentHeading(context,session,"200 OK","application","x-javascript",filestat.st_size);
-    else if(strcmp(cursor,"text")==0 || strcmp(cursor,"txt")==0)
-        webContentHeading(context,session,"200 OK","text","plain",filestat.st_size);
-    else if(strcmp(cursor,"ico")==0) webContentHeading(context,session,"200 OK","image","vnd.microsoft.icon",filestat.st_size);
-    else if(strcmp(cursor,"css")==0) webContentHeading(context,session,"200 OK","text","css",filestat.st_size);
-    // gif, png, jpg - all others are images
-    else webContentHeading(context,session,"200 OK","image",cursor,filestat.st_size);
     nbLogMsg(context,0,'T',"webServer: context=%p session=%p",context,session);
     nbProxyProducer(context,session->client,session,nbWebsterFileProducer);
     }
@@ -1112,6 +1418,7 @@ static void webRequirePassword(nbCELL context,nbWebSession *session){
   strncpy(ctimeCurrent,asctime(gmtime(&currentTime)),sizeof(ctimeCurrent)-1); // 2014-01-25 eat - CID 1164436
   *(ctimeCurrent+sizeof(ctimeCurrent)-1)=0;
   if((newline=strchr(ctimeCurrent,'\n'))!=NULL) *newline=0;
+  session->close=1;  // 2026-10-18 eat 0.9.04
   page=nbProxyPageOpen(context,&data,&size);
   len=snprintf((char *)data,size,response,ctimeCurrent,strlen(html),nb_charset,html);
   if(len>=size) nbExit("Logic error in webRequirePassword - static content exceeds page size");
@@ -1318,8 +1625,11 @@ static void nbWebsterShutdown(nbCELL context,nbProxy *proxy,void *handle,int cod
     nbProxyShutdown(context,proxy->other,0);
     }
   if(webster->handler && webster->handle) (*webster->handler)(context,session->handle,1);
+  if(session->prior) session->prior->next=session->next;  // 2026-10-18 eat 0.9.04
+  else webster->sessions=session->next;
+  if(session->next) session->next->prior=session->prior;
   // 2012-05-12 eat - included code to free up more things associated with the session
-  if(session->fd) close(session->fd);
+  if(session->fd>=0) close(session->fd);
   if(session->cookiesIn) free(session->cookiesIn);
   if(session->cookiesOut) free(session->cookiesOut);
   nbProxyBookClose(context,&session->book);  // make sure we have a closed book
@@ -1337,6 +1647,55 @@ static int nbWebsterShutdownProducer(nbCELL context,nbProxy *proxy,void *handle)
   return(2); // tell the proxy to shutdown after the buffer is consumed
   }
 
+/*
+*  Set the keep-alive timer to expire no later than the specified time
+*/
+static void nbWebsterSetTimer(nbCELL context,nbWebServer *webster,time_t expires){
+  int seconds;
+
+  if(!webster->synapse || (webster->timerTime && webster->timerTime<=expires)) return;
+  webster->timerTime=expires;
+  seconds=expires-nb_ClockTime;
+  if(seconds<1) seconds=1;
+  nbSynapseSetTimer(context,webster->synapse,seconds);
+  }
+
+/*
+*  Close connections idle longer than the keep-alive timeout
+*
+*    A connection is idle when we are not replying and have nothing left
+*    to write.  The idle time is set when we finish with the requests
+*    received, and each time more input arrives.
+*/
+static void nbWebsterTimer(nbCELL context,void *skillHandle,void *nodeHandle,nbCELL cell){
+  nbWebServer *webster=(nbWebServer *)nodeHandle;
+  nbWebSession *session,*next;
+  time_t expires,nextTime=0;
+
+  webster->timerTime=0;
+  for(session=webster->sessions;session;session=next){
+    next=session->next;
+    if(session->busy || session->close) continue;  // reply will schedule idle time or shutdown
+    if(session->client->obook.readPage || session->client->sendSize) expires=nb_ClockTime+webster->keepAliveTimeout;
+    else expires=session->idleTime+webster->keepAliveTimeout;
+    if(expires<=nb_ClockTime){
+      if(nb_websterTrace) nbLogMsg(context,0,'T',"nbWebsterTimer: closing idle connection %s",nbTlsGetUri(session->client->tls));
+      nbProxyShutdown(context,session->client,0);  // shutdown handler frees the session
+      }
+    else if(!nextTime || expires<nextTime) nextTime=expires;
+    }
+  if(nextTime) nbWebsterSetTimer(context,webster,nextTime);
+  }
+
+/*
+*  Process requests from a client
+*
+*    HTTP/1.1 clients may send requests without waiting for replies.  We
+*    consume one request at a time and reply to requests in order.  When a
+*    reply is produced asynchronously (file producer, sendfile, or cgi), the
+*    session is busy and remaining requests wait in the input book until
+*    nbWebsterRequestNext is called at the end of the reply.
+*/
 static int nbWebsterRequest(nbCELL context,nbProxy *proxy,void *handle){
   nbWebSession *session=(nbWebSession *)handle;
   nbWebServer *webster=session->webster;
@@ -1345,89 +1704,132 @@ static int nbWebsterRequest(nbCELL context,nbProxy *proxy,void *handle){
   int   rc;
   nbProxyPage *page;
   nbCELL filterClass=NULL;
-
-  session->type="text";     // initial type and subtype
-  session->subtype="html";  // handlers may override with call to nbWebsterSetType
-  len=nbProxyBookReadWhere(context,&session->client->ibook,&data);
-  nbLogMsg(context,0,'T',"nbWebsterRequest: len=%d Connection %s ",len,nbTlsGetUri(proxy->tls));
-  *(((char *)data)+len)=0;  // null terminate the request
-  if(nb_websterTrace) nbLogPut(context,"]%s\n",(char *)data);
-  nbLogMsg(context,0,'T',"nbWebsterRequest: calling nbWebsterDecodeRequest");
-  if((rc=nbWebsterDecodeRequest(context,session,(char *)data,len))!=0){
-    if(rc<0){
-      nbWebsterBadRequest(context,session,"Sorry, no hints.");
-      nbLogMsg(context,0,'T',"nbWebsterRequest: nbWebsterDecodeRequest returned non-zero");
-      //return(-1); // force end of session
-      return(0); // let's not force end of session
+  char  text[NB_BUFSIZE];
+
+  session->idleTime=nb_ClockTime;  // 2026-10-18 eat 0.9.04
+  while(!session->busy && (!session->close || webster->forwardUri)){
+    len=nbProxyBookReadWhere(context,&session->client->ibook,&data);
+    if(!len) break;
+    session->type="text";     // initial type and subtype
+    session->subtype="html";  // handlers may override with call to nbWebsterSetType
+    nbLogMsg(context,0,'T',"nbWebsterRequest: len=%d Connection %s ",len,nbTlsGetUri(proxy->tls));
+    if(nb_websterTrace) nbLogPut(context,"]%.*s\n",len,(char *)data);
+    nbLogMsg(context,0,'T',"nbWebsterRequest: calling nbWebsterDecodeRequest");
+    if((rc=nbWebsterDecodeRequest(context,session,(char *)data,len))!=0){
+      if(rc<0){
+        if(rc==-2) nbWebsterTooLarge(context,session,"431 Request Header Fields Too Large");  // 2026-10-18 eat 0.9.04
+        else if(rc==-3) nbWebsterTooLarge(context,session,"413 Content Too Large");
+        else nbWebsterBadRequest(context,session,"Sorry, no hints.");
+        nbLogMsg(context,0,'T',"nbWebsterRequest: nbWebsterDecodeRequest returned non-zero");
+        break;  // close after reply - we can't find the next request
+        }
+      // 2026-10-18 eat 0.9.04 - a pipelined request may continue on the next page
+      if(nbProxyBookJoin(context,&session->client->ibook)) continue;
+      nbLogMsg(context,0,'T',"nbWebsterRequest: did not get the full request - waiting for more input");
+      return(0); // need content wait for call again
       }
-    nbLogMsg(context,0,'T',"nbWebsterRequest: did not get the full request - waiting for more input");
-    return(0); // need content wait for call again
-    }
-  nbLogMsg(context,0,'T',"nbWebsterRequest: nbWebsterDecodeRequest returned zero");
-  //if(!session->server) nbProxyConsumed(context,session->client,len);
-  if(!webster->forwardUri) nbProxyConsumed(context,session->client,len);
-  // experimenting with filter
-  if(webster->filter){
-    nbLogMsg(context,0,'T',"nbWebsterRequest: calling filter\n%s",data);
-    filterClass=nbTranslatorExecute(context,webster->filter,data);
-    if(!filterClass || filterClass==NB_CELL_UNKNOWN){
-      nbLogMsg(context,0,'T',"nbWebsterRequest: filter denied request");
-      nbWebsterResourceNotFound(context,webster,session);
-      return(0); // force end of session
-      } 
-    nbLogMsg(context,0,'T',"nbWebsterRequest: filter accepted request");
-    }
-  // now let's figure what to do
-  //nbProxySend(context,session->proxy,session->request);     // use to inspect the client request
-  session->role=NB_WEBSTER_ROLE_GUEST;
-  if(strcmp(webster->authenticate,"no")!=0){
-    if(strcmp(webster->authenticate,"password")==0) session->role=getRoleByPassword(context,session);
-    else session->role=nbWebGetRoleByCertificate(context,session);
-    if(session->role==NB_WEBSTER_ROLE_REJECT){
-      nbLogMsg(context,0,'T',"webServer: requesting password");
-      webRequirePassword(context,session);  // tell client we need a password
-      // 2010-10-06 eat - experiment
-      //if(!session->server) nbProxyConsumed(context,session->client,len);
-      return(0);
+    nbLogMsg(context,0,'T',"nbWebsterRequest: nbWebsterDecodeRequest returned zero");
+    session->requests++;
+    if(!webster->keepAliveTimeout || (webster->keepAliveMax && session->requests>=webster->keepAliveMax)) session->close=1;
+    // experimenting with filter
+    if(webster->filter){
+      memcpy(text,data,session->reqlen);
+      *(text+session->reqlen)=0;
+      nbLogMsg(context,0,'T',"nbWebsterRequest: calling filter\n%s",text);
+      filterClass=nbTranslatorExecute(context,webster->filter,text);
       }
-    }
-  // call validation function
-  nbLogMsg(context,0,'T',"Request: %s",session->request);
-  // if we are a proxy service, forward to backend server
-  //if(session->server){
-  if(webster->forwardUri){
-    if(!session->server){
-      // For now create a connection each time.  In the future, maintain a pool of connections
-      session->server=nbProxyConnect(context,webster->forwardTlsx,webster->forwardUri,session,NULL,NULL,NULL);
-      if(!session->server){
-        nbLogMsg(context,0,'T',"Unable to establish connection to server for %s",nbTlsGetUri(proxy->tls));
-        return(-1);
+    //if(!session->server) nbProxyConsumed(context,session->client,len);
+    if(!webster->forwardUri) nbProxyConsumed(context,session->client,session->reqlen);
+    if(webster->filter){
+      if(!filterClass || filterClass==NB_CELL_UNKNOWN){
+        nbLogMsg(context,0,'T',"nbWebsterRequest: filter denied request");
+        nbWebsterResourceNotFound(context,webster,session);
+        break; // force end of session
+        } 
+      nbLogMsg(context,0,'T',"nbWebsterRequest: filter accepted request");
+      }
+    // now let's figure what to do
+    //nbProxySend(context,session->proxy,session->request);     // use to inspect the client request
+    session->role=NB_WEBSTER_ROLE_GUEST;
+    if(strcmp(webster->authenticate,"no")!=0){
+      if(strcmp(webster->authenticate,"password")==0) session->role=getRoleByPassword(context,session);
+      else session->role=nbWebGetRoleByCertificate(context,session);
+      if(session->role==NB_WEBSTER_ROLE_REJECT){
+        nbLogMsg(context,0,'T',"webServer: requesting password");
+        webRequirePassword(context,session);  // tell client we need a password
+        // 2010-10-06 eat - experiment
+        //if(!session->server) nbProxyConsumed(context,session->client,len);
+        continue;
         }
-      nbProxyForward(context,session->client,session->server,0x27);
       }
-    else{
-      nbLogMsg(context,0,'T',"nbWebsterRequest: calling nbProxyGetPage");
-      page=nbProxyGetPage(context,session->client);
-      nbLogMsg(context,0,'T',"nbWebsterRequest: nbProxyGetPage returned page=%p",page);
-      while(page){
-        nbLogMsg(context,0,'T',"nbWebsterRequest: calling nbProxyPutPage");
-        rc=nbProxyPutPage(context,session->server,page);
-        nbLogMsg(context,0,'T',"nbWebsterRequest: nbProxyPutPage returned code=%d",rc);
+    // call validation function
+    nbLogMsg(context,0,'T',"Request: %s",session->request);
+    // if we are a proxy service, forward to backend server
+    //if(session->server){
+    if(webster->forwardUri){
+      if(!session->server){
+        // For now create a connection each time.  In the future, maintain a pool of connections
+        session->server=nbProxyConnect(context,webster->forwardTlsx,webster->forwardUri,session,NULL,NULL,NULL);
+        if(!session->server){
+          nbLogMsg(context,0,'T',"Unable to establish connection to server for %s",nbTlsGetUri(proxy->tls));
+          return(-1);
+          }
+        nbProxyForward(context,session->client,session->server,0x27);
+        }
+      else{
+        nbLogMsg(context,0,'T',"nbWebsterRequest: calling nbProxyGetPage");
         page=nbProxyGetPage(context,session->client);
         nbLogMsg(context,0,'T',"nbWebsterRequest: nbProxyGetPage returned page=%p",page);
+        while(page){
+          nbLogMsg(context,0,'T',"nbWebsterRequest: calling nbProxyPutPage");
+          rc=nbProxyPutPage(context,session->server,page);
+          nbLogMsg(context,0,'T',"nbWebsterRequest: nbProxyPutPage returned code=%d",rc);
+          page=nbProxyGetPage(context,session->client);
+          nbLogMsg(context,0,'T',"nbWebsterRequest: nbProxyGetPage returned page=%p",page);
+          }
         }
+      nbLogMsg(context,0,'T',"nbWebsterRequest: returning");
+      return(0);
+      }
+    // ok, just act like a little web server
+    if(chdir(webster->rootdir)==0){
+      nbWebsterServe(context,webster,session);
+      if(chdir(webster->dir)<0) nbAbort("Webster unable to chdir back to document directory");
       }
-    nbLogMsg(context,0,'T',"nbWebsterRequest: returning");
-    return(0);
     }
-  // ok, just act like a little web server
-  if(chdir(webster->rootdir)==0){
-    nbWebsterServe(context,webster,session);
-    if(chdir(webster->dir)<0) nbAbort("Webster unable to chdir back to document directory");
+  // 2026-10-18 eat 0.9.04 - close after the reply or wait for the next request
+  if(session->busy) return(0);
+  if(session->close) nbProxyProducer(context,session->client,session,nbWebsterShutdownProducer);
+  else{
+    session->idleTime=nb_ClockTime;
+    nbWebsterSetTimer(context,webster,nb_ClockTime+webster->keepAliveTimeout);
     }
   return(0);
   }
 
+/*
+*  Continue with pipelined requests after a reply
+*
+*    This is called when an asynchronous reply has been produced.  When
+*    called from a producer, the producer returns 2 instead of calling
+*    this function if the connection is to be closed.
+*/
+static void nbWebsterRequestNext(nbCELL context,nbWebSession *session){
+  session->busy=0;
+  nbWebsterRequest(context,session->client,session);
+  }
+
+// 2026-10-18 eat 0.9.04 - continue with the next request after sendfile is done
+static int nbWebsterSendProducer(nbCELL context,nbProxy *proxy,void *handle){
+  nbWebSession *session=(nbWebSession *)handle;
+
+  if(proxy->sendSize) return(0);
+  nbProxyProducer(context,proxy,session,NULL);
+  if(session->close) return(2);
+  nbWebsterRequestNext(context,session);
+  return(0);
+  }
+
 static int nbWebsterAccept(nbCELL context,nbProxy *proxy,void *handle){
   nbWebServer *webster=(nbWebServer *)handle;
   nbWebSession *session;
@@ -1437,12 +1839,16 @@ static int nbWebsterAccept(nbCELL context,nbProxy *proxy,void *handle){
   // 2012-10-13 eat - replaced malloc
   session=(nbWebSession *)nbAlloc(sizeof(nbWebSession));
   memset(session,0,sizeof(nbWebSession));
+  session->fd=-1;  // 2026-10-18 eat 0.9.04 - zero is a valid descriptor
   session->webster=webster;
   session->role=NB_WEBSTER_ROLE_REJECT;
   *session->userid=0;
   session->contentLength=0;
   session->content=NULL;
   session->client=proxy;
+  session->next=webster->sessions;  // 2026-10-18 eat 0.9.04 - list for keep-alive timer
+  if(session->next) session->next->prior=session;
+  webster->sessions=session;
   nbLogMsg(context,0,'T',"nbWebsterAccept: webster->handler=%p webstger->handle=%p",webster->handler,webster->handle);
   if(webster->handler) session->handle=(*webster->handler)(context,webster->handle,0);
   //session=(nbWebSession *)nbAlloc(sizeof(nbWebSession));
@@ -1575,6 +1981,14 @@ int nbWebsterEnable(nbCELL context,nbWebServer *webster){
   //else{  // change to function call ctx=getSSLContext(context);
 
   webster->authenticate=strdup(nbTermOptionString(context,"Authenticate","yes"));
+  // 2026-10-18 eat 0.9.04 - static content cache limits in KB - zero disables the cache
+  webster->cacheMax=(size_t)nbTermOptionInteger(context,"CacheSize",8192)*1024;
+  webster->cacheFileMax=(size_t)nbTermOptionInteger(context,"CacheFileSize",1024)*1024;
+  // 2026-10-18 eat 0.9.04 - persistent connections - zero timeout closes after each reply
+  webster->keepAliveTimeout=nbTermOptionInteger(context,"KeepAliveTimeout",15);
+  if(webster->keepAliveTimeout<0) webster->keepAliveTimeout=0;
+  webster->keepAliveMax=nbTermOptionInteger(context,"KeepAliveMax",100);
+  if(webster->keepAliveTimeout>0 && !webster->synapse) webster->synapse=nbSynapseOpen(context,NULL,webster,NULL,nbWebsterTimer);
 
 //  webster->ctx=ctx;
 
@@ -1859,10 +2273,9 @@ int *nbWebsterReply(nbCELL context,nbWebSession *session){
   // slip this page ahead - should be nbProxyBookPreface function
   page->next=session->book.readPage;
   session->book.readPage=page;
-  // move this book to the proxy and let it go
-  memcpy(&session->client->obook,&session->book,sizeof(nbProxyBook));
+  // 2026-10-18 eat 0.9.04 - append to the output book, which may still hold an earlier reply
+  if(nbProxyPutPage(context,session->client,page)<0) nbProxyBookClose(context,&session->book);
   memset(&session->book,0,sizeof(nbProxyBook));
-  nbProxyProduced(context,session->client,0); // make it schedule
   if(session->cookiesOut){
     free(session->cookiesOut);
     session->cookiesOut=NULL;
@@ -1878,6 +2291,13 @@ int nbWebsterDisable(nbCELL context,nbWebServer *webster){
   // include code to shutdown webster->server
   free(webster->rootdir);
   free(webster->authenticate);
+  nbWebsterCacheFlush(webster);  // 2026-10-18 eat 0.9.04
+  if(webster->synapse) webster->synapse=nbSynapseClose(context,webster->synapse);
+  webster->timerTime=0;
+  if(webster->cacheHash){
+    nbFree(webster->cacheHash,NB_WEB_CACHE_HASH*sizeof(nbWebCache *));
+    webster->cacheHash=NULL;
+    }
   return(0);
   }
 
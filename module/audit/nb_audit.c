@@ -28,13 +28,25 @@
 *   
 * Synopsis:
 *
-*   define <term> node audit("<logfile>","<translator>",<schedule>);
+*   define <term> node audit("<logfile>","<translator>"[,<schedule>]);
 *
 * Description:
 *
 *   A log file is any text file that grows over time.  Normally each line
 *   identifies an event, although this is not a requirement.
 *
+*   When a schedule is specified, the file is checked for new lines when
+*   the schedule toggles to true.  Otherwise the file is checked when
+*   inotify reports a change in the directory containing the file (Linux
+*   only), so lines are processed as soon as they are written.
+*
+*   In both modes the file is kept open.  A file smaller than our position
+*   has been truncated and is read from the beginning.  When the file name
+*   refers to a new inode, the file has been rotated, so we finish the old
+*   file and read the new one from the beginning.  Data is read in large
+*   chunks and lines are split in place, so there is no limit on line
+*   length short of NB_AUDIT_LINEMAX, where a line is split.
+*
 * History:
 *
 *   This module replaces the obselete LOG listener.
@@ -62,6 +74,10 @@
 * 2007/06/25 eat 0.6.8  Structured skill module around old LOG listener code
 * 2010-02-25 eat 0.7.9  Cleaned up -Wall warning messages
 * 2012-10-13 eat 0.8.12 Replaced malloc/free with nbAlloc/nbFree
+* 2026-10-18 eat 0.9.04 Included inotify event mode and kept the file open
+*            Also replaced fgets with buffered reads to support long lines
+*            and included detection of file rotation by inode.
+* 2026-10-18 eat 0.9.04 Filtered inotify events on the audited file name
 *=====================================================================
 */
 #include "config.h"
@@ -69,15 +85,32 @@
 
 //=============================================================================
  
+#if defined(HAVE_SYS_INOTIFY_H)
+#include <sys/inotify.h>
+#endif
+
+#define NB_AUDIT_BUFSIZE  64*1024      // initial read buffer size
+#define NB_AUDIT_LINEMAX  1024*1024    // longest line before splitting
+
+//=============================================================================
+ 
 struct NB_MOD_AUDIT{
-  FILE   *file;                // audit file
+  int    fd;                   // audit file descriptor - -1 when closed
   long   pos;                  // current position within file
+  dev_t  dev;                  // device of open file
+  ino_t  ino;                  // inode of open file - a new inode means the file was rotated
+  char   *buf;                 // read buffer
+  size_t bufsize;              // size of read buffer
+  size_t buflen;               // bytes of partial line at start of buffer
+  int    inotify;              // inotify descriptor in event mode - -1 otherwise
+  int    enabled;              // 1 when enabled
   nbCELL fileNameCell;         // cell containing file name
   char   *fileName;            // file name
+  char   *baseName;            // file name within directory - matched against inotify events
   nbCELL translatorNameCell;   // cell containing translator name
   char   *translatorName;      // translator name
   nbCELL translatorCell;       // translator cell
-  nbCELL scheduleCell;         // schedule for checking file for new lines
+  nbCELL scheduleCell;         // schedule for checking file for new lines - NULL in event mode
   nbCELL synapseCell;          // synapse for monitoring schedule
   unsigned char trace;         // trace option
   };
@@ -92,63 +125,183 @@ typedef struct NB_MOD_AUDIT nbAudit;
 
 static int auditDisable(nbCELL context,void *skillHandle,nbAudit *audit);
 
+// Open the file and remember which file we have open
+//
+//   When end is true, we position to the end of the file so only new
+//   lines are read.
+
+static int auditOpen(nbCELL context,nbAudit *audit,int end){
+  struct stat st;
+
+  if((audit->fd=open(audit->fileName,O_RDONLY))<0) return(1);
+  if(fstat(audit->fd,&st)<0){
+    close(audit->fd);
+    audit->fd=-1;
+    return(1);
+    }
+  audit->dev=st.st_dev;
+  audit->ino=st.st_ino;
+  audit->pos=end ? (long)st.st_size : 0;
+  if(lseek(audit->fd,audit->pos,SEEK_SET)<0){
+    nbLogMsg(context,0,'E',"File \"%s\" lseek failed errno=%d.",audit->fileName,errno);
+    close(audit->fd);
+    audit->fd=-1;
+    return(1);
+    }
+  audit->buflen=0;
+  return(0);
+  }
+
+// Read new data and pass each complete line to the translator
+//
+//   Lines are split in place within the read buffer.  A partial line at
+//   the end of the buffer is moved to the front and completed by the next
+//   read.  The buffer grows for long lines up to NB_AUDIT_LINEMAX, after
+//   which a line is split.
+//
+//   Returns: 0 - ok, 1 - node disabled by a translator action
+
+static int auditRead(nbCELL context,nbAudit *audit){
+  char *line,*end,*cursor;
+  ssize_t len;
+
+  while(1){
+    if(audit->buflen==audit->bufsize){
+      if(audit->bufsize<NB_AUDIT_LINEMAX){
+        char *buf=nbAlloc(audit->bufsize*2+1);
+        memcpy(buf,audit->buf,audit->buflen);
+        nbFree(audit->buf,audit->bufsize+1);
+        audit->buf=buf;
+        audit->bufsize*=2;
+        }
+      else{   // split an extremely long line
+        *(audit->buf+audit->buflen)=0;
+        nbTranslatorExecute(context,audit->translatorCell,audit->buf);
+        if(audit->fd<0) return(1);
+        audit->buflen=0;
+        }
+      }
+    len=read(audit->fd,audit->buf+audit->buflen,audit->bufsize-audit->buflen);
+    if(len<0 && errno==EINTR) continue;
+    if(len<=0) break;
+    audit->pos+=len;
+    line=audit->buf;
+    end=audit->buf+audit->buflen+len;
+    while(line<end && (cursor=memchr(line,'\n',end-line))!=NULL){
+      *cursor=0;
+      if(audit->trace) nbLogPut(context,"] %s\n",line);
+      nbTranslatorExecute(context,audit->translatorCell,line);
+      if(audit->fd<0){
+        nbLogMsg(context,0,'W',"Node disabled during file processing");
+        return(1);
+        }
+      line=cursor+1;
+      }
+    audit->buflen=end-line;
+    if(audit->buflen>0 && line>audit->buf) memmove(audit->buf,line,audit->buflen);
+    }
+  return(0);
+  }
+
+// Check the file for new lines, truncation, and rotation
+//
+//   A file that is smaller than our position has been truncated, so we
+//   start over at the beginning.  A file name that now refers to another
+//   inode has been rotated, so we finish reading the old file and then
+//   read the new file from the beginning.
+
+static void auditCheck(nbCELL context,void *skillHandle,nbAudit *audit){
+  struct stat st;
+
+  if(audit->fd<0){
+    if(auditOpen(context,audit,0)) return;  // still waiting for the file to reappear
+    nbLogMsg(context,0,'I',"File \"%s\" opened.",audit->fileName);
+    }
+  if(fstat(audit->fd,&st)==0 && st.st_size<audit->pos){
+    nbLogMsg(context,0,'I',"File \"%s\" has shrunk from %ld to %ld, starting at beginning.",audit->fileName,audit->pos,(long)st.st_size);
+    lseek(audit->fd,0,SEEK_SET);
+    audit->pos=0;
+    audit->buflen=0;
+    }
+  if(audit->trace) nbLogBar(context);
+  if(auditRead(context,audit)) return;
+  if(audit->trace){
+    nbLogBar(context);
+    nbLogMsg(context,0,'T',"File size=%ld",audit->pos);
+    }
+  if(stat(audit->fileName,&st)<0 || st.st_dev!=audit->dev || st.st_ino!=audit->ino){
+    nbLogMsg(context,0,'I',"File \"%s\" rotated.",audit->fileName);
+    close(audit->fd);
+    audit->fd=-1;
+    if(auditOpen(context,audit,0)) return;  // wait for the new file
+    auditRead(context,audit);
+    }
+  }
+
 // Check for new lines in the file
 //   This function is scheduled by auditEnable() using nbSynapseOpen()
 
 static void auditAlarm(nbCELL context,void *skillHandle,void *nodeHandle,nbCELL cell){
   nbAudit *audit=(nbAudit *)nodeHandle;
   nbCELL value=nbCellGetValue(context,cell);
-  char logbuf[2048],*cursor;
-  long endloc;
 
   if(value!=NB_CELL_TRUE) return;  // only act when schedule toggles to true
+  auditCheck(context,skillHandle,audit);
+  }
 
-  if((audit->file=fopen(audit->fileName,"r"))==NULL){
-    nbLogMsg(context,0,'E',"Log file \"%s\" not found - disabling node.",audit->fileName);
-    auditDisable(context,skillHandle,audit);
-    return;
-    }
-  if((fseek(audit->file,0,SEEK_END))!=0){
-    nbLogMsg(context,0,'E',"Log file \"%s\" fseek failed errno=%d - disabling node.",audit->fileName,errno);
-    auditDisable(context,skillHandle,audit);
-    return;
-    }
-  endloc=ftell(audit->file);
-  if(endloc==audit->pos){
-    if(audit->trace) nbLogMsg(context,0,'T',"File \"%s\" has not grown.",audit->fileName);
-    fclose(audit->file);
-    audit->file=NULL;
-    return;
-    }
-  if(endloc<audit->pos){
-    nbLogMsg(context,0,'I',"File \"%s\" has shrunk from %d to %d, starting at beginning.",audit->fileName,audit->pos,endloc);
-    audit->pos=0;
+#if defined(HAVE_SYS_INOTIFY_H)
+// Check for new lines when notified of a change
+//   This function is registered by auditEnable() using nbListenerAdd()
+//
+//   We watch the directory instead of the file so we are notified when a
+//   rotated file is replaced.  Other files in the directory generate events
+//   too, so we only check the file when an event names it, or when events
+//   have been dropped because the queue overflowed.
+
+static void auditEvent(nbCELL context,int fildes,void *session){
+  nbAudit *audit=(nbAudit *)session;
+  char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+  struct inotify_event *event;
+  char *cursor;
+  ssize_t len;
+  int changed=0;
+
+  while((len=read(fildes,buffer,sizeof(buffer)))>0 || (len<0 && errno==EINTR)){
+    if(len<0) continue;
+    for(cursor=buffer;cursor<buffer+len;cursor+=sizeof(struct inotify_event)+event->len){
+      event=(struct inotify_event *)cursor;
+      if(event->mask&IN_Q_OVERFLOW || (event->len && strcmp(event->name,audit->baseName)==0)) changed=1;
+      }
     }
-  if((fseek(audit->file,audit->pos,SEEK_SET))!=0){
-    nbLogMsg(context,0,'E',"File \"%s\" fseek failed errno=%d.",audit->fileName,errno);
-    fclose(audit->file);
-    audit->file=NULL;
-    auditDisable(context,skillHandle,audit);
-    return;
+  if(!changed) return;
+  if(audit->trace) nbLogMsg(context,0,'T',"File \"%s\" changed.",audit->fileName);
+  auditCheck(context,NULL,audit);
+  }
+
+static int auditWatch(nbCELL context,nbAudit *audit){
+  char dir[1024],*name;
+
+  if((audit->inotify=inotify_init())<0){
+    nbLogMsg(context,0,'E',"Unable to initialize inotify - %s",strerror(errno));
+    return(1);
     }
-  if(audit->trace) nbLogBar(context);
-  while(fgets(logbuf,2048,audit->file)!=NULL){
-    cursor=strchr(logbuf,'\n');
-    if(cursor!=NULL) *cursor=0;
-    if(audit->trace) nbLogPut(context,"] %s\n",logbuf);
-    //nbLogPut(context,"] %s\n",logbuf);
-    nbTranslatorExecute(context,audit->translatorCell,logbuf);
-    if(audit->file==NULL){
-      nbLogMsg(context,0,'W',"Node disabled during file processing");
-      return;
-      }
+  fcntl(audit->inotify,F_SETFL,O_NONBLOCK);
+  fcntl(audit->inotify,F_SETFD,FD_CLOEXEC);
+  strncpy(dir,audit->fileName,sizeof(dir)-1);
+  *(dir+sizeof(dir)-1)=0;
+  if((name=strrchr(dir,'/'))!=NULL) *name=0;
+  else strcpy(dir,".");
+  if(!*dir) strcpy(dir,"/");
+  if(inotify_add_watch(audit->inotify,dir,IN_MODIFY|IN_CREATE|IN_MOVED_TO|IN_MOVED_FROM|IN_DELETE|IN_CLOSE_WRITE)<0){
+    nbLogMsg(context,0,'E',"Unable to watch directory \"%s\" - %s",dir,strerror(errno));
+    close(audit->inotify);
+    audit->inotify=-1;
+    return(1);
     }
-  if(audit->trace) nbLogBar(context);
-  audit->pos=ftell(audit->file);
-  if(audit->trace) nbLogMsg(context,0,'T',"File size=%u",audit->pos);
-  fclose(audit->file);
-  audit->file=NULL;
+  nbListenerAdd(context,audit->inotify,audit,auditEvent);
+  return(0);
   }
+#endif
 
 //==================================================================================
 // Skill Methods
@@ -196,6 +349,12 @@ static void *auditConstruct(nbCELL context,void *skillHandle,nbCELL arglist,char
   translatorName=nbCellGetString(context,translatorNameCell);  
 
   scheduleCell=nbListGetCell(context,&argSet);  // get schedule cell - not value
+#if !defined(HAVE_SYS_INOTIFY_H)
+  if(scheduleCell==NULL){
+    nbLogMsg(context,0,'E',"Expecting schedule as third parameter - event mode is not supported on this platform");
+    return(NULL);
+    }
+#endif
  
   nullCell=nbListGetCellValue(context,&argSet);
   if(nullCell!=NULL){
@@ -209,10 +368,17 @@ static void *auditConstruct(nbCELL context,void *skillHandle,nbCELL arglist,char
     return(NULL);
     }
   audit=nbAlloc(sizeof(struct NB_MOD_AUDIT));
-  audit->file=NULL;
+  audit->fd=-1;
   audit->pos=0;
+  audit->bufsize=NB_AUDIT_BUFSIZE;
+  audit->buf=nbAlloc(audit->bufsize+1);
+  audit->buflen=0;
+  audit->inotify=-1;
+  audit->enabled=0;
   audit->fileNameCell=fileNameCell;
   audit->fileName=fileName;
+  if((audit->baseName=strrchr(fileName,'/'))!=NULL) audit->baseName++;
+  else audit->baseName=fileName;
   audit->translatorNameCell=translatorNameCell;
   audit->translatorName=translatorName;
   audit->translatorCell=nbCellGrab(context,translatorCell);
@@ -233,20 +399,20 @@ static void *auditConstruct(nbCELL context,void *skillHandle,nbCELL arglist,char
 */
 static int auditEnable(nbCELL context,void *skillHandle,nbAudit *audit){
   if(audit->trace) nbLogMsg(context,0,'T',"auditEnable() called %s using",audit->fileName,audit->translatorName);
-  if((audit->file=fopen(audit->fileName,"r"))==NULL){
+  if(audit->enabled) return(0);
+  if(auditOpen(context,audit,1)){
     nbLogMsg(context,0,'E',"Unable to open audit file \"%s\".",audit->fileName);
     return(1);
     }
-  if((fseek(audit->file,0,SEEK_END))!=0){
-    nbLogMsg(context,0,'L',"Failed fseek on \"%s\" - errno=%d.",audit->fileName,errno);
-    fclose(audit->file);
-    audit->file=NULL;
+  if(audit->scheduleCell) audit->synapseCell=nbSynapseOpen(context,skillHandle,audit,audit->scheduleCell,auditAlarm);
+#if defined(HAVE_SYS_INOTIFY_H)
+  else if(auditWatch(context,audit)){
+    close(audit->fd);
+    audit->fd=-1;
     return(1);
     }
-  audit->pos=ftell(audit->file);
-  if(fclose(audit->file)!=0) nbLogMsg(context,0,'L',"File close failed - errno=%d %s",errno,strerror(errno));
-  audit->file=NULL;
-  audit->synapseCell=nbSynapseOpen(context,skillHandle,audit,audit->scheduleCell,auditAlarm);
+#endif
+  audit->enabled=1;
   nbLogMsg(context,0,'I',"Enabled audit of %s using %s",audit->fileName,audit->translatorName);
   nbLogFlush(context);
   return(0);
@@ -260,13 +426,20 @@ static int auditEnable(nbCELL context,void *skillHandle,nbAudit *audit){
 */
 static int auditDisable(nbCELL context,void *skillHandle,nbAudit *audit){
   if(audit->trace) nbLogMsg(context,0,'T',"auditDisable() called");
+  if(!audit->enabled) return(0);  // already disabled
   if(audit->synapseCell) audit->synapseCell=nbSynapseClose(context,audit->synapseCell);  // release the synapse
-  else return(0);  // already disabled
-  if(audit->file){
-    if(fclose(audit->file)!=0) nbLogMsg(context,0,'L',"File close failed - errno=%d %s",errno,strerror(errno));
-    audit->file=NULL;
+  if(audit->inotify>=0){
+    nbListenerRemove(context,audit->inotify);
+    close(audit->inotify);
+    audit->inotify=-1;
+    }
+  if(audit->fd>=0){
+    if(close(audit->fd)!=0) nbLogMsg(context,0,'L',"File close failed - errno=%d %s",errno,strerror(errno));
+    audit->fd=-1;
     }
   audit->pos=0;
+  audit->buflen=0;
+  audit->enabled=0;
   nbLogMsg(context,0,'I',"Disabled audit of %s using %s",audit->fileName,audit->translatorName);
   return(0);
   }
@@ -295,7 +468,8 @@ static int auditDestroy(nbCELL context,void *skillHandle,nbAudit *audit){
   if(audit->trace) nbLogMsg(context,0,'T',"auditDestroy called");
   auditDisable(context,skillHandle,audit);
   nbCellDrop(context,audit->fileNameCell);
-  nbCellDrop(context,audit->scheduleCell);
+  if(audit->scheduleCell) nbCellDrop(context,audit->scheduleCell);
+  nbFree(audit->buf,audit->bufsize+1);
   nbCellDrop(context,audit->translatorCell);
   nbCellDrop(context,audit->translatorNameCell);
   nbFree(audit,sizeof(struct NB_MOD_AUDIT));
@@ -48,12 +48,14 @@
 *     <options>    - comma separated options
 *                    "sum"    - add asserted values over each period and only check upper limits until end of period
 *                    "static" - profile is not modified (use in cases where training is complete)
+*                    "text"   - store profile in text format (nnnnnnnn.nb) instead of binary
 *
 *   Command:
 *
 *     <node>[(args)][:text]
 *
 *     .(name1,name2,...):set average,deviation;
+*     .:export <file>    - write the profile in text format
 *
 *   Cell Expression:
 *
@@ -112,12 +114,31 @@
 *   name is nnnnnnnn.nb where nnnnnnnn is a multiple of the period and less than
 *   the cycle time.
 *
-*   The format of a baseline file is a set of node commands.
+*   The baseline file for a period is a binary profile named nnnnnnnn.nbp.
+*   It contains a header, a packed array of average and deviation pairs,
+*   an array of key offsets, and the keys.  Each key is the list of
+*   qualifiers encoded as type and value ('s' string with null terminator,
+*   'r' double, 'u' unknown), and entries are sorted by key.  The file is
+*   memory mapped and loaded into the tree without the command interpreter.
+*
+*     header       "NBBP", version, count, key size
+*     values       double average,deviation [count]
+*     keyoff       unsigned int [count+1]
+*     keys         char [key size]
+*
+*   A new profile is written by a forked process to a temporary file that
+*   is renamed when complete, so the agent does not wait for the write and
+*   a reader never sees a partial file.
+*
+*   With the "text" option, or when no binary profile exists for the period,
+*   the text format is used.  It is a set of node commands loaded with the
+*   command interpreter.
 *
 *    .("name1","name2",...):set <average>,<deviation>;
 *
-*   This enables a "source" command to be used to load the baseline for each
-*   period.
+*   The export command writes the profile in text format, or in binary
+*   format when the file name ends in ".nbp".  The load command reads a
+*   profile file in either format.
 *
 *=============================================================================
 * Change History:
@@ -130,11 +151,16 @@
 * 2010-09-26 eat - included threshold in node to avoid recomputing on every assertion
 * 2012-12-27 eat 0.8.13 AST 46 - removed commented out function
 * 2013-01-14 eat 0.8.13 Checker updates
+* 2026-10-18 eat 0.9.04 Added binary profile format written in the background
+* 2026-10-18 eat 0.9.04 Included binary export and load command for profile files
 *=============================================================================
 */
 #include "config.h"
 #include <nb/nb.h>
 #include <nb/nbtree.h>
+#if !defined(_WINDOWS)
+#include <sys/mman.h>
+#endif
 
 #if defined(_WINDOWS)
 BOOL WINAPI DllMain(HINSTANCE hinstDLL,DWORD fdwReason,LPVOID lpvReserved){
@@ -185,6 +211,35 @@ typedef struct BTREE{
 #define BTREE_OPTION_PARTITION   4  // Match on highest value <= argument
 #define BTREE_OPTION_SUM         8  // Sum values over each period
 #define BTREE_OPTION_STATIC     16  // Don't update baseline profile
+#define BTREE_OPTION_TEXT       32  // Store baseline profile in text format
+
+#define BTREE_STORE_VALUE        0  // store values as assertions
+#define BTREE_STORE_LEARN        1  // update profile and store it
+#define BTREE_STORE_EXPORT       2  // store profile without updating it
+
+#define BTREE_QUALIFIERS_MAX    32  // maximum qualifiers (columns) in a measure key
+
+/* Binary profile file */
+
+#define BPROFILE_VERSION         1
+
+typedef struct BPROFILE_HEADER{
+  char         magic[4];       // "NBBP"
+  unsigned int version;        // BPROFILE_VERSION - also detects byte order
+  unsigned int count;          // number of entries
+  unsigned int keysize;        // size of key area
+  } BProfileHeader;
+
+typedef struct BPROFILE{
+  unsigned int count;          // number of entries
+  unsigned int alloc;          // entries allocated
+  double      *values;         // average and deviation pairs
+  unsigned int *keyoff;        // key offset for each entry
+  char        *keys;           // encoded keys
+  unsigned int keysize;        // size of encoded keys
+  unsigned int keyalloc;       // size of key area allocated
+  int          error;          // unable to allocate memory
+  } BProfile;
 
 typedef struct BTREE_SKILL{
   char trace;                    /* trace option */
@@ -350,6 +405,7 @@ static void *baselineConstruct(nbCELL context,BTreeSkill *skillHandle,nbCELL arg
     else if(strcmp(ident,"partition")==0) options|=BTREE_OPTION_PARTITION|BTREE_OPTION_ORDER;
     else if(strcmp(ident,"sum")==0) options|=BTREE_OPTION_SUM;
     else if(strcmp(ident,"static")==0) options|=BTREE_OPTION_STATIC;
+    else if(strcmp(ident,"text")==0) options|=BTREE_OPTION_TEXT;
     else if(strcmp(ident,"found")==0 || strcmp(ident,"notfound")==0){
       if(*cursor!='='){
         nbLogMsg(context,0,'E',"Expecting '=' at \"%s\".",cursor);
@@ -422,6 +478,287 @@ static int treeStoreValue(nbCELL context,nbCELL cell,char *cursor,size_t len){
   return(n);
   }
 
+//===========================================================================================================
+// Binary profile
+//===========================================================================================================
+
+static BProfile *bprofileOpen(void){
+  BProfile *profile;
+
+  profile=(BProfile *)nbAlloc(sizeof(BProfile));
+  memset(profile,0,sizeof(BProfile));
+  return(profile);
+  }
+
+static void bprofileClose(BProfile *profile){
+  if(profile->values) free(profile->values);
+  if(profile->keyoff) free(profile->keyoff);
+  if(profile->keys) free(profile->keys);
+  nbFree(profile,sizeof(BProfile));
+  }
+
+/*
+*  Add an entry to a profile
+*
+*  Returns: 0 - success, -1 - unable to allocate memory
+*/
+static int bprofileAdd(nbCELL context,BProfile *profile,nbCELL element[],int qualifiers,double average,double deviation){
+  unsigned int need,len;
+  char *string;
+  double real,*values;
+  unsigned int *keyoff;
+  char *keys;
+  int i;
+
+  if(profile->error) return(-1);
+  if(profile->count>=profile->alloc){
+    profile->alloc=profile->alloc ? profile->alloc*2 : 1024;
+    if((values=(double *)realloc(profile->values,profile->alloc*2*sizeof(double)))!=NULL) profile->values=values;
+    if((keyoff=(unsigned int *)realloc(profile->keyoff,profile->alloc*sizeof(unsigned int)))!=NULL) profile->keyoff=keyoff;
+    if(values==NULL || keyoff==NULL){
+      profile->error=1;
+      return(-1);
+      }
+    }
+  need=0;
+  for(i=0;i<qualifiers;i++){
+    switch(nbCellGetType(context,element[i])){
+      case NB_TYPE_STRING: need+=strlen(nbCellGetString(context,element[i]))+2; break;
+      case NB_TYPE_REAL:   need+=1+sizeof(double); break;
+      default:             need+=1;
+      }
+    }
+  if(profile->keysize+need>profile->keyalloc){
+    while(profile->keysize+need>profile->keyalloc) profile->keyalloc=profile->keyalloc ? profile->keyalloc*2 : 64*1024;
+    if((keys=(char *)realloc(profile->keys,profile->keyalloc))==NULL){
+      profile->error=1;
+      return(-1);
+      }
+    profile->keys=keys;
+    }
+  profile->keyoff[profile->count]=profile->keysize;
+  for(i=0;i<qualifiers;i++){
+    switch(nbCellGetType(context,element[i])){
+      case NB_TYPE_STRING:
+        string=nbCellGetString(context,element[i]);
+        len=strlen(string)+1;
+        *(profile->keys+profile->keysize)='s';
+        memcpy(profile->keys+profile->keysize+1,string,len);
+        profile->keysize+=1+len;
+        break;
+      case NB_TYPE_REAL:
+        real=nbCellGetReal(context,element[i]);
+        *(profile->keys+profile->keysize)='r';
+        memcpy(profile->keys+profile->keysize+1,&real,sizeof(double));
+        profile->keysize+=1+sizeof(double);
+        break;
+      default:
+        *(profile->keys+profile->keysize)='u';
+        profile->keysize++;
+      }
+    }
+  profile->values[profile->count*2]=average;
+  profile->values[profile->count*2+1]=deviation;
+  profile->count++;
+  return(0);
+  }
+
+static BProfile *bprofileSort_profile;  // profile being sorted
+
+static int bprofileCompare(const void *e1,const void *e2){
+  BProfile *profile=bprofileSort_profile;
+  unsigned int i1=*(unsigned int *)e1,i2=*(unsigned int *)e2;
+  unsigned int len1,len2;
+  int rc;
+
+  len1=(i1+1<profile->count ? profile->keyoff[i1+1] : profile->keysize)-profile->keyoff[i1];
+  len2=(i2+1<profile->count ? profile->keyoff[i2+1] : profile->keysize)-profile->keyoff[i2];
+  rc=memcmp(profile->keys+profile->keyoff[i1],profile->keys+profile->keyoff[i2],len1<len2 ? len1 : len2);
+  if(rc) return(rc);
+  return(len1<len2 ? -1 : len1>len2);
+  }
+
+/*
+*  Write a profile sorted by key to a temporary file and rename it
+*
+*  Returns: 0 - success, -1 - error (errno set)
+*/
+static int bprofileWrite(BProfile *profile,char *filename){
+  BProfileHeader header;
+  char tmpname[520],*keys=NULL;
+  double *values=NULL;
+  unsigned int *index=NULL,*keyoff=NULL,i,j,len,off;
+  FILE *file;
+  int rc=-1;
+
+  if((index=(unsigned int *)malloc((profile->count+1)*sizeof(unsigned int)))==NULL
+    || (keyoff=(unsigned int *)malloc((profile->count+1)*sizeof(unsigned int)))==NULL
+    || (values=(double *)malloc((profile->count*2+1)*sizeof(double)))==NULL
+    || (keys=(char *)malloc(profile->keysize+1))==NULL) goto done;
+  for(i=0;i<profile->count;i++) index[i]=i;
+  bprofileSort_profile=profile;
+  qsort(index,profile->count,sizeof(unsigned int),bprofileCompare);
+  for(i=0,off=0;i<profile->count;i++){
+    j=index[i];
+    len=(j+1<profile->count ? profile->keyoff[j+1] : profile->keysize)-profile->keyoff[j];
+    memcpy(keys+off,profile->keys+profile->keyoff[j],len);
+    keyoff[i]=off;
+    off+=len;
+    values[i*2]=profile->values[j*2];
+    values[i*2+1]=profile->values[j*2+1];
+    }
+  keyoff[profile->count]=off;
+  memcpy(header.magic,"NBBP",4);
+  header.version=BPROFILE_VERSION;
+  header.count=profile->count;
+  header.keysize=profile->keysize;
+  snprintf(tmpname,sizeof(tmpname),"%s.%d",filename,(int)getpid());
+  if((file=fopen(tmpname,"wb"))==NULL) goto done;
+  if(fwrite(&header,sizeof(header),1,file)!=1
+    || fwrite(values,sizeof(double)*2,profile->count,file)!=profile->count
+    || fwrite(keyoff,sizeof(unsigned int),profile->count+1,file)!=profile->count+1
+    || fwrite(keys,1,profile->keysize,file)!=profile->keysize
+    || fflush(file)!=0){
+    fclose(file);
+    remove(tmpname);
+    goto done;
+    }
+#if !defined(_WINDOWS)
+  fsync(fileno(file));
+#endif
+  if(fclose(file)!=0 || rename(tmpname,filename)!=0){
+    remove(tmpname);
+    goto done;
+    }
+  rc=0;
+done:
+  if(index) free(index);
+  if(keyoff) free(keyoff);
+  if(values) free(values);
+  if(keys) free(keys);
+  return(rc);
+  }
+
+/*
+*  Write a profile in the background
+*
+*    The profile is written by a forked process so the agent can continue
+*    while it is sorted and written.  If the fork fails, or on Windows, the
+*    profile is written before returning.  The process is reaped by the
+*    medulla like any other child process.
+*/
+static void bprofileStore(nbCELL context,BProfile *profile,char *filename){
+#if !defined(_WINDOWS)
+  int pid;
+
+  nbLogFlush(context);
+  pid=fork();
+  if(pid==0){
+    if(bprofileWrite(profile,filename)!=0){
+      nbLogMsg(context,0,'E',"Unable to write %s - %s",filename,strerror(errno));
+      nbLogFlush(context);
+      _exit(1);
+      }
+    _exit(0);
+    }
+  if(pid>0) return;
+#endif
+  if(bprofileWrite(profile,filename)!=0)
+    nbLogMsg(context,0,'E',"Unable to write %s - %s",filename,strerror(errno));
+  }
+
+static void treeSetMeasure(nbCELL context,BTree *tree,nbCELL element[],int qualifiers,double average,double deviation);
+
+/*
+*  Load a binary profile
+*
+*  Returns: 0 - loaded, 1 - error, -1 - file not found
+*/
+static int bprofileLoad(nbCELL context,BTree *tree,char *filename){
+  BProfileHeader *header;
+  struct stat filestat;
+  char *data,*keys,*cursor,*end;
+  double *values,real;
+  unsigned int *keyoff,i;
+  size_t size;
+  nbCELL element[BTREE_QUALIFIERS_MAX];
+  int fildes,qualifiers,rc=1;
+
+  if((fildes=open(filename,O_RDONLY))<0){
+    if(errno==ENOENT) return(-1);
+    nbLogMsg(context,0,'E',"Unable to open %s - %s",filename,strerror(errno));
+    return(1);
+    }
+  if(fstat(fildes,&filestat)!=0 || filestat.st_size<sizeof(BProfileHeader)){
+    nbLogMsg(context,0,'E',"Profile %s is not valid",filename);
+    close(fildes);
+    return(1);
+    }
+  size=filestat.st_size;
+#if !defined(_WINDOWS)
+  data=mmap(NULL,size,PROT_READ,MAP_PRIVATE,fildes,0);
+  if(data==MAP_FAILED){
+    nbLogMsg(context,0,'E',"Unable to map %s - %s",filename,strerror(errno));
+    close(fildes);
+    return(1);
+    }
+#else
+  data=(char *)malloc(size);
+  if(data==NULL || read(fildes,data,size)!=size){
+    nbLogMsg(context,0,'E',"Unable to read %s",filename);
+    if(data) free(data);
+    close(fildes);
+    return(1);
+    }
+#endif
+  close(fildes);
+  header=(BProfileHeader *)data;
+  values=(double *)(data+sizeof(BProfileHeader));
+  keyoff=(unsigned int *)(values+(size_t)header->count*2);
+  keys=(char *)(keyoff+(size_t)header->count+1);
+  if(memcmp(header->magic,"NBBP",4)!=0 || header->version!=BPROFILE_VERSION
+    || size!=sizeof(BProfileHeader)+(size_t)header->count*2*sizeof(double)+((size_t)header->count+1)*sizeof(unsigned int)+header->keysize
+    || keyoff[header->count]!=header->keysize){
+    nbLogMsg(context,0,'E',"Profile %s is not valid",filename);
+    goto done;
+    }
+  for(i=0;i<header->count;i++){
+    if(keyoff[i]>keyoff[i+1] || keyoff[i+1]>header->keysize) break;
+    cursor=keys+keyoff[i];
+    end=keys+keyoff[i+1];
+    for(qualifiers=0;cursor<end && qualifiers<BTREE_QUALIFIERS_MAX;qualifiers++){
+      if(*cursor=='s' && memchr(cursor+1,0,end-cursor-1)){
+        element[qualifiers]=nbCellCreateString(context,cursor+1);
+        cursor+=strlen(cursor+1)+2;
+        }
+      else if(*cursor=='r' && end-cursor>sizeof(double)){
+        memcpy(&real,cursor+1,sizeof(double));
+        element[qualifiers]=nbCellCreateReal(context,real);
+        cursor+=1+sizeof(double);
+        }
+      else if(*cursor=='u'){
+        element[qualifiers]=nbCellGrab(context,NB_CELL_UNKNOWN);
+        cursor++;
+        }
+      else break;
+      }
+    if(cursor!=end || qualifiers==0){
+      while(qualifiers>0) qualifiers--,nbCellDrop(context,element[qualifiers]);
+      break;
+      }
+    treeSetMeasure(context,tree,element,qualifiers,values[i*2],values[i*2+1]);
+    }
+  if(i<header->count) nbLogMsg(context,0,'E',"Profile %s is not valid at entry %u",filename,i);
+  else rc=0;
+done:
+#if !defined(_WINDOWS)
+  munmap(data,size);
+#else
+  free(data);
+#endif
+  return(rc);
+  }
+
 static void baselineAlert(nbCELL context,BTreeSkill *skillHandle,BTree *tree,BTreeNode *node,nbCELL element[],int qualifiers,double deviation){
   char cmd[1024];
   char *cmdcur;
@@ -455,21 +792,31 @@ static void baselineAlert(nbCELL context,BTreeSkill *skillHandle,BTree *tree,BTr
   node->threshold=threshold;
   }
 
-static int treeStoreNode(nbCELL context,BTreeSkill *skillHandle,BTree *tree,int learning,BTreeNode *node,nbCELL element[],int qualifiers,FILE *file,char *buffer,char *cursor,char *bufend){
+static int treeStoreNode(nbCELL context,BTreeSkill *skillHandle,BTree *tree,int learning,BTreeNode *node,nbCELL element[],int qualifiers,FILE *file,BProfile *profile,char *buffer,char *cursor,char *bufend){
   char *curCol=cursor;
   int n;
   double threshold,deviation;
 
+  if(qualifiers>=BTREE_QUALIFIERS_MAX){
+    nbLogMsg(context,0,'L',"Row has too many columns: %s\n",buffer);
+    return(-1);
+    }
   element[qualifiers]=(nbCELL)node->bnode.key;
   qualifiers++;
   //nbLogMsg(context,0,'T',"treeStoreNode: called tree=%p node=%p root=%p",tree,node,node->root);
-  n=treeStoreValue(context,node->bnode.key,cursor,bufend-cursor);
-  if(n<0){
-    nbLogMsg(context,0,'L',"Row is too large for buffer or cell type unrecognized: %s\n",buffer);
-    return(-1);
+  if(file){   // 2026-10-18 eat - the text row is only needed for the text format
+    n=treeStoreValue(context,node->bnode.key,cursor,bufend-cursor);
+    if(n<0){
+      nbLogMsg(context,0,'L',"Row is too large for buffer or cell type unrecognized: %s\n",buffer);
+      return(-1);
+      }
+    cursor+=n;
+    }
+  if(learning==BTREE_STORE_EXPORT){
+    if(file) fprintf(file,"%s):set %.10g,%.10g;\n",buffer,node->average,node->deviation);
+    if(profile) bprofileAdd(context,profile,element,qualifiers,node->average,node->deviation);
     }
-  cursor+=n;
-  if(learning){
+  else if(learning){
     if(node->average==0 && node->deviation==0){
       node->average=node->value;
       node->deviation=node->value/4;  // start with 25% deviation
@@ -485,53 +832,94 @@ static int treeStoreNode(nbCELL context,BTreeSkill *skillHandle,BTree *tree,int
       node->average+=tree->weight*(node->value-node->average);
       } 
     if(file) fprintf(file,"%s):set %.10g,%.10g;\n",buffer,node->average,node->deviation);
+    if(profile) bprofileAdd(context,profile,element,qualifiers,node->average,node->deviation);
     if(tree->options&BTREE_OPTION_SUM) node->value=0;  // reset value when summing
     }
   else if(file) fprintf(file,"%s)=%.10g;\n",buffer,node->value);
   if(node->root!=NULL){
-    strcpy(cursor,",");  // should make sure we have room for this
-    cursor++;
-    treeStoreNode(context,skillHandle,tree,learning,node->root,element,qualifiers,file,buffer,cursor,bufend);
+    if(file){
+      strcpy(cursor,",");  // should make sure we have room for this
+      cursor++;
+      }
+    treeStoreNode(context,skillHandle,tree,learning,node->root,element,qualifiers,file,profile,buffer,cursor,bufend);
     }
   qualifiers--;
-  if(node->bnode.left!=NULL) treeStoreNode(context,skillHandle,tree,learning,(BTreeNode *)node->bnode.left,element,qualifiers,file,buffer,curCol,bufend);
-  if(node->bnode.right!=NULL) treeStoreNode(context,skillHandle,tree,learning,(BTreeNode *)node->bnode.right,element,qualifiers,file,buffer,curCol,bufend);
+  if(node->bnode.left!=NULL) treeStoreNode(context,skillHandle,tree,learning,(BTreeNode *)node->bnode.left,element,qualifiers,file,profile,buffer,curCol,bufend);
+  if(node->bnode.right!=NULL) treeStoreNode(context,skillHandle,tree,learning,(BTreeNode *)node->bnode.right,element,qualifiers,file,profile,buffer,curCol,bufend);
   //nbLogMsg(context,0,'T',"treeStoreNode: returning tree=%p node=%p root=%p",tree,node,node->root);
   return(0);
   }
 
-static void treeStore(nbCELL context,BTreeSkill *skillHandle,BTree *tree,char *text){
-  char buffer[NB_BUFSIZE],*cursor=text,filename[512];
+/*
+*  Get a file name argument for a node command
+*
+*  Returns: length of file name - 0 when the file name is missing or too long
+*/
+static int treeGetFileName(nbCELL context,char *text,char *filename,int size){
+  char *cursor;
+  int len;
+
+  while(*text==' ') text++;
+  cursor=text;
+  while(*cursor!=0 && strchr(" ;",*cursor)==NULL) cursor++;
+  len=cursor-text;
+  if(len>size-1){
+    nbLogMsg(context,0,'E',"File name too large for buffer.");
+    return(0);
+    }
+  if(len==0){
+    nbLogMsg(context,0,'E',"Expecting file name.");
+    return(0);
+    }
+  strncpy(filename,text,len);
+  *(filename+len)=0;
+  return(len);
+  }
+
+static void treeStore(nbCELL context,BTreeSkill *skillHandle,BTree *tree,int learning,char *text){
+  char buffer[NB_BUFSIZE],*cursor,filename[512];
   FILE *file=NULL;
+  BProfile *profile=NULL;
   int qualifiers=0;
-  nbCELL element[32];
-  int learning=1;
+  nbCELL element[BTREE_QUALIFIERS_MAX];
   int len;
 
   if(text){
-    learning=0;
-    while(*cursor!=0 && strchr(" ;",*cursor)==NULL) cursor++;
-    len=cursor-text;
-    if(len>sizeof(filename)-1){
-      nbLogMsg(context,0,'E',"File name too large for buffer.");
+    if((len=treeGetFileName(context,text,filename,sizeof(filename)))==0) return;
+    if(learning==BTREE_STORE_EXPORT && len>4 && strcmp(filename+len-4,".nbp")==0) profile=bprofileOpen();
+    else if((file=fopen(filename,"w"))==NULL){
+      nbLogMsg(context,0,'E',"Unable to open %s",filename);
       return;
       }
-    strncpy(filename,text,len);
-    *(filename+len)=0;
     }
-  else sprintf(filename,"%s/%8.8d.nb",tree->directory,tree->period*tree->interval);
-  // write to file
-  if(!(tree->options&BTREE_OPTION_STATIC) && (file=fopen(filename,"w"))==NULL){
-    nbLogMsg(context,0,'E',"Unable to open %s",filename);
-    return;
+  else if(!(tree->options&BTREE_OPTION_STATIC)){
+    if(tree->options&BTREE_OPTION_TEXT){
+      sprintf(filename,"%s/%8.8d.nb",tree->directory,tree->period*tree->interval);
+      if((file=fopen(filename,"w"))==NULL){
+        nbLogMsg(context,0,'E',"Unable to open %s",filename);
+        return;
+        }
+      }
+    else{
+      sprintf(filename,"%s/%8.8d.nbp",tree->directory,tree->period*tree->interval);
+      profile=bprofileOpen();
+      }
     }
   if(tree->root){
     if(learning) strcpy(buffer,".(");
     else strcpy(buffer,"assert (");
     cursor=buffer+strlen(buffer);
-    treeStoreNode(context,skillHandle,tree,learning,tree->root,element,qualifiers,file,buffer,cursor,buffer+sizeof(buffer));
+    treeStoreNode(context,skillHandle,tree,learning,tree->root,element,qualifiers,file,profile,buffer,cursor,buffer+sizeof(buffer));
     }
   if(file) fclose(file);
+  if(profile){
+    if(profile->error) nbLogMsg(context,0,'E',"Unable to allocate memory for profile %s",filename);
+    else if(text){  // an export is complete when the command returns
+      if(bprofileWrite(profile,filename)!=0) nbLogMsg(context,0,'E',"Unable to write %s - %s",filename,strerror(errno));
+      }
+    else bprofileStore(context,profile,filename);
+    bprofileClose(profile);
+    }
   }
 
 static void treeLoad(nbCELL context,void *skillHandle,BTree *tree){
@@ -544,19 +932,41 @@ static void treeLoad(nbCELL context,void *skillHandle,BTree *tree){
   cycleTime=utime%tree->cycle;
   period=cycleTime/tree->interval;
   tree->period=period;
+  if(!(tree->options&BTREE_OPTION_TEXT)){
+    sprintf(filename,"%s/%8.8d.nbp",tree->directory,tree->period*tree->interval);
+    if(bprofileLoad(context,tree,filename)>=0) return;
+    }
   sprintf(filename,"%s/%8.8d.nb",tree->directory,tree->period*tree->interval);
   nbSource(context,0,filename); // load using the command interpreter
   }
 
+/*
+*  Load a profile file named by the load command
+*
+*    A file name ending in ".nbp" is loaded as a binary profile, otherwise
+*    the file is loaded with the command interpreter.
+*/
+static void treeLoadFile(nbCELL context,void *skillHandle,BTree *tree,char *text){
+  char filename[512];
+  int len;
+
+  if((len=treeGetFileName(context,text,filename,sizeof(filename)))==0) return;
+  if(len>4 && strcmp(filename+len-4,".nbp")==0){
+    if(bprofileLoad(context,tree,filename)<0) nbLogMsg(context,0,'E',"Profile %s not found",filename);
+    }
+  else nbSource(context,0,filename);
+  }
+
 static void treeAlarm(nbCELL context,void *skillHandle,void *nodeHandle,nbCELL cell){
   BTree *tree=(BTree *)nodeHandle;
   int remaining;
   time_t utime;
 
   if(tree->period>=0){ // store baseline
-    treeStore(context,skillHandle,tree,NULL);
+    treeStore(context,skillHandle,tree,BTREE_STORE_LEARN,NULL);
     }
-  treeLoad(context,skillHandle,tree); // load baseline
+  // 2026-10-18 eat - with a single period the tree already has the profile just stored
+  if(tree->periods>1 || tree->options&BTREE_OPTION_STATIC) treeLoad(context,skillHandle,tree); // load baseline
   // reset timer
   time(&utime);
   remaining=tree->interval-utime%tree->interval;
@@ -853,44 +1263,30 @@ static void treePrune(nbCELL context,BTreeSkill *skillHandle,BTree *tree,nbCELL
     }
   }
 
-static void treeSet(nbCELL context,BTreeSkill *skillHandle,BTree *tree,nbCELL arglist,char *text){
+/*
+*  Set the average and deviation of a measure
+*
+*    The element cells are grabbed cells that are either used as keys of new
+*    nodes or dropped.
+*/
+static void treeSetMeasure(nbCELL context,BTree *tree,nbCELL element[],int qualifiers,double average,double deviation){
   NB_TreePath path;
   BTreeNode *node=NULL,**nodeP=&tree->root;
-  nbSET argSet;
-  nbCELL argCell;
-  double average,deviation;
+  int i;
 
-  average=strtod(text,&text);
-  while(*text==' ') text++;
-  if(*text!=','){
-    nbLogMsg(context,0,'E',"Expecting ',' at: %s",text);
-    return;
-    }
-  text++;
-  deviation=strtod(text,&text);
-  while(*text==' ') text++;
-  if(*text!=';'){
-    nbLogMsg(context,0,'E',"Expecting ';' at: %s",text);
-    return;
-    }
-  if(arglist==NULL || (argSet=nbListOpen(context,arglist))==NULL){
-    nbLogMsg(context,0,'E',"Expecting argument list");
-    return;
-    }
-  argCell=nbListGetCellValue(context,&argSet);
-  while(argCell!=NULL){
+  for(i=0;i<qualifiers;i++){
     if(tree->options&BTREE_OPTION_ORDER)
-      node=nbTreeLocateValue(&path,argCell,(NB_TreeNode **)nodeP,treeCompare,context);
-    else node=nbTreeLocate(&path,argCell,(NB_TreeNode **)nodeP);
+      node=nbTreeLocateValue(&path,element[i],(NB_TreeNode **)nodeP,treeCompare,context);
+    else node=nbTreeLocate(&path,element[i],(NB_TreeNode **)nodeP);
     if(node==NULL){
       node=nbAlloc(sizeof(BTreeNode));
       memset(node,0,sizeof(BTreeNode));
       nbTreeInsert(&path,(NB_TreeNode *)node);
       nodeP=&(node->root);
-      while((argCell=nbListGetCellValue(context,&argSet))!=NULL){
+      for(i++;i<qualifiers;i++){
         node=nbAlloc(sizeof(BTreeNode));
         memset(node,0,sizeof(BTreeNode));
-        node->bnode.key=(void *)argCell;
+        node->bnode.key=(void *)element[i];
         *nodeP=node;
         nodeP=&(node->root);
         }
@@ -901,8 +1297,7 @@ static void treeSet(nbCELL context,BTreeSkill *skillHandle,BTree *tree,nbCELL ar
       return;
       }
     nodeP=&(node->root);
-    nbCellDrop(context,argCell);
-    argCell=nbListGetCellValue(context,&argSet);
+    nbCellDrop(context,element[i]);
     }
   if(node){
     /* matched - change value */
@@ -910,7 +1305,43 @@ static void treeSet(nbCELL context,BTreeSkill *skillHandle,BTree *tree,nbCELL ar
     node->deviation=deviation;
     node->threshold=(double)((int)1<<node->level)*deviation*tree->tolerance;
     }
-  return;
+  }
+
+static void treeSet(nbCELL context,BTreeSkill *skillHandle,BTree *tree,nbCELL arglist,char *text){
+  nbSET argSet;
+  nbCELL argCell;
+  nbCELL element[BTREE_QUALIFIERS_MAX];
+  int qualifiers=0;
+  double average,deviation;
+
+  average=strtod(text,&text);
+  while(*text==' ') text++;
+  if(*text!=','){
+    nbLogMsg(context,0,'E',"Expecting ',' at: %s",text);
+    return;
+    }
+  text++;
+  deviation=strtod(text,&text);
+  while(*text==' ') text++;
+  if(*text!=';'){
+    nbLogMsg(context,0,'E',"Expecting ';' at: %s",text);
+    return;
+    }
+  if(arglist==NULL || (argSet=nbListOpen(context,arglist))==NULL){
+    nbLogMsg(context,0,'E',"Expecting argument list");
+    return;
+    }
+  while((argCell=nbListGetCellValue(context,&argSet))!=NULL){
+    if(qualifiers>=BTREE_QUALIFIERS_MAX){
+      nbCellDrop(context,argCell);
+      while(qualifiers>0) qualifiers--,nbCellDrop(context,element[qualifiers]);
+      nbLogMsg(context,0,'E',"Too many arguments - limit is %d",BTREE_QUALIFIERS_MAX);
+      return;
+      }
+    element[qualifiers]=argCell;
+    qualifiers++;
+    }
+  treeSetMeasure(context,tree,element,qualifiers,average,deviation);
   }
 
 
@@ -956,7 +1387,9 @@ static int *baselineCommand(nbCELL context,BTreeSkill *skillHandle,BTree *tree,n
   else if(strcmp(ident,"flatten")==0) treeFlatten(context,skillHandle,tree);
   else if(strcmp(ident,"balance")==0) treeBalance(context,skillHandle,tree);
   else if(strcmp(ident,"set")==0) treeSet(context,skillHandle,tree,arglist,cursor);
-  else if(strcmp(ident,"store")==0) treeStore(context,skillHandle,tree,cursor);
+  else if(strcmp(ident,"store")==0) treeStore(context,skillHandle,tree,BTREE_STORE_VALUE,cursor);
+  else if(strcmp(ident,"export")==0) treeStore(context,skillHandle,tree,BTREE_STORE_EXPORT,cursor);
+  else if(strcmp(ident,"load")==0) treeLoadFile(context,skillHandle,tree,cursor);
   else if(strcmp(ident,"prune")==0) treePrune(context,skillHandle,tree,arglist,cursor);
   else nbLogMsg(context,0,'E',"Verb \"%s\" not recognized.",ident);
   return(0);
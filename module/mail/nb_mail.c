@@ -349,6 +349,7 @@ static void smtpFork(nbCELL context,nbSession *session){
   if(pid>0) return;
   else{
     NB_IpChannel *newChannel;
+    nbMedullaSigChildUnblock();  // 2026-10-18 eat 0.9.04 - the agent may block SIGCHLD
     newChannel=nbIpAlloc();
     newChannel->socket=session->channel->socket;
     strcpy(newChannel->ipaddr,session->channel->ipaddr);
@@ -392,6 +393,7 @@ static void smtpFork(nbCELL context,nbSession *session){
 * ---------- ---------------------------------------------------------
 * 2007/06/23 Ed Trettevik - original skill module prototype version
 * 2007/06/23 eat 0.6.8  Structured skill module around old SMTP listener code
+* 2026-10-18 eat 0.9.04 Unblocked SIGCHLD in the child serving a connection
 *=====================================================================
 */
 
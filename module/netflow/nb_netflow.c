@@ -60,6 +60,32 @@
 *   Every T seconds we clear the cache tables and start over.
 *   This does not include the address attribute cache table
 *
+*   Netflow versions 5 and 7 have fixed flow records.  Versions 9 and 10
+*   (IPFIX) describe flow records with templates sent by the exporter.
+*   Templates are cached by exporter address, source id (v9) or observation
+*   domain (IPFIX), and template id.  When a template is cached, the offsets
+*   of the fields we use are computed once, so records of a fixed length
+*   template are decoded without walking the field list.  Data sets for
+*   templates we have not received yet are skipped and counted.
+*
+*   Protocol volumes are kept in arrays indexed by protocol number.  TCP and
+*   UDP port volumes are kept in a hash of active ports, so memory is
+*   proportional to the number of ports seen instead of 65536 entries per
+*   protocol and measure.  History file periods are stored as float
+*   after an 8 byte header that identifies the format.  A history file
+*   without the header, written when periods were stored as double, is
+*   converted the first time it is opened.
+*
+*   Commands:
+*
+*     <node>:record <file>             - append received datagrams to a file
+*     <node>:record                    - stop recording
+*     <node>:replay <file>             - process recorded datagrams
+*     <node>:benchmark <file>[,<n>]    - process recorded datagrams n times
+*                                        and report the rate
+*
+*   Record files are written and read by nbIpRecord() and nbIpReplay().
+*
 *=====================================================================
 * Change History:
 *
@@ -77,18 +103,27 @@
 * 2012-12-27 eat 0.8.13 Checker updates
 * 2013-01-14 eat 0.8.13 Checker updates
 * 2013-01-20 eat 0.8.13 Checker updates
+* 2026-10-18 eat 0.9.04 Added v9/IPFIX template decoding and sparse port volumes
+* 2026-10-18 eat 0.9.04 Converted v5/v7 header and flow fields from network byte order
+* 2026-10-18 eat 0.9.04 Added record, replay and benchmark commands
+* 2026-10-18 eat 0.9.04 Added history file header and conversion of double periods
+* 2026-10-18 eat 0.9.04 Moved record and replay file handling to nbip.c
 *=====================================================================
 */
 #include "config.h"
 #include <nb/nb.h>
 
-struct NB_MOD_NETFLOW_METRIC_ARRAY{
-  double protocolPkts[256];
-  double protocolBytes[256];
-  double tcpPortPkts[65536];
-  double tcpPortBytes[65536];
-  double udpPortPkts[65536];
-  double udpPortBytes[65536];
+#define NB_MOD_NETFLOW_BUFSIZE  65536   /* maximum datagram size */
+#define NB_MOD_NETFLOW_MAGIC    "NBNFLOW1"  /* record file header */
+#define NB_MOD_NETFLOW_HISTORY  "NBNFHST2"  /* history file header - float periods */
+
+struct NB_MOD_NETFLOW_METRIC_ARRAY{   // 2026-10-18 eat - float to halve history periods
+  float protocolPkts[256];
+  float protocolBytes[256];
+  float tcpPortPkts[65536];
+  float tcpPortBytes[65536];
+  float udpPortPkts[65536];
+  float udpPortBytes[65536];
   };
 
 struct NB_MOD_NETFLOW_PERIOD{
@@ -111,6 +146,14 @@ struct NB_MOD_NETFLOW_VOLUME{
   double bytes;
   };
 
+struct NB_MOD_NETFLOW_PORT{           /* active TCP or UDP port */
+  struct NB_MOD_NETFLOW_PORT *next;
+  unsigned int   key;                 /* protocol<<16 | port */
+  struct NB_MOD_NETFLOW_VOLUME  sum;
+  struct NB_MOD_NETFLOW_MEASURE packets;
+  struct NB_MOD_NETFLOW_MEASURE bytes;
+  };
+
 struct NB_MOD_NETFLOW{          /* Netflow node descriptor */
   unsigned int   socket;        /* server socket for datagrams */
   unsigned short port;          /* UDP port of listener */
@@ -129,10 +172,14 @@ struct NB_MOD_NETFLOW{          /* Netflow node descriptor */
   unsigned int   flowCountPrev; /* flow count for previous interval */
   unsigned int   flowCountMon;  /* count of flows monitored in an interval */
   unsigned int   routerAddr;    /* router address */
+  unsigned int   templateMiss;  /* data sets skipped for unknown template */
+  FILE          *record;        /* datagram record file */
   struct NB_MOD_NETFLOW_DEVICE *device; 
   struct NB_MOD_NETFLOW_HASH *hashFlow;
   struct NB_MOD_NETFLOW_HASH *hashAddr;
   struct NB_MOD_NETFLOW_HASH *hashAttr;
+  struct NB_MOD_NETFLOW_HASH *hashPort;     /* active TCP and UDP ports */
+  struct NB_MOD_NETFLOW_HASH *hashTemplate; /* v9 and IPFIX templates */
 
   int periodNumber;
   int intervalNumber;
@@ -143,15 +190,9 @@ struct NB_MOD_NETFLOW{          /* Netflow node descriptor */
   int checksPerSum;
   
   struct NB_MOD_NETFLOW_VOLUME protocolSum[256];
-  struct NB_MOD_NETFLOW_VOLUME tcpPortSum[65536];
-  struct NB_MOD_NETFLOW_VOLUME udpPortSum[65536];
   struct NB_MOD_NETFLOW_MEASURE protocolPkts[256];
   struct NB_MOD_NETFLOW_MEASURE protocolBytes[256];
-  struct NB_MOD_NETFLOW_MEASURE tcpPortPkts[65536];
-  struct NB_MOD_NETFLOW_MEASURE tcpPortBytes[65536];
-  struct NB_MOD_NETFLOW_MEASURE udpPortPkts[65536];
-  struct NB_MOD_NETFLOW_MEASURE udpPortBytes[65536];
-  struct NB_MOD_NETFLOW_PERIOD periodProfile;
+  struct NB_MOD_NETFLOW_PERIOD *periodProfile;  /* NULL without a history file */
   };
 
 typedef struct NB_MOD_NETFLOW NB_MOD_Netflow;
@@ -163,6 +204,8 @@ struct NB_MOD_NETFLOW_DEVICE{         /* source netflow device */
   unsigned char name[63];             /* device name */
   unsigned int  v5pkts;               /* version 5 packets in last interval */
   unsigned int  v7pkts;               /* version 7 packets in last interval */
+  unsigned int  v9pkts;               /* version 9 packets in last interval */
+  unsigned int  ipfixpkts;            /* version 10 (IPFIX) packets in last interval */
   unsigned int  pkts;                 /* total packet in last interval */
   unsigned int  flowSeqRef;           /* reference flow sequence number */
   unsigned int  flowSeqLast;          /* last flow sequence number */
@@ -207,6 +250,57 @@ struct NB_MOD_NETFLOW_HASH{
   void *vector;
   };
 
+/*
+*  Netflow v9 and IPFIX template cache
+*/
+#define NB_MOD_NETFLOW_SLOT_NONE     0   /* field not used */
+#define NB_MOD_NETFLOW_SLOT_BYTES    1
+#define NB_MOD_NETFLOW_SLOT_PACKETS  2
+#define NB_MOD_NETFLOW_SLOT_PROTOCOL 3
+#define NB_MOD_NETFLOW_SLOT_SRCPORT  4
+#define NB_MOD_NETFLOW_SLOT_SRCADDR  5
+#define NB_MOD_NETFLOW_SLOT_DSTPORT  6
+#define NB_MOD_NETFLOW_SLOT_DSTADDR  7
+#define NB_MOD_NETFLOW_SLOTS         8
+
+#define NB_MOD_NETFLOW_VARLEN    65535   /* IPFIX variable length field */
+
+struct NB_MOD_NETFLOW_FIELD{
+  unsigned short type;                /* information element id */
+  unsigned short length;              /* field length or NB_MOD_NETFLOW_VARLEN */
+  unsigned char  slot;                /* NB_MOD_NETFLOW_SLOT_* */
+  };
+
+struct NB_MOD_NETFLOW_EXTRACT{        /* field used from a fixed length record */
+  unsigned char  slot;
+  unsigned short offset;
+  unsigned short length;
+  };
+
+struct NB_MOD_NETFLOW_TEMPLATE{
+  struct NB_MOD_NETFLOW_TEMPLATE *next;
+  unsigned int   exporter;            /* exporter address */
+  unsigned int   domain;              /* v9 source id or IPFIX observation domain */
+  unsigned short id;                  /* template id */
+  unsigned short fields;              /* number of fields - 0 for options templates */
+  unsigned short recordLen;           /* record length - 0 if variable */
+  unsigned short minLen;              /* minimum record length */
+  unsigned char  extracts;            /* number of fields used */
+  struct NB_MOD_NETFLOW_EXTRACT extract[NB_MOD_NETFLOW_SLOTS];
+  struct NB_MOD_NETFLOW_FIELD field[1];
+  };
+
+struct NB_MOD_NETFLOW_RECORD{         /* decoded v9 or IPFIX flow record */
+  unsigned long long packets;
+  unsigned long long bytes;
+  unsigned int   srcaddr;             /* network byte order */
+  unsigned int   dstaddr;             /* network byte order */
+  unsigned short srcport;
+  unsigned short dstport;
+  unsigned char  protocol;
+  unsigned char  ipv4;                /* 1 - source, 2 - destination, 3 - both */
+  };
+
 /*================================================================================*/
  
 /*
@@ -286,14 +380,62 @@ struct nfv7flow{
 
 /*================================================================================*/
 
+/*
+*  Convert a history file with double periods and no header
+*
+*  The file is rewritten to a temporary file with the header and float
+*  periods, and then renamed.
+*/
+static int convertHistory(nbCELL context,char *filename,int periods,size_t len){
+  char tmpname[512];
+  double *oldPeriod;
+  float *newPeriod;
+  size_t count=len/sizeof(float),i;
+  int oldFile,newFile,rc=0;
+
+  if(snprintf(tmpname,sizeof(tmpname),"%s.tmp",filename)>=sizeof(tmpname)) return(-1);
+  if((oldFile=open(filename,O_RDONLY))<0) return(-1);
+  if((newFile=open(tmpname,O_WRONLY|O_CREAT|O_TRUNC,S_IRUSR|S_IWUSR))<0){
+    close(oldFile);
+    return(-1);
+    }
+  oldPeriod=(double *)nbAlloc(count*sizeof(double));
+  newPeriod=(float *)nbAlloc(len);
+  if(write(newFile,NB_MOD_NETFLOW_HISTORY,8)!=8) rc=-1;
+  while(rc==0 && periods>0){
+    if(read(oldFile,oldPeriod,count*sizeof(double))!=(int)(count*sizeof(double))) rc=-1;
+    else{
+      for(i=0;i<count;i++) newPeriod[i]=(float)oldPeriod[i];
+      if(write(newFile,newPeriod,len)!=(int)len) rc=-1;
+      }
+    periods--;
+    }
+  nbFree(newPeriod,len);
+  nbFree(oldPeriod,count*sizeof(double));
+  close(oldFile);
+  if(close(newFile)<0) rc=-1;
+  if(rc==0 && rename(tmpname,filename)<0) rc=-1;
+  if(rc<0){
+    nbLogMsg(context,0,'E',"Unable to convert history file \"%s\" - %s",filename,strerror(errno));
+    remove(tmpname);
+    }
+  else nbLogMsg(context,0,'I',"Converted history file \"%s\" from double to float periods",filename);
+  return(rc);
+  }
+
 /*
 *  Open a history file - initialize if needed
 *
 *      open(logname,O_CREAT|O_RDWR,S_IREAD|S_IWRITE);
+*
+*  The file starts with an 8 byte header followed by the periods.  A file
+*  without the header that has the size of double periods is converted.
 */
-static int openHistory(char *filename,int periods,size_t len){
+static int openHistory(nbCELL context,char *filename,int periods,size_t len){
   int file;  
   char *buffer;
+  char header[8];
+  struct stat filestat;
   int wrote;
 
 #if !defined(FREEBSD) && !defined(mpe) && !defined(MACOS) && !defined(WIN32)
@@ -311,6 +453,11 @@ static int openHistory(char *filename,int periods,size_t len){
 #endif
       return(file);
       }
+    if(write(file,NB_MOD_NETFLOW_HISTORY,8)!=8){
+      fprintf(stderr,"openHistory: write failed - %s\n",strerror(errno));
+      close(file);
+      return(-1);
+      }
     buffer=(char *)nbAlloc(len);
     memset(buffer,0,len);
     while(periods>0){
@@ -331,6 +478,16 @@ static int openHistory(char *filename,int periods,size_t len){
       }
     nbFree(buffer,len);
     }
+  else if(read(file,header,8)!=8 || memcmp(header,NB_MOD_NETFLOW_HISTORY,8)!=0){
+    if(fstat(file,&filestat)<0 || filestat.st_size!=(off_t)periods*len*2){
+      nbLogMsg(context,0,'E',"File \"%s\" is not a history file for this version",filename);
+      close(file);
+      return(-1);
+      }
+    close(file);
+    if(convertHistory(context,filename,periods,len)<0) return(-1);
+    return(openHistory(context,filename,periods,len));
+    }
   return(file);
   }
 
@@ -338,7 +495,7 @@ static int openHistory(char *filename,int periods,size_t len){
 *  Read history period 
 */
 static int readHistory(int file,void *buffer,int period,size_t len){ // 2013-05-04 eat VID-8894-0.8.15-3-R240 - changed to static to help checker
-  long pos=period*len;
+  long pos=8+period*len;  // 2026-10-18 eat 0.9.04 - step over header
 
   if(!file) return(0);
   if(lseek(file,pos,SEEK_SET)!=pos) return(0);
@@ -351,7 +508,7 @@ static int readHistory(int file,void *buffer,int period,size_t len){ // 2013-05-
 */
 /* comment ount until ready to use
 static int writeHistory(int file,char *buffer,int period,size_t len){
-  long pos=period*len;
+  long pos=8+period*len;
 
   if(lseek(file,pos,SEEK_SET)!=pos) return(0);
   if(write(file,buffer,len)!=(int)len) return(0);
@@ -369,8 +526,8 @@ static void format5(nbCELL context,unsigned char *buf,int len){
   unsigned short srcport,dstport;
   unsigned char *ipaddress;         
 
-  n=hdr->count;
-  nbLogPut(context,"Version=%d Count=%d\n",hdr->version,n);
+  n=ntohs(hdr->count);
+  nbLogPut(context,"Version=%d Count=%d\n",ntohs(hdr->version),n);
   for(f=0;f<n && (unsigned char *)flow<=buf+len-sizeof(struct nfv5flow);f++){
     ipaddress=(unsigned char *)&flow->srcaddr;
     sprintf(srcaddr,"%3.3u.%3.3u.%3.3u.%3.3u",*ipaddress,*(ipaddress+1),*(ipaddress+2),*(ipaddress+3));
@@ -395,8 +552,8 @@ static void format7(nbCELL context,unsigned char *buf,int len){
   unsigned short srcport,dstport;
   unsigned char *ipaddress;
 
-  n=hdr->count;
-  nbLogPut(context,"Version=%d Count=%d\n",hdr->version,n);
+  n=ntohs(hdr->count);
+  nbLogPut(context,"Version=%d Count=%d\n",ntohs(hdr->version),n);
   for(f=0;f<n && (unsigned char *)flow<=buf+len-sizeof(struct nfv7flow);f++){
     ipaddress=(unsigned char *)&flow->srcaddr;
     sprintf(srcaddr,"%3.3u.%3.3u.%3.3u.%3.3u",*ipaddress,*(ipaddress+1),*(ipaddress+2),*(ipaddress+3));
@@ -466,29 +623,78 @@ static void hashFreeFlow(struct NB_MOD_NETFLOW_HASH *hash){
   nbFree(hash,sizeof(struct NB_MOD_NETFLOW_HASH)-sizeof(void *)+hash->modulo*sizeof(void *));
   }
 
+static void hashFreePort(struct NB_MOD_NETFLOW_HASH *hash){
+  struct NB_MOD_NETFLOW_PORT *entry,*next;
+  hashReset(hash);
+  for(entry=hash->free;entry!=NULL;entry=next){
+    next=entry->next;
+    nbFree(entry,sizeof(struct NB_MOD_NETFLOW_PORT));
+    }
+  nbFree(hash,sizeof(struct NB_MOD_NETFLOW_HASH)-sizeof(void *)+hash->modulo*sizeof(void *));
+  }
+
+static size_t templateSize(int fields){
+  return(sizeof(struct NB_MOD_NETFLOW_TEMPLATE)+(fields>1 ? fields-1 : 0)*sizeof(struct NB_MOD_NETFLOW_FIELD));
+  }
+
+static void hashFreeTemplate(struct NB_MOD_NETFLOW_HASH *hash){
+  struct NB_MOD_NETFLOW_TEMPLATE **entryP=(struct NB_MOD_NETFLOW_TEMPLATE **)&(hash->vector),*entry,*next;
+  int i;
+
+  for(i=0;i<hash->modulo;i++){
+    for(entry=*entryP;entry!=NULL;entry=next){
+      next=entry->next;
+      nbFree(entry,templateSize(entry->fields));
+      }
+    entryP++;
+    }
+  nbFree(hash,sizeof(struct NB_MOD_NETFLOW_HASH)-sizeof(void *)+hash->modulo*sizeof(void *));
+  }
+
 
 /********************************************************************************
 *  Cache table routines
 ********************************************************************************/
 
+/*
+*  Get the entry for an active TCP or UDP port - create if needed
+*/
+static struct NB_MOD_NETFLOW_PORT *getPort(NB_MOD_Netflow *netflow,unsigned char protocol,unsigned short port){
+  struct NB_MOD_NETFLOW_HASH *hash=netflow->hashPort;
+  struct NB_MOD_NETFLOW_PORT *entry,**entryP;
+  unsigned int key=(protocol<<16)|port;
+
+  entryP=(struct NB_MOD_NETFLOW_PORT **)&hash->vector+key%hash->modulo;
+  for(entry=*entryP;entry!=NULL && key>entry->key;entry=*entryP)
+    entryP=(struct NB_MOD_NETFLOW_PORT **)&(entry->next);
+  if(entry==NULL || key<entry->key){
+    if(NULL!=(entry=hash->free)) hash->free=entry->next;
+    else entry=nbAlloc(sizeof(struct NB_MOD_NETFLOW_PORT));
+    memset(entry,0,sizeof(struct NB_MOD_NETFLOW_PORT));
+    entry->key=key;
+    entry->next=*entryP;
+    *entryP=entry;
+    }
+  return(entry);
+  }
+
 /*
 *  increment volume counters
 */
-static void incrementVolume(nbCELL context,NB_MOD_Netflow *netflow,unsigned char protocol,unsigned short port,unsigned int packets,unsigned int bytes){
+static void incrementVolume(nbCELL context,NB_MOD_Netflow *netflow,unsigned char protocol,unsigned short port,double packets,double bytes){
   static int spud=0;
-  if(spud<30){ 
-    nbLogMsg(context,0,'T',"incrementVolume called: protocol=%u,port=%u,packets=%u,bytes=%u",protocol,port,packets,bytes);
+  struct NB_MOD_NETFLOW_PORT *entry;
+
+  if(netflow->trace && spud<30){   // 2026-10-18 eat - only when tracing
+    nbLogMsg(context,0,'T',"incrementVolume called: protocol=%u,port=%u,packets=%.0f,bytes=%.0f",protocol,port,packets,bytes);
     spud++;
     }
   netflow->protocolSum[protocol].packets+=packets;
   netflow->protocolSum[protocol].bytes+=bytes;
-  if(protocol==6){  /* TCP */
-    netflow->tcpPortSum[port].packets+=packets;
-    netflow->tcpPortSum[port].bytes+=bytes;
-    }
-  else if(protocol==17){ /* UDP */
-    netflow->udpPortSum[port].packets+=packets;
-    netflow->udpPortSum[port].bytes+=bytes;
+  if(protocol==6 || protocol==17){  /* TCP or UDP */
+    entry=getPort(netflow,protocol,port);
+    entry->sum.packets+=packets;
+    entry->sum.bytes+=bytes;
     }
   }
 
@@ -507,10 +713,14 @@ static void setSeq(NB_MOD_Netflow *netflow,unsigned int address,unsigned char en
     nbIpGetName(address,(char *)device->name,sizeof(device->name));
     device->v5pkts=0;
     device->v7pkts=0;
+    device->v9pkts=0;
+    device->ipfixpkts=0;
     device->pkts=1;
     switch(version){
       case 5: device->v5pkts=1; break;
       case 7: device->v7pkts=1; break;
+      case 9: device->v9pkts=1; seq=count; break;  // v9 sequence numbers count packets, not flows
+      case 10: device->ipfixpkts=1; break;
       }
     device->flowSeqRef=seq-count;
     device->flowSeqLast=seq;
@@ -522,6 +732,8 @@ static void setSeq(NB_MOD_Netflow *netflow,unsigned int address,unsigned char en
     switch(version){
       case 5: device->v5pkts++; break;
       case 7: device->v7pkts++; break;
+      case 9: device->v9pkts++; seq=device->flowSeqLast+count; break;
+      case 10: device->ipfixpkts++; break;
       }
     device->flowSeqLast=seq;
 /*
@@ -541,19 +753,23 @@ static unsigned int getSeq(nbCELL context,NB_MOD_Netflow *netflow){
   struct NB_MOD_NETFLOW_DEVICE *device;
   char caddr[16];
   unsigned int routerFlows=0,engines=0;
-  unsigned int v5pkts=0,v7pkts=0;
+  unsigned int v5pkts=0,v7pkts=0,v9pkts=0,ipfixpkts=0;
   
   nbLogMsg(context,0,'T',"Netflow Engine Table:");
   for(device=netflow->device;device!=NULL;device=device->next){
     engines++;
     // 2012-01-12 eat - VID 5761-0.8.13-2
-    snprintf(streamMsg,sizeof(streamMsg),"Router=%s Engine=%2.2u V5Pkts=%5.5u V7Pkts=%5.5u TotPkts=%8.8u,FirstSeq=%10.10u LastSeq=%10.10u Name=%s\n",nbIpGetAddrString(caddr,device->address),device->engineid,device->v5pkts,device->v7pkts,device->pkts,device->flowSeqRef,device->flowSeqLast,device->name);
+    snprintf(streamMsg,sizeof(streamMsg),"Router=%s Engine=%2.2u V5Pkts=%5.5u V7Pkts=%5.5u V9Pkts=%5.5u IpfixPkts=%5.5u TotPkts=%8.8u,FirstSeq=%10.10u LastSeq=%10.10u Name=%s\n",nbIpGetAddrString(caddr,device->address),device->engineid,device->v5pkts,device->v7pkts,device->v9pkts,device->ipfixpkts,device->pkts,device->flowSeqRef,device->flowSeqLast,device->name);
     nbStreamPublish(netflow->streamEngineStats,streamMsg);
-    nbLogPut(context,"Router=%s Engine=%2.2u V5Pkts=%5.5u V7Pkts=%5.5u TotPkts=%8.8u,FirstSeq=%10.10u LastSeq=%10.10u Name=%s\n",nbIpGetAddrString(caddr,device->address),device->engineid,device->v5pkts,device->v7pkts,device->pkts,device->flowSeqRef,device->flowSeqLast,device->name);
+    nbLogPut(context,"%s",streamMsg);
     v5pkts+=device->v5pkts;
     v7pkts+=device->v7pkts;
+    v9pkts+=device->v9pkts;
+    ipfixpkts+=device->ipfixpkts;
     device->v5pkts=0;
     device->v7pkts=0;
+    device->v9pkts=0;
+    device->ipfixpkts=0;
     routerFlows+=device->flowSeqLast-device->flowSeqRef;
 /*
     if(device->flowSeqRef<device->flowSeqLast) routerFlows+=device->flowSeqLast-device->flowSeqRef;
@@ -561,7 +777,8 @@ static unsigned int getSeq(nbCELL context,NB_MOD_Netflow *netflow){
       routerFlows+=device->flowSeqLast+(0xffffffff-device->flowSeqRef)+1; 
 */
     }
-  nbLogMsg(context,0,'T',"Engines=%u v5pkts=%5.5u v7pkts=%5.5u packets=%6.6u",engines,v5pkts,v7pkts,v5pkts+v7pkts);
+  nbLogMsg(context,0,'T',"Engines=%u v5pkts=%5.5u v7pkts=%5.5u v9pkts=%5.5u ipfixpkts=%5.5u packets=%6.6u templateMiss=%u",engines,v5pkts,v7pkts,v9pkts,ipfixpkts,v5pkts+v7pkts+v9pkts+ipfixpkts,netflow->templateMiss);
+  netflow->templateMiss=0;
   return(routerFlows);
   }
 
@@ -695,34 +912,93 @@ static void analyzeFlows(nbCELL context,NB_MOD_Netflow *netflow,unsigned int add
     }
   }
 
+/*
+*  Display a partial sum line
+*/
+static void partialSumLine(nbCELL context,int i,struct NB_MOD_NETFLOW_VOLUME *volume,struct NB_MOD_NETFLOW_MEASURE *packets,struct NB_MOD_NETFLOW_MEASURE *bytes){
+  char packetLcFlag,packetUcFlag,byteUcFlag,byteLcFlag;
+
+  if(volume->packets<packets->e-packets->r) packetLcFlag='*';
+  else packetLcFlag=' ';
+  if(volume->packets>packets->e+packets->r) packetUcFlag='*';
+  else packetUcFlag=' ';
+  if(volume->bytes<bytes->e-bytes->r) byteLcFlag='*';
+  else byteLcFlag=' ';
+  if(volume->bytes>bytes->e+bytes->r) byteUcFlag='*';
+  else byteUcFlag=' ';
+  nbLogPut(context,"%5.5d %c%e %e %c%e %c%e %e %c%e\n",i,packetLcFlag,packets->e-packets->r,volume->packets,packetUcFlag,packets->e+packets->r,byteLcFlag,bytes->e-bytes->r,volume->bytes,byteUcFlag,bytes->e+bytes->r);
+  }
+
 /*
 *  Check partial sums for anomalies
 */
 static void partialSum(nbCELL context,char *title,struct NB_MOD_NETFLOW_VOLUME *volume,int n,double min,struct NB_MOD_NETFLOW_MEASURE *packets,struct NB_MOD_NETFLOW_MEASURE *bytes){
   int i;
-  char packetLcFlag,packetUcFlag,byteUcFlag,byteLcFlag;
 
   nbLogMsg(context,0,'T',"%s Parial Sum Table:",title);
   nbLogPut(context,"Index  LCL           Packets      UCL           LCL          Bytes         UCL\n");
   nbLogPut(context,"-----  ------------ ------------  ------------  ------------ ------------  ------------\n");
   for(i=0;i<n;i++){
-    if(volume->packets<packets->e-packets->r) packetLcFlag='*';
-    else packetLcFlag=' ';
-    if(volume->packets>packets->e+packets->r) packetUcFlag='*';
-    else packetUcFlag=' ';
-    if(volume->bytes<bytes->e-bytes->r) byteLcFlag='*';
-    else byteLcFlag=' ';
-    if(volume->bytes>bytes->e+bytes->r) byteUcFlag='*';
-    else byteUcFlag=' ';
-    if(volume->packets>=min){
-      nbLogPut(context,"%5.5d %c%e %e %c%e %c%e %e %c%e\n",i,packetLcFlag,packets->e-packets->r,volume->packets,packetUcFlag,packets->e+packets->r,byteLcFlag,bytes->e-bytes->r,volume->bytes,byteUcFlag,bytes->e+bytes->r);
-      }
+    if(volume->packets>=min) partialSumLine(context,i,volume,packets,bytes);
     volume++;
     packets++;
     bytes++;
     }
   }
 
+static int comparePort(const void *p1,const void *p2){
+  unsigned int key1=(*(struct NB_MOD_NETFLOW_PORT **)p1)->key,key2=(*(struct NB_MOD_NETFLOW_PORT **)p2)->key;
+  return(key1<key2 ? -1 : key1>key2);
+  }
+
+/*
+*  Check partial sums of active ports for anomalies
+*
+*    Ports are displayed in order like the protocol table.
+*/
+static void partialSumPort(nbCELL context,NB_MOD_Netflow *netflow,char *title,unsigned char protocol,double min){
+  struct NB_MOD_NETFLOW_HASH *hash=netflow->hashPort;
+  struct NB_MOD_NETFLOW_PORT **entryP=(struct NB_MOD_NETFLOW_PORT **)&(hash->vector),*entry,**list;
+  int i,n=0,size=0;
+
+  for(i=0;i<hash->modulo;i++){
+    for(entry=*entryP;entry!=NULL;entry=entry->next)
+      if(entry->key>>16==protocol && entry->sum.packets>=min) size++;
+    entryP++;
+    }
+  nbLogMsg(context,0,'T',"%s Parial Sum Table:",title);
+  nbLogPut(context,"Index  LCL           Packets      UCL           LCL          Bytes         UCL\n");
+  nbLogPut(context,"-----  ------------ ------------  ------------  ------------ ------------  ------------\n");
+  if(size==0) return;
+  list=(struct NB_MOD_NETFLOW_PORT **)nbAlloc(size*sizeof(struct NB_MOD_NETFLOW_PORT *));
+  entryP=(struct NB_MOD_NETFLOW_PORT **)&(hash->vector);
+  for(i=0;i<hash->modulo;i++){
+    for(entry=*entryP;entry!=NULL;entry=entry->next)
+      if(entry->key>>16==protocol && entry->sum.packets>=min) list[n++]=entry;
+    entryP++;
+    }
+  qsort(list,n,sizeof(struct NB_MOD_NETFLOW_PORT *),comparePort);
+  for(i=0;i<n;i++) partialSumLine(context,list[i]->key&0xffff,&list[i]->sum,&list[i]->packets,&list[i]->bytes);
+  nbFree(list,size*sizeof(struct NB_MOD_NETFLOW_PORT *));
+  }
+
+/*
+*  Reset partial sums of active ports
+*/
+static void resetPortSum(NB_MOD_Netflow *netflow){
+  struct NB_MOD_NETFLOW_HASH *hash=netflow->hashPort;
+  struct NB_MOD_NETFLOW_PORT **entryP=(struct NB_MOD_NETFLOW_PORT **)&(hash->vector),*entry;
+  int i;
+
+  for(i=0;i<hash->modulo;i++){
+    for(entry=*entryP;entry!=NULL;entry=entry->next){
+      entry->sum.packets=0;
+      entry->sum.bytes=0;
+      }
+    entryP++;
+    }
+  }
+
 /*
 *  Display volume sum table
 */
@@ -925,10 +1201,12 @@ static void loadPeriod(nbCELL context,NB_MOD_Netflow *netflow){
   
   weektime=time(NULL)%(7*24*60*60); /* compute time within week */
   period=weektime/(60*60);      /* period - hour of week */
+  netflow->periodNumber=period;
 
-  if(0>readHistory(netflow->hfile,&netflow->periodProfile,period,sizeof(struct NB_MOD_NETFLOW_PERIOD))){
+  if(netflow->periodProfile==NULL) return;  // 2026-10-18 eat - no history file
+  if(0>readHistory(netflow->hfile,netflow->periodProfile,period,sizeof(struct NB_MOD_NETFLOW_PERIOD))){
     nbLogMsg(context,0,'L',"Unable to read history file - using null history period");
-    memset(&netflow->periodProfile,0,sizeof(struct NB_MOD_NETFLOW_PERIOD));
+    memset(netflow->periodProfile,0,sizeof(struct NB_MOD_NETFLOW_PERIOD));
     } 
   }
 
@@ -939,23 +1217,20 @@ static void sumInterval(nbCELL context,NB_MOD_Netflow *netflow){
 *  Check for statistical anomalies
 */
 static void checkInterval(nbCELL context,NB_MOD_Netflow *netflow){
-  static int first=1;
-  static int n=5,N=5;  /* test at 5 minute sum interval */
- 
-  if(first){
+  // 2026-10-18 eat - use node fields instead of static variables shared by all nodes
+  if(netflow->periodNumber<0){   /* first check */
     loadPeriod(context,netflow);
     return;
     }
   /* displaySum(context,"Protocol",netflow->protocolSum,256,1.0); */
   partialSum(context,"Protocol",netflow->protocolSum,256,1.0,netflow->protocolPkts,netflow->protocolBytes);
-  partialSum(context,"TCP Port",netflow->tcpPortSum,65536,2000.0,netflow->tcpPortPkts,netflow->tcpPortBytes);
-  partialSum(context,"UDP Port",netflow->udpPortSum,65536,1000.0,netflow->udpPortPkts,netflow->udpPortBytes);
-  n--;
-  if(n<=0){
+  partialSumPort(context,netflow,"TCP Port",6,2000.0);
+  partialSumPort(context,netflow,"UDP Port",17,1000.0);
+  netflow->intervalNumber++;
+  if(netflow->intervalNumber>=netflow->checksPerSum){  /* test at 5 minute sum interval */
     memset(netflow->protocolSum,0,sizeof(netflow->protocolSum));
-    memset(netflow->tcpPortSum,0,sizeof(netflow->tcpPortSum));
-    memset(netflow->udpPortSum,0,sizeof(netflow->udpPortSum));
-    n=N;
+    resetPortSum(netflow);
+    netflow->intervalNumber=0;
     sumInterval(context,netflow);
     }
   }
@@ -963,13 +1238,16 @@ static void checkInterval(nbCELL context,NB_MOD_Netflow *netflow){
 static void handleV5(nbCELL context,NB_MOD_Netflow *netflow,void *buffer,int len){
   struct nfv5hdr *hdr=(void *)buffer;
   struct nfv5flow *flow=(struct nfv5flow *)((char *)buffer+sizeof(struct nfv5hdr));
-  int f;
+  int f,count=ntohs(hdr->count);
+  unsigned short dstport;
 
-  for(f=0;f<hdr->count;f++){
-    incrementVolume(context,netflow,flow->protocol,flow->dstport,flow->packets,flow->bytes);
+  // 2026-10-18 eat - fields are in network byte order and the count is checked against the length
+  for(f=0;f<count && (char *)(flow+1)<=(char *)buffer+len;f++){
+    dstport=ntohs(flow->dstport);
+    incrementVolume(context,netflow,flow->protocol,dstport,ntohl(flow->packets),ntohl(flow->bytes));
     /* ignore flows involving addressses we have flagged to ignore */
     if(!(getAttr(netflow,flow->srcaddr)&ON_IGNORE || getAttr(netflow,flow->dstaddr)&ON_IGNORE))
-      assertFlow(context,netflow,flow->packets,flow->bytes,flow->srcaddr,flow->dstaddr,flow->protocol,flow->dstport);
+      assertFlow(context,netflow,ntohl(flow->packets),ntohl(flow->bytes),flow->srcaddr,flow->dstaddr,flow->protocol,dstport);
     flow++;
     }
   }
@@ -977,56 +1255,385 @@ static void handleV5(nbCELL context,NB_MOD_Netflow *netflow,void *buffer,int len
 static void handleV7(nbCELL context,NB_MOD_Netflow *netflow,void *buffer,int len){
   struct nfv7hdr *hdr=(void *)buffer;
   struct nfv7flow *flow=(void *)((char *)buffer+sizeof(struct nfv7hdr));
-  int f;
+  int f,count=ntohs(hdr->count);
+  unsigned short dstport;
 
-  for(f=0;f<hdr->count;f++){
-    incrementVolume(context,netflow,flow->protocol,flow->dstport,flow->packets,flow->bytes);
+  for(f=0;f<count && (char *)(flow+1)<=(char *)buffer+len;f++){
+    dstport=ntohs(flow->dstport);
+    incrementVolume(context,netflow,flow->protocol,dstport,ntohl(flow->packets),ntohl(flow->bytes));
     /* ignore flows involving addressses we have flagged to ignore */
     if(!(getAttr(netflow,flow->srcaddr)&ON_IGNORE || getAttr(netflow,flow->dstaddr)&ON_IGNORE))
-      assertFlow(context,netflow,flow->packets,flow->bytes,flow->srcaddr,flow->dstaddr,flow->protocol,flow->dstport);
+      assertFlow(context,netflow,ntohl(flow->packets),ntohl(flow->bytes),flow->srcaddr,flow->dstaddr,flow->protocol,dstport);
     flow++;
     }
 
   }
 
 /*================================================================================*/
+/*
+*  Netflow v9 and IPFIX
+*/
+
+/*
+*  Get an unsigned integer of 1 to 8 bytes in network byte order
+*/
+static unsigned long long getUint(unsigned char *cursor,int len){
+  unsigned long long value=0;
+
+  while(len>0) value=(value<<8)|*cursor++,len--;
+  return(value);
+  }
+
+/*
+*  Map an information element to the record field we use
+*
+*    v9 field types and IPFIX information element ids are the same for the
+*    fields we use.  Fields with an unexpected length are ignored.
+*/
+static unsigned char templateSlot(unsigned short type,unsigned short length){
+  switch(type){
+    case 1:  if(length>=1 && length<=8) return(NB_MOD_NETFLOW_SLOT_BYTES); break;    // IN_BYTES, octetDeltaCount
+    case 2:  if(length>=1 && length<=8) return(NB_MOD_NETFLOW_SLOT_PACKETS); break;  // IN_PKTS, packetDeltaCount
+    case 4:  if(length==1) return(NB_MOD_NETFLOW_SLOT_PROTOCOL); break;              // PROTOCOL, protocolIdentifier
+    case 7:  if(length==2) return(NB_MOD_NETFLOW_SLOT_SRCPORT); break;               // L4_SRC_PORT, sourceTransportPort
+    case 8:  if(length==4) return(NB_MOD_NETFLOW_SLOT_SRCADDR); break;               // IPV4_SRC_ADDR, sourceIPv4Address
+    case 11: if(length==2) return(NB_MOD_NETFLOW_SLOT_DSTPORT); break;               // L4_DST_PORT, destinationTransportPort
+    case 12: if(length==4) return(NB_MOD_NETFLOW_SLOT_DSTADDR); break;               // IPV4_DST_ADDR, destinationIPv4Address
+    }
+  return(NB_MOD_NETFLOW_SLOT_NONE);
+  }
+
+/*
+*  Find a cached template
+*/
+static struct NB_MOD_NETFLOW_TEMPLATE **templateFind(NB_MOD_Netflow *netflow,unsigned int exporter,unsigned int domain,unsigned short id){
+  struct NB_MOD_NETFLOW_HASH *hash=netflow->hashTemplate;
+  struct NB_MOD_NETFLOW_TEMPLATE *template,**templateP;
+
+  templateP=(struct NB_MOD_NETFLOW_TEMPLATE **)&hash->vector+(exporter^(domain*31)^(id*257))%hash->modulo;
+  for(template=*templateP;template!=NULL;template=*templateP){
+    if(template->id==id && template->exporter==exporter && template->domain==domain) break;
+    templateP=&template->next;
+    }
+  return(templateP);
+  }
+
+/*
+*  Remove a cached template
+*/
+static void templateRemove(NB_MOD_Netflow *netflow,unsigned int exporter,unsigned int domain,unsigned short id){
+  struct NB_MOD_NETFLOW_TEMPLATE *template,**templateP;
+
+  templateP=templateFind(netflow,exporter,domain,id);
+  if((template=*templateP)==NULL) return;
+  *templateP=template->next;
+  nbFree(template,templateSize(template->fields));
+  }
+
+/*
+*  Cache a template
+*
+*    Options templates are cached with no fields, so their data sets are
+*    skipped without counting them as unknown.
+*
+*    Returns: number of bytes used, or -1 if the template is truncated
+*/
+static int templateDefine(nbCELL context,NB_MOD_Netflow *netflow,int ipfix,unsigned int domain,unsigned short id,int fields,unsigned char *cursor,unsigned char *end){
+  struct NB_MOD_NETFLOW_TEMPLATE *template,**templateP;
+  struct NB_MOD_NETFLOW_FIELD *field;
+  unsigned char *start=cursor;
+  unsigned short type,length;
+  int i,offset=0,fixed=1;
+
+  templateRemove(netflow,netflow->routerAddr,domain,id);
+  template=nbAlloc(templateSize(fields));
+  memset(template,0,templateSize(fields));
+  template->exporter=netflow->routerAddr;
+  template->domain=domain;
+  template->id=id;
+  template->fields=fields;
+  for(i=0;i<fields;i++){
+    if(cursor+4>end){
+      nbFree(template,templateSize(fields));
+      return(-1);
+      }
+    type=getUint(cursor,2);
+    length=getUint(cursor+2,2);
+    cursor+=4;
+    field=&template->field[i];
+    field->type=type;
+    field->length=length;
+    if(ipfix && type&0x8000){    /* enterprise specific */
+      if(cursor+4>end){
+        nbFree(template,templateSize(fields));
+        return(-1);
+        }
+      cursor+=4;
+      field->type=0;
+      }
+    else field->slot=templateSlot(type,length);
+    if(length==NB_MOD_NETFLOW_VARLEN){
+      fixed=0;
+      template->minLen+=1;
+      }
+    else{
+      template->minLen+=length;
+      if(fixed && field->slot && template->extracts<NB_MOD_NETFLOW_SLOTS){
+        template->extract[template->extracts].slot=field->slot;
+        template->extract[template->extracts].offset=offset;
+        template->extract[template->extracts].length=length;
+        template->extracts++;
+        }
+      offset+=length;
+      }
+    }
+  if(fixed) template->recordLen=offset;
+  if(template->minLen==0) template->minLen=1;
+  templateP=templateFind(netflow,netflow->routerAddr,domain,id);
+  template->next=*templateP;
+  *templateP=template;
+  if(netflow->trace) nbLogMsg(context,0,'T',"Template %u domain %u fields=%d recordLen=%u",id,domain,fields,template->recordLen);
+  return(cursor-start);
+  }
+
+/*
+*  Store a field value in a decoded record
+*/
+static void recordField(struct NB_MOD_NETFLOW_RECORD *record,unsigned char slot,unsigned char *cursor,int length){
+  switch(slot){
+    case NB_MOD_NETFLOW_SLOT_BYTES:    record->bytes=getUint(cursor,length); break;
+    case NB_MOD_NETFLOW_SLOT_PACKETS:  record->packets=getUint(cursor,length); break;
+    case NB_MOD_NETFLOW_SLOT_PROTOCOL: record->protocol=*cursor; break;
+    case NB_MOD_NETFLOW_SLOT_SRCPORT:  record->srcport=getUint(cursor,2); break;
+    case NB_MOD_NETFLOW_SLOT_DSTPORT:  record->dstport=getUint(cursor,2); break;
+    case NB_MOD_NETFLOW_SLOT_SRCADDR:  memcpy(&record->srcaddr,cursor,4); record->ipv4|=1; break;
+    case NB_MOD_NETFLOW_SLOT_DSTADDR:  memcpy(&record->dstaddr,cursor,4); record->ipv4|=2; break;
+    }
+  }
+
+/*
+*  Process a decoded record
+*
+*    Flows without IPv4 addresses are included in protocol and port volumes
+*    but are not included in the flow and address tables.
+*/
+static void handleRecord(nbCELL context,NB_MOD_Netflow *netflow,struct NB_MOD_NETFLOW_RECORD *record){
+  char srcaddr[16],dstaddr[16];
+
+  if(netflow->format)
+    nbLogPut(context,"%s:%5.5u -> %s:%5.5u protocol=%u packets=%llu bytes=%llu\n",nbIpGetAddrString(srcaddr,record->srcaddr),record->srcport,nbIpGetAddrString(dstaddr,record->dstaddr),record->dstport,record->protocol,record->packets,record->bytes);
+  if(netflow->null) return;
+  incrementVolume(context,netflow,record->protocol,record->dstport,(double)record->packets,(double)record->bytes);
+  if(record->ipv4!=3) return;
+  /* ignore flows involving addressses we have flagged to ignore */
+  if(!(getAttr(netflow,record->srcaddr)&ON_IGNORE || getAttr(netflow,record->dstaddr)&ON_IGNORE))
+    assertFlow(context,netflow,(unsigned int)record->packets,(unsigned int)record->bytes,record->srcaddr,record->dstaddr,record->protocol,record->dstport);
+  }
+
+/*
+*  Decode the records of a data set
+*
+*    Returns: number of records
+*/
+static int handleData(nbCELL context,NB_MOD_Netflow *netflow,struct NB_MOD_NETFLOW_TEMPLATE *template,unsigned char *cursor,unsigned char *end){
+  struct NB_MOD_NETFLOW_RECORD record;
+  struct NB_MOD_NETFLOW_EXTRACT *extract;
+  int i,length,count=0;
+
+  if(template->fields==0) return(0);  /* options data */
+  if(template->recordLen){  /* fixed length - use precomputed offsets */
+    for(;cursor+template->recordLen<=end;cursor+=template->recordLen){
+      memset(&record,0,sizeof(record));
+      for(i=0,extract=template->extract;i<template->extracts;i++,extract++)
+        recordField(&record,extract->slot,cursor+extract->offset,extract->length);
+      handleRecord(context,netflow,&record);
+      count++;
+      }
+    return(count);
+    }
+  while(cursor+template->minLen<=end){  /* variable length - walk the fields */
+    memset(&record,0,sizeof(record));
+    for(i=0;i<template->fields;i++){
+      length=template->field[i].length;
+      if(length==NB_MOD_NETFLOW_VARLEN){
+        length=*cursor++;
+        if(length==255){
+          if(cursor+2>end) return(count);
+          length=getUint(cursor,2);
+          cursor+=2;
+          }
+        }
+      if(cursor+length>end) return(count);
+      if(template->field[i].slot) recordField(&record,template->field[i].slot,cursor,length);
+      cursor+=length;
+      }
+    handleRecord(context,netflow,&record);
+    count++;
+    }
+  return(count);
+  }
+
+/*
+*  Handle a version 9 or IPFIX (version 10) datagram
+*
+*    The two formats differ in header layout and set ids, and IPFIX adds
+*    enterprise specific and variable length fields.
+*
+*    Returns: number of flow records
+*/
+static int handleTemplated(nbCELL context,NB_MOD_Netflow *netflow,int version,unsigned char *buffer,int len){
+  struct NB_MOD_NETFLOW_TEMPLATE *template;
+  unsigned char *cursor,*end=buffer+len,*setEnd;
+  unsigned int domain,seq;
+  unsigned short setId,id,fields,scopeFields;
+  int ipfix=(version==10),setLen,used,count=0;
+
+  if(ipfix){
+    if(len<16) return(0);
+    if(getUint(buffer+2,2)<len) end=buffer+getUint(buffer+2,2);
+    seq=getUint(buffer+8,4);
+    domain=getUint(buffer+12,4);
+    cursor=buffer+16;
+    }
+  else{
+    if(len<20) return(0);
+    seq=getUint(buffer+12,4);
+    domain=getUint(buffer+16,4);
+    cursor=buffer+20;
+    }
+  while(cursor+4<=end){
+    setId=getUint(cursor,2);
+    setLen=getUint(cursor+2,2);
+    if(setLen<4 || cursor+setLen>end) break;
+    setEnd=cursor+setLen;
+    cursor+=4;
+    if(setId==(ipfix ? 2 : 0)){          /* template set */
+      while(cursor+4<=setEnd){
+        id=getUint(cursor,2);
+        fields=getUint(cursor+2,2);
+        cursor+=4;
+        if(id<256) break;
+        if(fields==0){                   /* IPFIX template withdrawal */
+          templateRemove(netflow,netflow->routerAddr,domain,id);
+          continue;
+          }
+        if((used=templateDefine(context,netflow,ipfix,domain,id,fields,cursor,setEnd))<0) break;
+        cursor+=used;
+        }
+      }
+    else if(setId==(ipfix ? 3 : 1)){     /* options template set - cache id only */
+      while(cursor+6<=setEnd){
+        id=getUint(cursor,2);
+        if(id<256) break;
+        if(ipfix){
+          fields=getUint(cursor+2,2);
+          scopeFields=getUint(cursor+4,2);
+          if(fields==0 || scopeFields==0) break;
+          cursor+=6;
+          for(;fields>0 && cursor+4<=setEnd;fields--) cursor+=(getUint(cursor,2)&0x8000) ? 8 : 4;
+          }
+        else cursor+=6+getUint(cursor+2,2)+getUint(cursor+4,2);
+        templateDefine(context,netflow,ipfix,domain,id,0,cursor,setEnd);
+        }
+      }
+    else if(setId>=256){                 /* data set */
+      template=*templateFind(netflow,netflow->routerAddr,domain,setId);
+      if(template==NULL) netflow->templateMiss++;
+      else count+=handleData(context,netflow,template,cursor,setEnd);
+      }
+    cursor=setEnd;
+    }
+  netflow->flowCount+=count;
+  setSeq(netflow,netflow->routerAddr,(unsigned char)domain,seq,count,version);
+  return(count);
+  }
+
+/*================================================================================*/
+/*
+*  Process a datagram
+*/
+static void netflowDatagram(nbCELL context,NB_MOD_Netflow *netflow,unsigned char *buffer,int len){
+  struct nfv5hdr *hdr=(void *)buffer;
+  int version,count;
+
+  if(len<(int)sizeof(struct nfv5hdr)) return;
+  version=ntohs(hdr->version);
+  switch(version){
+    case 5:
+    case 7:
+      /* assert the flows in this packet */
+      count=ntohs(hdr->count);
+      netflow->flowCount+=count;
+      /* set the flow sequence number for the router */
+      setSeq(netflow,netflow->routerAddr,hdr->engineid,ntohl(hdr->flowseq),count,version);
+      if(!netflow->null){
+        if(version==5) handleV5(context,netflow,buffer,len);
+        else handleV7(context,netflow,buffer,len);
+        }
+      break;
+    case 9:
+    case 10:
+      handleTemplated(context,netflow,version,buffer,len);
+      break;
+    }
+  }
+
 /*
 *  Read incoming packets
 */
 static void netflowRead(nbCELL context,int serverSocket,void *handle){
   NB_MOD_Netflow *netflow=handle;
-  unsigned char buffer[NB_BUFSIZE];
-  size_t buflen=NB_BUFSIZE;
+  static unsigned char buffer[NB_MOD_NETFLOW_BUFSIZE];
+  size_t buflen=NB_MOD_NETFLOW_BUFSIZE;
   int  len;
   unsigned short rport;
   char daddr[40],raddr[40];
   struct nfv5hdr *hdr=(void *)buffer;
-  //struct nfv5flow *flow=(void *)(buffer+24);
 
   nbIpGetSocketAddrString(serverSocket,daddr);
   len=nbIpGetDatagram(context,serverSocket,&netflow->routerAddr,&rport,buffer,buflen);
+  if(len<=0) return;
   if(netflow->trace){
-    nbLogMsg(context,0,'I',"Datagram %s:%5.5u -> %s len=%d version=%d\n",nbIpGetAddrString(raddr,netflow->routerAddr),rport,daddr,len,hdr->version);
+    nbLogMsg(context,0,'I',"Datagram %s:%5.5u -> %s len=%d version=%d\n",nbIpGetAddrString(raddr,netflow->routerAddr),rport,daddr,len,ntohs(hdr->version));
     if(netflow->dump) nbLogDump(context,buffer,len);
     if(netflow->format){
-      switch(hdr->version){
+      switch(ntohs(hdr->version)){
         case 5: format5(context,buffer,len); break;
         case 7: format7(context,buffer,len); break;
         }
       }
     }
-  /* assert the flows in this packet */
-  netflow->flowCount+=hdr->count;
-  /* set the flow sequence number for the router */
-  setSeq(netflow,netflow->routerAddr,hdr->engineid,hdr->flowseq,hdr->count,hdr->version);
+  if(netflow->record) netflow->record=nbIpRecordPut(context,netflow->record,netflow->routerAddr,buffer,len);
+  netflowDatagram(context,netflow,buffer,len);
+  }
+
 /*
-  nbLogPut(context,"router %s enginetype=%u engineid=%u flowseq=%u\n",nbIpGetAddrString(daddr,netflow->routerAddr),hdr->enginetype,hdr->engineid,hdr->flowseq);
+*  Handle a replayed datagram
 */
-  if(!netflow->null){
-    switch(hdr->version){
-      case 5: handleV5(context,netflow,buffer,len); break;
-      case 7: handleV7(context,netflow,buffer,len); break;
-      }
+static void netflowReplayDatagram(nbCELL context,void *handle,unsigned int addr,unsigned char *buffer,int len){
+  NB_MOD_Netflow *netflow=(NB_MOD_Netflow *)handle;
+
+  netflow->routerAddr=addr;
+  netflowDatagram(context,netflow,buffer,len);
+  }
+
+/*
+*  Replay recorded datagrams - see nbIpReplay()
+*/
+static void netflowReplay(nbCELL context,NB_MOD_Netflow *netflow,char *filename,int repeat,int benchmark){
+  unsigned int routerAddr=netflow->routerAddr,flowCount=netflow->flowCount,templateMiss=netflow->templateMiss;
+  double elapsed;
+  int datagrams;
+
+  datagrams=nbIpReplay(context,filename,NB_MOD_NETFLOW_MAGIC,NB_MOD_NETFLOW_BUFSIZE,repeat,netflow,netflowReplayDatagram,&elapsed);
+  netflow->routerAddr=routerAddr;
+  if(datagrams<0) return;
+  flowCount=netflow->flowCount-flowCount;
+  templateMiss=netflow->templateMiss-templateMiss;
+  nbLogMsg(context,0,'I',"Replayed %d datagrams with %u flows - %u data sets with unknown template",datagrams,flowCount,templateMiss);
+  if(benchmark){
+    if(elapsed<=0) elapsed=1e-9;
+    nbLogMsg(context,0,'I',"Benchmark: %.3f seconds, %.0f datagrams/second, %.0f flows/second",elapsed,datagrams/elapsed,flowCount/elapsed);
     }
   }
 
@@ -1082,7 +1689,7 @@ static void *netflowConstruct(nbCELL context,void *skillHandle,nbCELL arglist,ch
       exit(NB_EXITCODE_FAIL);
       }
     nbCellDrop(context,cell);
-    hfile=openHistory(hfilename,7*24,sizeof(struct NB_MOD_NETFLOW_PERIOD));
+    hfile=openHistory(context,hfilename,7*24,sizeof(struct NB_MOD_NETFLOW_PERIOD));
     if(hfile<0){
       nbLogMsg(context,0,'E',"Unable to open history file");
       return(NULL);
@@ -1123,19 +1730,22 @@ static void *netflowConstruct(nbCELL context,void *skillHandle,nbCELL arglist,ch
   netflow->flowCount=0;
   netflow->flowCountPrev=0;
   netflow->flowCountMon=0;
+  netflow->templateMiss=0;
+  netflow->record=NULL;
+  netflow->display=0;
   netflow->hashFlow=hashNew(9601);
   netflow->hashAddr=hashNew(9601);
   netflow->hashAttr=hashNew(9601);
+  netflow->hashPort=hashNew(1021);
+  netflow->hashTemplate=hashNew(257);
   memset(netflow->protocolSum,0,sizeof(netflow->protocolSum));
-  memset(netflow->tcpPortSum,0,sizeof(netflow->tcpPortSum));
-  memset(netflow->udpPortSum,0,sizeof(netflow->udpPortSum));
   memset(netflow->protocolPkts,0,sizeof(netflow->protocolPkts));
   memset(netflow->protocolBytes,0,sizeof(netflow->protocolBytes));
-  memset(netflow->tcpPortPkts,0,sizeof(netflow->tcpPortPkts));
-  memset(netflow->tcpPortBytes,0,sizeof(netflow->tcpPortBytes));
-  memset(netflow->udpPortPkts,0,sizeof(netflow->udpPortPkts));
-  memset(netflow->udpPortBytes,0,sizeof(netflow->udpPortBytes));
-  memset(&netflow->periodProfile,0,sizeof(netflow->periodProfile));
+  netflow->periodProfile=NULL;
+  if(*hfilename){
+    netflow->periodProfile=nbAlloc(sizeof(struct NB_MOD_NETFLOW_PERIOD));
+    memset(netflow->periodProfile,0,sizeof(struct NB_MOD_NETFLOW_PERIOD));
+    }
 
   netflow->periodNumber=-1;            /* indicates we have not started yet */
   netflow->intervalNumber=0;
@@ -1186,11 +1796,23 @@ static int netflowDisable(nbCELL context,void *skillHandle,NB_MOD_Netflow *netfl
 *    <node>[(<args>)][:<text>]
 *
 *    <node>:check,reset,display
+*    <node>:record [<file>]
+*    <node>:replay <file>
+*    <node>:benchmark <file>[,<repeat>]
 */
 static int *netflowCommand(nbCELL context,void *skillHandle,NB_MOD_Netflow *netflow,nbCELL arglist,char *text){
+  char verb[16],filename[512];
+  int rc,repeat;
+
   if(netflow->trace){
     nbLogMsg(context,0,'T',"nb_netflow:netflowCommand() text=[%s]\n",text);
     }
+  if((rc=nbIpRecordParse(context,text,verb,sizeof(verb),filename,sizeof(filename),&repeat))!=0){
+    if(rc<0) return(0);
+    if(strcmp(verb,"record")==0) netflow->record=nbIpRecord(context,netflow->record,filename,NB_MOD_NETFLOW_MAGIC);
+    else netflowReplay(context,netflow,filename,repeat,strcmp(verb,"benchmark")==0);
+    return(0);
+    }
   if(strstr(text,"check")) checkInterval(context,netflow);
   else if(strstr(text,"reset")) resetFlow(context,netflow);
   else if(strstr(text,"display")) netflow->display=1;
@@ -1207,8 +1829,12 @@ static int *netflowCommand(nbCELL context,void *skillHandle,NB_MOD_Netflow *netf
 static int netflowDestroy(nbCELL context,void *skillHandle,NB_MOD_Netflow *netflow){
   nbLogMsg(context,0,'T',"netflowDestroy called");
   if(netflow->socket!=0) netflowDisable(context,skillHandle,netflow);
+  if(netflow->record) fclose(netflow->record);
   hashFreeFlow(netflow->hashFlow);
   hashFreeAddr(netflow->hashAddr);
+  hashFreePort(netflow->hashPort);
+  hashFreeTemplate(netflow->hashTemplate);
+  if(netflow->periodProfile) nbFree(netflow->periodProfile,sizeof(struct NB_MOD_NETFLOW_PERIOD));
   nbFree(netflow,sizeof(NB_MOD_Netflow));
   return(0);
   }
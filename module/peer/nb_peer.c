@@ -105,6 +105,12 @@
 * 2012-10-17 eat 0.8.12 Added size parameter to nbNodeGetNameFull
 * 2012-12-16 eat 0.8.13 Checker updates.
 * 2012-12-27 eat 0.8.13 Checker updates.
+* 2026-10-18 eat 0.9.04 Included peer.vlicheck and peer.vlibench commands
+* 2026-10-18 eat 0.9.04 Included peer.skecheck and peer.skebench commands
+* 2026-10-18 eat 0.9.04 Included queue log event mode and convert, process, and bench commands
+* 2026-10-18 eat 0.9.04 Require control authority for peer.vlicheck and peer.vlibench and limit the count
+* 2026-10-18 eat 0.9.04 Require control authority for peer.skecheck and peer.skebench and limit the count
+* 2026-10-18 eat 0.9.04 Included peer.recordcheck command for nbPeer records over 64KB
 *=====================================================================
 */
 //#include "config.h"
@@ -121,6 +127,10 @@
 
 #include "nb_peer.h"  // 2009-04-19 eat 0.7.5 - used to expose client to nbprotocol for queue transfer
 
+#if defined(HAVE_SYS_INOTIFY_H)
+#include <sys/inotify.h>
+#endif
+
 static unsigned short nb_mode_embraceable=0;  /* flag server as deadly embraceable---has NBP listener */
 //=============================================================================
  
@@ -970,6 +980,8 @@ typedef struct NB_MOD_QUEUE{
   nbCELL           nameCell;      // queue name
   nbCELL           scheduleCell;  // schedule 
   nbCELL           synapseCell;   // synapse - used to respond to schedule
+  int              inotify;       // inotify descriptor in event mode - -1 otherwise
+  int              wd;            // watch descriptor for the queue directory
   } nbQueue;
 
 // Check for new queue files
@@ -980,9 +992,88 @@ static void queueAlarm(nbCELL context,void *skillHandle,void *nodeHandle,nbCELL
   nbCELL value=nbCellGetValue(context,cell);
 
   if(value!=NB_CELL_TRUE) return;  // only act when schedule toggles to true
+#if !defined(WIN32)
+  nbQueueLogProcess(context,nbCellGetString(context,queue->nameCell));  // 2026-10-18 eat 0.9.04
+#endif
   nbQueueProcess(context,nbCellGetString(context,queue->nameCell),queue->synapseCell);
   }
 
+#if defined(HAVE_SYS_INOTIFY_H)
+// Event mode
+//
+//   Without a schedule, every identity directory is kept in the log format
+//   and watched with inotify.  Commands are processed as soon as they are
+//   appended.  Command queue files written to an identity directory by other
+//   producers are moved into the log when they are closed or renamed into
+//   place.
+
+#define NB_QUEUE_WATCH IN_MODIFY|IN_CLOSE_WRITE|IN_MOVED_TO|IN_CREATE
+
+static void queueWatchIdentity(nbCELL context,nbQueue *queue,char *identityName){
+  char dirname[1024];
+
+  snprintf(dirname,sizeof(dirname),"%s/%s",nbCellGetString(context,queue->nameCell),identityName);
+  if(inotify_add_watch(queue->inotify,dirname,NB_QUEUE_WATCH)<0)
+    nbLogMsg(context,0,'E',"Unable to watch directory \"%s\" - %s",dirname,strerror(errno));
+  }
+
+static void queueEvent(nbCELL context,int fildes,void *session){
+  nbQueue *queue=(nbQueue *)session;
+  char *dirname=nbCellGetString(context,queue->nameCell);
+  char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+  struct inotify_event *event;
+  char *cursor;
+  ssize_t len;
+  int convert=0;
+
+  while((len=read(fildes,buffer,sizeof(buffer)))>0 || (len<0 && errno==EINTR)){
+    for(cursor=buffer;len>0 && cursor<buffer+len;cursor+=sizeof(struct inotify_event)+event->len){
+      event=(struct inotify_event *)cursor;
+      if(event->len==0) continue;
+      if(event->wd==queue->wd){
+        if((event->mask&IN_ISDIR) && *event->name!='.' && nbIdentityGet(context,event->name)!=NULL){
+          nbQueueLogCreate(dirname,event->name);
+          queueWatchIdentity(context,queue,event->name);
+          }
+        }
+      else if((event->mask&(IN_CLOSE_WRITE|IN_MOVED_TO)) && *event->name!='L' && strlen(event->name)>2 &&
+        strcmp(event->name+strlen(event->name)-2,".q")==0) convert=1;
+      }
+    }
+  if(convert) nbQueueLogConvert(dirname,NULL);
+  nbQueueLogProcess(context,dirname);
+  }
+
+static int queueWatch(nbCELL context,nbQueue *queue){
+  char *dirname=nbCellGetString(context,queue->nameCell);
+  DIR *dir;
+  struct dirent *ent;
+
+  if(nbQueueLogConvert(dirname,NULL)<0) return(1);
+  if((queue->inotify=inotify_init())<0){
+    nbLogMsg(context,0,'E',"Unable to initialize inotify - %s",strerror(errno));
+    return(1);
+    }
+  fcntl(queue->inotify,F_SETFL,O_NONBLOCK);
+  fcntl(queue->inotify,F_SETFD,FD_CLOEXEC);
+  if((queue->wd=inotify_add_watch(queue->inotify,dirname,IN_CREATE|IN_MOVED_TO|IN_ONLYDIR))<0){
+    nbLogMsg(context,0,'E',"Unable to watch directory \"%s\" - %s",dirname,strerror(errno));
+    close(queue->inotify);
+    queue->inotify=-1;
+    return(1);
+    }
+  if((dir=opendir(dirname))!=NULL){
+    while((ent=readdir(dir))!=NULL){
+      if(*ent->d_name!='.' && nbQueueLogExists(dirname,ent->d_name)) queueWatchIdentity(context,queue,ent->d_name);
+      }
+    closedir(dir);
+    }
+  nbListenerAdd(context,queue->inotify,queue,queueEvent);
+  nbQueueLogProcess(context,dirname);  // catch up
+  return(0);
+  }
+#endif
+
 /*
 *  construct() method
 *
@@ -1018,6 +1109,8 @@ static void *queueConstruct(nbCELL context,void *skillHandle,nbCELL arglist,char
   queue->nameCell=nameCell;
   queue->scheduleCell=scheduleCell;
   queue->synapseCell=NULL; 
+  queue->inotify=-1;
+  queue->wd=-1;
 
   nbListenerEnableOnDaemon(context);  // sign up to enable when we daemonize
   return(queue);
@@ -1029,7 +1122,15 @@ static void *queueConstruct(nbCELL context,void *skillHandle,nbCELL arglist,char
 *    enable <node>
 */
 static int queueEnable(nbCELL context,void *skillHandle,nbQueue *queue){
-  if(queue->synapseCell!=NULL) return(0);
+  if(queue->synapseCell!=NULL || queue->inotify>=0) return(0);
+#if defined(HAVE_SYS_INOTIFY_H)
+  if(queue->scheduleCell==NULL){  // 2026-10-18 eat 0.9.04 - event mode
+    if(queueWatch(context,queue)) return(1);
+    nbLogMsg(context,0,'I',"Enabled queue %s in event mode",nbCellGetString(context,queue->nameCell));
+    nbLogFlush(context);
+    return(0);
+    }
+#endif
   queue->synapseCell=nbSynapseOpen(context,skillHandle,queue,queue->scheduleCell,queueAlarm);
   nbLogMsg(context,0,'I',"Enabled queue %s",nbCellGetString(context,queue->nameCell));
   nbLogFlush(context);
@@ -1042,6 +1143,15 @@ static int queueEnable(nbCELL context,void *skillHandle,nbQueue *queue){
 *    disable <node>
 */
 static int queueDisable(nbCELL context,void *skillHandle,nbQueue *queue){
+  if(queue->inotify>=0){  // 2026-10-18 eat 0.9.04
+    nbListenerRemove(context,queue->inotify);
+    close(queue->inotify);
+    queue->inotify=-1;
+    queue->wd=-1;
+    nbLogMsg(context,0,'I',"Disabled queue %s",nbCellGetString(context,queue->nameCell));
+    nbLogFlush(context);
+    return(0);
+    }
   if(queue->synapseCell==NULL) return(0);
   queue->synapseCell=nbSynapseClose(context,queue->synapseCell);  // release the synapse
   nbLogMsg(context,0,'I',"Disabled queue %s",nbCellGetString(context,queue->nameCell));
@@ -1053,9 +1163,71 @@ static int queueDisable(nbCELL context,void *skillHandle,nbQueue *queue){
 *  command() method
 *
 *    <node>[(<args>)][:<text>]
+*
+*    <node>:convert log [<identity>]   - move command queue files into logs
+*    <node>:convert file [<identity>]  - move logs into command queue files
+*    <node>:process                    - process logs now
+*    <node>:bench [<records>]          - compare file and log formats
 */
 static int *queueCommand(nbCELL context,void *skillHandle,nbQueue *queue,nbCELL arglist,char *text){
-  /* process commands here */
+#if !defined(WIN32)
+  char *dirname=nbCellGetString(context,queue->nameCell);
+  char *cursor=text,*identityName=NULL;
+  char symid,verb[32],token[256],benchdir[512],identdir[1024];
+  double seconds[4];
+  int records=10000,count;
+
+  symid=nbParseSymbol(verb,sizeof(verb),&cursor);
+  if(symid==';') return(0);
+  if(symid=='t' && strcmp(verb,"convert")==0){
+    symid=nbParseSymbol(token,sizeof(token),&cursor);
+    if(symid!='t' || (strcmp(token,"log")!=0 && strcmp(token,"file")!=0)){
+      nbLogMsg(context,0,'E',"Expecting \"log\" or \"file\" at: %s",text);
+      return(0);
+      }
+    symid=nbParseSymbol(verb,sizeof(verb),&cursor);
+    if(symid=='t') identityName=verb;
+    else if(symid!=';'){
+      nbLogMsg(context,0,'E',"Expecting identity name at: %s",text);
+      return(0);
+      }
+    if(identityName && nbIdentityGet(context,identityName)==NULL){
+      nbLogMsg(context,0,'E',"Identity %s not recognized",identityName);
+      return(0);
+      }
+    if(*token=='l') count=nbQueueLogConvert(dirname,identityName);
+    else count=nbQueueLogUnload(dirname,identityName,1);
+    if(count<0) nbLogMsg(context,0,'E',"Queue %s conversion failed",dirname);
+    else nbLogMsg(context,0,'I',"Queue %s converted to %s format - %d records moved",dirname,token,count);
+    }
+  else if(symid=='t' && strcmp(verb,"process")==0){
+    count=nbQueueLogProcess(context,dirname);
+    nbLogMsg(context,0,'I',"Queue %s log processed - %d commands",dirname,count);
+    }
+  else if(symid=='t' && strcmp(verb,"bench")==0){
+    symid=nbParseSymbol(token,sizeof(token),&cursor);
+    if(symid=='i') records=atoi(token);
+    if(records<1){
+      nbLogMsg(context,0,'E',"Expecting positive number of records");
+      return(0);
+      }
+    snprintf(benchdir,sizeof(benchdir),"%s/.bench",dirname);
+    identityName=nbIdentityGetName(context,nbIdentityGetActive(context));
+    count=nbQueueBench(benchdir,identityName,records,seconds);
+    snprintf(identdir,sizeof(identdir),"%s/%s",benchdir,identityName);
+    rmdir(identdir);
+    rmdir(benchdir);
+    if(count<0){
+      nbLogMsg(context,0,'E',"Queue benchmark failed");
+      return(0);
+      }
+    nbLogMsg(context,0,'I',"Queue benchmark %d records: file write %.2f us, read %.2f us, log write %.2f us, read %.2f us per record, %d lost",
+      records,seconds[0]*1e6/records,seconds[1]*1e6/records,seconds[2]*1e6/records,seconds[3]*1e6/records,count);
+    nbLogMsg(context,0,'I',"Queue benchmark speedup: write %.1fx, read %.1fx",
+      seconds[2]>0 ? seconds[0]/seconds[2] : 0,seconds[3]>0 ? seconds[1]/seconds[3] : 0);
+    }
+  else nbLogMsg(context,0,'E',"Verb \"%s\" not recognized - expecting \"convert\", \"process\", or \"bench\"",verb);
+#endif
   return(0);
   }
 
@@ -1067,6 +1239,10 @@ static int *queueCommand(nbCELL context,void *skillHandle,nbQueue *queue,nbCELL
 */
 static int queueDestroy(nbCELL context,void *skillHandle,nbQueue *queue){
   nbLogMsg(context,0,'T',"queueDestroy called");
+  if(queue->inotify>=0){  // 2026-10-18 eat 0.9.04
+    nbListenerRemove(context,queue->inotify);
+    close(queue->inotify);
+    }
   nbCellDrop(context,queue->nameCell);
   nbCellDrop(context,queue->scheduleCell);
   nbCellDrop(context,queue->synapseCell);
@@ -1087,6 +1263,218 @@ extern void *queueBind(nbCELL context,void *moduleHandle,nbCELL skill,nbCELL arg
   }
 
 //=====================================================================
+/*
+*  Check or benchmark vlipow
+*
+*    peer.vlicheck [<bits> [<count>]]
+*    peer.vlibench [<bits> [<count>]]
+*/
+static int peerCmdVli(nbCELL context,void *handle,char *verb,char *text){
+  char *cursor=text;
+  char symid,token[16];
+  unsigned int bits=1024;
+  int count=10,errors;
+  double seconds[2];
+
+  symid=nbParseSymbol(token,sizeof(token),&cursor);
+  if(symid=='i'){
+    bits=atoi(token);
+    symid=nbParseSymbol(token,sizeof(token),&cursor);
+    if(symid=='i'){
+      count=atoi(token);
+      symid=nbParseSymbol(token,sizeof(token),&cursor);
+      }
+    }
+  if(symid!=';'){
+    nbLogMsg(context,0,'E',"Expecting [<bits> [<count>]] at [%s].",text);
+    return(1);
+    }
+  if(bits<32 || bits>4096 || count<1 || count>100){
+    nbLogMsg(context,0,'E',"Expecting bits from 32 to 4096 and a count from 1 to 100.");
+    return(1);
+    }
+  if(strcmp(verb,"peer.vlibench")==0){
+    errors=vlicheck(bits,count,seconds);
+    nbLogMsg(context,0,'I',"vlipow %u bits: %d operations, %.3f ms/op, vlipowc %.3f ms/op, speedup %.1fx, %d mismatches",
+      bits,count,seconds[0]*1000/count,seconds[1]*1000/count,seconds[0]>0 ? seconds[1]/seconds[0] : 0,errors);
+    }
+  else{
+    errors=vlicheck(bits,count,NULL);
+    nbLogMsg(context,0,errors ? 'E' : 'I',"vlipow %u bits: %d operations, %d mismatches",bits,count,errors);
+    }
+  return(errors ? 1 : 0);
+  }
+
+/*
+*  Check or benchmark skeCipher
+*
+*    peer.skecheck [<keySize> [<blocks> [<count>]]]
+*    peer.skebench [<keySize> [<blocks> [<count>]]]
+*/
+static int peerCmdSke(nbCELL context,void *handle,char *verb,char *text){
+  char *cursor=text;
+  char symid,token[16];
+  int arg[3]={4,1024,100},i,errors;
+  double seconds[2],bytes;
+
+  symid=nbParseSymbol(token,sizeof(token),&cursor);
+  for(i=0;i<3 && symid=='i';i++){
+    arg[i]=atoi(token);
+    symid=nbParseSymbol(token,sizeof(token),&cursor);
+    }
+  if(symid!=';'){
+    nbLogMsg(context,0,'E',"Expecting [<keySize> [<blocks> [<count>]]] at [%s].",text);
+    return(1);
+    }
+  if(arg[0]<1 || arg[0]>8 || arg[1]<1 || arg[1]>65536 || arg[2]<1 || arg[2]>1000){
+    nbLogMsg(context,0,'E',"Expecting key size from 1 to 8 words, 1 to 65536 blocks, and a count from 1 to 1000.");
+    return(1);
+    }
+  if(strcmp(verb,"peer.skebench")==0){
+    errors=skeCheck(arg[0],arg[1],arg[2],seconds);
+    bytes=2.0*arg[1]*16*arg[2]/(1024*1024);
+    nbLogMsg(context,0,'I',"skeCipher %s key size %d: %d x %d blocks, %.1f MB/s, skeCipherc %.1f MB/s, speedup %.1fx, %d mismatches",
+      skeAccelerate(-1) ? "AES-NI" : "table",arg[0],arg[2],arg[1],
+      seconds[0]>0 ? bytes/seconds[0] : 0,seconds[1]>0 ? bytes/seconds[1] : 0,seconds[0]>0 ? seconds[1]/seconds[0] : 0,errors);
+    }
+  else{
+    errors=skeCheck(arg[0],arg[1],arg[2],NULL);
+    nbLogMsg(context,0,errors ? 'E' : 'I',"skeCipher key size %d: %d x %d blocks, %d mismatches",arg[0],arg[2],arg[1],errors);
+    }
+  return(errors ? 1 : 0);
+  }
+
+/*
+*  Check nbPeer records on both sides of the 64KB length limit
+*
+*    peer.recordcheck <context>
+*
+*    The context provides the "uri" and "option" terms used by nbPeerConstruct,
+*    normally a TCP uri on the local host.  A client peer sends records to a
+*    listening peer.  Records of 64KB or more are written with a 2 byte zero
+*    length and a 4 byte length.  The listener checks the size and content of
+*    each record and asserts "records" in the context as the number received
+*    intact, or -1 when a record is damaged or the connection fails.
+*/
+static size_t peerRecordSize[]={1,65531,65532,65533,65534,65535,65536,200000,1048576,3};
+#define PEER_RECORD_COUNT (int)(sizeof(peerRecordSize)/sizeof(size_t))
+
+typedef struct PEER_RECORD_CHECK{
+  nbCELL  context;     // context with uri and option terms
+  nbPeer  *listener;   // listening peer
+  nbPeer  *server;     // accepted peer
+  nbPeer  *client;     // connecting peer
+  int     sent;        // records sent by client
+  int     received;    // records received intact by server
+  int     done;        // result has been asserted
+  } peerRecordCheck;
+
+static peerRecordCheck peerRecord;
+
+static unsigned char peerRecordByte(size_t size,size_t i){
+  return((unsigned char)((i*7+size)&0xff));
+  }
+
+/*
+*  Assert the result and stop the other peers
+*
+*    The peer being shut down by the caller is left alone.
+*/
+static void peerRecordResult(nbCELL context,nbPeer *peer,int records){
+  char cmd[64];
+
+  if(peerRecord.done) return;
+  peerRecord.done=1;
+  nbLogMsg(context,0,records==PEER_RECORD_COUNT ? 'I' : 'E',"peer.recordcheck: %d of %d records received intact",peerRecord.received,PEER_RECORD_COUNT);
+  snprintf(cmd,sizeof(cmd),"assert records=%d",records);
+  nbCmd(peerRecord.context,cmd,0);
+  if(peerRecord.client && peerRecord.client!=peer) nbPeerShutdown(context,peerRecord.client,0);
+  if(peerRecord.listener && peerRecord.listener!=peer) nbPeerShutdown(context,peerRecord.listener,0);
+  }
+
+static int peerRecordProducer(nbCELL context,nbPeer *peer,void *handle){
+  unsigned char *data;
+  size_t size,i;
+  int rc=0;
+
+  while(peerRecord.sent<PEER_RECORD_COUNT && rc==0){
+    size=peerRecordSize[peerRecord.sent];
+    data=(unsigned char *)nbAlloc(size);
+    for(i=0;i<size;i++) data[i]=peerRecordByte(size,i);
+    rc=nbPeerSend(context,peer,data,size);
+    nbFree(data,size);
+    if(rc==0) peerRecord.sent++;
+    }
+  return(rc<0 ? rc : 0);
+  }
+
+static int peerRecordAccepter(nbCELL context,nbPeer *peer,void *handle){
+  peerRecord.server=peer;
+  return(0);
+  }
+
+static int peerRecordConsumer(nbCELL context,nbPeer *peer,void *handle,void *data,int len){
+  unsigned char *cursor=(unsigned char *)data;
+  size_t size,i;
+
+  size=peerRecordSize[peerRecord.received];
+  if((size_t)len!=size){
+    nbLogMsg(context,0,'E',"peer.recordcheck: record %d has %d bytes - expecting %zu",peerRecord.received+1,len,size);
+    return(-1);
+    }
+  for(i=0;i<size && *cursor==peerRecordByte(size,i);i++) cursor++;
+  if(i<size){
+    nbLogMsg(context,0,'E',"peer.recordcheck: record %d of %zu bytes differs at byte %zu",peerRecord.received+1,size,i);
+    return(-1);
+    }
+  peerRecord.received++;
+  if(peerRecord.received<PEER_RECORD_COUNT) return(0);
+  return(1);
+  }
+
+static void peerRecordShutdown(nbCELL context,nbPeer *peer,void *handle,int code){
+  peerRecordResult(context,peer,peerRecord.received==PEER_RECORD_COUNT ? peerRecord.received : -1);
+  }
+
+static int peerCmdRecord(nbCELL context,void *handle,char *verb,char *text){
+  char *cursor=text;
+  char symid,ident[256],token[16];
+  nbCELL tlsContext;
+
+  symid=nbParseSymbol(ident,sizeof(ident),&cursor);
+  if(symid!='t' || nbParseSymbol(token,sizeof(token),&cursor)!=';'){
+    nbLogMsg(context,0,'E',"Expecting <context> at [%s].",text);
+    return(1);
+    }
+  if((tlsContext=nbTermLocate(context,ident))==NULL){
+    nbLogMsg(context,0,'E',"Term \"%s\" not defined.",ident);
+    return(1);
+    }
+  if(peerRecord.listener){
+    if(!peerRecord.done){
+      nbLogMsg(context,0,'E',"The previous peer.recordcheck has not finished.");
+      return(1);
+      }
+    if(peerRecord.server) nbPeerDestroy(context,peerRecord.server);
+    nbPeerDestroy(context,peerRecord.client);
+    nbPeerDestroy(context,peerRecord.listener);
+    }
+  memset(&peerRecord,0,sizeof(peerRecord));
+  peerRecord.context=tlsContext;
+  peerRecord.listener=nbPeerConstruct(context,0,"uri","",tlsContext,&peerRecord,peerRecordAccepter,peerRecordConsumer,peerRecordShutdown);
+  peerRecord.client=nbPeerConstruct(context,1,"uri","",tlsContext,&peerRecord,NULL,NULL,NULL);
+  if(!peerRecord.listener->tls || !peerRecord.client->tls || nbPeerListen(context,peerRecord.listener)<0){
+    nbLogMsg(context,0,'E',"Unable to listen on uri defined in \"%s\".",ident);
+    peerRecord.done=1;
+    return(1);
+    }
+  if(nbPeerConnect(context,peerRecord.client,&peerRecord,peerRecordProducer,NULL,peerRecordShutdown)<0){
+    nbLogMsg(context,0,'E',"Unable to connect to uri defined in \"%s\".",ident);
+    return(1);
+    }
+  return(0);
+  }
+
 // Commands
 
 static int peerCmdShow(struct NB_CELL *context,void *handle,char *verb,char *cursor){
@@ -1103,5 +1491,10 @@ _declspec (dllexport)
 extern void *nbBind(nbCELL context,char *ident,nbCELL arglist,char *text){
   nbVerbDeclare(context,"peer.identify",NB_AUTH_CONTROL,0,NULL,&peerCmdIdentify,"<identity> [bits]");
   nbVerbDeclare(context,"peer.show",NB_AUTH_CONNECT,0,NULL,&peerCmdShow,"");
+  nbVerbDeclare(context,"peer.vlicheck",NB_AUTH_CONTROL,0,NULL,&peerCmdVli,"[<bits> [<count>]]");
+  nbVerbDeclare(context,"peer.vlibench",NB_AUTH_CONTROL,0,NULL,&peerCmdVli,"[<bits> [<count>]]");
+  nbVerbDeclare(context,"peer.skecheck",NB_AUTH_CONTROL,0,NULL,&peerCmdSke,"[<keySize> [<blocks> [<count>]]]");
+  nbVerbDeclare(context,"peer.skebench",NB_AUTH_CONTROL,0,NULL,&peerCmdSke,"[<keySize> [<blocks> [<count>]]]");
+  nbVerbDeclare(context,"peer.recordcheck",NB_AUTH_CONTROL,0,NULL,&peerCmdRecord,"<context>");
   return(NULL);
   }
@@ -272,6 +272,7 @@
 * 2012-10-17 eat 0.8.12 Checker updates
 * 2012-12-16 eat 0.8.13 Checker updates
 * 2013-01-20 eat 0.8.13 Checker updates
+* 2026-10-18 eat 0.9.04 Used the segmented queue log when an identity directory has one
 *=============================================================================
 */
 #include <openssl/rand.h>
@@ -1756,6 +1757,18 @@ int nbqStoreCmd(NB_Term *brainTerm,char *cursor){
   size_t size;
   long wpos;
   NBQFILE file;
+#if !defined(WIN32)
+  char dirname[512];
+  struct NBQ_LOG *log;
+
+  // 2026-10-18 eat 0.9.04 - append to the segmented log if the identity directory has one
+  if(nbqGetDir(dirname,brainTerm)<0) return(-1);
+  if((log=nbQueueLogGet(dirname,brain->myId))!=NULL){
+    if(nbQueueLogWrite(log,cursor,strlen(cursor))<0) return(-1);
+    if(trace) nbLogMsgI(0,'I',"Command queued to %s",log->dirname);
+    return(0);
+    }
+#endif
 
   if((file=nbqOpen(brainTerm,NBQ_INTERVAL,'q',filename,sizeof(filename)))<0) return(-1);
   /*
@@ -1844,6 +1857,53 @@ int nbqSendDirect(qHandle,brainTerm)
   return(0);
   }
 
+#if !defined(WIN32)
+/*
+*  Send commands in a segmented queue log direct to a peer brain
+*
+*    The position is committed in batches.  A command that can not be sent
+*    is returned to the log.
+*
+*    -1 Unable to communicate with peer
+*/
+static int nbqSendLog(char *dirname,NB_Term *brainTerm){
+  struct BRAIN *brain=(struct BRAIN *)brainTerm->def;
+  struct NBP_SESSION *session=NULL;
+  struct NBQ_LOG *log;
+  char *cmd;
+  int count=0;
+
+  if(trace) nbLogMsgI(0,'T',"nbqSendLog() called");
+  if((log=nbQueueLogOpen(dirname,brain->myId,NBQ_CONSUMER))==NULL) return(0);  // busy
+  while((cmd=nbQueueLogRead(log))!=NULL){
+    if(session==NULL && (session=nbpOpen(nbp,brainTerm,""))==NULL){
+      nbQueueLogRewind(log);
+      nbQueueLogClose(log);
+      nbLogMsgI(0,'E',"Unable to open a session with %s",brainTerm->word->value);
+      return(-1);
+      }
+    nbLogPutI("> %s\n",cmd);
+    if(nbpPut(session,cmd)!=0){
+      nbQueueLogRewind(log);
+      nbQueueLogClose(log);
+      nbpClose(session);
+      nbLogMsgI(0,'W',"Unable to send commands to peer at this time.");
+      return(-1);
+      }
+    count++;
+    if(log->records>=NBQ_LOG_SYNC) nbQueueLogCommit(log);
+    }
+  nbQueueLogClose(log);
+  if(session==NULL) return(0);
+  if(((struct BRAIN *)session->peer->def)->dsec==0){
+    nbpStop(session);
+    nbpClose(session);
+    }
+  nbLogMsgI(0,'I',"Queue log %s/%s forwarded %d commands to %s",dirname,brain->myId,count,brainTerm->word->value);
+  return(0);
+  }
+#endif
+
 /*
 *  Send any queue file type to a peer brain associated with an open session
 */
@@ -1934,6 +1994,13 @@ void nbqSend(NB_Term *brainTerm){
     nbLogMsgI(0,'E',"Unable to send queue for brain %s at this time.",brainTerm->word->value);
     return;
     }
+#if !defined(WIN32)
+  // 2026-10-18 eat 0.9.04 - a segmented log is sent direct, or moved to a file for the skull
+  if(nbQueueLogExists(dirname,brain->myId)){
+    if(!direct) nbQueueLogUnload(dirname,brain->myId,0);
+    else if(nbqSendLog(dirname,brainTerm)!=0) return;
+    }
+#endif
   if((qHandle=nbQueueOpenDir(dirname,brain->myId,1))==NULL){
     nbLogMsgI(0,'E',"Unable to send queue for brain %s at this time.",brainTerm->word->value);
     return;
@@ -76,6 +76,9 @@
 *
 *   skeKey(skeKEY *key,int keySize,unsigned int keyData[]);
 *   skeCipher(unsigned int *buffer,unsigned int blocks,unsigned int *cipher,skeKEY *key);
+*   skeCipherc(unsigned int *buffer,unsigned int blocks,unsigned int *cipher,skeKEY *key);
+*   int skeAccelerate(int accel);
+*   int skeCheck(int keySize,unsigned int blocks,int count,double *seconds);
 *
 *   skeSeedCipher(unsigned int cipher[4]);
 *   skeRandCipher(unsigned int cipher[4]);
@@ -153,6 +156,11 @@
 *             to left.  The 32-bit cipher key is derived from the 128-bit cipher
 *             key supplied.                         
 *
+*   The Rijndael rounds are performed with the AES-NI instructions when the
+*   processor supports them, and with table lookup otherwise.  The result is
+*   the same, so peers may use either.  skeCipherc always uses table lookup,
+*   and skeCheck compares the two.  skeAccelerate(0) forces table lookup.
+*
 *   Secret keys should be exchanged under the protection of public key encryption
 *   (see nbpke.h).  For network communication, the CBC cipher key should be a
 *   random value that changes for each multi-block operation following a
@@ -259,12 +267,21 @@
 * 2010-02-28 eat 0.7.9  Cleaned up -Wall warning messages. (gcc 4.5.0)
 * 2012-06-16 eat 0.8.10 Replaced rand with random
 * 2012-10-16 eat 0.8.12 Replaced random with nbRand32
+* 2026-10-18 eat 0.9.04 Included AES-NI implementation of skeCipher
 *=============================================================================
 */
 #include <nb/nb.h>
 #include "nbske.h"
 #include "nbrand.h"
 
+/*
+*  AES-NI is used for the Rijndael rounds when the compiler supports it and
+*  the processor has it.  See skeAccelerate().
+*/
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SKE_AESNI 1
+#endif
+
 typedef unsigned int		word32;
 
 unsigned char S[256] = {
@@ -811,7 +828,7 @@ void skeKey(skeKEY *key,int keySize,unsigned int keyData[]){
     }
   if(key->mode<0){ /* adjust for decryption, except first and last rounds */
     for(wptr-=5;wptr>=&key->keySched[4];wptr--){
-      *wptr=U1[(*wptr&0xff000000)>>24]^U2[(*wptr&0xff0000)>>16]<<16^U3[(*wptr&0xff00)>>8]^U4[(*wptr&0xff)];
+      *wptr=U1[(*wptr&0xff000000)>>24]^U2[(*wptr&0xff0000)>>16]^U3[(*wptr&0xff00)>>8]^U4[(*wptr&0xff)];  // 2026-10-18 eat 0.9.04 - removed <<16
       }
     }    
   }
@@ -823,8 +840,10 @@ void skeKey(skeKEY *key,int keySize,unsigned int keyData[]){
 *    blocks - number of blocks
 *    cipher - CBC xor key
 *    key    - encryption/decryption key
+*
+*  This is the portable table lookup version.  See skeCipher below.
 */
-void skeCipher(unsigned int *buffer,unsigned int blocks,unsigned int cipher[4],skeKEY *key){
+void skeCipherc(unsigned int *buffer,unsigned int blocks,unsigned int cipher[4],skeKEY *key){
   unsigned int *b=buffer;
   int r,rounds=key->rounds;
   unsigned int state[4];   /* temporary state array */
@@ -941,3 +960,237 @@ void skeCipher(unsigned int *buffer,unsigned int blocks,unsigned int cipher[4],s
     *(b+7)^=cipher[3];
     }
   }
+
+/*
+*  AES-NI block encryption
+*
+*    The Rijndael rounds of skeCipher are standard AES rounds applied to
+*    words holding state columns in big-endian byte order, so the AES
+*    instructions can be used with the same key schedule after a byte swap.
+*    Any number of rounds is supported, so all key sizes are handled.  The
+*    decryption schedule built by skeKey is already in the form aesdec
+*    expects.
+*
+*    Blocks are independent once the CBC words are applied, so we process
+*    four at a time to keep the AES unit busy.
+*/
+#if defined(SKE_AESNI)
+
+#include <immintrin.h>
+
+static int skeAesNi=-1;    /* -1 unknown, 0 table lookup, 1 AES-NI */
+
+#define SKE_BSWAP _mm_set_epi8(12,13,14,15,8,9,10,11,4,5,6,7,0,1,2,3)
+
+__attribute__((target("aes,ssse3")))
+static void skeKeyNi(__m128i *k,skeKEY *key){
+  __m128i bswap=SKE_BSWAP;
+  int r;
+
+  for(r=0;r<=key->rounds;r++) k[r]=_mm_shuffle_epi8(_mm_loadu_si128((__m128i *)&key->keySched[r*4]),bswap);
+  }
+
+__attribute__((target("aes,ssse3")))
+static void skeEncryptNi(unsigned int *buffer,unsigned int blocks,skeKEY *key){
+  __m128i k[15],bswap=SKE_BSWAP,s0,s1,s2,s3;
+  __m128i *b=(__m128i *)buffer;
+  int r,rounds=key->rounds;
+
+  skeKeyNi(k,key);
+  for(;blocks>=4;blocks-=4,b+=4){
+    s0=_mm_xor_si128(_mm_shuffle_epi8(_mm_loadu_si128(b),bswap),k[0]);
+    s1=_mm_xor_si128(_mm_shuffle_epi8(_mm_loadu_si128(b+1),bswap),k[0]);
+    s2=_mm_xor_si128(_mm_shuffle_epi8(_mm_loadu_si128(b+2),bswap),k[0]);
+    s3=_mm_xor_si128(_mm_shuffle_epi8(_mm_loadu_si128(b+3),bswap),k[0]);
+    for(r=1;r<rounds;r++){
+      s0=_mm_aesenc_si128(s0,k[r]);
+      s1=_mm_aesenc_si128(s1,k[r]);
+      s2=_mm_aesenc_si128(s2,k[r]);
+      s3=_mm_aesenc_si128(s3,k[r]);
+      }
+    _mm_storeu_si128(b,_mm_shuffle_epi8(_mm_aesenclast_si128(s0,k[rounds]),bswap));
+    _mm_storeu_si128(b+1,_mm_shuffle_epi8(_mm_aesenclast_si128(s1,k[rounds]),bswap));
+    _mm_storeu_si128(b+2,_mm_shuffle_epi8(_mm_aesenclast_si128(s2,k[rounds]),bswap));
+    _mm_storeu_si128(b+3,_mm_shuffle_epi8(_mm_aesenclast_si128(s3,k[rounds]),bswap));
+    }
+  for(;blocks>0;blocks--,b++){
+    s0=_mm_xor_si128(_mm_shuffle_epi8(_mm_loadu_si128(b),bswap),k[0]);
+    for(r=1;r<rounds;r++) s0=_mm_aesenc_si128(s0,k[r]);
+    _mm_storeu_si128(b,_mm_shuffle_epi8(_mm_aesenclast_si128(s0,k[rounds]),bswap));
+    }
+  }
+
+__attribute__((target("aes,ssse3")))
+static void skeDecryptNi(unsigned int *buffer,unsigned int blocks,skeKEY *key){
+  __m128i k[15],bswap=SKE_BSWAP,s0,s1,s2,s3;
+  __m128i *b=(__m128i *)buffer;
+  int r,rounds=key->rounds;
+
+  skeKeyNi(k,key);
+  for(;blocks>=4;blocks-=4,b+=4){
+    s0=_mm_xor_si128(_mm_shuffle_epi8(_mm_loadu_si128(b),bswap),k[rounds]);
+    s1=_mm_xor_si128(_mm_shuffle_epi8(_mm_loadu_si128(b+1),bswap),k[rounds]);
+    s2=_mm_xor_si128(_mm_shuffle_epi8(_mm_loadu_si128(b+2),bswap),k[rounds]);
+    s3=_mm_xor_si128(_mm_shuffle_epi8(_mm_loadu_si128(b+3),bswap),k[rounds]);
+    for(r=rounds-1;r>0;r--){
+      s0=_mm_aesdec_si128(s0,k[r]);
+      s1=_mm_aesdec_si128(s1,k[r]);
+      s2=_mm_aesdec_si128(s2,k[r]);
+      s3=_mm_aesdec_si128(s3,k[r]);
+      }
+    _mm_storeu_si128(b,_mm_shuffle_epi8(_mm_aesdeclast_si128(s0,k[0]),bswap));
+    _mm_storeu_si128(b+1,_mm_shuffle_epi8(_mm_aesdeclast_si128(s1,k[0]),bswap));
+    _mm_storeu_si128(b+2,_mm_shuffle_epi8(_mm_aesdeclast_si128(s2,k[0]),bswap));
+    _mm_storeu_si128(b+3,_mm_shuffle_epi8(_mm_aesdeclast_si128(s3,k[0]),bswap));
+    }
+  for(;blocks>0;blocks--,b++){
+    s0=_mm_xor_si128(_mm_shuffle_epi8(_mm_loadu_si128(b),bswap),k[rounds]);
+    for(r=rounds-1;r>0;r--) s0=_mm_aesdec_si128(s0,k[r]);
+    _mm_storeu_si128(b,_mm_shuffle_epi8(_mm_aesdeclast_si128(s0,k[0]),bswap));
+    }
+  }
+
+/*
+*  Encrypt/Decrypt a buffer using AES-NI for the Rijndael rounds
+*
+*    This produces the same result as skeCipherc.  The CBC words are applied
+*    in separate passes, in the same order, around the block rounds.
+*/
+static void skeCipherNi(unsigned int *buffer,unsigned int blocks,unsigned int cipher[4],skeKEY *key){
+  unsigned int *b=buffer,*e=buffer+blocks*4;
+  unsigned int cipherWord;
+
+  if(blocks<1) return;
+  cipherWord=cipher[0]^cipher[1]^cipher[2]^cipher[3];
+  cipherWord=T1[(cipherWord&0xff000000)>>24]^T2[(cipherWord&0xff0000)>>16]^T3[(cipherWord&0xff00)>>8]^T4[cipherWord&0xff];
+  if(key->mode>0){          /* encryption */
+    *(b+0)^=cipher[0];
+    *(b+1)^=cipher[1];
+    *(b+2)^=cipher[2];
+    *(b+3)^=cipher[3];
+    for(b+=4;b<e;b+=4){
+      *(b+0)^=*(b-4);
+      *(b+1)^=*(b-3);
+      *(b+2)^=*(b-2);
+      *(b+3)^=*(b-1);
+      }
+    for(b-=4;b>=buffer;b-=4){
+      *(b+3)^=cipherWord;
+      *(b+2)^=*(b+3);
+      *(b+1)^=*(b+2);
+      *(b+0)^=*(b+1);
+      cipherWord=*b;
+      }
+    skeEncryptNi(buffer,blocks,key);
+    }
+  else if(key->mode<0){     /* decryption */
+    skeDecryptNi(buffer,blocks,key);
+    for(;b<e;b+=4){
+      if(b>buffer) *(b-1)^=*b;
+      *(b+0)^=*(b+1);
+      *(b+1)^=*(b+2);
+      *(b+2)^=*(b+3);
+      }
+    *(b-1)^=cipherWord;
+    for(b-=8;b>=buffer;b-=4){
+      *(b+4)^=*(b+0);
+      *(b+5)^=*(b+1);
+      *(b+6)^=*(b+2);
+      *(b+7)^=*(b+3);
+      }
+    *(b+4)^=cipher[0];
+    *(b+5)^=cipher[1];
+    *(b+6)^=cipher[2];
+    *(b+7)^=cipher[3];
+    }
+  }
+
+#endif
+
+/*
+*  Select the Rijndael implementation
+*
+*    accel: -1 detect, 0 table lookup, 1 AES-NI if supported
+*
+*    Returns 1 when AES-NI is used.
+*/
+int skeAccelerate(int accel){
+#if defined(SKE_AESNI)
+  __builtin_cpu_init();
+  if(accel!=0 && __builtin_cpu_supports("aes") && __builtin_cpu_supports("ssse3")) skeAesNi=1;
+  else skeAesNi=0;
+  return(skeAesNi);
+#else
+  return(0);
+#endif
+  }
+
+/*
+*  Encrypt/Decrypt a buffer of 128-bit blocks using Cipher Block Chaining (CBC) mode.
+*
+*    Uses AES-NI when available and table lookup otherwise.
+*/
+void skeCipher(unsigned int *buffer,unsigned int blocks,unsigned int cipher[4],skeKEY *key){
+#if defined(SKE_AESNI)
+  if(skeAesNi<0) skeAccelerate(-1);
+  if(skeAesNi){
+    skeCipherNi(buffer,blocks,cipher,key);
+    return;
+    }
+#endif
+  skeCipherc(buffer,blocks,cipher,key);
+  }
+
+/*
+*  Compare skeCipher with skeCipherc on random buffers
+*
+*    Each buffer is encrypted and decrypted by both.  Returns the number of
+*    mismatches.  When seconds is not NULL, the time spent by each is
+*    returned for benchmarks.
+*/
+int skeCheck(int keySize,unsigned int blocks,int count,double *seconds){
+  unsigned int *buf,*Buf,*plain,keyData[8],cipher[4],i;
+  skeKEY enKey,deKey;
+  struct timespec t0,t1,t2;
+  int n,errors=0;
+
+  if(seconds){
+    seconds[0]=0;
+    seconds[1]=0;
+    }
+  buf=(unsigned int *)malloc(3*blocks*16);
+  if(!buf) nbExit("skeCheck: out of memory - terminating.");
+  Buf=buf+blocks*4;
+  plain=Buf+blocks*4;
+  for(n=0;n<count;n++){
+    skeKeyData(keySize>8 ? 8 : keySize,keyData);
+    skeKey(&enKey,keySize,keyData);
+    skeKey(&deKey,-keySize,keyData);
+    skeSeedCipher(cipher);
+    for(i=0;i<blocks*4;i++) plain[i]=nbRand32()<<16^nbRand32();
+    memcpy(buf,plain,blocks*16);
+    memcpy(Buf,plain,blocks*16);
+    clock_gettime(CLOCK_MONOTONIC,&t0);
+    skeCipher(buf,blocks,cipher,&enKey);
+    clock_gettime(CLOCK_MONOTONIC,&t1);
+    skeCipherc(Buf,blocks,cipher,&enKey);
+    clock_gettime(CLOCK_MONOTONIC,&t2);
+    if(seconds){
+      seconds[0]+=(t1.tv_sec-t0.tv_sec)+(t1.tv_nsec-t0.tv_nsec)/1e9;
+      seconds[1]+=(t2.tv_sec-t1.tv_sec)+(t2.tv_nsec-t1.tv_nsec)/1e9;
+      }
+    if(memcmp(buf,Buf,blocks*16)!=0) errors++;
+    clock_gettime(CLOCK_MONOTONIC,&t0);
+    skeCipher(buf,blocks,cipher,&deKey);
+    clock_gettime(CLOCK_MONOTONIC,&t1);
+    skeCipherc(Buf,blocks,cipher,&deKey);
+    clock_gettime(CLOCK_MONOTONIC,&t2);
+    if(seconds){
+      seconds[0]+=(t1.tv_sec-t0.tv_sec)+(t1.tv_nsec-t0.tv_nsec)/1e9;
+      seconds[1]+=(t2.tv_sec-t1.tv_sec)+(t2.tv_nsec-t1.tv_nsec)/1e9;
+      }
+    if(memcmp(buf,plain,blocks*16)!=0 || memcmp(Buf,plain,blocks*16)!=0) errors++;
+    }
+  free(buf);
+  return(errors);
+  }
@@ -34,6 +34,7 @@
 * ---------- -----------------------------------------------------------------
 * 2003-03-15 eat 0.5.1  Created to conform to new makefile
 * 2010-02-28 eat 0.7.9  Cleaned up -Wall warning messages. (gcc 4.5.0)
+* 2026-10-18 eat 0.9.04 Included skeCipherc, skeAccelerate and skeCheck
 *=============================================================================
 */
 #ifndef _NB_SKE_H_
@@ -52,5 +53,8 @@ void skeRandCipher(unsigned int cipher[4]);
 void skeKeyData(unsigned int keySize,unsigned int keyData[]);
 void skeKey(skeKEY *key,int keySize,unsigned int keyData[]);
 void skeCipher(unsigned int *buffer,unsigned int blocks,unsigned int cipher[4],skeKEY *key);
+void skeCipherc(unsigned int *buffer,unsigned int blocks,unsigned int cipher[4],skeKEY *key);
+int skeAccelerate(int accel);
+int skeCheck(int keySize,unsigned int blocks,int count,double *seconds);
 
 #endif
@@ -34,6 +34,7 @@
 * ---------- -----------------------------------------------------------------
 * 2003-03-15 eat 0.5.1  Created to conform to new makefile
 * 2010-02-28 eat 0.7.9  Cleaned up -Wall warning messages (gcc 4.5.0)
+* 2026-10-18 eat 0.9.04 Included vlipowc and vlicheck
 *=============================================================================
 */
 #ifndef _NB_VLI_H_
@@ -74,6 +75,7 @@ void vlisub(vliWord *x,vliWord *y);
 void vlimul(vliWord *x,vliWord *y,vliWord *p);
 void vlisqr(vliWord *x,vliWord *p);
 void vlipow(vliWord *x,vliWord *m,vliWord *e);
+void vlipowc(vliWord *x,vliWord *m,vliWord *e);
 void vligetb(vliWord *x,unsigned char *b,unsigned int l);
 void vliputb(vliWord *x,unsigned char *b,unsigned int l);
 void vligetd(vliWord *x,unsigned char *s);
@@ -87,5 +89,7 @@ void vliprint(vliWord *x,char *label);
 unsigned int vlibits(vli x);
 unsigned int vlibytes(vli x);
 unsigned int vlidiv(vliWord *x,vliWord *m,vliWord *q);
+unsigned int vlimod(vli x,vli n);
+int vlicheck(unsigned int bits,int count,double *seconds);
 
 #endif
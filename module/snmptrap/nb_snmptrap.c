@@ -36,7 +36,7 @@
 *
 *   This module listens for SNMP V1/V2 traps (UDP datagrams) and converts
 *   them into NodeBrain ALERT commands.  See the comments for the
-*   translate() function for a description of the generated command
+*   trapDecode() function for a description of the generated command
 *   format.
 *
 *   To use this module, first declare your nodebrain script.  You can
@@ -71,6 +71,10 @@
 *                     trace   - display every trap received
 *                     dump    - display a hex dump of UDP datagrams
 *                     silent  - don't echo generated NodeBrain commands
+*
+*                     A silent node that is not tracing asserts traps
+*                     directly, without generating an ALERT command,
+*                     unless a handler is defined for the trap.
 *     Examples:
 *
 *       define snmptrap node snmptrap; 
@@ -118,6 +122,17 @@
 *
 *       snmptrap. define r1 if(process="inetd") trouble=5;
 *   
+*   Recorded traps may be replayed to test rules or measure performance.
+*
+*     Syntax:
+*
+*       <node>:record <file>             - append received datagrams to a file
+*       <node>:record                    - stop recording
+*       <node>:replay <file>             - translate recorded datagrams
+*       <node>:benchmark <file>[,<n>]    - translate recorded datagrams n times
+*
+*     Record files are written and read by nbIpRecord() and nbIpReplay().
+*
 *   An snmptrap node will not start listening until you enable it.
 *
 *     Syntax:
@@ -248,6 +263,13 @@
 * 2012-12-27 eat 0.8.13 Checker updates
 * 2013-01-13 eat 0.8.13 Checker updates
 * 2014-06-24 eat 0.9.02 Fixed length of stop on NULLOBJ variable type 
+* 2026-10-18 eat 0.9.04 Replaced recursive translation with a table driven BER decoder
+*            Traps are decoded into a list of bindings that point into the datagram.
+*            OID names are cached by encoded OID, and silent nodes assert traps
+*            directly instead of generating and parsing an ALERT command.
+* 2026-10-18 eat 0.9.04 Fixed trap OID for V1 generic traps (RFC 3584 snmpTraps.<generic+1>)
+* 2026-10-18 eat 0.9.04 Added record, replay and benchmark commands
+* 2026-10-18 eat 0.9.04 Moved record and replay file handling to nbip.c
 *=====================================================================
 */
 #include "config.h"
@@ -261,6 +283,47 @@
 *  structure which it stores in a node's "handle".  The handle is passed to
 *  various functions defined in this module.
 */
+#define NB_MOD_SNMPTRAP_BINDINGS  256        /* maximum variable bindings in a trap */
+#define NB_MOD_SNMPTRAP_OID_HASH  1021       /* OID cache hash modulo */
+#define NB_MOD_SNMPTRAP_OID_MAX   4096       /* OID cache entries before flushing */
+#define NB_MOD_SNMPTRAP_OID_TEXT  512        /* maximum OID text length */
+#define NB_MOD_SNMPTRAP_RCVBUF    (4*1024*1024)  /* socket receive buffer size */
+#define NB_MOD_SNMPTRAP_MAGIC     "NBSTRAP1" /* record file header */
+
+#define NB_MOD_SNMPTRAP_SYNTAX_DEFAULT     0
+#define NB_MOD_SNMPTRAP_SYNTAX_DATEANDTIME 1
+
+typedef struct NB_MOD_SNMPTRAP_TYPE{       /* BER value type */
+  unsigned char  tag;              /* BER tag */
+  char           kind;             /* decoding - see snmptrapTypeTable */
+  unsigned char  minLen;           /* minimum value length */
+  unsigned char  maxLen;           /* maximum value length - 0 if no limit */
+  } NB_MOD_SnmptrapType;
+
+typedef struct NB_MOD_SNMPTRAP_TLV{        /* BER element - the value is not copied */
+  unsigned char  tag;              /* BER tag */
+  unsigned int   len;              /* value length */
+  unsigned char *value;            /* value within the datagram */
+  } NB_MOD_SnmptrapTlv;
+
+typedef struct NB_MOD_SNMPTRAP_OID{        /* OID cache entry */
+  struct NB_MOD_SNMPTRAP_OID *next;        /* next entry in hash list */
+  nbCELL         term;             /* term in node context - NULL until first assertion */
+  char          *name;             /* term name - '<oid>' or attribute name */
+  size_t         size;             /* size of this entry */
+  unsigned char  syntax;           /* NB_MOD_SNMPTRAP_SYNTAX_* */
+  unsigned char  trapOid;          /* 1 for snmpTrapOID.0 */
+  unsigned short len;              /* encoded OID length */
+  unsigned char  code[1];          /* encoded OID followed by name */
+  } NB_MOD_SnmptrapOid;
+
+typedef struct NB_MOD_SNMPTRAP_BINDING{    /* decoded variable binding */
+  NB_MOD_SnmptrapOid *oid;         /* variable */
+  char           kind;             /* 'n' - number, 's' - string, '?' - unknown */
+  double         real;             /* number value */
+  char          *text;             /* string value in scratch buffer */
+  } NB_MOD_SnmptrapBinding;
+
 typedef struct NB_MOD_SNMPTRAP{            /* SNMPTRAP node descriptor */
   unsigned int   socket;           /* server socket for datagrams */
   char interfaceAddr[16];              /* interface address to bind listener */
@@ -272,6 +335,16 @@ typedef struct NB_MOD_SNMPTRAP{            /* SNMPTRAP node descriptor */
   nbCELL handlerContext;
   nbCELL syntaxContext;
   nbCELL attributeContext;
+  FILE          *record;           /* datagram record file */
+  unsigned int   traps;            /* traps translated */
+  unsigned int   errors;           /* datagrams not translated */
+  unsigned int   oids;             /* OID cache entries */
+  NB_MOD_SnmptrapOid *oidHash[NB_MOD_SNMPTRAP_OID_HASH]; /* OID cache */
+  int            bindings;         /* bindings in decoded trap */
+  NB_MOD_SnmptrapBinding binding[NB_MOD_SNMPTRAP_BINDINGS];
+  char           trapOid[NB_MOD_SNMPTRAP_OID_TEXT+2];   /* '<oid>' of decoded trap */
+  char          *scratchCur;       /* next free byte in scratch buffer */
+  char           scratch[NB_BUFSIZE];                   /* string values of decoded trap */
   } NB_MOD_Snmptrap;
 
 /*================================================================================*/
@@ -338,85 +411,19 @@ typedef struct NB_MOD_SNMPTRAP{            /* SNMPTRAP node descriptor */
 */
 
 /*
-* Get the length of an object and advance the cursor
+*  BER value types
 *
-*     0x01-0x7f  - one byte length
-*     0x81 - one byte length greater than 127 follows
-*     0x82 - two byte length follows     
-*     0x83 - three byte length follows
-*     ...
-*/
-static int getObjectLength(unsigned char **bufP,unsigned char *bufend){
-  int objlen,bytes;
-  unsigned char *buf=*bufP;
-
-  objlen=*buf;
-  buf++;
-  if(objlen>127){
-    bytes=objlen&127;   
-    objlen=*buf;
-    buf++;
-    for(bytes--;bytes>0;bytes--){
-      objlen=(objlen<<8)|*buf;
-      buf++;
-      }
-    }
-  if(buf+objlen>bufend) return(-1);
-  *bufP=buf;
-  return(objlen);
-  }
-
-/*
-*  Translate OID from binary coding to character
-*/
-static char *translateOid(unsigned char **cursorP,unsigned char *bufend,char **cmdP,char *cmdend){
-  unsigned char *cursor=*cursorP;
-  char *cmdcur=*cmdP;
-  int objlen,n=0;
-
-  objlen=getObjectLength(&cursor,bufend);
-  if(objlen<0) return("variable binding OID value length error");
-  // first byte of OID has two numbers     
-  sprintf(cmdcur,"%u.%u.",*cursor/40,*cursor%40);    
-  cmdcur+=strlen(cmdcur);   // 2013-01-14 eat - VID 968-0.8.13-3 FP but replaced strchr(cmdcur,0)   
-  objlen--;    
-  cursor++;    
-  // then we get 7 bits per byte    
-  // high order bit of 1 means we have another byte    
-  for(;objlen>0;objlen--){    
-    n=*cursor&0x7f;    
-    while(*cursor&0x80){    
-      cursor++;    
-      n=(n<<7)|(*cursor&0x7f);    
-      objlen--;    
-      }    
-    cursor++;    
-    sprintf(cmdcur,"%u.",n);    
-    cmdcur+=strlen(cmdcur); // 2013-01-14 eat - VID 962-0.8.13-3 FP but replaced strchr(cmdcur,0)   
-    }    
-  if(*(cmdcur-1)=='.') cmdcur--;    
-  *cursorP=cursor;
-  *cmdP=cmdcur;
-  return(NULL);
-  }
-
-/*
-*  Translate an SNMP value into a NodeBrain value
-*
-*  SNMP Value Types           NodeBrain Value
-*
-*    i 02 - INTEGER           number n
-*    s 04 - OCTET STRING      string "abcdef"
-**   x 04 - HEX STRING        "
-**   d 04 - DECIMAL STRING    "
-**   b 04 - BITS              "
-**     04 - DateAndTime       number n - UTC time
-*    n 05 - NULLOBJ           unknown value ? 
-*    o 06 - OBJID             string "n.n.n.n..."
-*    a 40 - IpAddress         string "xxx.xxx.xxx.xxx" 
-**   c 41 - Counter32         number n 
-**   u 42 - Unsigned          " 
-**   t 43 - TimeTicks         " 
+*  2026-10-18 eat 0.9.04 - The decoder is driven by this table instead of a
+*  switch on each type.  A decoded element (NB_MOD_SnmptrapTlv) points into
+*  the datagram, so nothing is allocated or copied while walking a trap.
+*
+*    i - signed integer        number n
+*    u - unsigned integer      number n
+*    c - 64 bit counter        number n
+*    s - octet string          string "abcdef" (see note 2 and 3 below)
+*    n - null                  unknown value ?
+*    o - object identifier     string "n.n.n.n..."
+*    a - IP address            string "xxx.xxx.xxx.xxx" (see note 1 below)
 *
 *  Note 1: Addresses are formated in a non-standard way to simplify comparison.  Leading
 *          zeros are included so every number has three digits.  For example, 192.168.1.23
@@ -429,383 +436,577 @@ static char *translateOid(unsigned char **cursorP,unsigned char *bufend,char **c
 *          NodeBrain strings.
 *
 *  Note 3: For some reason SNMP elected to double up on value types like 0x04.  We have a
-*          default way of representing values, but accept a syntax parameter to direct 
+*          default way of representing values, but accept a syntax parameter to direct
 *          the representation when the default is not appropriate.
 *
 *          04 Default     - as is if all bytes are printable, else convert bytes to hex string
 *          04 DateAndTime - number n - UTC Time
-*          
 */
-static void translateUnquoteString(char *cursor,int len){
-  char *delim;
-  delim=memchr(cursor,'"',len);
-  while(delim){
-    *delim='\'';
-    len-=delim-cursor;
-    cursor=delim;
-    delim=memchr(cursor,'"',len);
+static NB_MOD_SnmptrapType snmptrapTypeTable[]={
+  {0x02,'i',1,4},   // INTEGER
+  {0x04,'s',0,0},   // OCTET STRING
+  {0x05,'n',0,0},   // NULLOBJ
+  {0x06,'o',1,0},   // OBJID
+  {0x40,'a',4,4},   // IpAddress
+  {0x41,'u',1,5},   // Counter32
+  {0x42,'u',1,5},   // Unsigned
+  {0x43,'u',1,5},   // TimeTicks
+  {0x44,'s',0,0},   // Opaque
+  {0x46,'c',1,9},   // Counter64
+  {0,0,0,0}};
+
+static NB_MOD_SnmptrapType *snmptrapType[256];  // type table indexed by tag
+
+// Encoded OIDs of the notification parameters we insert (RFC 3584)
+static unsigned char oidCommunity[]={0x2b,0x06,0x01,0x06,0x03,0x12,0x01,0x04};       // 1.3.6.1.6.3.18.1.4
+static unsigned char oidEnterprise[]={0x2b,0x06,0x01,0x06,0x03,0x01,0x01,0x04,0x03}; // 1.3.6.1.6.3.1.1.4.3
+static unsigned char oidAgent[]={0x2b,0x06,0x01,0x06,0x03,0x12,0x01,0x03};           // 1.3.6.1.6.3.18.1.3
+static unsigned char oidTrapOid[]={0x2b,0x06,0x01,0x06,0x03,0x01,0x01,0x04,0x01,0x00}; // 1.3.6.1.6.3.1.1.4.1.0
+static unsigned char oidUptime[]={0x2b,0x06,0x01,0x02,0x01,0x01,0x03,0x00};         // 1.3.6.1.2.1.1.3.0
+
+static char translateMsg[256];
+
+/*
+*  Get a BER element and return a cursor to the next element
+*
+*    The length may be one byte (0x00-0x7f) or 0x81-0x84 followed by one
+*    to four bytes of length.
+*
+*  Returns NULL if the element does not fit in the buffer.
+*/
+static unsigned char *berGet(unsigned char *cursor,unsigned char *bufend,NB_MOD_SnmptrapTlv *tlv){
+  unsigned int len,bytes;
+
+  if(bufend-cursor<2) return(NULL);
+  tlv->tag=*cursor;
+  cursor++;
+  len=*cursor;
+  cursor++;
+  if(len&0x80){
+    bytes=len&0x7f;
+    if(bytes<1 || bytes>4 || bufend-cursor<bytes) return(NULL);
+    for(len=0;bytes>0;bytes--){
+      len=(len<<8)|*cursor;
+      cursor++;
+      }
+    }
+  if(len>bufend-cursor) return(NULL);
+  tlv->len=len;
+  tlv->value=cursor;
+  return(cursor+len);
+  }
+
+/*
+*  Get a BER element of a given type
+*/
+static unsigned char *berExpect(unsigned char *cursor,unsigned char *bufend,NB_MOD_SnmptrapTlv *tlv,unsigned char tag){
+  if(cursor>=bufend || *cursor!=tag) return(NULL);
+  return(berGet(cursor,bufend,tlv));
+  }
+
+/*
+*  Write an unsigned number as text without sprintf
+*/
+static char *textUint(char *text,unsigned int n){
+  char digit[10],*cursor=digit;
+
+  do{
+    *cursor='0'+n%10;
+    cursor++;
+    n/=10;
+    } while(n);
+  while(cursor>digit){
+    cursor--;
+    *text=*cursor;
+    text++;
     }
+  return(text);
   }
 
-char mymsg[256];
-static char *translateValue(unsigned char **cursorP,unsigned char *bufend,char **cmdP,char *cmdend,char *syntax){
-  unsigned char *cursor=*cursorP,*lookahead;
-  char *cmdcur=*cmdP,*msg;
-  int objlen,n=0,type;
+/*
+*  Translate an encoded OID to text "n.n.n..."
+*
+*    The first subidentifier holds the first two numbers (x*40+y), then
+*    each subidentifier is coded 7 bits per byte with the high order bit
+*    set on all but the last byte.
+*
+*  Returns the end of the text or NULL if the OID is malformed or too long.
+*/
+static char *oidText(unsigned char *code,unsigned int len,char *text,char *textend){
+  unsigned char *end=code+len;
+  unsigned int n;
+  int first=1;
+
+  while(code<end){
+    if(textend-text<24) return(NULL);
+    n=0;
+    do{
+      if(n>>25) return(NULL);  // more than 32 bits
+      n=(n<<7)|(*code&0x7f);
+      code++;
+      } while(*(code-1)&0x80 && code<end);
+    if(*(code-1)&0x80) return(NULL);
+    if(first){
+      if(n<80){
+        *text='0'+n/40;
+        n%=40;
+        }
+      else{
+        *text='2';
+        n-=80;
+        }
+      text++;
+      *text='.';
+      text++;
+      first=0;
+      }
+    text=textUint(text,n);
+    *text='.';
+    text++;
+    }
+  if(first) return(NULL);
+  text--;
+  *text=0;
+  return(text);
+  }
+
+/*
+*  Hash an encoded OID
+*/
+static unsigned int oidHash(unsigned char *code,unsigned int len){
+  unsigned int hash=2166136261u;
+  for(;len>0;len--){
+    hash=(hash^*code)*16777619u;
+    code++;
+    }
+  return(hash%NB_MOD_SNMPTRAP_OID_HASH);
+  }
+
+/*
+*  Remove all OIDs from the cache
+*
+*    The cache is flushed when the node is enabled, so changes to the
+*    "attribute" and "syntax" glossaries take effect.
+*/
+static void oidFlush(nbCELL context,NB_MOD_Snmptrap *snmptrap){
+  NB_MOD_SnmptrapOid *oid;
+  int i;
+
+  for(i=0;i<NB_MOD_SNMPTRAP_OID_HASH;i++){
+    while((oid=snmptrap->oidHash[i])!=NULL){
+      snmptrap->oidHash[i]=oid->next;
+      if(oid->term) nbCellDrop(context,oid->term);
+      nbFree(oid,oid->size);
+      }
+    }
+  snmptrap->oids=0;
+  }
+
+/*
+*  Get an OID from the cache
+*
+*    On the first reference to an OID, we render the term name, look up the
+*    syntax and attribute name, and save them keyed by the encoded OID.  An
+*    identical OID in a later trap costs a hash lookup.
+*/
+static NB_MOD_SnmptrapOid *oidGet(nbCELL context,NB_MOD_Snmptrap *snmptrap,unsigned char *code,unsigned int len){
+  NB_MOD_SnmptrapOid *oid,**oidP;
+  nbCELL cell;
+  char name[NB_MOD_SNMPTRAP_OID_TEXT+2],*syntax="",*attribute=NULL,*cursor;
+  size_t size;
+
+  oidP=&snmptrap->oidHash[oidHash(code,len)];
+  for(oid=*oidP;oid!=NULL;oid=oid->next){
+    if(oid->len==len && memcmp(oid->code,code,len)==0) return(oid);
+    }
+  *name='\'';
+  if((cursor=oidText(code,len,name+1,name+sizeof(name)-1))==NULL) return(NULL);
+  *cursor='\'';
+  *(cursor+1)=0;
+  // look up syntax for value representation
+  if(snmptrap->syntaxContext
+      && (cell=nbTermLocateHere(snmptrap->syntaxContext,name))!=NULL
+      && (cell=nbTermGetDefinition(snmptrap->syntaxContext,cell))!=NULL
+      && nbCellGetType(snmptrap->syntaxContext,cell)==NB_TYPE_STRING){
+    syntax=nbCellGetString(snmptrap->syntaxContext,cell);
+    }
+  // look up attribute name to use instead of the OID
+  if(snmptrap->attributeContext
+      && (cell=nbTermLocateHere(snmptrap->attributeContext,name))!=NULL
+      && (cell=nbTermGetDefinition(snmptrap->attributeContext,cell))!=NULL
+      && nbCellGetType(snmptrap->attributeContext,cell)==NB_TYPE_STRING){
+    attribute=nbCellGetString(snmptrap->attributeContext,cell);
+    }
+  if(!attribute) attribute=name;
+  size=sizeof(NB_MOD_SnmptrapOid)+len+strlen(attribute)+1;
+  oid=nbAlloc(size);
+  oid->next=*oidP;
+  oid->term=NULL;
+  oid->size=size;
+  oid->syntax=strcmp(syntax,"DateAndTime")==0 ? NB_MOD_SNMPTRAP_SYNTAX_DATEANDTIME : NB_MOD_SNMPTRAP_SYNTAX_DEFAULT;
+  oid->trapOid=(len==sizeof(oidTrapOid) && memcmp(code,oidTrapOid,len)==0);
+  oid->len=len;
+  memcpy(oid->code,code,len);
+  oid->name=(char *)oid->code+len;
+  strcpy(oid->name,attribute);
+  *oidP=oid;
+  snmptrap->oids++;
+  return(oid);
+  }
+
+/*
+*  Copy a string value to the scratch buffer
+*/
+static char *valueString(NB_MOD_Snmptrap *snmptrap,int len){
+  char *text=snmptrap->scratchCur;
+  if(snmptrap->scratch+sizeof(snmptrap->scratch)-text<len+1) return(NULL);
+  snmptrap->scratchCur+=len+1;
+  *(text+len)=0;
+  return(text);
+  }
+
+/*
+*  Decode an SNMP value into a binding
+*/
+static char *valueDecode(NB_MOD_Snmptrap *snmptrap,NB_MOD_SnmptrapTlv *tlv,int syntax,NB_MOD_SnmptrapBinding *binding){
+  NB_MOD_SnmptrapType *type=snmptrapType[tlv->tag];
+  unsigned char *cursor=tlv->value,*end=tlv->value+tlv->len;
   char *hexchar="0123456789ABCDEF";
+  char *text,*textCur;
+  unsigned long long u=0;
+  unsigned int n;
   double d=0;
   time_t utime;
   struct tm tm;
 
-  type=*cursor;  /* get date type */
-  cursor++;
-  objlen=getObjectLength(&cursor,bufend);
-  if(objlen*2>cmdend-cmdcur-1){  /* all types except string need twice as much space after converted */
-    if(type!=4 || objlen>cmdend-cmdcur-1) return("object is too long for command buffer");
+  if(!type){
+    sprintf(translateMsg,"unrecognized value type %x len=%d",tlv->tag,tlv->len);
+    return(translateMsg);
     }
-  switch(type){
-    case 0x02: /* integer */
-      if(objlen<1 || objlen>4) return("variable binding integer value length error");
-      for(;objlen>0;objlen--){
-        n=(n<<8)|*cursor;
-        cursor++;
-        } 
-      sprintf(cmdcur,"%d",n);
-      cmdcur+=strlen(cmdcur);  // 2013-01-14 eat - VID 4164-0.8.13-3 FP but replaced strchr(cmdcur,0)
+  if(tlv->len<type->minLen || (type->maxLen && tlv->len>type->maxLen)){
+    sprintf(translateMsg,"variable binding value length error - type %x len=%d",tlv->tag,tlv->len);
+    return(translateMsg);
+    }
+  binding->kind='n';
+  switch(type->kind){
+    case 'i':
+      n=*cursor&0x80 ? 0xffffffff : 0;  // sign extend
+      for(;cursor<end;cursor++) n=(n<<8)|*cursor;
+      binding->real=(int)n;
+      break;
+    case 'u':
+      for(;cursor<end;cursor++) u=(u<<8)|*cursor;
+      binding->real=(double)(u&0xffffffff);
       break;
-    case 0x04: /* string */
-      if(objlen<0) return("variable binding string value length error");
-      if(objlen>cmdend-cmdcur-1) return("value is too large for buffer");
-      if(strcmp(syntax,"DateAndTime")==0){
-        if(objlen!=8 && objlen!=11) return("variable binding DateAndTime value length error");
-        tm.tm_year=*cursor<<8;
-        cursor++;
-        tm.tm_year|=*cursor;
-        tm.tm_year-=1900;
-        cursor++;
-        tm.tm_mon=*cursor-1;
-        cursor++;
-        tm.tm_mday=*cursor;
-        cursor++;
-        tm.tm_hour=*cursor;
-        cursor++;
-        tm.tm_min=*cursor;
-        cursor++;
-        tm.tm_sec=*cursor;
-        cursor++;
-        cursor++; // ignore deci-seconds
-        objlen-=8;
-        if(objlen){ 
+    case 'c':
+      for(;cursor<end;cursor++) d=d*256+*cursor;
+      binding->real=d;
+      break;
+    case 's':
+      if(syntax==NB_MOD_SNMPTRAP_SYNTAX_DATEANDTIME){
+        if(tlv->len!=8 && tlv->len!=11) return("variable binding DateAndTime value length error");
+        tm.tm_year=(*cursor<<8|*(cursor+1))-1900;
+        tm.tm_mon=*(cursor+2)-1;
+        tm.tm_mday=*(cursor+3);
+        tm.tm_hour=*(cursor+4);
+        tm.tm_min=*(cursor+5);
+        tm.tm_sec=*(cursor+6);
+        cursor+=8; // ignore deci-seconds
+        if(tlv->len==11){
           if(*cursor=='+'){
-            cursor++;
-            tm.tm_hour-=*cursor;
-            cursor++;
-            tm.tm_min-=*cursor;
+            tm.tm_hour-=*(cursor+1);
+            tm.tm_min-=*(cursor+2);
             }
           else if(*cursor=='-'){
-            cursor++;
-            tm.tm_hour+=*cursor;
-            cursor++;
-            tm.tm_min+=*cursor;
+            tm.tm_hour+=*(cursor+1);
+            tm.tm_min+=*(cursor+2);
             }
           else return("variable binding DateAndtime value has unrecognized direction from UTC");
-          cursor++;
           }
         tm.tm_isdst=0;
         utime=nbClockTimeGm(&tm);
-        sprintf(cmdcur,"%d",(int)utime);
-        cmdcur=strchr(cmdcur,0);
+        binding->real=(double)utime;
+        break;
+        }
+      binding->kind='s';
+      for(;cursor<end && isprint(*cursor);cursor++);
+      if(cursor==end){
+        if((text=valueString(snmptrap,tlv->len))==NULL) return("value is too large for buffer");
+        for(cursor=tlv->value,textCur=text;cursor<end;cursor++,textCur++) *textCur=*cursor=='"' ? '\'' : *cursor;
         }
       else{
-        *cmdcur='"';
-        cmdcur++;
-        for(lookahead=cursor+objlen-1;lookahead>=cursor && isprint(*lookahead);lookahead--);
-        if(lookahead<cursor){
-          strncpy(cmdcur,(char *)cursor,objlen);
-          translateUnquoteString(cmdcur,objlen);
-          cmdcur+=objlen;
+        if((text=valueString(snmptrap,tlv->len*2))==NULL) return("value is too large for buffer");
+        for(cursor=tlv->value,textCur=text;cursor<end;cursor++){
+          *textCur=*(hexchar+(*cursor>>4));
+          textCur++;
+          *textCur=*(hexchar+(*cursor&0x0f));
+          textCur++;
           }
-        else{
-          for(lookahead=cursor;lookahead<cursor+objlen;lookahead++){
-            *cmdcur=*(hexchar+(*lookahead>>4));
-            cmdcur++;
-            *cmdcur=*(hexchar+(*lookahead&0x0f));
-            cmdcur++;
-            }
-          }
-        *cmdcur='"';
-        cmdcur++;
-        cursor+=objlen;
         }
+      binding->text=text;
       break;
-    case 0x05: /* NULLOBJ */
-      if(objlen!=0) return("variable binding NULLOBJ length error - expecting zero");
-      strcpy(cmdcur,"?");  /* we'll use NodeBrain's Unknown value for NULLOBJ */
-      cmdcur++; // 2014-06-24 eat - changed from 2 to 1 byte step because "?" replaced "??"
+    case 'n':
+      binding->kind='?';  // we'll use NodeBrain's Unknown value for NULLOBJ
       break;
-    case 0x06: /* OID */
-      *cmdcur='"';
-      cmdcur++;
-      cursor=*cursorP+1; /* go back to the length */
-      if((msg=translateOid(&cursor,bufend,&cmdcur,cmdend))!=NULL) return(msg);
-      *cmdcur='"';
-      cmdcur++;
-      break;
-    case 0x40: /* address */
-      if(objlen!=4) return("expecting 4 byte address");
-      *cmdcur='"';
-      cmdcur++;
-      sprintf(cmdcur,"%3.3u.%3.3u.%3.3u.%3.3u",*cursor,*(cursor+1),*(cursor+2),*(cursor+3));
-      cmdcur+=15;
-      *cmdcur='"';
-      cmdcur++;
-      cursor+=4;
+    case 'o':
+      binding->kind='s';
+      text=snmptrap->scratchCur;
+      if((textCur=oidText(cursor,tlv->len,text,snmptrap->scratch+sizeof(snmptrap->scratch)))==NULL) return("variable binding OID value error");
+      snmptrap->scratchCur=textCur+1;
+      binding->text=text;
       break;
-    case 0x41: /* counter32 */
-      if(objlen<1 || objlen>4) return("variable binding integer value length error");
-      for(;objlen>0;objlen--){
-        n=(n<<8)|*cursor;
-        cursor++;
-        } 
-      sprintf(cmdcur,"%d",n);
-      cmdcur+=strlen(cmdcur); // 2013-01-14 eat - VID 4154-0.8.13-3 FP but replaced strchr(cmdcur,0)
+    case 'a':
+      binding->kind='s';
+      if((text=valueString(snmptrap,15))==NULL) return("value is too large for buffer");
+      sprintf(text,"%3.3u.%3.3u.%3.3u.%3.3u",*cursor,*(cursor+1),*(cursor+2),*(cursor+3));
+      binding->text=text;
       break;
-    case 0x42: /* unsigned */
-      if(objlen<1 || objlen>4) return("variable binding integer value length error");
-      for(;objlen>0;objlen--){
-        n=(n<<8)|*cursor;
-        cursor++;
-        } 
-      sprintf(cmdcur,"%d",n);
-      cmdcur+=strlen(cmdcur); // 2013-01-14 eat - VID 4158-0.8.13-3 FP but replaced strchr(cmdcur,0)
-      break;
-    case 0x43: /* timeticks */
-      if(objlen<0) return("variable binding OID value length error");
-      for(;objlen>0;objlen--){
-      	n=(n<<8)|*cursor;
-        cursor++;
-        }
-      sprintf(cmdcur,"%d",n);
-      cmdcur+=strlen(cmdcur); // 2013-01-14 eat - VID 4153-0.8.13-3 FP but replaced strchr(cmdcur,0)
-      break;
-    case 0x46: // 64 bit number
-      if(objlen<1 || objlen>8) return("variable binding Counter64 value length error");
-      for(;objlen>0;objlen--){
-        d=d*256+*cursor;
-        cursor++;
-        } 
-      sprintf(cmdcur,"%.10g",d);
-      cmdcur+=strlen(cmdcur);  // 2013-01-14 eat - VID 4159-0.8.13-3 FP but replaced strchr(cmdcur,0)
-      break;
-    default:
-      sprintf(mymsg,"unrecognized value type %x len=%d",type,objlen);
-      return(mymsg);
     }
-  *cursorP=cursor;
-  *cmdP=cmdcur;
   return(NULL);
   }
 
 /*
-*  Translate an SNMP V1 or V2 Trap to a NodeBrain ALERT command
-*
-*    alert '<oid>'=<value>,...;
-*
-*    Here's an example of a full alert with a single <variable-binding>.
-*  
-*    *** include example here ***
+*  Add a binding to the decoded trap
 */
-static char *translate(NB_MOD_Snmptrap *snmptrap,unsigned char *buf,int len,char *cmd,int cmdlen,char **handlerNameP){
-  char *cmdcur=cmd;
-  char *cmdend=cmdcur+cmdlen;
-  unsigned char *cursor=buf;
-  unsigned char *bufend=buf+len;
-  unsigned char *enterpriseOid;
-  int objlen,generic;
-  char *msg,version,senderAddr[40];
-  char trapOID[64],*trapOIDCur;  // value of '1.3.6.1.6.3.1.1.4.1.0' (SNMP_TRAP_OID)
-  //char *handler;
-  nbCELL cell;
-  char *oid,*value,*syntax,*attribute;
+static NB_MOD_SnmptrapBinding *bindingAdd(nbCELL context,NB_MOD_Snmptrap *snmptrap,unsigned char *code,unsigned int len){
+  NB_MOD_SnmptrapBinding *binding;
 
-  fprintf(stderr,"translate: called\n");
-  fflush(stderr);
+  if(snmptrap->bindings>=NB_MOD_SNMPTRAP_BINDINGS) return(NULL);
+  binding=&snmptrap->binding[snmptrap->bindings];
+  if((binding->oid=oidGet(context,snmptrap,code,len))==NULL) return(NULL);
+  snmptrap->bindings++;
+  return(binding);
+  }
 
-  *trapOID=0;
-  if(*cursor!=0x30) return("packet not recognized");
-  cursor++;
-  objlen=getObjectLength(&cursor,bufend);
-  if(objlen<0) return("trap length error");
-  if(*cursor!=0x02 || *(cursor+1)!=0x01) return("expecting 02.01 to start trap");
-  cursor+=2;
-  version=*cursor;
-  cursor++;
-  sprintf(cmdcur,"alert '1.3.6.1.6.3.18.1.4'=");  // snmpTrapCommunity OID
-  cmdcur+=strlen(cmdcur);  // 2013-01-14 eat - VID 976-0.8.13-3 FP but replaced strchr(cmdcur,0)
-  if(*cursor!=0x04) return("expecting type 04 (string) for community string");
-  if(NULL!=(msg=translateValue(&cursor,bufend,&cmdcur,cmdend,""))) return(msg);
+/*
+*  Decode an SNMP V1 or V2 Trap into a list of bindings
+*
+*    The V1 notification parameters are translated to V2 variable bindings
+*    using RFC 3584 section 3.1, so both versions produce the same bindings.
+*
+*      '1.3.6.1.6.3.18.1.4'     - community
+*      '1.3.6.1.6.3.1.1.4.3'    - enterprise (V1)
+*      '1.3.6.1.6.3.18.1.3'     - agent address (sender address for V2)
+*      '1.3.6.1.6.3.1.1.4.1.0'  - trap OID
+*      '1.3.6.1.2.1.1.3.0'      - uptime (V1)
+*
+*    The trap OID is also saved in snmptrap->trapOid as a quoted term name
+*    for looking up a handler.
+*/
+static char *trapDecode(nbCELL context,NB_MOD_Snmptrap *snmptrap,unsigned char *buf,int len){
+  NB_MOD_SnmptrapTlv tlv,enterprise,specific,oid;
+  NB_MOD_SnmptrapBinding *binding;
+  unsigned char *cursor=buf,*bufend=buf+len,*end,*value;
+  char *msg,*text;
+  int version,generic;
 
-  fprintf(stderr,"translate: checking version specific stuff\n");
-  fflush(stderr);
+  snmptrap->bindings=0;
+  snmptrap->scratchCur=snmptrap->scratch;
+  *snmptrap->trapOid=0;
+  if(berExpect(cursor,bufend,&tlv,0x30)==NULL) return("packet not recognized");
+  cursor=tlv.value;
+  bufend=tlv.value+tlv.len;
+  if((cursor=berExpect(cursor,bufend,&tlv,0x02))==NULL || tlv.len!=1) return("expecting 02.01 to start trap");
+  version=*tlv.value;
+  if((cursor=berExpect(cursor,bufend,&tlv,0x04))==NULL) return("expecting type 04 (string) for community string");
+  if((binding=bindingAdd(context,snmptrap,oidCommunity,sizeof(oidCommunity)))==NULL) return("too many variable bindings");
+  if((msg=valueDecode(snmptrap,&tlv,NB_MOD_SNMPTRAP_SYNTAX_DEFAULT,binding))!=NULL) return(msg);
 
   switch(version){
     case 0: /* snmpV1 trap */
-      if(*cursor!=0xA4) return("expecting 0xA4 for V1 trap");
-      cursor++;
-      objlen=getObjectLength(&cursor,bufend);
-      if(objlen<0) return("buffer length confusion");
-
-      if(*cursor!=0x06) return("expecting 0x06 for enterprise OID");
-      strcpy(cmdcur,",'1.3.6.1.6.3.1.1.4.3'=");
-      cmdcur+=strlen(cmdcur);  // 2013-01-14 eat - VID 4157-0.8.13-3 FP but replaced strchr(cmdcur,0)
-      enterpriseOid=cursor;
-      if(NULL!=(msg=translateValue(&cursor,bufend,&cmdcur,cmdend,""))) return(msg);
-
-      if(*cursor!=0x40) return("expecting 0x40 for address");
-      strcpy(cmdcur,",'1.3.6.1.6.3.18.1.3'=");
-      cmdcur+=strlen(cmdcur);  // 2013-01-14 eat - VID 4165-0.8.13-3 FP but replaced strchr(cmdcur,0)
-      if(NULL!=(msg=translateValue(&cursor,bufend,&cmdcur,cmdend,""))) return(msg);
-
-      if(*cursor!=0x02) return("expecting integer for trap generic type");
-      cursor++;
-      if(*cursor>1) return("generic trap type length error - expecting 1");
-      cursor++;
-      generic=*cursor;
-      cursor++;
-      if(*cursor!=0x02) return("expecting integer for trap specific type");             
-      strcpy(cmdcur,",'1.3.6.1.6.3.1.1.4.1.0'=");  // snmpTrapOID.0
-      cmdcur+=strlen(cmdcur);   // 2013-01-14 eat - VID 4162-0.8.13-3 FP but replaced strchr(cmdcur,0)
-      if(generic!=6){
-        sprintf(cmdcur,"\"1.3.6.1.6.3.1.1.5.%d\"",(*cursor)+1); // see RFC 3584
-        cmdcur+=strlen(cmdcur);   // 2013-01-14 eat - VID 4156-0.8.13-3 FP but replaced strchr(cmdcur,0)
-        cursor++;
-        objlen=getObjectLength(&cursor,bufend);  // step over trap specific type
-        if(objlen<0) return("buffer length confusion");
-        }
+      if((cursor=berExpect(cursor,bufend,&tlv,0xA4))==NULL) return("expecting 0xA4 for V1 trap");
+      cursor=tlv.value;
+      bufend=tlv.value+tlv.len;
+      if((cursor=berExpect(cursor,bufend,&enterprise,0x06))==NULL) return("expecting 0x06 for enterprise OID");
+      if((binding=bindingAdd(context,snmptrap,oidEnterprise,sizeof(oidEnterprise)))==NULL) return("too many variable bindings");
+      if((msg=valueDecode(snmptrap,&enterprise,NB_MOD_SNMPTRAP_SYNTAX_DEFAULT,binding))!=NULL) return(msg);
+      if((cursor=berExpect(cursor,bufend,&tlv,0x40))==NULL) return("expecting 0x40 for address");
+      if((binding=bindingAdd(context,snmptrap,oidAgent,sizeof(oidAgent)))==NULL) return("too many variable bindings");
+      if((msg=valueDecode(snmptrap,&tlv,NB_MOD_SNMPTRAP_SYNTAX_DEFAULT,binding))!=NULL) return(msg);
+      if((cursor=berExpect(cursor,bufend,&tlv,0x02))==NULL || tlv.len!=1) return("generic trap type length error - expecting 1");
+      generic=*tlv.value;
+      if((cursor=berExpect(cursor,bufend,&specific,0x02))==NULL) return("expecting integer for trap specific type");
+      if((binding=bindingAdd(context,snmptrap,oidTrapOid,sizeof(oidTrapOid)))==NULL) return("too many variable bindings");
+      binding->kind='s';
+      // 2026-10-18 eat 0.9.04 - generic traps are snmpTraps.<generic+1> - was using the specific type tag
+      if(generic!=6) sprintf(snmptrap->trapOid,"'1.3.6.1.6.3.1.1.5.%d'",generic+1); // see RFC 3584
       else{
-        trapOIDCur=cmdcur+1;  //save location of trapOId
-        if(NULL!=(msg=translateValue(&enterpriseOid,bufend,&cmdcur,cmdend,""))) return(msg);
-        cmdcur--;  // back up over ending quote to extend this enterprise oid
-        strcpy(cmdcur,".0.");
-        cmdcur+=3;
-        if(NULL!=(msg=translateValue(&cursor,bufend,&cmdcur,cmdend,""))) return(msg);
-        *trapOID='\'';
-        objlen=cmdcur-trapOIDCur;
-        strncpy(trapOID+1,trapOIDCur,objlen);
-        *(trapOID+objlen+1)='\'';
-        *(trapOID+objlen+2)=0;
-        *cmdcur='"';
-        cmdcur++;
+        if((text=oidText(enterprise.value,enterprise.len,snmptrap->trapOid+1,snmptrap->trapOid+sizeof(snmptrap->trapOid)-16))==NULL) return("enterprise OID error");
+        if((msg=valueDecode(snmptrap,&specific,NB_MOD_SNMPTRAP_SYNTAX_DEFAULT,binding))!=NULL) return(msg);
+        sprintf(text,".0.%.0f'",binding->real);
+        *snmptrap->trapOid='\'';
         }
-      if(*cursor!=0x43) return("expecting 0x43 for uptime");
-      strcpy(cmdcur,",'1.3.6.1.2.1.1.3.0'=");
-      cmdcur+=strlen(cmdcur);   // 2013-01-14 eat - VID 966-0.8.13-3 FP but replaced strchr(cmdcur,0)
-      if(NULL!=(msg=translateValue(&cursor,bufend,&cmdcur,cmdend,""))) return(msg);
+      len=strlen(snmptrap->trapOid)-2;
+      if((binding->text=valueString(snmptrap,len))==NULL) return("value is too large for buffer");
+      strncpy(binding->text,snmptrap->trapOid+1,len);
+      binding->kind='s';
+      if((cursor=berExpect(cursor,bufend,&tlv,0x43))==NULL) return("expecting 0x43 for uptime");
+      if((binding=bindingAdd(context,snmptrap,oidUptime,sizeof(oidUptime)))==NULL) return("too many variable bindings");
+      if((msg=valueDecode(snmptrap,&tlv,NB_MOD_SNMPTRAP_SYNTAX_DEFAULT,binding))!=NULL) return(msg);
       break;
 
     case 1: /* snmpV2 trap */
-
-      if(*cursor!=0xA7) return("expecting 0xA7 for trap");
-      cursor++;
-      objlen=getObjectLength(&cursor,bufend);
-      if(objlen<0) return("buffer length confusion");
-  	
-      if(*cursor!=0x02) return("expecting 0x02 for variable 1");
-      cursor++;
-      objlen=getObjectLength(&cursor,bufend);
-      if(objlen<0) return("variable 1 length error");
-      cursor+=objlen;  
-  	
-      if(*cursor!=0x02 || *(cursor+1)!=0x01 || *(cursor+2)!=0x00 || *(cursor+3)!=0x02 || *(cursor+4)!=0x01 || *(cursor+5)!=0x00) return("V2:expecting 02 01 00 02 01 00 to start trap");
-      cursor+=6;
-
-      // Insert the sender's address - don't worry, this will be overridden if sender supplies in variable bindings  
-      sprintf(cmdcur,",'1.3.6.1.6.3.18.1.3'=\"%s\"",nbIpGetAddrString(senderAddr,snmptrap->sourceAddr));
-      cmdcur+=strlen(cmdcur);   // 2013-01-14 eat - VID 980-0.8.13-3 FP but replaced strchr(cmdcur,0)
+      if((cursor=berExpect(cursor,bufend,&tlv,0xA7))==NULL) return("expecting 0xA7 for trap");
+      cursor=tlv.value;
+      bufend=tlv.value+tlv.len;
+      if((cursor=berExpect(cursor,bufend,&tlv,0x02))==NULL) return("expecting 0x02 for request id");
+      if((cursor=berExpect(cursor,bufend,&tlv,0x02))==NULL || (cursor=berExpect(cursor,bufend,&tlv,0x02))==NULL) return("V2:expecting error status and index to start trap");
+      // Insert the sender's address - don't worry, this will be overridden if sender supplies in variable bindings
+      if((binding=bindingAdd(context,snmptrap,oidAgent,sizeof(oidAgent)))==NULL) return("too many variable bindings");
+      if((binding->text=valueString(snmptrap,39))==NULL) return("value is too large for buffer");
+      nbIpGetAddrString(binding->text,snmptrap->sourceAddr);
+      binding->kind='s';
       break;
     default: return("unrecognized trap version");
     }
 
-  fprintf(stderr,"translate: checking for handler\n");
-  fflush(stderr);
-
-  fprintf(stderr,"translate: processing variable bindings\n");
-  fflush(stderr);
-
   // Variable bindings same for V1 and V2
-  if(*cursor!=0x30) return("expecting 0x30 for variable binding list");
-  cursor++;
-  objlen=getObjectLength(&cursor,bufend);
-  if(objlen<0) return("variable binding list length error");
+  if((cursor=berExpect(cursor,bufend,&tlv,0x30))==NULL) return("expecting 0x30 for variable binding list");
+  cursor=tlv.value;
+  bufend=tlv.value+tlv.len;
   while(cursor<bufend){
-    if(*cursor!=0x30) return("expecting 0x30 for variable binding");
-    cursor++;
-    objlen=getObjectLength(&cursor,bufend);
-    if(objlen<0) return("variable binding length error");
-    if(*cursor!=0x06) return("expecting OID on left side of variable binding");
-    cursor++;
-    *cmdcur=',';
-    cmdcur++;
-    oid=cmdcur;  // save location of OID
-    *cmdcur='\'';
-    cmdcur++;
-    if((msg=translateOid(&cursor,bufend,&cmdcur,cmdend))!=NULL) return(msg);
-    *cmdcur='\'';
-    cmdcur++;
-    *cmdcur=0;
-    // look up syntax for value representation
-    if(snmptrap->syntaxContext
-        && (cell=nbTermLocateHere(snmptrap->syntaxContext,oid))!=NULL
-        && (cell=nbTermGetDefinition(snmptrap->syntaxContext,cell))!=NULL
-        && nbCellGetType(snmptrap->syntaxContext,cell)==NB_TYPE_STRING){
-      syntax=nbCellGetString(snmptrap->syntaxContext,cell);
+    if((cursor=berExpect(cursor,bufend,&tlv,0x30))==NULL) return("expecting 0x30 for variable binding");
+    end=tlv.value+tlv.len;
+    if((value=berExpect(tlv.value,end,&oid,0x06))==NULL) return("expecting OID on left side of variable binding");
+    if(berGet(value,end,&tlv)==NULL) return("variable binding value length error");
+    if((binding=bindingAdd(context,snmptrap,oid.value,oid.len))==NULL) return("variable binding OID value error or too many bindings");
+    if((msg=valueDecode(snmptrap,&tlv,binding->oid->syntax,binding))!=NULL) return(msg);
+    if(binding->oid->trapOid && tlv.tag==0x06 && strlen(binding->text)<sizeof(snmptrap->trapOid)-2){
+      sprintf(snmptrap->trapOid,"'%s'",binding->text);
       }
-    else syntax="";
-    // look up attribute name and replace if found
-    if(snmptrap->attributeContext
-        && (cell=nbTermLocateHere(snmptrap->attributeContext,oid))!=NULL
-        && (cell=nbTermGetDefinition(snmptrap->attributeContext,cell))!=NULL
-        && nbCellGetType(snmptrap->attributeContext,cell)==NB_TYPE_STRING){
-      attribute=nbCellGetString(snmptrap->attributeContext,cell);
-      strcpy(oid,attribute);
-      cmdcur=strchr(oid,0);
+    }
+  return(NULL);
+  }
+
+/*
+*  Translate decoded bindings to a NodeBrain ALERT command
+*
+*    alert '<oid>'=<value>,...;
+*
+*    An attribute name replaces '<oid>' when defined in the "attribute" glossary.
+*/
+static char *trapCommand(NB_MOD_Snmptrap *snmptrap,char *cmd,size_t size){
+  NB_MOD_SnmptrapBinding *binding,*bindingEnd=snmptrap->binding+snmptrap->bindings;
+  char *cmdcur=cmd,*cmdend=cmd+size-1;
+  size_t len;
+
+  strcpy(cmdcur,"alert ");
+  cmdcur+=6;
+  for(binding=snmptrap->binding;binding<bindingEnd;binding++){
+    len=strlen(binding->oid->name);
+    if(binding->kind=='s') len+=strlen(binding->text)+2;
+    if(cmdend-cmdcur<len+32) return("trap is too large for command buffer");
+    if(binding>snmptrap->binding){
+      *cmdcur=',';
+      cmdcur++;
       }
+    strcpy(cmdcur,binding->oid->name);
+    cmdcur=strchr(cmdcur,0);
     *cmdcur='=';
     cmdcur++;
-    value=cmdcur;
-    if((msg=translateValue(&cursor,bufend,&cmdcur,cmdend,syntax))!=NULL) return(msg);
-    if(strncmp(oid,"'1.3.6.1.6.3.1.1.4.1.0'",23)==0 && *value=='"'){
-      oid=trapOID;
-      *oid='\'';
-      oid++;
-      value++;
-      while(value<cmdcur && *value!='"') *oid=*value,oid++,value++;
-      *oid='\'';
-      oid++;
-      *oid=0;
+    switch(binding->kind){
+      case 'n':
+        sprintf(cmdcur,"%.10g",binding->real);
+        cmdcur=strchr(cmdcur,0);
+        break;
+      case 's':
+        sprintf(cmdcur,"\"%s\"",binding->text);
+        cmdcur=strchr(cmdcur,0);
+        break;
+      default:
+        *cmdcur='?';
+        cmdcur++;
       }
     }
   *cmdcur=0;
+  return(NULL);
+  }
+
+/*
+*  Assert decoded bindings directly as an alert
+*
+*    This is equivalent to the ALERT command generated by trapCommand, but
+*    it avoids generating and parsing the command.  The assertion list is
+*    built in reverse order, so the last assignment to a term still wins.
+*/
+static char *trapAssert(nbCELL context,NB_MOD_Snmptrap *snmptrap){
+  NB_MOD_SnmptrapBinding *binding;
+  NB_MOD_SnmptrapOid *oid;
+  nbSET assertion=NULL;
+  nbCELL cell;
 
+  for(binding=snmptrap->binding+snmptrap->bindings-1;binding>=snmptrap->binding;binding--){
+    oid=binding->oid;
+    if(!oid->term){
+      if((cell=nbTermLocateHere(context,oid->name))==NULL
+        && (cell=nbTermCreate(context,oid->name,NB_CELL_UNKNOWN))==NULL){
+        nbListEmpty(context,&assertion);
+        sprintf(translateMsg,"unable to create term %.200s",oid->name);
+        return(translateMsg);
+        }
+      oid->term=nbCellGrab(context,cell);
+      }
+    switch(binding->kind){
+      case 'n':
+        cell=nbCellCreateReal(context,binding->real);
+        nbAssertionAddTermValue(context,&assertion,oid->term,cell);
+        nbCellDrop(context,cell);
+        break;
+      case 's':
+        cell=nbCellCreateString(context,binding->text);
+        nbAssertionAddTermValue(context,&assertion,oid->term,cell);
+        nbCellDrop(context,cell);
+        break;
+      default:
+        nbAssertionAddTermValue(context,&assertion,oid->term,NB_CELL_UNKNOWN);
+      }
+    }
+  nbAssert(context,assertion,1);
+  nbListEmpty(context,&assertion);
+  nbRuleReact();
+  nbNodeAlert(context,context);
+  return(NULL);
+  }
+
+/*
+*  Translate an SNMP V1 or V2 Trap datagram
+*
+*    When the node is silent and not tracing, and no handler is defined for
+*    the trap OID, the trap is asserted directly.  Otherwise an ALERT command
+*    is generated, so it can be displayed or passed to a handler node.
+*/
+static void translate(nbCELL context,NB_MOD_Snmptrap *snmptrap,unsigned char *buf,int len){
+  char cmd[NB_BUFSIZE];
+  char *msg,*handlerName=NULL;
+  nbCELL cell;
+
+  if(snmptrap->oids>=NB_MOD_SNMPTRAP_OID_MAX) oidFlush(context,snmptrap);
+  if((msg=trapDecode(context,snmptrap,buf,len))!=NULL){
+    snmptrap->errors++;
+    nbLogMsg(context,0,'E',"%s",msg);
+    return;
+    }
+  snmptrap->traps++;
   // Check for handler
-  if(snmptrap->handlerContext
-      && (cell=nbTermLocateHere(snmptrap->handlerContext,trapOID))!=NULL
+  if(snmptrap->handlerContext && *snmptrap->trapOid
+      && (cell=nbTermLocateHere(snmptrap->handlerContext,snmptrap->trapOid))!=NULL
       && (cell=nbTermGetDefinition(snmptrap->handlerContext,cell))!=NULL
       && nbCellGetType(snmptrap->handlerContext,cell)==NB_TYPE_STRING){
-    *handlerNameP=nbCellGetString(snmptrap->handlerContext,cell);
-    //handler=nbCellGetString(snmptrap->handlerContext,cell);
-    //strcpy(cmd,handler);
-    //cmdcur=strchr(cmd,0);
-    //*cmdcur=':';
-    //cmdcur++; 
-    //strcpy(cmdcur,trapOID);
-    //cmdcur=strchr(cmdcur,0);
+    handlerName=nbCellGetString(snmptrap->handlerContext,cell);
+    }
+  if(!handlerName && !snmptrap->echo && !snmptrap->trace) msg=trapAssert(context,snmptrap);
+  else if((msg=trapCommand(snmptrap,cmd,sizeof(cmd)))==NULL){
+    if(snmptrap->trace && !snmptrap->echo) nbLogMsg(context,0,'I',"%s",cmd);
+    if(handlerName){
+      *(cmd+5)=':'; // convert to node command, stepping over "alert" verb
+      nbNodeCmd(context,handlerName,cmd+5);
+      }
+    else nbCmd(context,cmd,snmptrap->echo);
+    }
+  if(msg){
+    snmptrap->errors++;
+    nbLogMsg(context,0,'E',"%s",msg);
     }
-
-  fprintf(stderr,"translate: returning\n");
-  fflush(stderr);
-
-  return(NULL);
   }
 
 /*==================================================================================
@@ -832,26 +1033,57 @@ static void serverRead(nbCELL context,int serverSocket,void *handle){
   int  len;
   unsigned short rport;
   char daddr[40],raddr[40];
-  char cmd[NB_BUFSIZE];
-  size_t cmdlen=NB_BUFSIZE;
-  char *msg;
-  char *handlerName=NULL;
 
-  nbIpGetSocketAddrString(serverSocket,daddr);
   len=nbIpGetDatagram(context,serverSocket,&snmptrap->sourceAddr,&rport,buffer,buflen);
-  if(snmptrap->trace) nbLogMsg(context,0,'I',"Datagram %s:%5.5u -> %s len=%d\n",nbIpGetAddrString(raddr,snmptrap->sourceAddr),rport,daddr,len);
-  if(snmptrap->dump) nbLogDump(context,buffer,len);
-  msg=translate(snmptrap,buffer,len,cmd,cmdlen,&handlerName);
-  if(msg!=NULL){
-    nbLogMsg(context,0,'E',msg);
-    return;
+  if(len<=0) return;
+  if(snmptrap->trace){
+    nbIpGetSocketAddrString(serverSocket,daddr);
+    nbLogMsg(context,0,'I',"Datagram %s:%5.5u -> %s len=%d\n",nbIpGetAddrString(raddr,snmptrap->sourceAddr),rport,daddr,len);
     }
-  if(snmptrap->trace && !snmptrap->echo) nbLogMsg(context,0,'I',cmd);
-  if(handlerName){
-    *(cmd+5)=':'; // convert to node command, stepping over "alert" verb
-    nbNodeCmd(context,handlerName,cmd+5);
+  if(snmptrap->dump) nbLogDump(context,buffer,len);
+  if(snmptrap->record) snmptrap->record=nbIpRecordPut(context,snmptrap->record,snmptrap->sourceAddr,buffer,len);
+  translate(context,snmptrap,buffer,len);
+  }
+
+/*
+*  Locate glossaries and flush the OID cache
+*/
+static void serverLocate(nbCELL context,NB_MOD_Snmptrap *snmptrap){
+  snmptrap->handlerContext=nbTermLocateHere(context,"handler");
+  snmptrap->syntaxContext=nbTermLocateHere(context,"syntax");
+  snmptrap->attributeContext=nbTermLocateHere(context,"attribute");
+  oidFlush(context,snmptrap);
+  }
+
+/*
+*  Handle a replayed datagram
+*/
+static void serverReplayDatagram(nbCELL context,void *handle,unsigned int addr,unsigned char *buffer,int len){
+  NB_MOD_Snmptrap *snmptrap=(NB_MOD_Snmptrap *)handle;
+
+  snmptrap->sourceAddr=addr;
+  translate(context,snmptrap,buffer,len);
+  }
+
+/*
+*  Replay recorded datagrams - see nbIpReplay()
+*/
+static void serverReplay(nbCELL context,NB_MOD_Snmptrap *snmptrap,char *filename,int repeat,int benchmark){
+  unsigned int sourceAddr=snmptrap->sourceAddr,traps=snmptrap->traps,errors=snmptrap->errors;
+  double elapsed;
+  int datagrams;
+
+  if(!snmptrap->socket) serverLocate(context,snmptrap);
+  datagrams=nbIpReplay(context,filename,NB_MOD_SNMPTRAP_MAGIC,NB_BUFSIZE,repeat,snmptrap,serverReplayDatagram,&elapsed);
+  snmptrap->sourceAddr=sourceAddr;
+  if(datagrams<0) return;
+  traps=snmptrap->traps-traps;
+  errors=snmptrap->errors-errors;
+  nbLogMsg(context,0,'I',"Replayed %d datagrams with %u traps - %u errors",datagrams,traps,errors);
+  if(benchmark){
+    if(elapsed<=0) elapsed=1e-9;
+    nbLogMsg(context,0,'I',"Benchmark: %.3f seconds, %.0f traps/second, %u cached OIDs",elapsed,traps/elapsed,snmptrap->oids);
     }
-  else nbCmd(context,cmd,snmptrap->echo);
   }
 
 /*
@@ -863,7 +1095,7 @@ static void serverRead(nbCELL context,int serverSocket,void *handle){
 *    <text> - flag keywords
 *               trace   - display input packets
 *               dump    - display dump of SNMP UDP packets
-*               silent  - don't echo generated NodeBrain commands 
+*               silent  - don't echo generated NodeBrain commands
 *
 *    define snmptrap node snmptrap;
 *    define snmptrap node snmptrap:dump,silent;
@@ -886,8 +1118,8 @@ static void *serverConstruct(nbCELL context,void *skillHandle,nbCELL arglist,cha
 
   *interfaceAddr=0;
 
-  argSet=nbListOpen(context,arglist);   
-  cell=nbListGetCellValue(context,&argSet); 
+  argSet=nbListOpen(context,arglist);
+  cell=nbListGetCellValue(context,&argSet);
   if(cell!=NULL){
     type=nbCellGetType(context,cell);
     if(type==NB_TYPE_STRING){
@@ -901,7 +1133,7 @@ static void *serverConstruct(nbCELL context,void *skillHandle,nbCELL arglist,cha
         return(NULL);
         }
       strncpy(interfaceAddr,str,len);
-      *(interfaceAddr+len)=0; 
+      *(interfaceAddr+len)=0;
       if(delim!=NULL){
         delim++;
         port=(unsigned int)atoi(delim);
@@ -922,7 +1154,7 @@ static void *serverConstruct(nbCELL context,void *skillHandle,nbCELL arglist,cha
       nbLogMsg(context,0,'E',"Expecting interface (\"address[:port]\") or (port) as argument list");
       return(NULL);
       }
-    cell=nbListGetCellValue(context,&argSet); 
+    cell=nbListGetCellValue(context,&argSet);
     if(cell!=NULL){
       nbLogMsg(context,0,'E',"Only one argument expected - ignoring additional arguments");
       nbCellDrop(context,cell);
@@ -940,7 +1172,7 @@ static void *serverConstruct(nbCELL context,void *skillHandle,nbCELL arglist,cha
       *delim=0;
       if(strcmp(cursor,"trace")==0){trace=1;}
       else if(strcmp(cursor,"dump")==0){trace=1;dump=1;}
-      else if(strcmp(cursor,"silent")==0) echo=0; 
+      else if(strcmp(cursor,"silent")==0) echo=0;
       *delim=saveDelim;
       cursor=delim;
       if(*cursor==',') cursor++;
@@ -948,6 +1180,7 @@ static void *serverConstruct(nbCELL context,void *skillHandle,nbCELL arglist,cha
       }
     }
   snmptrap=nbAlloc(sizeof(NB_MOD_Snmptrap));
+  memset(snmptrap,0,sizeof(NB_MOD_Snmptrap));
   snmptrap->socket=0;
   strcpy(snmptrap->interfaceAddr,interfaceAddr);
   snmptrap->port=port;
@@ -967,14 +1200,14 @@ static void *serverConstruct(nbCELL context,void *skillHandle,nbCELL arglist,cha
 *    enable <node>
 */
 static int serverEnable(nbCELL context,void *skillHandle,NB_MOD_Snmptrap *snmptrap){
-  int fd;
-  snmptrap->handlerContext=nbTermLocateHere(context,"handler");
-  snmptrap->syntaxContext=nbTermLocateHere(context,"syntax");
-  snmptrap->attributeContext=nbTermLocateHere(context,"attribute");
+  int fd,rcvbuf=NB_MOD_SNMPTRAP_RCVBUF;
+  serverLocate(context,snmptrap);
   if((fd=nbIpGetUdpServerSocket(context,snmptrap->interfaceAddr,snmptrap->port))<0){ // 2012-12-27 eat 0.8.13 - CID 751574
     nbLogMsg(context,0,'E',"Unable to listen on port %d\n",snmptrap->port);
     return(1);
     }
+  // 2026-10-18 eat 0.9.04 - a larger receive buffer absorbs trap bursts
+  setsockopt(fd,SOL_SOCKET,SO_RCVBUF,(char *)&rcvbuf,sizeof(rcvbuf));
   snmptrap->socket=fd;
   nbListenerAdd(context,snmptrap->socket,snmptrap,serverRead);
   nbLogMsg(context,0,'I',"Listening on port %u for SNMP Trap Datagrams",snmptrap->port);
@@ -983,7 +1216,7 @@ static int serverEnable(nbCELL context,void *skillHandle,NB_MOD_Snmptrap *snmptr
 
 /*
 *  disable method
-* 
+*
 *    disable <node>
 */
 static int serverDisable(nbCELL context,void *skillHandle,NB_MOD_Snmptrap *snmptrap){
@@ -1001,12 +1234,27 @@ static int serverDisable(nbCELL context,void *skillHandle,NB_MOD_Snmptrap *snmpt
 *  command() method
 *
 *    <node>[(<args>)][:<text>]
+*
+*    <node>:record <file>             - append received datagrams to a file
+*    <node>:record                    - stop recording
+*    <node>:replay <file>             - translate recorded datagrams
+*    <node>:benchmark <file>[,<n>]    - translate recorded datagrams n times
 */
 static int *serverCommand(nbCELL context,void *skillHandle,NB_MOD_Snmptrap *snmptrap,nbCELL arglist,char *text){
+  char verb[16],filename[512];
+  int rc,repeat;
+
   if(snmptrap->trace){
     nbLogMsg(context,0,'T',"nb_snmptrap:serverCommand() text=[%s]\n",text);
     }
-  /* insert command parsing code here */
+  if((rc=nbIpRecordParse(context,text,verb,sizeof(verb),filename,sizeof(filename),&repeat))<0) return(0);
+  if(rc==0){
+    while(*text==' ') text++;
+    nbLogMsg(context,0,'E',"Command \"%s\" not recognized",text);
+    return(0);
+    }
+  if(strcmp(verb,"record")==0) snmptrap->record=nbIpRecord(context,snmptrap->record,filename,NB_MOD_SNMPTRAP_MAGIC);
+  else serverReplay(context,snmptrap,filename,repeat,strcmp(verb,"benchmark")==0);
   return(0);
   }
 
@@ -1019,14 +1267,25 @@ static int *serverCommand(nbCELL context,void *skillHandle,NB_MOD_Snmptrap *snmp
 static int serverDestroy(nbCELL context,void *skillHandle,NB_MOD_Snmptrap *snmptrap){
   nbLogMsg(context,0,'T',"serverDestroy called");
   if(snmptrap->socket!=0) serverDisable(context,skillHandle,snmptrap);
+  if(snmptrap->record) fclose(snmptrap->record);
+  oidFlush(context,snmptrap);
   nbFree(snmptrap,sizeof(NB_MOD_Snmptrap));
   return(0);
   }
 
+/*
+*  Build the type table indexed by tag
+*/
+static void serverTypeInit(void){
+  NB_MOD_SnmptrapType *type;
+  for(type=snmptrapTypeTable;type->kind;type++) snmptrapType[type->tag]=type;
+  }
+
 #if defined(_WINDOWS)
 _declspec (dllexport)
 #endif
 extern void *snmptrapBind(nbCELL context,void *moduleHandle,nbCELL skill,nbCELL arglist,char *text){
+  serverTypeInit();
   nbSkillSetMethod(context,skill,NB_NODE_CONSTRUCT,serverConstruct);
   nbSkillSetMethod(context,skill,NB_NODE_DISABLE,serverDisable);
   nbSkillSetMethod(context,skill,NB_NODE_ENABLE,serverEnable);
@@ -1039,6 +1298,7 @@ extern void *snmptrapBind(nbCELL context,void *moduleHandle,nbCELL skill,nbCELL
 _declspec (dllexport)
 #endif
 extern void *serverBind(nbCELL context,void *moduleHandle,nbCELL skill,nbCELL arglist,char *text){
+  serverTypeInit();
   nbSkillSetMethod(context,skill,NB_NODE_CONSTRUCT,serverConstruct);
   nbSkillSetMethod(context,skill,NB_NODE_DISABLE,serverDisable);
   nbSkillSetMethod(context,skill,NB_NODE_ENABLE,serverEnable);
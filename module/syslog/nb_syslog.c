@@ -110,12 +110,17 @@
 *                        <port>            - bind alternate port number
 *                                            (default is 514)
 *                        "<address>:port"  - bind to interface and port
+*                        "tcp://<address>:port" - listen for TCP connections
+*                                            (RFC 6587 octet counting or LF)
 *
 *       <options>     -  Options to control the log output 
 *
 *                        trace   - display every trap received
 *                        dump    - display a hex dump of UDP datagrams
 *                        silent  - don't echo generated NodeBrain commands
+*                        rfc5424 - parse RFC 5424 messages and alert the
+*                                  node with header and structured data
+*                                  fields (translator may be "")
 *     Examples:
 *
 *       define syslog node syslog.server("syslog.nbx"); 
@@ -124,6 +129,7 @@
 *       define syslog node syslog.server("syslog.nbx","127.0.0.1:50514");  # both
 *       define syslog node syslog.server("syslog.nbx"):dump;  # specify an option
 *       define syslog node syslog.server("syslog.nbx",50514):silent; # specify port and option
+*       define syslog node syslog.server("","tcp://127.0.0.1:50601"):rfc5424,silent;
 *
 *   All input packets are passed to the translator.  It is the translator's job to
 *   match lines of syslog text to regular expressions and issue NodeBrain commands
@@ -206,10 +212,13 @@
 * 2012-10-17 eat 0.8.12 Checker updates
 * 2012-10-18 eat 0.8.12 Checker updates
 * 2012-12-27 eat 0.8.13 Checker updates
+* 2026-10-18 eat 0.9.04 Included RFC 5424 parsing and RFC 6587 TCP transport
+* 2026-10-18 eat 0.9.04 Normalize field values once when parsed, for assert and command paths
 *=====================================================================
 */
 #include "config.h"
 #include <nb/nb.h>
+#include <ctype.h>
 #include <syslog.h>
 
 /*
@@ -219,6 +228,36 @@
 *  structure which it stores in a node's "handle".  The handle is passed to
 *  various functions defined in this module.
 */
+#define NB_MOD_SYSLOG_FIELDS     64     /* maximum fields asserted per message */
+#define NB_MOD_SYSLOG_TERM_HASH  509    /* term cache hash size */
+#define NB_MOD_SYSLOG_TERM_MAX   2048   /* term cache entries before flush */
+
+typedef struct NB_MOD_SYSLOG_TERM{ /* term cache entry */
+  struct NB_MOD_SYSLOG_TERM *next; /* next entry in hash list */
+  nbCELL         term;             /* term in node context */
+  size_t         size;             /* size of entry */
+  char           name[1];          /* term name */
+  } NB_MOD_SyslogTerm;
+
+typedef struct NB_MOD_SYSLOG_FIELD{ /* parsed message field */
+  NB_MOD_SyslogTerm *term;         /* cached term */
+  char           kind;             /* 'n' - number, 's' - string, '?' - unknown */
+  double         real;             /* number value */
+  char          *text;             /* string value */
+  } NB_MOD_SyslogField;
+
+struct NB_MOD_SERVER;
+
+typedef struct NB_MOD_SYSLOG_CONN{ /* TCP connection */
+  struct NB_MOD_SYSLOG_CONN *next; /* next connection of server */
+  struct NB_MOD_SERVER *server;    /* server accepting connection */
+  int            socket;           /* connection socket */
+  char           addr[16];         /* remote address */
+  size_t         len;              /* bytes in buffer */
+  size_t         skip;             /* bytes of oversized frame to skip */
+  char           buffer[NB_BUFSIZE+16];
+  } NB_MOD_SyslogConn;
+
 typedef struct NB_MOD_SERVER{      /* syslog.server node descriptor */
   char          *uri;              /* uri of socket we listen on */
   unsigned int   socket;           /* server socket for datagrams */
@@ -228,7 +267,18 @@ typedef struct NB_MOD_SERVER{      /* syslog.server node descriptor */
   unsigned char  trace;            /* trace option */
   unsigned char  dump;             /* option to dump packets in trace */
   unsigned char  echo;             /* echo option */
+  unsigned char  tcp;              /* listen on TCP with RFC 6587 framing */
+  unsigned char  rfc5424;          /* parse RFC 5424 messages */
   unsigned int   sourceAddr;       /* source address */
+  NB_MOD_SyslogConn *conn;         /* TCP connections */
+  unsigned long  messages;         /* messages received */
+  unsigned long  parsed;           /* messages parsed as RFC 5424 */
+  unsigned int   terms;            /* terms cached */
+  NB_MOD_SyslogTerm *termHash[NB_MOD_SYSLOG_TERM_HASH];
+  int            fields;           /* fields of current message */
+  NB_MOD_SyslogField field[NB_MOD_SYSLOG_FIELDS];
+  char          *scratchCur;       /* next free byte of scratch buffer */
+  char           scratch[NB_BUFSIZE+256]; /* field values of current message */
   } NB_MOD_Server;
 
 /*================================================================================*/
@@ -300,6 +350,382 @@ typedef struct NB_MOD_SERVER{      /* syslog.server node descriptor */
 *  
 */
 
+/*
+*  syslog Message Format (See RFC 5424)
+*
+*    <PRI>VERSION SP TIMESTAMP SP HOSTNAME SP APP-NAME SP PROCID SP MSGID SP STRUCTURED-DATA [SP MSG]
+*
+*    <165>1 2003-10-11T22:14:15.003Z mymachine.example.com evntslog - ID47 [exampleSDID@32473 iut="3" eventSource="Application"] An application event log entry...
+*
+*  When the rfc5424 option is specified, a message in this format is parsed by
+*  this module and asserted to the node context as an alert, so rules may
+*  reference the fields without extracting them with a translator.
+*
+*    facility         - PRI/8
+*    severity         - PRI%8
+*    version          - VERSION
+*    timestamp        - TIMESTAMP as a string
+*    hostname         - HOSTNAME
+*    appname          - APP-NAME
+*    procid           - PROCID
+*    msgid            - MSGID
+*    message          - MSG with a leading UTF-8 BOM removed
+*    <sdid>.<param>   - PARAM-VALUE of each SD-PARAM within an SD-ELEMENT
+*
+*  A NILVALUE ("-") is asserted as Unknown.  An SD-ID or PARAM-NAME that is not
+*  a simple NodeBrain term name is single quoted (e.g. 'exampleSDID@32473'.iut).
+*  As with an ALERT command, an SD-PARAM keeps its value until it is asserted
+*  again.  When a translator is specified, MSG is passed to the translator after
+*  the alert.  Messages in any other format are passed to the translator as is.
+*
+*  TCP Transport (See RFC 6587)
+*
+*    When the server is bound to "tcp://<address>:<port>", messages are framed
+*    by octet counting (MSG-LEN SP SYSLOG-MSG) or by a trailing LF when a frame
+*    does not start with a digit.
+*/
+static char *syslogFieldName[]={"facility","severity","version","timestamp","hostname","appname","procid","msgid","message"};
+
+#define NB_MOD_SYSLOG_FIELD_FACILITY  0
+#define NB_MOD_SYSLOG_FIELD_SEVERITY  1
+#define NB_MOD_SYSLOG_FIELD_VERSION   2
+#define NB_MOD_SYSLOG_FIELD_TIMESTAMP 3
+#define NB_MOD_SYSLOG_FIELD_HOSTNAME  4
+#define NB_MOD_SYSLOG_FIELD_APPNAME   5
+#define NB_MOD_SYSLOG_FIELD_PROCID    6
+#define NB_MOD_SYSLOG_FIELD_MSGID     7
+#define NB_MOD_SYSLOG_FIELD_MESSAGE   8
+
+/*
+*  Hash a term name
+*/
+static unsigned int syslogTermHash(char *name){
+  unsigned int hash=2166136261u;
+  for(;*name;name++) hash=(hash^(unsigned char)*name)*16777619u;
+  return(hash%NB_MOD_SYSLOG_TERM_HASH);
+  }
+
+/*
+*  Remove all terms from the cache
+*/
+static void syslogTermFlush(nbCELL context,NB_MOD_Server *server){
+  NB_MOD_SyslogTerm *entry;
+  int i;
+
+  for(i=0;i<NB_MOD_SYSLOG_TERM_HASH;i++){
+    while((entry=server->termHash[i])!=NULL){
+      server->termHash[i]=entry->next;
+      nbCellDrop(context,entry->term);
+      nbFree(entry,entry->size);
+      }
+    }
+  server->terms=0;
+  }
+
+/*
+*  Get a term in the node context by name
+*
+*    Terms are cached by name, so a field or SD-PARAM seen before costs a
+*    hash lookup instead of a term lookup.
+*/
+static NB_MOD_SyslogTerm *syslogTerm(nbCELL context,NB_MOD_Server *server,char *name){
+  NB_MOD_SyslogTerm *entry,**entryP;
+  nbCELL term;
+  size_t size;
+
+  entryP=&server->termHash[syslogTermHash(name)];
+  for(entry=*entryP;entry!=NULL;entry=entry->next){
+    if(strcmp(entry->name,name)==0) return(entry);
+    }
+  if((term=nbTermLocateHere(context,name))==NULL
+    && (term=nbTermCreate(context,name,NB_CELL_UNKNOWN))==NULL) return(NULL);
+  size=sizeof(NB_MOD_SyslogTerm)+strlen(name);
+  entry=nbAlloc(size);
+  entry->next=*entryP;
+  entry->term=nbCellGrab(context,term);
+  entry->size=size;
+  strcpy(entry->name,name);
+  *entryP=entry;
+  server->terms++;
+  return(entry);
+  }
+
+/*
+*  Add a field to the parsed message
+*/
+static NB_MOD_SyslogField *syslogField(nbCELL context,NB_MOD_Server *server,char *name){
+  NB_MOD_SyslogField *field;
+
+  if(server->fields>=NB_MOD_SYSLOG_FIELDS) return(NULL);
+  field=&server->field[server->fields];
+  if((field->term=syslogTerm(context,server,name))==NULL) return(NULL);
+  server->fields++;
+  field->kind='?';
+  return(field);
+  }
+
+/*
+*  Normalize a character of a field value
+*
+*    Double quotes are replaced with single quotes to avoid terminating
+*    NodeBrain strings, and control characters are replaced with spaces to
+*    keep a command on one line.  Values are normalized once, as they are
+*    parsed, so asserted values match the values in an echoed command.
+*/
+static char syslogChar(char c){
+  if(c=='"') return('\'');
+  if((unsigned char)c<32) return(' ');
+  return(c);
+  }
+
+/*
+*  Copy text to the scratch buffer
+*/
+static char *syslogScratch(NB_MOD_Server *server,char *text,size_t len){
+  char *copy=server->scratchCur,*cursor;
+  if(server->scratch+sizeof(server->scratch)-copy<len+1) return(NULL);
+  for(cursor=copy;cursor<copy+len;cursor++,text++) *cursor=syslogChar(*text);
+  *(copy+len)=0;
+  server->scratchCur+=len+1;
+  return(copy);
+  }
+
+/*
+*  Get a header token - printable US-ASCII terminated by a space
+*/
+static char *syslogToken(char **cursorP,char *end,size_t *lenP){
+  char *cursor=*cursorP,*token=cursor;
+
+  while(cursor<end && *cursor>32 && *cursor<127) cursor++;
+  if(cursor==token || cursor>=end || *cursor!=' ' || cursor-token>255) return(NULL);
+  *lenP=cursor-token;
+  *cursorP=cursor+1;
+  return(token);
+  }
+
+/*
+*  Get an SD-ID or PARAM-NAME as a term name - quoted unless a simple name
+*/
+static char *syslogSdName(char **cursorP,char *end,char *name,char *nameEnd){
+  char *cursor=*cursorP,*start=cursor;
+  int simple=1;
+
+  while(cursor<end && *cursor>32 && *cursor<127 && *cursor!='=' && *cursor!=']' && *cursor!='"'){
+    if(*cursor=='\'') return(NULL);
+    if(!isalnum((unsigned char)*cursor) && *cursor!='_') simple=0;
+    cursor++;
+    }
+  if(!isalpha((unsigned char)*start)) simple=0;
+  if(cursor==start || cursor-start>32 || nameEnd-name<cursor-start+3) return(NULL);
+  if(!simple){
+    *name='\'';
+    name++;
+    }
+  memcpy(name,start,cursor-start);
+  name+=cursor-start;
+  if(!simple){
+    *name='\'';
+    name++;
+    }
+  *name=0;
+  *cursorP=cursor;
+  return(name);
+  }
+
+/*
+*  Parse an RFC 5424 message into fields
+*
+*    The message text is not modified.  Field values, including the MSG
+*    field, are normalized and copied to the scratch buffer.
+*
+*  Returns: 0 - parsed, -1 - not an RFC 5424 message
+*/
+static int syslogParse(nbCELL context,NB_MOD_Server *server,char *text,char *end,char **msgP){
+  NB_MOD_SyslogField *field;
+  char *cursor=text,*token,*value,*valueCur,*nameCur;
+  char name[80];
+  size_t len;
+  int pri=0,version=0,i;
+
+  server->fields=0;
+  server->scratchCur=server->scratch;
+  if(cursor>=end || *cursor!='<') return(-1);
+  for(cursor++,i=0;cursor<end && *cursor>='0' && *cursor<='9' && i<3;cursor++,i++) pri=pri*10+*cursor-'0';
+  if(i==0 || cursor>=end || *cursor!='>' || pri>191) return(-1);
+  cursor++;
+  if(cursor>=end || *cursor<'1' || *cursor>'9') return(-1);
+  for(i=0;cursor<end && *cursor>='0' && *cursor<='9' && i<3;cursor++,i++) version=version*10+*cursor-'0';
+  if(cursor>=end || *cursor!=' ') return(-1);
+  cursor++;
+  if((field=syslogField(context,server,syslogFieldName[NB_MOD_SYSLOG_FIELD_FACILITY]))==NULL) return(-1);
+  field->kind='n';
+  field->real=pri/8;
+  if((field=syslogField(context,server,syslogFieldName[NB_MOD_SYSLOG_FIELD_SEVERITY]))==NULL) return(-1);
+  field->kind='n';
+  field->real=pri%8;
+  if((field=syslogField(context,server,syslogFieldName[NB_MOD_SYSLOG_FIELD_VERSION]))==NULL) return(-1);
+  field->kind='n';
+  field->real=version;
+  for(i=NB_MOD_SYSLOG_FIELD_TIMESTAMP;i<=NB_MOD_SYSLOG_FIELD_MSGID;i++){
+    if((token=syslogToken(&cursor,end,&len))==NULL) return(-1);
+    if((field=syslogField(context,server,syslogFieldName[i]))==NULL) return(-1);
+    if(len==1 && *token=='-') continue;  // NILVALUE
+    field->kind='s';
+    if((field->text=syslogScratch(server,token,len))==NULL) return(-1);
+    }
+  // STRUCTURED-DATA
+  if(cursor<end && *cursor=='-') cursor++;
+  else{
+    if(cursor>=end || *cursor!='[') return(-1);
+    while(cursor<end && *cursor=='['){
+      cursor++;
+      if((nameCur=syslogSdName(&cursor,end,name,name+sizeof(name)-40))==NULL) return(-1);
+      while(cursor<end && *cursor==' '){
+        cursor++;
+        *nameCur='.';
+        if(syslogSdName(&cursor,end,nameCur+1,name+sizeof(name))==NULL) return(-1);
+        if(cursor+1>=end || *cursor!='=' || *(cursor+1)!='"') return(-1);
+        cursor+=2;
+        // PARAM-VALUE with '"', '\' and ']' escaped by '\'
+        value=valueCur=server->scratchCur;
+        while(cursor<end && *cursor!='"'){
+          if(*cursor=='\\' && cursor+1<end && (*(cursor+1)=='"' || *(cursor+1)=='\\' || *(cursor+1)==']')) cursor++;
+          if(valueCur>=server->scratch+sizeof(server->scratch)-1) return(-1);
+          *valueCur=syslogChar(*cursor);
+          valueCur++;
+          cursor++;
+          }
+        if(cursor>=end) return(-1);
+        cursor++;
+        *valueCur=0;
+        server->scratchCur=valueCur+1;
+        if((field=syslogField(context,server,name))!=NULL){  // ignore parameters beyond the limit
+          field->kind='s';
+          field->text=value;
+          }
+        *nameCur=0;
+        }
+      if(cursor>=end || *cursor!=']') return(-1);
+      cursor++;
+      }
+    }
+  // MSG
+  if((field=syslogField(context,server,syslogFieldName[NB_MOD_SYSLOG_FIELD_MESSAGE]))==NULL) return(-1);
+  if(cursor<end){
+    if(*cursor!=' ') return(-1);
+    cursor++;
+    if(end-cursor>=3 && memcmp(cursor,"\xEF\xBB\xBF",3)==0) cursor+=3;
+    field->kind='s';
+    if((field->text=syslogScratch(server,cursor,end-cursor))==NULL) return(-1);
+    }
+  *msgP=cursor;
+  return(0);
+  }
+
+/*
+*  Translate parsed fields to a NodeBrain ALERT command
+*
+*    String values have been normalized by syslogParse(), so they are
+*    copied as is.
+*/
+static char *syslogCommand(NB_MOD_Server *server,char *cmd,size_t size){
+  NB_MOD_SyslogField *field,*fieldEnd=server->field+server->fields;
+  char *cmdcur=cmd,*cmdend=cmd+size-1,*text;
+  size_t len;
+
+  strcpy(cmdcur,"alert ");
+  cmdcur+=6;
+  for(field=server->field;field<fieldEnd;field++){
+    len=strlen(field->term->name);
+    if(field->kind=='s') len+=strlen(field->text)+2;
+    if(cmdend-cmdcur<len+32) return("message is too large for command buffer");
+    if(field>server->field){
+      *cmdcur=',';
+      cmdcur++;
+      }
+    strcpy(cmdcur,field->term->name);
+    cmdcur=strchr(cmdcur,0);
+    *cmdcur='=';
+    cmdcur++;
+    switch(field->kind){
+      case 'n':
+        sprintf(cmdcur,"%.10g",field->real);
+        cmdcur=strchr(cmdcur,0);
+        break;
+      case 's':
+        *cmdcur='"';
+        cmdcur++;
+        for(text=field->text;*text;text++,cmdcur++) *cmdcur=*text;
+        *cmdcur='"';
+        cmdcur++;
+        break;
+      default:
+        *cmdcur='?';
+        cmdcur++;
+      }
+    }
+  *cmdcur=0;
+  return(NULL);
+  }
+
+/*
+*  Assert parsed fields directly as an alert
+*
+*    The assertion list is built in reverse order, so the last assignment
+*    to a term wins, as it would in an ALERT command.
+*/
+static void syslogAssert(nbCELL context,NB_MOD_Server *server){
+  NB_MOD_SyslogField *field;
+  nbSET assertion=NULL;
+  nbCELL cell;
+
+  for(field=server->field+server->fields-1;field>=server->field;field--){
+    switch(field->kind){
+      case 'n':
+        cell=nbCellCreateReal(context,field->real);
+        nbAssertionAddTermValue(context,&assertion,field->term->term,cell);
+        nbCellDrop(context,cell);
+        break;
+      case 's':
+        cell=nbCellCreateString(context,field->text);
+        nbAssertionAddTermValue(context,&assertion,field->term->term,cell);
+        nbCellDrop(context,cell);
+        break;
+      default:
+        nbAssertionAddTermValue(context,&assertion,field->term->term,NB_CELL_UNKNOWN);
+      }
+    }
+  nbAssert(context,assertion,1);
+  nbListEmpty(context,&assertion);
+  nbRuleReact();
+  nbNodeAlert(context,context);
+  }
+
+/*
+*  Process a syslog message
+*
+*    The text must be null terminated at text+len.
+*/
+static void syslogMessage(nbCELL context,NB_MOD_Server *server,char *text,size_t len){
+  char cmd[NB_BUFSIZE],*msg=text,*errmsg;
+
+  server->messages++;
+  if(server->rfc5424){
+    if(server->terms>=NB_MOD_SYSLOG_TERM_MAX) syslogTermFlush(context,server);
+    if(syslogParse(context,server,text,text+len,&msg)==0){
+      server->parsed++;
+      if(!server->echo && !server->trace) syslogAssert(context,server);
+      else if((errmsg=syslogCommand(server,cmd,sizeof(cmd)))!=NULL) nbLogMsg(context,0,'E',"%s",errmsg);
+      else{
+        if(server->trace && !server->echo) nbLogMsg(context,0,'I',"%s",cmd);
+        nbCmd(context,cmd,server->echo);
+        }
+      }
+    else if(server->trace) nbLogMsg(context,0,'T',"Message not in RFC 5424 format");
+    }
+  if(server->translator) nbTranslatorExecute(context,server->translator,msg);
+  }
+
 /*==================================================================================
 *
 *  M E T H O D S
@@ -320,19 +746,143 @@ typedef struct NB_MOD_SERVER{      /* syslog.server node descriptor */
 static void serverRead(nbCELL context,int serverSocket,void *handle){
   NB_MOD_Server *server=handle;
   char buffer[NB_BUFSIZE];
-  size_t buflen=NB_BUFSIZE;
+  size_t buflen=NB_BUFSIZE-1;
   int  len;
   unsigned short rport;
   char daddr[40],raddr[40];
 
-  nbIpGetSocketAddrString(serverSocket,daddr);
   len=nbIpGetDatagram(context,serverSocket,&server->sourceAddr,&rport,(unsigned char *)buffer,buflen);
   while(len<0 && errno==EINTR) len=nbIpGetDatagram(context,serverSocket,&server->sourceAddr,&rport,(unsigned char *)buffer,buflen);
   if(len<0) return;  // 2012-12-18 eat - CID 751566
-  if(server->trace) nbLogMsg(context,0,'I',"Datagram %s:%5.5u -> %s len=%d",nbIpGetAddrString(raddr,server->sourceAddr),rport,daddr,len);
+  if(server->trace){
+    nbIpGetSocketAddrString(serverSocket,daddr);
+    nbLogMsg(context,0,'I',"Datagram %s:%5.5u -> %s len=%d",nbIpGetAddrString(raddr,server->sourceAddr),rport,daddr,len);
+    }
   if(server->dump) nbLogDump(context,buffer,len);
   *(buffer+len)=0;  // make sure we have a null terminator
-  nbTranslatorExecute(context,server->translator,buffer);
+  syslogMessage(context,server,buffer,len);
+  }
+
+/*
+*  Close a TCP connection
+*/
+static void serverClose(nbCELL context,NB_MOD_Server *server,NB_MOD_SyslogConn *conn){
+  NB_MOD_SyslogConn **connP;
+
+  for(connP=&server->conn;*connP!=NULL && *connP!=conn;connP=&(*connP)->next);
+  if(*connP) *connP=conn->next;
+  nbListenerRemove(context,conn->socket);
+  nbIpCloseSocket(conn->socket);
+  if(server->trace) nbLogMsg(context,0,'I',"Connection from %s closed",conn->addr);
+  nbFree(conn,sizeof(NB_MOD_SyslogConn));
+  }
+
+/*
+*  Read from a TCP connection
+*
+*    The socket is non-blocking, so we process the complete frames we have
+*    and keep a partial frame until the next read.  An octet counted frame
+*    that is too large for the buffer is skipped.
+*/
+static void serverReadTcp(nbCELL context,int socket,void *handle){
+  NB_MOD_SyslogConn *conn=handle;
+  NB_MOD_Server *server=conn->server;
+  char *cursor,*end,*digit,*frame,save;
+  size_t frameLen;
+  int len,counted;
+
+  len=recv(socket,conn->buffer+conn->len,sizeof(conn->buffer)-1-conn->len,0);
+  if(len<0 && (errno==EAGAIN || errno==EWOULDBLOCK || errno==EINTR)) return;
+  if(len<=0){
+    serverClose(context,server,conn);
+    return;
+    }
+  if(server->dump) nbLogDump(context,conn->buffer+conn->len,len);
+  conn->len+=len;
+  cursor=conn->buffer;
+  end=conn->buffer+conn->len;
+  while(cursor<end){
+    if(conn->skip){
+      frameLen=end-cursor<conn->skip ? end-cursor : conn->skip;
+      conn->skip-=frameLen;
+      cursor+=frameLen;
+      continue;
+      }
+    counted=(*cursor>='1' && *cursor<='9');
+    if(counted){  // octet counting
+      frameLen=0;
+      for(digit=cursor;digit<end && *digit>='0' && *digit<='9' && digit-cursor<9;digit++) frameLen=frameLen*10+*digit-'0';
+      if(digit>=end) break;
+      if(*digit!=' '){
+        nbLogMsg(context,0,'E',"Syslog frame length not terminated by a space from %s - closing connection",conn->addr);
+        serverClose(context,server,conn);
+        return;
+        }
+      frame=digit+1;
+      if(frameLen>sizeof(conn->buffer)-16){
+        nbLogMsg(context,0,'W',"Syslog frame of %u bytes from %s exceeds buffer - skipped",(unsigned int)frameLen,conn->addr);
+        conn->skip=frameLen;
+        cursor=frame;
+        continue;
+        }
+      if(end-frame<frameLen) break;
+      }
+    else{  // non-transparent framing
+      frame=cursor;
+      if((digit=memchr(cursor,'\n',end-cursor))==NULL){
+        if(cursor>conn->buffer || conn->len<sizeof(conn->buffer)-1) break;
+        digit=end;  // buffer full, so take what we have
+        }
+      frameLen=digit-frame;
+      if(frameLen>0 && *(frame+frameLen-1)=='\r') frameLen--;
+      if(digit<end) digit++;
+      if(frameLen==0){
+        cursor=digit;
+        continue;
+        }
+      }
+    cursor=frame+frameLen;
+    save=*cursor;
+    *cursor=0;
+    syslogMessage(context,server,frame,frameLen);
+    *cursor=save;
+    if(!counted) cursor=digit;  // skip LF
+    }
+  conn->len=end-cursor;
+  if(conn->len>0 && cursor>conn->buffer) memmove(conn->buffer,cursor,conn->len);
+  }
+
+/*
+*  Accept a TCP connection
+*/
+static void serverAccept(nbCELL context,int serverSocket,void *handle){
+  NB_MOD_Server *server=handle;
+  NB_MOD_SyslogConn *conn;
+  NB_IpChannel *channel;
+
+  channel=nbIpAlloc();
+  if(nbIpAccept(channel,serverSocket)<0){
+    nbIpFree(channel);
+    return;
+    }
+#if !defined(WIN32)
+  if(fcntl(channel->socket,F_SETFL,fcntl(channel->socket,F_GETFL)|O_NONBLOCK)){
+    nbLogMsg(context,0,'E',"Unable to make socket non-blocking - %s",strerror(errno));
+    nbIpClose(channel);
+    nbIpFree(channel);
+    return;
+    }
+#endif
+  conn=nbAlloc(sizeof(NB_MOD_SyslogConn));
+  memset(conn,0,sizeof(NB_MOD_SyslogConn));
+  conn->server=server;
+  conn->socket=channel->socket;
+  strcpy(conn->addr,channel->ipaddr);
+  nbIpFree(channel);
+  conn->next=server->conn;
+  server->conn=conn;
+  if(server->trace) nbLogMsg(context,0,'I',"Connection from %s",conn->addr);
+  nbListenerAdd(context,conn->socket,conn,serverReadTcp);
   }
 
 /*
@@ -340,12 +890,13 @@ static void serverRead(nbCELL context,int serverSocket,void *handle){
 *
 *    define <term> node <skill>("<translator>",[<binding>])[:<text>]
 *
-*    <translator> - name of translator file
-*    <binding>    - port_number or "interface_address[:port_number]"
+*    <translator> - name of translator file or "" for none
+*    <binding>    - port_number or "[udp://|tcp://]interface_address[:port_number]"
 *    <text>       - flag keywords
 *                     trace   - display input packets
 *                     dump    - display dump of syslog packets
-*                     silent  - don't echo generated NodeBrain commands 
+*                     silent  - don't echo generated NodeBrain commands
+*                     rfc5424 - parse RFC 5424 messages and assert fields
 *
 *    define syslog node syslog.server("syslog.nbx");
 *    define syslog node syslog.server("syslog.nbx"):dump,silent;
@@ -353,6 +904,7 @@ static void serverRead(nbCELL context,int serverSocket,void *handle){
 *    define syslog node syslog.server("syslog.nbx",50162);
 *    define syslog node syslog.server("syslog.nbx","127.0.0.1:50162");
 *    define syslog node syslog.server("syslog.nbx","127.0.0.1:50162"):silent;
+*    define syslog node syslog.server("","tcp://127.0.0.1:50601"):rfc5424,silent;
 */
 static void *serverConstruct(nbCELL context,void *skillHandle,nbCELL arglist,char *text){
   NB_MOD_Server *server;
@@ -362,11 +914,11 @@ static void *serverConstruct(nbCELL context,void *skillHandle,nbCELL arglist,cha
   double r,d;
   char interfaceAddr[512];
   unsigned int port=514;
-  int type,trace=0,dump=0,echo=1;
+  int type,trace=0,dump=0,echo=1,tcp=0,rfc5424=0;
   int len;
   char *str;
   char *transfilename;
-  nbCELL translator;
+  nbCELL translator=NULL;
   char *uri="";;
 
   *interfaceAddr=0;
@@ -383,10 +935,12 @@ static void *serverConstruct(nbCELL context,void *skillHandle,nbCELL arglist,cha
     return(NULL);
     }
   transfilename=nbCellGetString(context,cell);
-  translator=nbTranslatorCompile(context,0,transfilename);
-  if(translator==NULL){
-    nbLogMsg(context,0,'E',"Unable to load translator '%s'",transfilename);
-    return(NULL);
+  if(*transfilename){  // 2026-10-18 eat 0.9.04 - translator is optional with rfc5424 option
+    translator=nbTranslatorCompile(context,0,transfilename);
+    if(translator==NULL){
+      nbLogMsg(context,0,'E',"Unable to load translator '%s'",transfilename);
+      return(NULL);
+      }
     }
   cell=nbListGetCellValue(context,&argSet);
   if(cell!=NULL){
@@ -396,6 +950,10 @@ static void *serverConstruct(nbCELL context,void *skillHandle,nbCELL arglist,cha
       uri=strdup(str);
       if(!uri) nbExit("serverConstruct: Out of memory - terminating");
       if(strncmp(str,"udp://",6)==0) str+=6;  // allow for uri
+      else if(strncmp(str,"tcp://",6)==0){    // 2026-10-18 eat 0.9.04 - RFC 6587 transport
+        str+=6;
+        tcp=1;
+        }
       delim=strchr(str,':');
       if(delim==NULL) len=strlen(str);
       else len=delim-str;
@@ -410,7 +968,7 @@ static void *serverConstruct(nbCELL context,void *skillHandle,nbCELL arglist,cha
         return(NULL);
         }
       strncpy(interfaceAddr,str,len);
-      *(interfaceAddr+len)=0; 
+      *(interfaceAddr+len)=0;
       if(delim!=NULL){
         delim++;
         port=(unsigned int)atoi(delim);
@@ -447,13 +1005,19 @@ static void *serverConstruct(nbCELL context,void *skillHandle,nbCELL arglist,cha
     *delim=0;
     if(strcmp(cursor,"trace")==0){trace=1;}
     else if(strcmp(cursor,"dump")==0){trace=1;dump=1;}
-    else if(strcmp(cursor,"silent")==0) echo=0; 
+    else if(strcmp(cursor,"silent")==0) echo=0;
+    else if(strcmp(cursor,"rfc5424")==0) rfc5424=1;
     *delim=saveDelim;
     cursor=delim;
     if(*cursor==',') cursor++;
     while(*cursor==' ' || *cursor==',') cursor++;
     }
+  if(translator==NULL && !rfc5424){
+    nbLogMsg(context,0,'E',"Translator configuration file required unless rfc5424 option is specified");
+    return(NULL);
+    }
   server=nbAlloc(sizeof(NB_MOD_Server));
+  memset(server,0,sizeof(NB_MOD_Server));
   server->uri=uri;
   server->socket=0;
   strcpy(server->interfaceAddr,interfaceAddr);
@@ -462,6 +1026,8 @@ static void *serverConstruct(nbCELL context,void *skillHandle,nbCELL arglist,cha
   server->trace=trace;
   server->dump=dump;
   server->echo=echo;
+  server->tcp=tcp;
+  server->rfc5424=rfc5424;
   nbLogMsg(context,0,'I',"calling nbListenerEnableOnDaemon");
   nbListenerEnableOnDaemon(context);  // sign up to enable when we daemonize
   return(server);
@@ -474,8 +1040,18 @@ static void *serverConstruct(nbCELL context,void *skillHandle,nbCELL arglist,cha
 */
 static int serverEnable(nbCELL context,void *skillHandle,NB_MOD_Server *server){
   int fd;
+  if(server->tcp){  // 2026-10-18 eat 0.9.04
+    if((fd=nbIpListen(server->interfaceAddr,server->port))<0){
+      nbLogMsg(context,0,'E',"Unable to listen on TCP port %u",server->port);
+      return(1);
+      }
+    server->socket=fd;
+    nbListenerAdd(context,server->socket,server,serverAccept);
+    nbLogMsg(context,0,'I',"Listening on %s for syslog",server->uri);
+    return(0);
+    }
   if((fd=nbIpGetUdpServerSocket(context,server->interfaceAddr,server->port))<0){  // 2012-12-27 eat 0.8.13 - CID 761574
-    nbLogMsg(context,0,'E',"Unable to listen on port %s\n",server->port);
+    nbLogMsg(context,0,'E',"Unable to listen on port %u",server->port);  // 2026-10-18 eat 0.9.04 - was %s
     return(1);
     }
   server->socket=fd;
@@ -488,10 +1064,11 @@ static int serverEnable(nbCELL context,void *skillHandle,NB_MOD_Server *server){
 
 /*
 *  disable method
-* 
+*
 *    disable <node>
 */
 static int serverDisable(nbCELL context,void *skillHandle,NB_MOD_Server *server){
+  while(server->conn) serverClose(context,server,server->conn);  // 2026-10-18 eat 0.9.04
   nbListenerRemove(context,server->socket);
 #if defined(WIN32)
   closesocket(server->socket);
@@ -506,12 +1083,27 @@ static int serverDisable(nbCELL context,void *skillHandle,NB_MOD_Server *server)
 *  command() method
 *
 *    <node>[(<args>)][:<text>]
+*
+*    <node>:message <syslog_message>   - process a message as if received
+*    <node>:stats                      - display message counters
 */
 static int *serverCommand(nbCELL context,void *skillHandle,NB_MOD_Server *server,nbCELL arglist,char *text){
+  char *cursor=text,*verb;
+
   if(server->trace){
     nbLogMsg(context,0,'T',"serverCommand: text=[%s]\n",text);
     }
-  /* insert command parsing code here */
+  while(*cursor==' ') cursor++;
+  verb=cursor;
+  while(*cursor && *cursor!=' ' && *cursor!=';') cursor++;
+  if(cursor-verb==7 && strncmp(verb,"message",7)==0){  // 2026-10-18 eat 0.9.04
+    if(*cursor==' ') cursor++;
+    syslogMessage(context,server,cursor,strlen(cursor));
+    }
+  else if(cursor-verb==5 && strncmp(verb,"stats",5)==0){
+    nbLogMsg(context,0,'I',"Messages: %lu received, %lu parsed, %u terms cached",server->messages,server->parsed,server->terms);
+    }
+  else if(cursor>verb) nbLogMsg(context,0,'E',"Verb \"%.*s\" not recognized - expecting \"message\" or \"stats\"",(int)(cursor-verb),verb);
   return(0);
   }
 
@@ -523,6 +1115,7 @@ static int *serverCommand(nbCELL context,void *skillHandle,NB_MOD_Server *server
 static int serverDestroy(nbCELL context,void *skillHandle,NB_MOD_Server *server){
   nbLogMsg(context,0,'T',"serverDestroy called");
   if(server->socket!=0) serverDisable(context,skillHandle,server);
+  syslogTermFlush(context,server);
   nbFree(server,sizeof(NB_MOD_Server));
   return(0);
   }
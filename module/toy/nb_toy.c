@@ -35,9 +35,10 @@
 *
 *   The toy module provides three trivial skills and illustrates how to use
 *   the nbBind() function to declare skills that don't conform to the naming
-*   standards. 
+*   standards.  A post skill illustrates worker threads handing calls to the
+*   main thread.
 *
-*     nb_toy.c  - Trival skill examples: sum, add, and count
+*     nb_toy.c  - Trival skill examples: sum, add, count, and post
 *
 *   For more complicated examples, refer to any of the node modules in the
 *   distribution.
@@ -106,10 +107,14 @@
 * 2005-05-14 eat 0.6.3  countBind() and addBind() updated for moduleHandle
 * 2010-02-25 eat 0.7.9  Cleaned up -Wall warning messages
 * 2012-10-13 eat 0.8.12 Replaced malloc/free with nbAlloc/nbFree
+* 2026-10-18 eat 0.9.04 Included post skill to exercise the medulla post queue
 *=============================================================================
 */
 #include "config.h"
 #include <nb/nb.h>
+#if !defined(_WINDOWS)
+#include <sched.h>
+#endif
 
 #if defined(_WINDOWS)
 BOOL WINAPI DllMain(HINSTANCE hinstDLL,DWORD fdwReason,LPVOID lpvReserved){
@@ -546,3 +551,162 @@ extern void *countBind(nbCELL context,void *moduleHandle,nbCELL skill,nbCELL arg
   nbSkillSetMethod(context,skill,NB_NODE_DESTROY,countDestroy);
   return(NULL);
   }
+
+#if !defined(_WINDOWS)
+/*========================================================================
+* Post skill
+*
+* Description:
+*
+*   The post skill illustrates nbMedullaPost(), used by worker threads to
+*   hand calls to the main thread, where they may use the interpreter.  The
+*   command starts worker threads that each post a numbered sequence of
+*   calls, and waits for the post queue to fill so a worker is sure to see
+*   the full queue return code.  The medulla handles the calls after the
+*   command returns.  When the last call is handled, the results are
+*   asserted in the node's context.
+*
+*       handled  - number of calls handled
+*       ordered  - 1 if each worker's calls arrived in the order posted
+*       full     - 1 if a worker found the queue full
+*
+*       declare toy module /usr/local/lib/nb_toy.so;
+*
+*       define post node toy.post;
+*       post. define r1 on(handled>0) ...
+*       post:4,100000   # 4 workers posting 100000 calls each
+*
+*========================================================================
+*/
+
+#define NB_MOD_POST_WORKERS 16   // maximum workers
+
+typedef struct NB_MOD_POSTER NB_MOD_Poster;
+
+typedef struct NB_MOD_POST_WORKER{
+  NB_MOD_Poster *poster;
+  long next;                     // next call number expected by the handler
+  } NB_MOD_PostWorker;
+
+struct NB_MOD_POSTER{
+  nbCELL context;                // node term
+  long calls;                    // calls per worker
+  long total;                    // calls by all workers
+  volatile long posted;          // calls posted by all workers
+  volatile long full;            // times a worker found the queue full
+  long handled;                  // calls handled
+  long disorder;                 // calls handled out of order
+  NB_MOD_PostWorker worker[NB_MOD_POST_WORKERS];
+  };
+
+/*
+*  Post handler - called on the main thread
+*/
+static void postHandler(void *session,void *data){
+  NB_MOD_PostWorker *worker=(NB_MOD_PostWorker *)session;
+  NB_MOD_Poster *poster=worker->poster;
+  char cmd[128];
+
+  if((long)data!=worker->next) poster->disorder++;
+  worker->next=(long)data+1;
+  poster->handled++;
+  if(poster->handled==poster->total){
+    snprintf(cmd,sizeof(cmd),"assert handled=%ld,ordered=%d,full=%d;",
+      poster->handled,poster->disorder==0,poster->full!=0);
+    nbCmd(poster->context,cmd,1);
+    }
+  }
+
+/*
+*  Worker thread
+*/
+static void *postWorker(void *arg){
+  NB_MOD_PostWorker *worker=(NB_MOD_PostWorker *)arg;
+  NB_MOD_Poster *poster=worker->poster;
+  long i;
+
+  for(i=0;i<poster->calls;i++){
+    while(nbMedullaPost(postHandler,worker,(void *)i)==1){  // queue is full
+      __sync_fetch_and_add(&poster->full,1);
+      sched_yield();
+      }
+    __sync_fetch_and_add(&poster->posted,1);
+    }
+  return(NULL);
+  }
+
+/*
+*  construct() method
+*
+*    define <term> node toy.post;
+*/
+static void *postConstruct(nbCELL context,void *skillHandle,nbCELL arglist,char *text){
+  NB_MOD_Poster *poster;
+
+  poster=nbAlloc(sizeof(NB_MOD_Poster));
+  memset(poster,0,sizeof(NB_MOD_Poster));
+  poster->context=context;
+  return(poster);
+  }
+
+/*
+*  command() method
+*
+*    <node>:<workers>,<calls>
+*
+*    post:4,100000
+*/
+static int postCommand(nbCELL context,void *skillHandle,NB_MOD_Poster *poster,nbCELL arglist,char *text){
+  char *cursor=text;
+  long workers,calls;
+  int w;
+
+  if(poster->handled<poster->total){
+    nbLogMsg(context,0,'E',"Calls from the last command are still being handled");
+    return(1);
+    }
+  workers=strtol(cursor,&cursor,10);
+  if(*cursor==',') cursor++;
+  calls=strtol(cursor,&cursor,10);
+  if(workers<1 || workers>NB_MOD_POST_WORKERS || calls<1){
+    nbLogMsg(context,0,'E',"Expecting \"<workers>,<calls>\" with 1 to %d workers",NB_MOD_POST_WORKERS);
+    return(1);
+    }
+  memset(poster->worker,0,sizeof(poster->worker));
+  poster->calls=calls;
+  poster->total=workers*calls;
+  poster->posted=0;
+  poster->full=0;
+  poster->handled=0;
+  poster->disorder=0;
+  for(w=0;w<workers;w++){
+    poster->worker[w].poster=poster;
+    if(nbMedullaWorkerCreate(postWorker,&poster->worker[w])!=0){
+      nbLogMsg(context,0,'E',"Unable to create worker thread - %s",strerror(errno));
+      poster->total=w*calls;  // handle what the workers we have will post
+      return(1);
+      }
+    }
+  // nothing takes calls off the queue until we return
+  while(poster->full==0 && poster->posted<poster->total) sched_yield();
+  return(0);
+  }
+
+/*
+*  destroy() method
+*
+*    undefine <node>
+*/
+static int postDestroy(nbCELL context,void *skillHandle,NB_MOD_Poster *poster){
+  if(poster->handled<poster->total) return(0);  // workers still refer to it
+  nbFree(poster,sizeof(NB_MOD_Poster));
+  return(0);
+  }
+
+extern void *postBind(nbCELL context,void *moduleHandle,nbCELL skill,nbCELL arglist,char *text){
+  nbSkillSetMethod(context,skill,NB_NODE_CONSTRUCT,postConstruct);
+  nbSkillSetMethod(context,skill,NB_NODE_COMMAND,postCommand);
+  nbSkillSetMethod(context,skill,NB_NODE_DESTROY,postDestroy);
+  return(NULL);
+  }
+#endif
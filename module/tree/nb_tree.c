@@ -39,6 +39,7 @@
 *
 *     define table1 node tree;
 *     define table2 node tree:partition;
+*     define table3 node tree:hash;
 *
 *   Command:
 *
@@ -100,6 +101,12 @@
 *      
 *      define r2 on(t2(a,b)); # found because matches head of t2(1,2,3,4)
 *
+*   The "hash" option indexes every level of a tree in a hash table for
+*   exact match lookups.  Because string and number cells are unique by
+*   value, a key is found by cell address in constant time instead of
+*   by a binary search of the level.  The binary trees are still
+*   maintained for ordered traversal and partition matching.
+*
 *=============================================================================
 * Change History:
 *
@@ -113,6 +120,9 @@
 * 2012-12-18 eat 0.8.13 Checker updates
 * 2013-12-27 eat 0.8.13 Removed commented out function treeFind
 * 2014-12-05 eat 0.9.03 Added safe mode restriction on store command
+* 2026-10-18 eat 0.9.04 Added save and restore methods for checkpoints
+* 2026-10-18 eat 0.9.04 Added hash option and key value comparison without API calls
+* 2026-10-18 eat 0.9.04 Added bench command to measure assert and evaluate rates
 *=============================================================================
 */
 #include "config.h"
@@ -134,102 +144,262 @@ BOOL WINAPI DllMain(HINSTANCE hinstDLL,DWORD fdwReason,LPVOID lpvReserved){
 
 /* Tree skill and node structures */
 
+typedef union BTREE_DATA{     // key value for ordered comparison
+  char   *string;              // string key - owned by key cell
+  double real;                 // real key
+  } BTreeData;
+
 typedef struct BTREE_NODE{
   NB_TreeNode bnode;           // binary tree node
   nbCELL value;                // assigned value
   struct BTREE_NODE *root ;    // root node for next column
+  int    type;                 // key cell type (order and hash options)
+  BTreeData data;              // key value
+  struct BTREE_NODE **level;   // address of level root pointer - qualifies key in hash (hash option)
+  struct BTREE_NODE *hashNext; // next node in hash bucket
   } BTreeNode;
 
+// Node size by option - fields not used are not allocated
+#define BTREE_NODE_SIZE_PLAIN    offsetof(BTreeNode,type)
+#define BTREE_NODE_SIZE_ORDER    offsetof(BTreeNode,level)
+#define BTREE_NODE_SIZE_HASH     sizeof(BTreeNode)
+
 typedef struct BTREE{
   int    options;              // option flags
+  int    nodeSize;             // size of nodes allocated for options
   nbCELL notfound;             // default value for missing index (defaults to Unknown)
   nbCELL found;                // default value for partial rows (defaults to notfound)
   struct BTREE_NODE *root;
+  struct BTREE_NODE **hash;    // hash vector of nodes by level and key (hash option)
+  unsigned int hashSize;       // number of hash buckets - power of 2
+  unsigned int hashCount;      // number of nodes in hash
   } BTree;
 
 #define BTREE_OPTION_TRACE       1  // use closed world assumption
 #define BTREE_OPTION_ORDER       2  // Order keys by value (otherwise by address)
 #define BTREE_OPTION_PARTITION   4  // Match on highest value <= argument
+#define BTREE_OPTION_HASH        8  // Index keys in hash table for exact match
+
+#define BTREE_HASH_SIZE        256  // initial hash size
 
 typedef struct BTREE_SKILL{
   char trace;                    /* trace option */
   } BTreeSkill;
 
+typedef struct BTREE_KEY{        // argument key resolved for comparison
+  nbCELL cell;                   // key cell
+  int    type;                   // key cell type
+  BTreeData data;                // key value
+  } BTreeKey;
+
+/*
+*  Resolve a key cell for comparison
+*
+*    The type and value are obtained once for an argument, and saved in
+*    the node when inserted, so a search doesn't call the API at each node.
+*    Trees ordered by address only need the cell.
+*/
+static void treeKeySet(nbCELL context,BTree *tree,BTreeKey *key,nbCELL cell){
+  key->cell=cell;
+  if(tree->nodeSize==BTREE_NODE_SIZE_PLAIN) return;
+  key->type=nbCellGetType(context,cell);
+  if(key->type==NB_TYPE_STRING) key->data.string=nbCellGetString(context,cell);
+  else if(key->type==NB_TYPE_REAL) key->data.real=nbCellGetReal(context,cell);
+  else key->data.string=NULL;
+  }
 
-// NOTE: This compare function should be part of the NodeBrain API
 /*
-*  Compare two cells
+*  Compare an argument key to a node key
+*
+*    Numbers are less than unrecognized types, which are less than strings.
+*    Cells of unrecognized type are ordered by address.
 *
 *  Return:
-*     -3 c1<c2 because c1 is not recognized and c2 is string
-*     -2 c1<c2 because c1 is number and c2 isn't
-*     -1 c1<c2 
-*      0 c1=c2 string=string, number=number, or both have unrecognized types
-*      1 c1>c2
-*      2 c1>c2 because c1 is string and c2 isn't
-*      3 c1>c2 because c1 is not recognized and c2 is number
+*     <0 key<node
+*      0 key=node
+*     >0 key>node
 */
-static int treeCompare(nbCELL context,nbCELL c1,nbCELL c2){
-  int c1Type,c2Type;
-  char *c1Str,*c2Str;
-  double c1Real,c2Real;
-
-  c1Type=nbCellGetType(context,c1);
-  c2Type=nbCellGetType(context,c2);
-  if(c1Type==NB_TYPE_STRING){
-    if(c2Type==NB_TYPE_STRING){
-      c1Str=nbCellGetString(context,c1);
-      c2Str=nbCellGetString(context,c2);
-      return(strcmp(c1Str,c2Str));
-      }
-    else return(2);
-    }
-  else if(c1Type==NB_TYPE_REAL){
-    if(c2Type==NB_TYPE_REAL){
-      c1Real=nbCellGetReal(context,c1);
-      c2Real=nbCellGetReal(context,c2);
-      if(c1Real<c2Real) return(-1);
-      else if(c1Real==c2Real) return(0);
-      else return(1);
+static int treeCompare(BTreeKey *key,BTreeNode *node){
+  if(key->type==NB_TYPE_STRING){
+    if(node->type==NB_TYPE_STRING) return(strcmp(key->data.string,node->data.string));
+    return(1);
+    }
+  if(key->type==NB_TYPE_REAL){
+    if(node->type!=NB_TYPE_REAL) return(-1);
+    if(key->data.real<node->data.real) return(-1);
+    if(key->data.real>node->data.real) return(1);
+    return(0);
+    }
+  if(node->type==NB_TYPE_STRING) return(-1);
+  if(node->type==NB_TYPE_REAL) return(1);
+  if(key->cell<(nbCELL)node->bnode.key) return(-1);
+  if(key->cell>(nbCELL)node->bnode.key) return(1);
+  return(0);
+  }
+
+/*
+*  Hash table of nodes by level and key
+*
+*    A single table for the tree is used instead of a table for each level,
+*    because most levels below the first have few nodes.  The level is
+*    identified by the address of the root pointer for the level.
+*/
+static unsigned int treeHashIndex(BTree *tree,BTreeNode **level,nbCELL key){
+  size_t h;
+
+  h=((size_t)level>>3)*31+((size_t)key>>3);
+  h^=h>>11;
+  h*=2654435761u;
+  h^=h>>15;
+  return(h&(tree->hashSize-1));
+  }
+
+static void treeHashInit(BTree *tree){
+  tree->hashSize=BTREE_HASH_SIZE;
+  tree->hashCount=0;
+  tree->hash=(BTreeNode **)nbAlloc(tree->hashSize*sizeof(BTreeNode *));
+  memset(tree->hash,0,tree->hashSize*sizeof(BTreeNode *));
+  }
+
+static BTreeNode *treeHashFind(BTree *tree,BTreeNode **level,nbCELL key){
+  BTreeNode *node;
+
+  for(node=tree->hash[treeHashIndex(tree,level,key)];node!=NULL;node=node->hashNext)
+    if(node->bnode.key==(void *)key && node->level==level) return(node);
+  return(NULL);
+  }
+
+static void treeHashInsert(BTree *tree,BTreeNode *node){
+  BTreeNode **oldHash=tree->hash,*entry,*next,**bucket;
+  unsigned int oldSize=tree->hashSize,i;
+
+  if(tree->hashCount>=tree->hashSize){  // double the size when the average chain reaches 1
+    tree->hashSize*=2;
+    tree->hash=(BTreeNode **)nbAlloc(tree->hashSize*sizeof(BTreeNode *));
+    memset(tree->hash,0,tree->hashSize*sizeof(BTreeNode *));
+    for(i=0;i<oldSize;i++){
+      for(entry=oldHash[i];entry!=NULL;entry=next){
+        next=entry->hashNext;
+        bucket=&tree->hash[treeHashIndex(tree,entry->level,(nbCELL)entry->bnode.key)];
+        entry->hashNext=*bucket;
+        *bucket=entry;
+        }
       }
-    else return(-2);
+    nbFree(oldHash,oldSize*sizeof(BTreeNode *));
     }
-  else{
-    if(c2Type==NB_TYPE_STRING) return(3);
-    else if(c2Type==NB_TYPE_REAL) return(-3);
-    else return(0);
+  bucket=&tree->hash[treeHashIndex(tree,node->level,(nbCELL)node->bnode.key)];
+  node->hashNext=*bucket;
+  *bucket=node;
+  tree->hashCount++;
+  }
+
+static void treeHashRemove(BTree *tree,BTreeNode *node){
+  BTreeNode **nodeP;
+
+  nodeP=&tree->hash[treeHashIndex(tree,node->level,(nbCELL)node->bnode.key)];
+  while(*nodeP!=NULL && *nodeP!=node) nodeP=&(*nodeP)->hashNext;
+  if(*nodeP==NULL) return;
+  *nodeP=node->hashNext;
+  tree->hashCount--;
+  }
+
+static int treeNodeSize(int options){
+  if(options&BTREE_OPTION_HASH) return(BTREE_NODE_SIZE_HASH);
+  if(options&BTREE_OPTION_ORDER) return(BTREE_NODE_SIZE_ORDER);
+  return(BTREE_NODE_SIZE_PLAIN);
+  }
+
+/*
+*  Allocate a node for a key at a level
+*
+*    The node takes the caller's reference to the key cell.  The caller
+*    links the node into the level, with nbTreeInsert() or directly when the
+*    level is empty.
+*/
+static BTreeNode *treeNodeNew(BTree *tree,BTreeNode **level,BTreeKey *key){
+  BTreeNode *node;
+
+  node=nbAlloc(tree->nodeSize);
+  memset(node,0,tree->nodeSize);
+  node->bnode.key=(void *)key->cell;
+  if(tree->nodeSize==BTREE_NODE_SIZE_PLAIN) return(node);
+  node->type=key->type;
+  node->data=key->data;
+  if(tree->hash!=NULL){
+    node->level=level;
+    treeHashInsert(tree,node);
     }
+  return(node);
   }
 
+/*
+*  Locate a key at a level - sets path for nbTreeInsert() or nbTreeRemove()
+*/
+static BTreeNode *treeLocate(BTree *tree,NB_TreePath *path,BTreeKey *key,BTreeNode **rootP){
+  BTreeNode *node;
+  NB_TreeNode **nodeP;
+  int depth=0,cmp;
 
-// Find the next argument
-//
-// argSetP - address of pointer (argSet) returned by call to nbListOpen(context,&argSet);
-//           This is a handle to the remaining arguments
+  if(!(tree->options&BTREE_OPTION_ORDER)) return(nbTreeLocate(path,key->cell,(NB_TreeNode **)rootP));
+  path->key=key->cell;  // save key for insertions
+  path->rootP=nodeP=path->balanceP=(NB_TreeNode **)rootP;
+  path->balanceDepth=1;
+  path->node[depth]=(NB_TreeNode *)rootP; // this depends on the left pointer being first
+  path->step[depth++]=0;
+  for(node=*rootP;node!=NULL;node=(BTreeNode *)*nodeP){
+    if((cmp=treeCompare(key,node))==0) break;
+    cmp=cmp>0;          // 0 left, 1 right
+    if(node->bnode.balance!=0) path->balanceP=nodeP, path->balanceDepth=depth;
+    path->node[depth]=(NB_TreeNode *)node;
+    if((path->step[depth++]=cmp)) nodeP=&node->bnode.right;
+    else nodeP=&node->bnode.left;
+    }
+  path->nodeP=nodeP;
+  path->depth=depth;
+  return(node);
+  }
+
+/*
+*  Find a key at a level
+*
+*    With the partition option, the node with the highest key less than
+*    or equal to the argument is returned when there is no exact match.
+*/
+static BTreeNode *treeFind(BTree *tree,BTreeKey *key,BTreeNode **rootP){
+  BTreeNode *node,*floor=NULL;
+  int cmp;
+
+  if(tree->hash!=NULL){
+    if((node=treeHashFind(tree,rootP,key->cell))!=NULL || !(tree->options&BTREE_OPTION_PARTITION)) return(node);
+    }
+  if(!(tree->options&BTREE_OPTION_ORDER)) return((BTreeNode *)nbTreeFind(key->cell,(NB_TreeNode *)*rootP));
+  for(node=*rootP;node!=NULL;){
+    if((cmp=treeCompare(key,node))==0) return(node);
+    if(cmp>0){
+      floor=node;
+      node=(BTreeNode *)node->bnode.right;
+      }
+    else node=(BTreeNode *)node->bnode.left;
+    }
+  if(tree->options&BTREE_OPTION_PARTITION) return(floor);
+  return(NULL);
+  }
+
+// Find an argument at a level
 //
-// ptr     - This is a pointer to a node pointer. This value my be useful when the argument
-//           is not found in addition to when it is found, because it is positioned to where
-//           the node should be inserted if not found.
+// rootP   - Address of the root pointer for the level
 //
-// Returns node pointer - NULL if not found.
+// Returns node pointer - NULL if not found.  Partition trees require an
+// exact match here.
 //
-static BTreeNode *treeFindArg(nbCELL context,BTree *tree,nbCELL argCell,void **ptrP){
-  BTreeNode **nodeP=*ptrP,*node=*nodeP;
-  int rc;
+static BTreeNode *treeFindArg(nbCELL context,BTree *tree,nbCELL argCell,BTreeNode **rootP){
+  BTreeKey key;
+  BTreeNode *node;
 
-  rc=1;
-  while(node!=NULL && rc!=0){
-    if(tree->options&BTREE_OPTION_ORDER)
-      rc=treeCompare(context,node->bnode.key,argCell);
-    else if((nbCELL)node->bnode.key<argCell) rc=-1;
-    else if((nbCELL)node->bnode.key>argCell) rc=1;
-    else rc=0;
-    if(rc<0) *ptrP=(BTreeNode *)&node->bnode.right;
-    else if(rc>0) *ptrP=(BTreeNode *)&node->bnode.left;
-    nodeP=*ptrP;
-    node=*nodeP;
-    }
-  return(node);  
+  treeKeySet(context,tree,&key,argCell);
+  node=treeFind(tree,&key,rootP);
+  if(node!=NULL && (tree->options&BTREE_OPTION_PARTITION) && treeCompare(&key,node)!=0) return(NULL);
+  return(node);
   }
 
 //===========================================================================================================
@@ -264,6 +434,7 @@ static void *treeConstruct(nbCELL context,BTreeSkill *skillHandle,nbCELL arglist
     if(strcmp(ident,"trace")==0) options|=BTREE_OPTION_TRACE;
     else if(strcmp(ident,"order")==0) options|=BTREE_OPTION_ORDER;
     else if(strcmp(ident,"partition")==0) options|=BTREE_OPTION_PARTITION|BTREE_OPTION_ORDER;
+    else if(strcmp(ident,"hash")==0) options|=BTREE_OPTION_HASH;
     else if(strcmp(ident,"found")==0 || strcmp(ident,"notfound")==0){
       if(*cursor!='='){
         nbLogMsg(context,0,'E',"Expecting '=' at \"%s\".",cursor);
@@ -296,9 +467,14 @@ static void *treeConstruct(nbCELL context,BTreeSkill *skillHandle,nbCELL arglist
   if(found==NULL) found=notfound;
   tree=(BTree *)nbAlloc(sizeof(BTree));
   tree->options=options;
+  tree->nodeSize=treeNodeSize(options);
   tree->notfound=notfound;
   tree->found=found;
   tree->root=NULL;
+  tree->hash=NULL;
+  tree->hashSize=0;
+  tree->hashCount=0;
+  if(options&BTREE_OPTION_HASH) treeHashInit(tree);
   return(tree);
   }
 
@@ -306,12 +482,13 @@ static void *treeConstruct(nbCELL context,BTreeSkill *skillHandle,nbCELL arglist
 // Recursively remove all nodes in a binary tree
 // 
 static void *removeTree(nbCELL context,BTree *tree,BTreeNode *node){
+  if(tree->hash!=NULL) treeHashRemove(tree,node);
   node->bnode.key=nbCellDrop(context,node->bnode.key);
   if(node->value!=NULL) node->value=nbCellDrop(context,node->value);
   if(node->bnode.left!=NULL) node->bnode.left=removeTree(context,tree,(BTreeNode *)node->bnode.left);
   if(node->bnode.right!=NULL) node->bnode.right=removeTree(context,tree,(BTreeNode *)node->bnode.right);
   if(node->root!=NULL) node->root=removeTree(context,tree,node->root);
-  nbFree(node,sizeof(BTreeNode));
+  nbFree(node,tree->nodeSize);
   return(NULL);
   }
 
@@ -326,6 +503,7 @@ static void *removeTree(nbCELL context,BTree *tree,BTreeNode *node){
 static int removeNode(nbCELL context,BTree *tree,BTreeNode **nodeP,nbSET *argSetP){
   NB_TreePath path;
   BTreeNode *node=*nodeP;
+  BTreeKey key;
   nbCELL argCell;
   int code=1;
 
@@ -337,9 +515,8 @@ static int removeNode(nbCELL context,BTree *tree,BTreeNode **nodeP,nbSET *argSet
     }
   else{
     if(node==NULL) return(0);  // can't match to empty tree
-    if(tree->options&BTREE_OPTION_ORDER) 
-      node=(BTreeNode *)nbTreeLocateValue(&path,argCell,(NB_TreeNode **)nodeP,treeCompare,context);
-    else node=nbTreeLocate(&path,argCell,(NB_TreeNode **)nodeP);   
+    treeKeySet(context,tree,&key,argCell);
+    node=treeLocate(tree,&path,&key,nodeP);
     nbCellDrop(context,argCell);
     if(node==NULL) return(0);          // didn't find argument
     switch(removeNode(context,tree,&node->root,argSetP)){
@@ -353,9 +530,10 @@ static int removeNode(nbCELL context,BTree *tree,BTreeNode **nodeP,nbSET *argSet
   if(node->value!=NULL) node->value=nbCellDrop(context,node->value); // release value
   if(node->root!=NULL) return(0);  
   nbTreeRemove(&path);  // Remove node from binary search tree
+  if(tree->hash!=NULL) treeHashRemove(tree,node);
   if(node->bnode.key!=NULL) node->bnode.key=nbCellDrop(context,(nbCELL)node->bnode.key);  // release key
   //if(node->root!=NULL) node->root =removeTree(context,tree,node->root);
-  nbFree(node,sizeof(BTreeNode));
+  nbFree(node,tree->nodeSize);
   return(code);
   }
 
@@ -375,6 +553,7 @@ static int removeNode(nbCELL context,BTree *tree,BTreeNode **nodeP,nbSET *argSet
 static int treeAssert(nbCELL context,void *skillHandle,BTree *tree,nbCELL arglist,nbCELL value){
   NB_TreePath path;
   BTreeNode *node=NULL,**nodeP=&tree->root;
+  BTreeKey key;
   nbCELL argCell;
   nbSET  argSet=NULL;
 
@@ -388,18 +567,16 @@ static int treeAssert(nbCELL context,void *skillHandle,BTree *tree,nbCELL arglis
   if(argSet==NULL) return(0);
   argCell=nbListGetCellValue(context,&argSet);
   while(argCell!=NULL){
-    if(tree->options&BTREE_OPTION_ORDER) 
-      node=nbTreeLocateValue(&path,argCell,(NB_TreeNode **)nodeP,treeCompare,context);
-    else node=nbTreeLocate(&path,argCell,(NB_TreeNode **)nodeP);
-    if(node==NULL){
-      node=nbAlloc(sizeof(BTreeNode));
-      memset(node,0,sizeof(BTreeNode));
+    treeKeySet(context,tree,&key,argCell);
+    node=NULL;
+    if(tree->hash!=NULL) node=treeHashFind(tree,nodeP,argCell);
+    if(node==NULL && (node=treeLocate(tree,&path,&key,nodeP))==NULL){
+      node=treeNodeNew(tree,nodeP,&key);
       nbTreeInsert(&path,(NB_TreeNode *)node);
       nodeP=&(node->root);
       while((argCell=nbListGetCellValue(context,&argSet))!=NULL){
-        node=nbAlloc(sizeof(BTreeNode));
-        memset(node,0,sizeof(BTreeNode));
-        node->bnode.key=(void *)argCell;
+        treeKeySet(context,tree,&key,argCell);
+        node=treeNodeNew(tree,nodeP,&key);
         *nodeP=node;
         nodeP=&(node->root);
         }
@@ -427,7 +604,8 @@ static int treeAssert(nbCELL context,void *skillHandle,BTree *tree,nbCELL arglis
 static nbCELL treeEvaluate(nbCELL context,BTreeSkill *skillHandle,BTree *tree,nbCELL arglist){
   nbCELL    argCell;
   nbSET     argSet;
-  BTreeNode *node=NULL,*root=tree->root;
+  BTreeKey  key;
+  BTreeNode *node=NULL,**rootP=&tree->root;
 
   if(skillHandle->trace || tree->options&BTREE_OPTION_TRACE){
     nbLogMsg(context,0,'T',"nb_tree::treeEvaluate()");
@@ -442,19 +620,15 @@ static nbCELL treeEvaluate(nbCELL context,BTreeSkill *skillHandle,BTree *tree,nb
   if(argSet==NULL) return(tree->notfound); // tree() returns default value
   argCell=nbListGetCellValue(context,&argSet);
   while(argCell!=NULL && argSet!=NULL){
-    if(tree->options&BTREE_OPTION_ORDER){
-      if(tree->options&BTREE_OPTION_PARTITION)
-        node=nbTreeFindFloor(argCell,(NB_TreeNode *)root,treeCompare,context);
-      else node=nbTreeFindValue(argCell,(NB_TreeNode *)root,treeCompare,context); 
-      }
-    else node=nbTreeFind(argCell,(NB_TreeNode *)root);
+    treeKeySet(context,tree,&key,argCell);
+    node=treeFind(tree,&key,rootP);
     if(node==NULL){
       nbCellDrop(context,argCell);
       return(tree->notfound);
       }
     nbCellDrop(context,argCell);
     argCell=nbListGetCellValue(context,&argSet);
-    root=node->root;
+    rootP=&node->root;
     }
   // matched on arguments
   if(node->value==NULL) return(tree->found);
@@ -594,7 +768,7 @@ static void treeStore(nbCELL context,BTreeSkill *skillHandle,BTree *tree,nbCELL
   BTreeNode *node=NULL;
   nbSET argSet;
   nbCELL argCell;
-  void *ptr;
+  BTreeNode **levelP;
 
 
   if(nb_opt_safe){ // 2014-12-05 eat - prevent store in safe mode for demo
@@ -621,9 +795,9 @@ static void treeStore(nbCELL context,BTreeSkill *skillHandle,BTree *tree,nbCELL
     if(tree->root!=NULL) treeStoreNode(context,skillHandle,tree->root,file,buffer,cursor,buffer+sizeof(buffer));
     }
   else{
-    ptr=&tree->root;
+    levelP=&tree->root;
     if(argSet!=NULL){
-      while((argCell=nbListGetCellValue(context,&argSet))!=NULL && (node=treeFindArg(context,tree,argCell,&ptr))!=NULL){ 
+      while((argCell=nbListGetCellValue(context,&argSet))!=NULL && (node=treeFindArg(context,tree,argCell,levelP))!=NULL){ 
         len=treeStoreValue(context,node->bnode.key,cursor,bufend-cursor);
         if(len<0){
           nbLogMsg(context,0,'L',"Row is too large for buffer or cell type unrecognized: %s\n",buffer);
@@ -636,7 +810,7 @@ static void treeStore(nbCELL context,BTreeSkill *skillHandle,BTree *tree,nbCELL
           cursor++;
           } 
         nbCellDrop(context,argCell);
-        ptr=&node->root;   
+        levelP=&node->root;
         }
       if(argCell!=NULL){
         nbLogMsg(context,0,'E',"Entry not found.");
@@ -649,13 +823,83 @@ static void treeStore(nbCELL context,BTreeSkill *skillHandle,BTree *tree,nbCELL
   fclose(file);
   }
 
+/*
+*  save() method - write tree to a checkpoint
+*
+*    Each level of the tree is written as a count followed by the nodes in
+*    key order.  A node is a key, a flag byte (1 - has value, 2 - has next
+*    column), an optional value, and the next column level.
+*/
+static int treeSaveCount(BTreeNode *node){
+  if(node==NULL) return(0);
+  return(1+treeSaveCount((BTreeNode *)node->bnode.left)+treeSaveCount((BTreeNode *)node->bnode.right));
+  }
+
+static void treeSaveLevel(nbCELL context,BTreeNode *root,nbCHECKPOINT checkpoint);
+
+static void treeSaveNode(nbCELL context,BTreeNode *node,nbCHECKPOINT checkpoint){
+  if(node==NULL) return;
+  treeSaveNode(context,(BTreeNode *)node->bnode.left,checkpoint);
+  nbCheckpointPutCell(context,checkpoint,(nbCELL)node->bnode.key);
+  nbCheckpointPutInt(context,checkpoint,(node->value!=NULL)|(node->root!=NULL)<<1);
+  if(node->value!=NULL) nbCheckpointPutCell(context,checkpoint,node->value);
+  if(node->root!=NULL) treeSaveLevel(context,node->root,checkpoint);
+  treeSaveNode(context,(BTreeNode *)node->bnode.right,checkpoint);
+  }
+
+static void treeSaveLevel(nbCELL context,BTreeNode *root,nbCHECKPOINT checkpoint){
+  nbCheckpointPutInt(context,checkpoint,treeSaveCount(root));
+  treeSaveNode(context,root,checkpoint);
+  }
+
+static int treeSave(nbCELL context,BTreeSkill *skillHandle,BTree *tree,nbCHECKPOINT checkpoint){
+  treeSaveLevel(context,tree->root,checkpoint);
+  return(0);
+  }
+
+/*
+*  restore() method - replace tree with content of a checkpoint
+*/
+static int treeRestoreLevel(nbCELL context,BTree *tree,BTreeNode **rootP,nbCHECKPOINT checkpoint){
+  NB_TreePath path;
+  BTreeNode *node;
+  BTreeKey treeKey;
+  nbCELL key,value;
+  unsigned long long count,flags;
+
+  if(nbCheckpointGetInt(context,checkpoint,&count)) return(-1);
+  for(;count>0;count--){
+    if((key=nbCheckpointGetCell(context,checkpoint))==NULL) return(-1);
+    treeKeySet(context,tree,&treeKey,key);
+    node=treeLocate(tree,&path,&treeKey,rootP);
+    if(node==NULL){
+      node=treeNodeNew(tree,rootP,&treeKey);
+      nbTreeInsert(&path,(NB_TreeNode *)node);  // node takes our reference to the key
+      }
+    else nbCellDrop(context,key);
+    if(nbCheckpointGetInt(context,checkpoint,&flags)) return(-1);
+    if(flags&1){
+      if((value=nbCheckpointGetCell(context,checkpoint))==NULL) return(-1);
+      if(node->value!=NULL) nbCellDrop(context,node->value);
+      node->value=value;
+      }
+    if(flags&2 && treeRestoreLevel(context,tree,&node->root,checkpoint)) return(-1);
+    }
+  return(0);
+  }
+
+static int treeRestore(nbCELL context,BTreeSkill *skillHandle,BTree *tree,nbCHECKPOINT checkpoint){
+  if(tree->root!=NULL) tree->root=removeTree(context,tree,tree->root);
+  return(treeRestoreLevel(context,tree,&tree->root,checkpoint));
+  }
+
 // Prune a tree at the selected node without removing the selected node
 //
 static void treePrune(nbCELL context,BTreeSkill *skillHandle,BTree *tree,nbCELL arglist,char *text){
   BTreeNode *node=NULL;
   nbSET argSet;
   nbCELL argCell;
-  void *ptr;
+  BTreeNode **levelP;
 
   argSet=nbListOpen(context,arglist);
   if(argSet==NULL){
@@ -665,11 +909,11 @@ static void treePrune(nbCELL context,BTreeSkill *skillHandle,BTree *tree,nbCELL
       }
     }
   else{
-    ptr=&tree->root;
+    levelP=&tree->root;
     if(argSet!=NULL){
-      while((argCell=nbListGetCellValue(context,&argSet))!=NULL && (node=treeFindArg(context,tree,argCell,&ptr))!=NULL){ 
+      while((argCell=nbListGetCellValue(context,&argSet))!=NULL && (node=treeFindArg(context,tree,argCell,levelP))!=NULL){ 
         nbCellDrop(context,argCell);
-        ptr=&node->root;   
+        levelP=&node->root;
         }
       if(argCell!=NULL){
         //nbLogMsg(context,0,'E',"Entry not found.");
@@ -683,6 +927,70 @@ static void treePrune(nbCELL context,BTreeSkill *skillHandle,BTree *tree,nbCELL
     }
   }
 
+/*
+*  Measure assert and evaluate rates
+*
+*    <node>:bench [<rows>]
+*
+*    A scratch tree with the options of the node is loaded with rows of
+*    three columns ("a<n>",<n>,"c<n>"), where the first column has 16
+*    values and the second column distinguishes rows within them.  Each row
+*    is then evaluated.  Rows are asserted and evaluated in a shuffled
+*    order, as they would be in a lookup table.  The node itself is not
+*    modified.
+*/
+static void treeBench(nbCELL context,BTreeSkill *skillHandle,BTree *tree,char *cursor){
+  BTree bench;
+  nbCELL *rows,cell;
+  char text[128],*textCursor;
+  int n=100000,i,j,errors=0;
+  unsigned int seed=1;
+  clock_t clockBegin,clockAssert,clockEvaluate;
+  double assertSeconds,evaluateSeconds;
+
+  if(*cursor>='0' && *cursor<='9') n=atoi(cursor);
+  if(n<1 || n>10000000){
+    nbLogMsg(context,0,'E',"Bench rows must be from 1 to 10000000.");
+    return;
+    }
+  memset(&bench,0,sizeof(BTree));
+  bench.options=tree->options&~BTREE_OPTION_TRACE;
+  bench.nodeSize=tree->nodeSize;
+  bench.notfound=NB_CELL_UNKNOWN;
+  bench.found=NB_CELL_UNKNOWN;
+  if(bench.options&BTREE_OPTION_HASH) treeHashInit(&bench);
+  rows=(nbCELL *)nbAlloc(n*sizeof(nbCELL));
+  for(i=0;i<n;i++){
+    sprintf(text,"\"a%d\",%d,\"c%d\")",i%16,i/16,i%7);
+    textCursor=text;
+    rows[i]=nbCellGrab(context,nbListCreate(context,&textCursor));
+    }
+  for(i=n-1;i>0;i--){  // shuffle with a fixed generator so runs are comparable
+    seed=seed*1103515245+12345;
+    j=(seed>>8)%(i+1);
+    cell=rows[i];
+    rows[i]=rows[j];
+    rows[j]=cell;
+    }
+  clockBegin=clock();
+  for(i=0;i<n;i++) treeAssert(context,skillHandle,&bench,rows[i],NB_CELL_TRUE);
+  clockAssert=clock();
+  for(i=0;i<n;i++){
+    cell=treeEvaluate(context,skillHandle,&bench,rows[i]);
+    if(cell!=NB_CELL_TRUE) errors++;
+    }
+  clockEvaluate=clock();
+  assertSeconds=(double)(clockAssert-clockBegin)/CLOCKS_PER_SEC;
+  evaluateSeconds=(double)(clockEvaluate-clockAssert)/CLOCKS_PER_SEC;
+  nbLogMsg(context,0,'I',"Asserted %d rows in %.3f seconds (%.0f per second)",n,assertSeconds,assertSeconds>0 ? n/assertSeconds : 0);
+  nbLogMsg(context,0,'I',"Evaluated %d rows in %.3f seconds (%.0f per second)",n,evaluateSeconds,evaluateSeconds>0 ? n/evaluateSeconds : 0);
+  if(errors) nbLogMsg(context,0,'E',"Evaluation returned the wrong value for %d rows",errors);
+  if(bench.root!=NULL) removeTree(context,&bench,bench.root);
+  if(bench.hash!=NULL) nbFree(bench.hash,bench.hashSize*sizeof(BTreeNode *));
+  for(i=0;i<n;i++) nbCellDrop(context,rows[i]);
+  nbFree(rows,n*sizeof(nbCELL));
+  }
+
 static int treeGetIdent(char **cursorP,char *ident,int size){
   char *cursor=*cursorP,*delim;
   int len;
@@ -725,6 +1033,7 @@ static int *treeCommand(nbCELL context,BTreeSkill *skillHandle,BTree *tree,nbCEL
   else if(strcmp(ident,"balance")==0) treeBalance(context,skillHandle,tree);
   else if(strcmp(ident,"store")==0) treeStore(context,skillHandle,tree,arglist,cursor);
   else if(strcmp(ident,"prune")==0) treePrune(context,skillHandle,tree,arglist,cursor);
+  else if(strcmp(ident,"bench")==0) treeBench(context,skillHandle,tree,cursor);
   else nbLogMsg(context,0,'E',"Verb \"%s\" not recognized.",ident);
   return(0);
   }
@@ -807,6 +1116,8 @@ extern void *treeBind(nbCELL context,void *moduleHandle,nbCELL skill,nbCELL argl
   nbSkillSetMethod(context,skill,NB_NODE_EVALUATE,treeEvaluate);
   nbSkillSetMethod(context,skill,NB_NODE_SHOW,treeShow);
   nbSkillSetMethod(context,skill,NB_NODE_COMMAND,treeCommand);
+  nbSkillSetMethod(context,skill,NB_NODE_SAVE,treeSave);
+  nbSkillSetMethod(context,skill,NB_NODE_RESTORE,treeRestore);
 
   // 2013-12-07 eat - experimenting with facets
   facet=nbSkillFacet(context,skill,"prune");
@@ -0,0 +1,25 @@
+#!/usr/bin/perl
+# Show latency for check/latency.nb- and look for the stages of the udp
+# server event in the show output and in the metrics.
+use IO::Socket::UNIX;
+$|=1;
+($out,$path)=@ARGV;
+print("show %latency\n");
+for($i=0;$i<10;$i++){
+  open(OUT,$out) or exit 1;
+  $text=join('',<OUT>);
+  close(OUT);
+  last if($text=~/^server +fire /m);
+  sleep 1;
+  }
+unlink($out);
+$rows=0;
+foreach $stage ('wait','handler','command','react','rule','fire'){
+  $rows++ if($text=~/^server +$stage +\d+ +\d+\.\d+/m);
+  }
+print("assert rows=$rows;\n");
+$sock=IO::Socket::UNIX->new(Type=>SOCK_STREAM,Peer=>$path) or exit 1;
+$text=join('',<$sock>);
+close($sock);
+print("metric close\n");
+print("assert exposed=1;\n") if($text=~/^nb_event_latency_seconds_bucket\{node="server",stage="fire",le="\+Inf"\} \d+$/m);
@@ -0,0 +1,57 @@
+#!/usr/bin/perl
+# Send pipelined and oversized requests and assert the results
+use IO::Socket::INET;
+$|=1;
+my $port=shift;
+my $dir="check/pipeline";
+
+sub connect{
+  my $socket;
+  for(my $try=0;$try<20 && !$socket;$try++){
+    $socket=IO::Socket::INET->new(PeerAddr=>"127.0.0.1",PeerPort=>$port,Proto=>"tcp") or select(undef,undef,undef,0.1);
+    }
+  $socket or die "unable to connect: $!";
+  return($socket);
+  }
+
+sub reply{
+  my($socket)=@_;
+  my($line,$status,%head,$body);
+  $line=<$socket>;
+  ($status)=$line=~/^HTTP\/1\.\d (\d+)/ or return;
+  while(($line=<$socket>)=~/^([^:\r\n]+):\s*(.*?)\r?$/){$head{lc($1)}=$2;}
+  read($socket,$body,$head{"content-length"});
+  return($status,$body);
+  }
+
+# Pipelined requests over 64KB, so one is split between input pages
+my @file=("a","b","c");
+my $socket=&connect;
+my $requests="";
+for(my $i=0;$i<400;$i++){
+  $requests.="GET /$file[$i%3].html HTTP/1.1\r\nHost: 127.0.0.1\r\nX-Request: $i".("." x 150)."\r\n\r\n";
+  }
+print $socket $requests;
+my $ok=length($requests)>65536;
+for(my $i=0;$i<400 && $ok;$i++){
+  my($status,$body)=reply($socket);
+  $ok=($status==200 && $body eq "<html>$file[$i%3]</html>\n");
+  }
+close($socket);
+print("assert pipelined=",$ok ? 1 : 0,";\n");
+
+# Header fields larger than the request buffer
+$socket=&connect;
+print $socket "GET /a.html HTTP/1.1\r\nHost: 127.0.0.1\r\nX-Pad: ".("." x 20000)."\r\n\r\n";
+my($status)=reply($socket);
+close($socket);
+print("assert header=",$status==431 ? 1 : 0,";\n");
+
+# Content larger than the request buffer
+$socket=&connect;
+print $socket "POST /a.html HTTP/1.1\r\nHost: 127.0.0.1\r\nContent-Length: 20000\r\n\r\n";
+($status)=reply($socket);
+close($socket);
+unlink(glob("$dir/*"));
+rmdir($dir);
+print("assert content=",$status==413 ? 1 : 0,";\n");
@@ -0,0 +1,54 @@
+#!/usr/bin/perl
+# Request static files on one connection and assert the results
+use IO::Socket::INET;
+$|=1;
+my $port=shift;
+my $dir="check/static";
+my $socket;
+for(my $try=0;$try<20 && !$socket;$try++){
+  $socket=IO::Socket::INET->new(PeerAddr=>"127.0.0.1",PeerPort=>$port,Proto=>"tcp") or select(undef,undef,undef,0.1);
+  }
+$socket or die "unable to connect: $!";
+
+sub get{
+  my($file,$header)=@_;
+  my($line,%head,$body);
+  print $socket "GET /$file HTTP/1.1\r\nHost: 127.0.0.1\r\n$header\r\n";
+  $line=<$socket>;
+  return(undef) if($line!~/^HTTP\/1\.\d 200/);
+  while(($line=<$socket>)=~/^([^:\r\n]+):\s*(.*?)\r?$/){$head{lc($1)}=$2;}
+  read($socket,$body,$head{"content-length"});
+  return($body,$head{"content-encoding"});
+  }
+
+sub file{
+  my($file)=@_;
+  local $/;
+  open(FILE,"<$dir/$file");
+  binmode(FILE);
+  my $data=<FILE>;
+  close(FILE);
+  return($data);
+  }
+
+# A cached file is served again from memory and reloaded when it changes
+my($first)=get("cached.html","");
+my($second)=get("cached.html","");
+open(FILE,">$dir/cached.html");
+print(FILE "<html>changed in cache</html>\n");
+close(FILE);
+my($third)=get("cached.html","");
+print("assert cached=",($first eq "<html>cached</html>\n" && $second eq $first && $third eq file("cached.html")) ? 1 : 0,";\n");
+
+# A precompressed file is only served to a client that accepts gzip
+my($plain,$plainEncoding)=get("zipped.html","");
+my($zipped,$encoding)=get("zipped.html","Accept-Encoding: gzip, deflate\r\n");
+print("assert gzip=",($plain eq file("zipped.html") && !$plainEncoding && $encoding eq "gzip" && $zipped eq file("zipped.html.gz")) ? 1 : 0,";\n");
+
+# A file over CacheFileSize is sent with sendfile
+my($large)=get("sendfile.html","");
+my $sendfile=(length($large)>1024 && $large eq file("sendfile.html")) ? 1 : 0;
+close($socket);
+unlink(glob("$dir/*"));
+rmdir($dir);
+print("assert sendfile=$sendfile;\n");
@@ -74,6 +74,7 @@
 * 2012-12-15 eat 0.8.13 Checker updates
 * 2013-01-21 eat 0.8.13 Checker updates
 * 2013-04-06 eat 0.8.14 Checker updates
+* 2026-10-18 eat 0.9.04 Included :metrics resource for Prometheus scrapes
 *=====================================================================
 */
 #include "config.h"
@@ -1116,6 +1117,19 @@ static int webHelp(nbCELL context,nbWebSession *session,void *handle){
   return(0);
   }
 
+static void webMetricPut(nbCELL context,void *handle,char *text){
+  nbWebsterPutText(context,(nbWebSession *)handle,text);
+  }
+
+/*
+*  Expose engine metrics in the Prometheus text format
+*/
+static int webMetrics(nbCELL context,nbWebSession *session,void *handle){
+  nbWebsterSetType(context,session,"text","plain; version=0.0.4");
+  nbMetricExpose(context,session,webMetricPut);
+  return(0);
+  }
+
 //======================================================================================
 // Methods using Webster API
 //======================================================================================
@@ -1200,6 +1214,7 @@ static int websterEnable(nbCELL context,void *skillHandle,nbWebster *webster){
   nbWebsterRegisterResource(context,webster->webserver,":file",webster,webPath);
   nbWebsterRegisterResource(context,webster->webserver,":nb",webster,webCommand);
   nbWebsterRegisterResource(context,webster->webserver,":help",webster,webHelp);
+  nbWebsterRegisterResource(context,webster->webserver,":metrics",webster,webMetrics);
   // get options
   //webster->rootdir=strdup(getOption(context,"DocumentRoot","web"));
   //if(!webster->rootdir) nbExit("websterEnable: Out of memory - terminating");